@@ -1,9 +1,54 @@
 #include "Application.hpp"
 #include "Window.hpp"
 #include "VulkanContext.hpp"
+#include "GpuPagePool.hpp"
 #include "Logger.hpp"
+#include "Core/FrameProfiler.hpp"
+#include "Core/JobSystem.hpp"
+#include "Culling/ClusterCulling.hpp"
+#include "Culling/ClusterHierarchy.hpp"
+#include "Culling/LodSelector.hpp"
+#include "Culling/OcclusionCuller.hpp"
+#include "Raster/SoftwareRasterizer.hpp"
+#include "Scene/InstanceStore.hpp"
+#include "Streaming/PageCache.hpp"
+#include "Streaming/PageDecoder.hpp"
+#include "Streaming/PageStreamer.hpp"
+#include "Streaming/PagedGeometry.hpp"
+#include <glm/gtc/matrix_transform.hpp>
 #include <tracy/Tracy.hpp>
+#include <algorithm>
 #include <chrono>
+#include <format>
+#include <functional>
+#include <limits>
+
+namespace {
+
+// Duration of one pass along the camera path in windowed runs without a frame count
+constexpr float kCameraPathSeconds = 20.0f;
+// World-space box around the grid cells a cluster's positions can take under an affine
+// transform
+auto makeOcclusionBox(const PageCluster& cluster, float positionStep, const glm::mat4& transform)
+    -> OcclusionBox {
+    glm::vec3 halfExtent{0.0f};
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        const auto steps = static_cast<float>((1u << cluster.positionBits[axis]) - 1);
+        halfExtent[axis] = positionStep * steps * 0.5f;
+    }
+    const glm::vec3 center =
+        glm::vec3{transform * glm::vec4{cluster.positionMin + halfExtent, 1.0f}};
+    const glm::vec3 worldHalfExtent = glm::abs(glm::vec3{transform[0]}) * halfExtent.x +
+                                      glm::abs(glm::vec3{transform[1]}) * halfExtent.y +
+                                      glm::abs(glm::vec3{transform[2]}) * halfExtent.z;
+    return OcclusionBox{center - worldHalfExtent, center + worldHalfExtent};
+}
+
+auto makeClusterKey(const SelectedCluster& selected) -> uint64_t {
+    return static_cast<uint64_t>(selected.instance) << 32 | selected.cluster;
+}
+
+} // namespace
 
 auto Application::create(const Config& config) -> Result<Application> {
     ZoneScoped;
@@ -21,34 +66,179 @@ auto Application::initialize(const Config& config) -> VoidResult {
     Logger::init();
     Logger::info("Initializing application: {}", config.applicationName);
 
-    auto windowResult = Window::create(
-        config.applicationName,
-        config.windowWidth,
-        config.windowHeight
-    );
+    if (config.headless && config.frameCount == 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            "Headless runs need a frame count"
+        ));
+    }
+    m_frameCount = config.frameCount;
+
+    if (!config.benchmarkOutput.empty()) {
+        if (config.frameCount == 0) {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidArgument,
+                "Benchmarks need a frame count"
+            ));
+        }
+        m_benchmarkOutput = config.benchmarkOutput;
+        m_profiler = std::make_unique<FrameProfiler>(config.frameCount);
+        m_profiler->setMetadata("backend", config.renderBackend == RenderBackend::Vulkan
+                                               ? "vulkan"
+                                               : "software");
+        m_profiler->setMetadata("headless", config.headless ? "true" : "false");
+        m_profiler->setMetadata("geometry", config.geometryPath);
+        m_profiler->setMetadata("resolution",
+                                std::format("{}x{}", config.windowWidth, config.windowHeight));
+    }
+
+    if (!config.headless) {
+        auto windowResult = Window::create(
+            config.applicationName,
+            config.windowWidth,
+            config.windowHeight
+        );
+
+        if (!windowResult) {
+            return std::unexpected(windowResult.error());
+        }
+
+        m_window = std::make_unique<Window>(std::move(*windowResult));
+    }
+
+    // Shared by LOD selection, culling and rasterization
+    m_jobSystem = JobSystem::create();
 
-    if (!windowResult) {
-        return std::unexpected(windowResult.error());
+    if (config.renderBackend == RenderBackend::Vulkan) {
+        auto vulkanResult = config.headless
+            ? VulkanContext::createHeadless(
+                config.applicationName,
+                config.enableValidationLayers,
+                config.windowWidth,
+                config.windowHeight,
+                config.framesInFlight,
+                config.pipelineCacheDirectory
+            )
+            : VulkanContext::create(
+                *m_window,
+                config.applicationName,
+                config.enableValidationLayers,
+                config.framesInFlight,
+                config.pipelineCacheDirectory
+            );
+
+        if (!vulkanResult) {
+            return std::unexpected(vulkanResult.error());
+        }
+
+        m_vulkanContext = std::make_unique<VulkanContext>(std::move(*vulkanResult));
+    } else {
+        m_rasterizer = std::make_unique<SoftwareRasterizer>(SoftwareRasterizer::Config{
+            .width = config.windowWidth,
+            .height = config.windowHeight,
+        });
+        Logger::info("Rendering with the software rasterizer on {} threads, nothing is presented",
+                     m_jobSystem->getThreadCount());
     }
 
-    m_window = std::make_unique<Window>(std::move(*windowResult));
+    if (!config.geometryPath.empty()) {
+        if (auto result = loadGeometry(config.geometryPath, config.geometryBudgetBytes); !result) {
+            return std::unexpected(result.error());
+        }
+        if (m_vulkanContext) {
+            auto pagePoolResult = GpuPagePool::create(*m_vulkanContext,
+                                                      m_pageCache->getStats().slotCount,
+                                                      m_geometry->getHeader().pageSize);
+            if (!pagePoolResult) {
+                return std::unexpected(pagePoolResult.error());
+            }
+            m_gpuPages = std::move(*pagePoolResult);
+        }
+    }
 
-    auto vulkanResult = VulkanContext::create(
-        *m_window,
-        config.applicationName,
-        config.enableValidationLayers
-    );
+    m_cameraPath = config.cameraPath;
+    if (m_cameraPath.isEmpty()) {
+        m_cameraPath = CameraPath::orbit(m_geometry ? m_geometry->getHeader().bounds
+                                                    : glm::vec4{0.0f, 0.0f, 0.0f, 1.0f});
+    }
 
-    if (!vulkanResult) {
-        return std::unexpected(vulkanResult.error());
+    if (m_geometry) {
+        auto hierarchyResult = ClusterHierarchy::fromPagedGeometry(*m_geometry);
+        if (!hierarchyResult) {
+            return std::unexpected(hierarchyResult.error());
+        }
+        m_hierarchy = std::make_unique<ClusterHierarchy>(std::move(*hierarchyResult));
+        m_lodSelector = std::make_unique<LodSelector>();
+        m_cullBounds = std::make_unique<ClusterCullBounds>();
+        if (config.occlusionCulling) {
+            m_occlusionCuller = std::make_unique<OcclusionCuller>(OcclusionCuller::Config{});
+        }
     }
 
-    m_vulkanContext = std::make_unique<VulkanContext>(std::move(*vulkanResult));
+    // The scene is a single instance of the loaded geometry for now
+    m_instances = std::make_unique<InstanceStore>();
+    if (m_geometry) {
+        m_instances->add(m_instances->addMesh(m_geometry->getHeader().bounds), glm::mat4{1.0f});
+    }
 
     Logger::info("Application initialized successfully");
     return {};
 }
 
+auto Application::loadGeometry(const std::string& path, uint64_t budgetBytes) -> VoidResult {
+    ZoneScoped;
+    using Clock = std::chrono::high_resolution_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+
+    // Only the header and hierarchy are read here; no page is touched until it is streamed in
+    const auto start = Clock::now();
+    auto geometryResult = PagedGeometry::open(path);
+    if (!geometryResult) {
+        return std::unexpected(geometryResult.error());
+    }
+
+    m_geometry = std::make_unique<PagedGeometry>(std::move(*geometryResult));
+
+    const PageFileHeader& header = m_geometry->getHeader();
+    Logger::info("Mapped geometry {}: {} triangles in {} pages, {} KiB resident ({:.2f} ms)",
+                 path, header.triangleCount, header.pageCount, header.hierarchySize / 1024,
+                 Milliseconds(Clock::now() - start).count());
+
+    auto streamerResult = PageStreamer::create(*m_geometry, path, PageStreamer::Config{});
+    if (!streamerResult) {
+        return std::unexpected(streamerResult.error());
+    }
+    m_pageStreamer = std::move(*streamerResult);
+
+    auto cacheResult = PageCache::create(*m_geometry, *m_pageStreamer,
+                                         PageCache::Config{budgetBytes});
+    if (!cacheResult) {
+        return std::unexpected(cacheResult.error());
+    }
+    m_pageCache = std::move(*cacheResult);
+
+    for (uint32_t page = 0; page < header.pageCount; ++page) {
+        if (m_geometry->getPageDependencies(page).empty()) {
+            m_rootPages.push_back(page);
+        }
+    }
+    return {};
+}
+
+void Application::updateStreaming() {
+    ZoneScoped;
+    const FrameProfiler::Scope scope(m_profiler.get(), FrameStage::Streaming);
+    m_pageCache->beginFrame();
+    // The roots are needed before anything can be drawn, so they always go first
+    for (uint32_t page : m_rootPages) {
+        m_pageCache->request(page, std::numeric_limits<float>::infinity());
+    }
+    for (const PageRequest& request : m_pageRequests) {
+        m_pageCache->request(request.page, request.priority);
+    }
+    m_pageCache->update();
+}
+
 Application::~Application() {
     ZoneScoped;
     Logger::info("Shutting down application");
@@ -60,17 +250,49 @@ auto Application::run() -> int {
     Logger::info("Starting main loop");
 
     mainLoop();
+
+    if (m_profiler) {
+        if (auto result = writeBenchmark(); !result) {
+            Logger::error("Failed to write the benchmark results: {}", result.error().toString());
+            return 1;
+        }
+    }
     return 0;
 }
 
+auto Application::writeBenchmark() const -> VoidResult {
+    ZoneScoped;
+    const std::string jsonPath = m_benchmarkOutput + ".json";
+    const std::string csvPath = m_benchmarkOutput + ".csv";
+    if (auto result = m_profiler->writeJson(jsonPath); !result) {
+        return result;
+    }
+    if (auto result = m_profiler->writeCsv(csvPath); !result) {
+        return result;
+    }
+
+    for (size_t index = 0; index < FrameProfiler::kStageCount; ++index) {
+        const auto stage = static_cast<FrameStage>(index);
+        const FrameProfiler::Summary summary = m_profiler->summarize(stage);
+        Logger::info("  {:>12}: p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms",
+                     FrameProfiler::getStageName(stage), summary.p50, summary.p95, summary.p99);
+    }
+    const FrameProfiler::Summary frames = m_profiler->summarizeFrames();
+    Logger::info("  {:>12}: p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms", "frame", frames.p50,
+                 frames.p95, frames.p99);
+    Logger::info("Wrote {} and {}", jsonPath, csvPath);
+    return {};
+}
+
 void Application::mainLoop() {
     ZoneScoped;
     using Clock = std::chrono::high_resolution_clock;
     using Duration = std::chrono::duration<float>;
 
-    auto lastFrameTime = Clock::now();
+    const auto startTime = Clock::now();
+    auto lastFrameTime = startTime;
 
-    while (m_isRunning && !m_window->shouldClose()) {
+    while (m_isRunning && (!m_window || !m_window->shouldClose())) {
         ZoneScopedN("Frame");
         FrameMark;
 
@@ -78,29 +300,329 @@ void Application::mainLoop() {
         const float deltaTime = Duration(currentTime - lastFrameTime).count();
         lastFrameTime = currentTime;
 
-        {
+        if (m_profiler) {
+            m_profiler->beginFrame();
+        }
+
+        if (m_window) {
             ZoneScopedN("Poll Events");
+            const FrameProfiler::Scope scope(m_profiler.get(), FrameStage::PollEvents);
             m_window->pollEvents();
         }
 
         update(deltaTime);
         render();
+
+        if (m_profiler) {
+            m_profiler->endFrame();
+        }
+
+        if (m_frameCount > 0 && ++m_frameIndex >= m_frameCount) {
+            break;
+        }
+    }
+
+    if (m_frameCount > 0) {
+        const float seconds = Duration(Clock::now() - startTime).count();
+        Logger::info("Ran {} frames in {:.2f} s, {:.2f} ms/frame", m_frameIndex, seconds,
+                     seconds * 1000.0f / static_cast<float>(std::max(m_frameIndex, 1u)));
     }
 
-    m_vulkanContext->waitIdle();
+    if (m_vulkanContext) {
+        m_vulkanContext->waitIdle();
+        // Compilations run on the job system, which is destroyed before the context
+        m_vulkanContext->getPipelineCache().waitForCompilation();
+    }
 }
 
-void Application::update([[maybe_unused]] float deltaTime) {
+void Application::update(float deltaTime) {
     ZoneScoped;
-    // Update logic will go here
+    const FrameProfiler::Scope scope(m_profiler.get(), FrameStage::Update);
+    m_time += deltaTime;
+    // Fixed-length runs step the path by frame, so every run sees the same views
+    m_camera = m_frameCount > 0 ? m_cameraPath.evaluateFrame(m_frameIndex, m_frameCount)
+                                : m_cameraPath.evaluate(m_time / kCameraPathSeconds);
+    // Only instances moved since the last frame are touched
+    m_instances->updateBounds(m_jobSystem.get());
+    if (m_pageCache) {
+        updateStreaming();
+    }
 }
 
 void Application::render() {
     ZoneScoped;
-    if (auto result = m_vulkanContext->beginFrame(); result) {
-        // Render commands will go here
-        m_vulkanContext->endFrame();
+    const FrameProfiler::Scope scope(m_profiler.get(), FrameStage::Render);
+    if (m_rasterizer) {
+        renderSoftware();
+        return;
+    }
+
+    if (m_window && m_window->wasResized()) {
+        m_vulkanContext->notifyResized();
+        m_window->resetResizedFlag();
+    }
+
+    if (!m_vulkanContext->beginFrame()) {
+        return;
+    }
+
+    if (m_hierarchy) {
+        const VkExtent2D extent = m_vulkanContext->isHeadless()
+            ? m_vulkanContext->getOffscreenExtent()
+            : m_vulkanContext->getSwapchainExtent();
+        selectClusters(makeFrameView(static_cast<float>(extent.width),
+                                     static_cast<float>(extent.height)));
+        m_gpuPages->update(*m_pageCache, m_residentPages);
+    }
+    m_vulkanContext->endFrame();
+}
+
+auto Application::makeFrameView(float width, float height) const -> FrameView {
+    FrameView view;
+    view.fovY = glm::radians(60.0f);
+    view.height = height;
+    view.position = m_camera.position;
+
+    // The far plane reaches past the whole mesh from wherever the camera is
+    const glm::vec4 bounds =
+        m_geometry ? m_geometry->getHeader().bounds : glm::vec4{0.0f, 0.0f, 0.0f, 1.0f};
+    view.nearDistance = bounds.w * 0.01f;
+    const float farDistance = glm::length(view.position - glm::vec3{bounds}) + bounds.w * 2.0f;
+    glm::mat4 projection =
+        glm::perspectiveRH_ZO(view.fovY, width / height, view.nearDistance, farDistance);
+    projection[1][1] *= -1.0f; // Vulkan's y points down
+    const glm::mat4 viewMatrix =
+        glm::lookAt(view.position, m_camera.target, glm::vec3{0.0f, 1.0f, 0.0f});
+    view.viewProjection = projection * viewMatrix;
+    return view;
+}
+
+void Application::selectClusters(const FrameView& view) {
+    ZoneScoped;
+    {
+        const FrameProfiler::Scope scope(m_profiler.get(), FrameStage::LodSelection);
+        const LodInstance instance{m_instances->getTransform(0)};
+        const LodCamera camera = LodCamera::fromPerspective(view.position, view.fovY,
+                                                            view.height, view.nearDistance, 1.0f);
+        // The cut only reaches resident pages and keeps coarser clusters where a finer page
+        // is missing, so everything below reads the cache's validated copies
+        m_residentPages.resize(m_geometry->getPageCount());
+        for (uint32_t page = 0; page < m_residentPages.size(); ++page) {
+            m_residentPages[page] = m_pageCache->isResident(page) ? 1 : 0;
+        }
+        m_lodSelector->select(*m_hierarchy, std::span(&instance, 1), camera, m_jobSystem.get(),
+                              m_lodCut, m_residentPages);
+        collectPageRequests(camera, instance);
+    }
+
+    const FrameProfiler::Scope scope(m_profiler.get(), FrameStage::Culling);
+    m_cullBounds->clear();
+    m_cullBounds->reserve(m_lodCut.size());
+    for (const SelectedCluster& selected : m_lodCut) {
+        const HierarchyCluster& cluster = m_hierarchy->getClusters()[selected.cluster];
+        const PageCluster& pageCluster =
+            m_pageCache->getPage(cluster.page)->clusters[cluster.index];
+        m_cullBounds->add(pageCluster.boundingSphere, pageCluster.coneAxis,
+                          pageCluster.coneCutoff);
+    }
+    m_visibleClusters.clear();
+    ClusterCuller::cull(*m_cullBounds, CullView::fromViewProjection(view.viewProjection,
+                                                                    view.position),
+                        m_visibleClusters);
+    if (m_occlusionCuller) {
+        cullOccluded(view);
+    }
+}
+
+void Application::cullOccluded(const FrameView& view) {
+    ZoneScoped;
+    const glm::mat4 transform = m_instances->getTransform(0);
+    const float scale = glm::length(glm::vec3{transform[0]});
+    const auto clusters = m_hierarchy->getClusters();
+    const auto candidateCount = static_cast<uint32_t>(m_visibleClusters.size());
+
+    // Sized for every candidate up front so the occluder spans stay valid; each cluster is
+    // decoded the first time it occludes
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    m_occlusionBoxes.clear();
+    for (const uint32_t visible : m_visibleClusters) {
+        const HierarchyCluster& cluster = clusters[m_lodCut[visible].cluster];
+        const PageCluster& pageCluster =
+            m_pageCache->getPage(cluster.page)->clusters[cluster.index];
+        vertexCount += pageCluster.vertexCount;
+        indexCount += pageCluster.triangleCount * 3;
+        m_occlusionBoxes.push_back(
+            makeOcclusionBox(pageCluster, m_geometry->getHeader().positionStep, transform));
+    }
+    m_occluderPositions.resize(vertexCount);
+    m_occluderIndices.resize(indexCount);
+    m_occluders.assign(candidateCount, Occluder{});
+    size_t vertexOffset = 0;
+    size_t indexOffset = 0;
+    auto addOccluder = [&](uint32_t candidate) {
+        Occluder& occluder = m_occluders[candidate];
+        if (occluder.indices.empty()) {
+            const SelectedCluster& selected = m_lodCut[m_visibleClusters[candidate]];
+            const HierarchyCluster& cluster = clusters[selected.cluster];
+            const PageView page = *m_pageCache->getPage(cluster.page);
+            const PageCluster& pageCluster = page.clusters[cluster.index];
+            const std::span positions =
+                std::span(m_occluderPositions).subspan(vertexOffset, pageCluster.vertexCount);
+            const std::span indices = std::span(m_occluderIndices)
+                                          .subspan(indexOffset, pageCluster.triangleCount * 3);
+            m_occluderTriangles.resize(indices.size());
+            PageDecoder::decodePositions(page, pageCluster, positions);
+            PageDecoder::decodeTriangles(page, pageCluster, m_occluderTriangles);
+            std::ranges::copy(m_occluderTriangles, indices.begin());
+            vertexOffset += positions.size();
+            indexOffset += indices.size();
+
+            const glm::vec4& sphere = pageCluster.boundingSphere;
+            const glm::vec4 center = transform * glm::vec4{glm::vec3{sphere}, 1.0f};
+            occluder = Occluder{positions, indices, transform,
+                                glm::vec4{glm::vec3{center}, sphere.w * scale}};
+        }
+        m_occlusionCuller->addOccluder(occluder);
+    };
+    auto wasVisible = [&](uint32_t candidate) {
+        return std::ranges::binary_search(
+            m_previousVisible, makeClusterKey(m_lodCut[m_visibleClusters[candidate]]));
+    };
+
+    // First phase: what was visible last frame and is still in the cut occludes every
+    // candidate. It is this frame's geometry, so nothing it hides can show.
+    m_occlusionCuller->beginFrame(view.viewProjection, view.position);
+    for (uint32_t candidate = 0; candidate < candidateCount; ++candidate) {
+        if (wasVisible(candidate)) {
+            addOccluder(candidate);
+        }
+    }
+    m_occlusionCuller->rasterize(m_jobSystem.get());
+    m_occlusionVisible.clear();
+    m_occlusionCuller->cullBoxes(m_occlusionBoxes, m_occlusionVisible);
+
+    // Second phase: the newly visible clusters join the occluders and are tested again, so a
+    // cluster disoccluded this frame can still be hidden behind another one
+    m_occlusionPassed.assign(candidateCount, 0);
+    m_occlusionRetest.clear();
+    for (const uint32_t candidate : m_occlusionVisible) {
+        m_occlusionPassed[candidate] = 1;
+        if (!wasVisible(candidate)) {
+            m_occlusionRetest.push_back(candidate);
+        }
+    }
+    if (!m_occlusionRetest.empty()) {
+        m_occlusionCuller->beginFrame(view.viewProjection, view.position);
+        for (const uint32_t candidate : m_occlusionVisible) {
+            addOccluder(candidate);
+        }
+        m_occlusionCuller->rasterize(m_jobSystem.get());
+        for (const uint32_t candidate : m_occlusionRetest) {
+            if (m_occlusionCuller->isOccluded(m_occlusionBoxes[candidate])) {
+                m_occlusionPassed[candidate] = 0;
+            }
+        }
+    }
+
+    uint32_t passedCount = 0;
+    for (uint32_t candidate = 0; candidate < candidateCount; ++candidate) {
+        if (m_occlusionPassed[candidate] != 0) {
+            m_visibleClusters[passedCount++] = m_visibleClusters[candidate];
+        }
+    }
+    m_visibleClusters.resize(passedCount);
+    m_occlusionTested += candidateCount;
+    m_occlusionCulled += candidateCount - passedCount;
+
+    m_previousVisible.clear();
+    for (const uint32_t visible : m_visibleClusters) {
+        m_previousVisible.push_back(makeClusterKey(m_lodCut[visible]));
+    }
+    std::ranges::sort(m_previousVisible);
+}
+
+void Application::collectPageRequests(const LodCamera& camera, const LodInstance& instance) {
+    ZoneScoped;
+    // The cut's own pages are kept, and the pages refining the clusters that only stand in
+    // for a missing finer group are fetched
+    m_pageRequests.clear();
+    for (const SelectedCluster& selected : m_lodCut) {
+        const HierarchyCluster& cluster = m_hierarchy->getClusters()[selected.cluster];
+        m_pageRequests.push_back(PageRequest{cluster.page, 0.0f});
+        if (cluster.childPage != kNoChildPage && m_residentPages[cluster.childPage] == 0 &&
+            LodSelector::projectError(camera, instance, cluster.error, cluster.lodBounds) >
+                camera.errorThreshold) {
+            m_pageRequests.push_back(PageRequest{cluster.childPage, 0.0f});
+        }
+    }
+    std::ranges::sort(m_pageRequests, {}, &PageRequest::page);
+    const auto duplicates = std::ranges::unique(m_pageRequests, {}, &PageRequest::page);
+    m_pageRequests.erase(duplicates.begin(), duplicates.end());
+
+    // Without a page its groups fall back to their parents, which are off by the groups'
+    // errors, so a page matters as much as the largest of them on screen
+    const auto pageTable = m_geometry->getPageTable();
+    const auto groups = m_geometry->getGroups();
+    for (PageRequest& request : m_pageRequests) {
+        const PageTableEntry& entry = pageTable[request.page];
+        for (const PageGroup& group : groups.subspan(entry.groupOffset, entry.groupCount)) {
+            request.priority = std::max(request.priority,
+                                        LodSelector::projectError(camera, instance, group.error,
+                                                                  group.lodBounds));
+        }
+    }
+    // The cache forwards a page at the priority of the first request that reaches it
+    std::ranges::sort(m_pageRequests, std::greater{}, &PageRequest::priority);
+}
+
+void Application::renderSoftware() {
+    ZoneScoped;
+    const FrameView view = makeFrameView(static_cast<float>(m_rasterizer->getWidth()),
+                                         static_cast<float>(m_rasterizer->getHeight()));
+    m_rasterizer->beginFrame(view.viewProjection);
+
+    if (m_hierarchy) {
+        selectClusters(view);
+
+        // The cut only holds resident pages, so every cluster is decoded from the cache's copy,
+        // which the streamer validated on arrival, rather than from the mapped file.
+        // Size the scratch first so the spans handed to the rasterizer stay valid
+        size_t vertexCount = 0;
+        size_t triangleCount = 0;
+        for (const uint32_t visible : m_visibleClusters) {
+            const HierarchyCluster& cluster =
+                m_hierarchy->getClusters()[m_lodCut[visible].cluster];
+            const PageCluster& pageCluster =
+                m_pageCache->getPage(cluster.page)->clusters[cluster.index];
+            vertexCount += pageCluster.vertexCount;
+            triangleCount += pageCluster.triangleCount;
+        }
+        m_rasterPositions.resize(vertexCount);
+        m_rasterTriangles.resize(triangleCount * 3);
+
+        size_t vertexOffset = 0;
+        size_t triangleOffset = 0;
+        for (const uint32_t visible : m_visibleClusters) {
+            const HierarchyCluster& cluster =
+                m_hierarchy->getClusters()[m_lodCut[visible].cluster];
+            const PageView page = *m_pageCache->getPage(cluster.page);
+            const PageCluster& pageCluster = page.clusters[cluster.index];
+            const std::span positions =
+                std::span(m_rasterPositions).subspan(vertexOffset, pageCluster.vertexCount);
+            const std::span triangles = std::span(m_rasterTriangles)
+                                            .subspan(triangleOffset, pageCluster.triangleCount * 3);
+            PageDecoder::decodePositions(page, pageCluster, positions);
+            PageDecoder::decodeTriangles(page, pageCluster, triangles);
+            vertexOffset += pageCluster.vertexCount;
+            triangleOffset += triangles.size();
+            m_rasterizer->addCluster(RasterCluster{positions, {}, triangles});
+        }
     }
+
+    m_rasterizer->render(m_jobSystem.get());
+    ++m_softwareFrames;
+    m_softwareMilliseconds += m_rasterizer->getStats().milliseconds;
 }
 
 void Application::shutdown() noexcept {
@@ -109,6 +631,48 @@ void Application::shutdown() noexcept {
 
     if (m_vulkanContext) {
         m_vulkanContext->waitIdle();
+        // Compilations run on the job system, which is destroyed before the context
+        m_vulkanContext->getPipelineCache().waitForCompilation();
+    }
+
+    if (m_gpuPages) {
+        const GpuPagePool::Stats& stats = m_gpuPages->getStats();
+        Logger::info("GPU page pool: {} pages ({} MiB) uploaded on the transfer queue, {} "
+                     "deferred to a later frame by a full upload ring", stats.uploadedPages,
+                     stats.uploadedBytes >> 20, stats.deferredPages);
+        m_gpuPages.reset();
+    }
+
+    if (m_pageStreamer) {
+        const PageStreamer::Stats stats = m_pageStreamer->getStats();
+        Logger::info("Streamed {} pages ({} MiB, {} failed), latency p50 {:.2f} ms, "
+                     "p95 {:.2f} ms, p99 {:.2f} ms",
+                     stats.completed, stats.bytesRead >> 20, stats.failed, stats.latencyP50Ms,
+                     stats.latencyP95Ms, stats.latencyP99Ms);
+
+        const PageCache::Stats cacheStats = m_pageCache->getStats();
+        Logger::info("Page cache: {:.1f}% hit rate, {} evictions, {} of {} slots resident",
+                     cacheStats.hitRate() * 100.0f, cacheStats.evictions,
+                     cacheStats.residentPages, cacheStats.slotCount);
+        m_pageCache.reset();
+        m_pageStreamer.reset();
+    }
+
+    if (m_occlusionCuller && m_occlusionTested > 0) {
+        Logger::info("Occlusion culling: {:.1f}% of the clusters passing frustum and cone "
+                     "culling were occluded",
+                     100.0 * static_cast<double>(m_occlusionCulled) /
+                         static_cast<double>(m_occlusionTested));
+        m_occlusionTested = 0;
+    }
+
+    if (m_rasterizer && m_softwareFrames > 0) {
+        const SoftwareRasterizer::Stats& stats = m_rasterizer->getStats();
+        Logger::info("Software rasterizer: {} frames, {:.2f} ms/frame, last frame {} clusters "
+                     "and {} triangles", m_softwareFrames,
+                     m_softwareMilliseconds / static_cast<float>(m_softwareFrames),
+                     stats.clustersSubmitted, stats.trianglesSubmitted);
+        m_softwareFrames = 0;
     }
 
     // Only terminate GLFW if we own resources (not moved-from)
@@ -1,11 +1,39 @@
 #pragma once
 
 #include "Error.hpp"
+#include "Core/CameraPath.hpp"
+#include <glm/glm.hpp>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
 class Window;
 class VulkanContext;
+class PagedGeometry;
+class PageStreamer;
+class PageCache;
+class GpuPagePool;
+class JobSystem;
+class ClusterHierarchy;
+class LodSelector;
+class SoftwareRasterizer;
+class InstanceStore;
+struct ClusterCullBounds;
+class FrameProfiler;
+struct SelectedCluster;
+struct LodCamera;
+struct LodInstance;
+class OcclusionCuller;
+struct Occluder;
+struct OcclusionBox;
+
+enum class RenderBackend : uint8_t {
+    Vulkan,
+    // CPU rasterization into a visibility buffer, for validation and machines without a GPU.
+    // Decodes the cut from the streaming cache's copies of its pages.
+    Software,
+};
 
 class Application {
 public:
@@ -14,6 +42,30 @@ public:
         uint32_t windowWidth{1280};
         uint32_t windowHeight{720};
         bool enableValidationLayers{true};
+        // Cooked .vgeo file to map at startup; empty for none
+        std::string geometryPath;
+        // Memory for resident geometry pages, never exceeded
+        uint64_t geometryBudgetBytes{256ull << 20};
+        RenderBackend renderBackend{RenderBackend::Vulkan};
+        // CPU recording of one frame overlaps GPU execution of up to this many earlier ones,
+        // clamped to [1, VulkanContext::kMaxFramesInFlight]
+        uint32_t framesInFlight{2};
+        // No GLFW, window or surface: Vulkan renders to offscreen targets on any device with a
+        // graphics queue, the software backend needs no GPU at all
+        bool headless{false};
+        // Frames to run before exiting, 0 to run until the window closes; headless runs need one
+        uint32_t frameCount{0};
+        // Camera flight, sampled per frame when frameCount is set and over time otherwise;
+        // empty orbits the geometry
+        CameraPath cameraPath{};
+        // Records the CPU time of every main loop stage per frame and writes
+        // <benchmarkOutput>.json with p50/p95/p99 summaries and <benchmarkOutput>.csv with
+        // every frame; needs a frameCount so runs are comparable
+        std::string benchmarkOutput{};
+        // Where the Vulkan pipeline cache persists between runs; empty to recompile every run
+        std::string pipelineCacheDirectory{"cache"};
+        // Hi-Z occlusion culling of the cut on the CPU after frustum and cone culling
+        bool occlusionCulling{false};
     };
 
     [[nodiscard]] static auto create(const Config& config) -> Result<Application>;
@@ -30,12 +82,87 @@ public:
 private:
     Application() = default;
     [[nodiscard]] auto initialize(const Config& config) -> VoidResult;
+    [[nodiscard]] auto loadGeometry(const std::string& path, uint64_t budgetBytes)
+        -> VoidResult;
 
     void mainLoop();
     void update(float deltaTime);
+    void updateStreaming();
+    // Camera of the current frame for a target of the given size
+    struct FrameView {
+        glm::mat4 viewProjection{1.0f};
+        glm::vec3 position{0.0f};
+        float fovY{0.0f};
+        float height{0.0f};
+        float nearDistance{0.0f};
+    };
+
     void render();
+    void renderSoftware();
+    [[nodiscard]] auto makeFrameView(float width, float height) const -> FrameView;
+    // LOD selection and culling into m_lodCut and m_visibleClusters
+    void selectClusters(const FrameView& view);
+    // Removes occluded clusters from m_visibleClusters in two phases: the clusters visible last
+    // frame occlude first, then the newly visible ones are tested again against a depth
+    // buffer that includes them
+    void cullOccluded(const FrameView& view);
+    // The cut's pages and the missing pages refining it into m_pageRequests, most important first
+    void collectPageRequests(const LodCamera& camera, const LodInstance& instance);
+    [[nodiscard]] auto writeBenchmark() const -> VoidResult;
 
     std::unique_ptr<Window> m_window;
     std::unique_ptr<VulkanContext> m_vulkanContext;
+    std::unique_ptr<PagedGeometry> m_geometry;
+    std::unique_ptr<PageStreamer> m_pageStreamer;
+    std::unique_ptr<PageCache> m_pageCache;
+    // Device copy of the cache's pages, Vulkan backend only
+    std::unique_ptr<GpuPagePool> m_gpuPages;
+    // Pages without dependencies, which are kept resident at all times
+    std::vector<uint32_t> m_rootPages;
+    struct PageRequest {
+        uint32_t page{0};
+        float priority{0.0f}; // Projected error in pixels
+    };
+    // Made by the last LOD selection and issued by the next streaming update
+    std::vector<PageRequest> m_pageRequests;
+    std::vector<uint8_t> m_residentPages; // Per page, as of this frame's selection
+
+    CameraPath m_cameraPath;
+    CameraKeyframe m_camera;
+    uint32_t m_frameCount{0};
+    uint32_t m_frameIndex{0};
+    std::unique_ptr<FrameProfiler> m_profiler;
+    std::string m_benchmarkOutput;
+
+    std::unique_ptr<JobSystem> m_jobSystem;
+    std::unique_ptr<InstanceStore> m_instances;
+    std::unique_ptr<ClusterHierarchy> m_hierarchy;
+    std::unique_ptr<LodSelector> m_lodSelector;
+    std::vector<SelectedCluster> m_lodCut;
+    std::unique_ptr<ClusterCullBounds> m_cullBounds;
+    std::vector<uint32_t> m_visibleClusters; // Indices into m_lodCut
+
+    std::unique_ptr<OcclusionCuller> m_occlusionCuller;
+    std::vector<uint64_t> m_previousVisible; // Instance and cluster of last frame's, sorted
+    // Per frustum-visible cluster of the current frame
+    std::vector<OcclusionBox> m_occlusionBoxes;
+    std::vector<Occluder> m_occluders;
+    std::vector<uint8_t> m_occlusionPassed;
+    std::vector<uint32_t> m_occlusionVisible;
+    std::vector<uint32_t> m_occlusionRetest;
+    // Decoded occluder geometry
+    std::vector<glm::vec3> m_occluderPositions;
+    std::vector<uint32_t> m_occluderIndices;
+    std::vector<uint8_t> m_occluderTriangles;
+    uint64_t m_occlusionTested{0};
+    uint64_t m_occlusionCulled{0};
+
+    // Software backend
+    std::unique_ptr<SoftwareRasterizer> m_rasterizer;
+    std::vector<glm::vec3> m_rasterPositions; // Decoded positions of the cut's clusters
+    std::vector<uint8_t> m_rasterTriangles;   // and their triangles
+    uint32_t m_softwareFrames{0};
+    float m_softwareMilliseconds{0.0f};
+    float m_time{0.0f};
     bool m_isRunning{true};
 };
\ No newline at end of file
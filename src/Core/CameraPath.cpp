@@ -0,0 +1,151 @@
+#include "CameraPath.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <numbers>
+#include <string>
+
+namespace {
+
+auto catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2,
+                const glm::vec3& p3, float t) -> glm::vec3 {
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return 0.5f * (2.0f * p1 + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+} // namespace
+
+CameraPath::CameraPath(std::vector<CameraKeyframe> keyframes, bool closed)
+    : m_keyframes(std::move(keyframes)), m_closed(closed && m_keyframes.size() > 1) {}
+
+auto CameraPath::orbit(const glm::vec4& sphere, uint32_t keyframeCount) -> CameraPath {
+    const glm::vec3 center{sphere};
+    const float distance = sphere.w * 2.5f;
+    std::vector<CameraKeyframe> keyframes(std::max(keyframeCount, 4u));
+    for (size_t i = 0; i < keyframes.size(); ++i) {
+        const float angle = 2.0f * std::numbers::pi_v<float> * static_cast<float>(i) /
+                            static_cast<float>(keyframes.size());
+        keyframes[i].position = center + glm::vec3{std::cos(angle) * distance, sphere.w * 0.5f,
+                                                   std::sin(angle) * distance};
+        keyframes[i].target = center;
+    }
+    return CameraPath(std::move(keyframes), true);
+}
+
+auto CameraPath::load(const std::filesystem::path& path) -> Result<CameraPath> {
+    std::ifstream file(path);
+    if (!file) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open camera path {}", path.string())
+        ));
+    }
+
+    std::vector<CameraKeyframe> keyframes;
+    bool closed = false;
+    std::string line;
+    for (uint32_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        if (line.compare(first, 6, "closed") == 0) {
+            closed = true;
+            continue;
+        }
+
+        std::array<float, 6> values{};
+        const char* cursor = line.data() + first;
+        const char* end = line.data() + line.size();
+        for (float& value : values) {
+            while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+                ++cursor;
+            }
+            auto [ptr, ec] = std::from_chars(cursor, end, value);
+            if (ec != std::errc{}) {
+                return std::unexpected(makeError(
+                    ErrorCode::FileParseFailed,
+                    std::format("{}:{}: expected six numbers", path.string(), lineNumber)
+                ));
+            }
+            cursor = ptr;
+        }
+        keyframes.push_back(CameraKeyframe{glm::vec3{values[0], values[1], values[2]},
+                                           glm::vec3{values[3], values[4], values[5]}});
+    }
+
+    if (keyframes.empty()) {
+        return std::unexpected(makeError(
+            ErrorCode::FileParseFailed,
+            std::format("Camera path {} has no keyframes", path.string())
+        ));
+    }
+    return CameraPath(std::move(keyframes), closed);
+}
+
+auto CameraPath::save(const std::filesystem::path& path) const -> VoidResult {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {}", path.string())
+        ));
+    }
+
+    file << "# px py pz tx ty tz\n";
+    if (m_closed) {
+        file << "closed\n";
+    }
+    for (const CameraKeyframe& keyframe : m_keyframes) {
+        file << std::format("{} {} {} {} {} {}\n", keyframe.position.x, keyframe.position.y,
+                            keyframe.position.z, keyframe.target.x, keyframe.target.y,
+                            keyframe.target.z);
+    }
+
+    if (!file.good()) {
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to write {}", path.string())
+        ));
+    }
+    return {};
+}
+
+auto CameraPath::evaluate(float t) const -> CameraKeyframe {
+    if (m_keyframes.size() < 2) {
+        return m_keyframes.empty() ? CameraKeyframe{} : m_keyframes.front();
+    }
+
+    const auto count = static_cast<int64_t>(m_keyframes.size());
+    const int64_t segments = m_closed ? count : count - 1;
+    t = m_closed ? t - std::floor(t) : std::clamp(t, 0.0f, 1.0f);
+    const float position = t * static_cast<float>(segments);
+    const int64_t segment =
+        std::clamp(static_cast<int64_t>(std::floor(position)), int64_t{0}, segments - 1);
+    const float local = position - static_cast<float>(segment);
+
+    // Open paths repeat their end keyframes, which keeps the ends from overshooting
+    auto key = [&](int64_t index) -> const CameraKeyframe& {
+        index = m_closed ? (index % count + count) % count
+                         : std::clamp(index, int64_t{0}, count - 1);
+        return m_keyframes[static_cast<size_t>(index)];
+    };
+    const CameraKeyframe& k0 = key(segment - 1);
+    const CameraKeyframe& k1 = key(segment);
+    const CameraKeyframe& k2 = key(segment + 1);
+    const CameraKeyframe& k3 = key(segment + 2);
+    return CameraKeyframe{
+        catmullRom(k0.position, k1.position, k2.position, k3.position, local),
+        catmullRom(k0.target, k1.target, k2.target, k3.target, local),
+    };
+}
+
+auto CameraPath::evaluateFrame(uint32_t frame, uint32_t frameCount) const -> CameraKeyframe {
+    const uint32_t divisor = m_closed ? std::max(frameCount, 1u) : std::max(frameCount, 2u) - 1;
+    return evaluate(static_cast<float>(frame) / static_cast<float>(divisor));
+}
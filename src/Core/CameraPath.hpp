@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Error.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+struct CameraKeyframe {
+    glm::vec3 position{0.0f};
+    glm::vec3 target{0.0f, 0.0f, -1.0f};
+};
+
+// Camera flight through keyframes, interpolated with uniform Catmull-Rom splines so speed and
+// direction change smoothly. Parameterised by frame rather than time, so scripted runs see the
+// same views however long each frame takes.
+class CameraPath {
+public:
+    CameraPath() = default;
+    // A closed path continues from the last keyframe back to the first
+    explicit CameraPath(std::vector<CameraKeyframe> keyframes, bool closed = false);
+
+    // Circles a bounding sphere once, slightly above its centre, looking at it
+    [[nodiscard]] static auto orbit(const glm::vec4& sphere, uint32_t keyframeCount = 16)
+        -> CameraPath;
+
+    // Text file with one keyframe per line as "px py pz tx ty tz"; a line reading "closed"
+    // closes the path and lines starting with '#' are comments
+    [[nodiscard]] static auto load(const std::filesystem::path& path) -> Result<CameraPath>;
+    [[nodiscard]] auto save(const std::filesystem::path& path) const -> VoidResult;
+
+    // t in [0, 1] covers the whole path; values outside wrap for closed paths and clamp
+    // otherwise
+    [[nodiscard]] auto evaluate(float t) const -> CameraKeyframe;
+    // Frame index of frameCount evenly spaced samples; a closed path does not repeat its start
+    [[nodiscard]] auto evaluateFrame(uint32_t frame, uint32_t frameCount) const
+        -> CameraKeyframe;
+
+    [[nodiscard]] auto isEmpty() const noexcept -> bool { return m_keyframes.empty(); }
+    [[nodiscard]] auto isClosed() const noexcept -> bool { return m_closed; }
+    [[nodiscard]] auto getKeyframes() const noexcept -> std::span<const CameraKeyframe> {
+        return m_keyframes;
+    }
+
+private:
+    std::vector<CameraKeyframe> m_keyframes;
+    bool m_closed{false};
+};
@@ -0,0 +1,205 @@
+#include "FrameProfiler.hpp"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <numeric>
+
+namespace {
+
+using Milliseconds = std::chrono::duration<float, std::milli>;
+
+auto summarizeSamples(std::vector<float> samples) -> FrameProfiler::Summary {
+    FrameProfiler::Summary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0f) /
+                   static_cast<float>(samples.size());
+    // Same nearest-rank convention as the streaming latency percentiles
+    std::ranges::sort(samples);
+    auto percentile = [&](float fraction) {
+        return samples[static_cast<size_t>(fraction * static_cast<float>(samples.size() - 1))];
+    };
+    summary.p50 = percentile(0.50f);
+    summary.p95 = percentile(0.95f);
+    summary.p99 = percentile(0.99f);
+    summary.max = samples.back();
+    return summary;
+}
+
+auto escapeJson(std::string_view text) -> std::string {
+    std::string escaped;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += std::format("\\u{:04x}", static_cast<unsigned>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+auto formatSummary(const FrameProfiler::Summary& summary) -> std::string {
+    return std::format("{{\"mean\": {:.4f}, \"p50\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f}, "
+                       "\"max\": {:.4f}}}", summary.mean, summary.p50, summary.p95, summary.p99,
+                       summary.max);
+}
+
+} // namespace
+
+FrameProfiler::Scope::Scope(FrameProfiler* profiler, FrameStage stage) noexcept
+    : m_profiler(profiler), m_stage(stage) {
+    if (m_profiler) {
+        m_parent = m_profiler->m_activeScope;
+        m_profiler->m_activeScope = this;
+        m_start = std::chrono::steady_clock::now();
+    }
+}
+
+FrameProfiler::Scope::~Scope() {
+    if (!m_profiler) {
+        return;
+    }
+    const float elapsed = Milliseconds(std::chrono::steady_clock::now() - m_start).count();
+    if (m_parent) {
+        m_parent->m_childMilliseconds += elapsed;
+    }
+    m_profiler->m_activeScope = m_parent;
+    if (m_profiler->m_inFrame) {
+        m_profiler->m_frames.back().stageMilliseconds[static_cast<size_t>(m_stage)] +=
+            std::max(elapsed - m_childMilliseconds, 0.0f);
+    }
+}
+
+FrameProfiler::FrameProfiler(uint32_t expectedFrames) {
+    m_frames.reserve(expectedFrames);
+}
+
+void FrameProfiler::beginFrame() {
+    m_frames.emplace_back();
+    m_frameStart = std::chrono::steady_clock::now();
+    m_inFrame = true;
+}
+
+void FrameProfiler::endFrame() {
+    if (!m_inFrame) {
+        return;
+    }
+    m_frames.back().milliseconds =
+        Milliseconds(std::chrono::steady_clock::now() - m_frameStart).count();
+    m_inFrame = false;
+}
+
+void FrameProfiler::setMetadata(std::string key, std::string value) {
+    for (auto& [existingKey, existingValue] : m_metadata) {
+        if (existingKey == key) {
+            existingValue = std::move(value);
+            return;
+        }
+    }
+    m_metadata.emplace_back(std::move(key), std::move(value));
+}
+
+auto FrameProfiler::summarize(FrameStage stage) const -> Summary {
+    std::vector<float> samples;
+    samples.reserve(m_frames.size());
+    for (const Frame& frame : m_frames) {
+        samples.push_back(frame.stageMilliseconds[static_cast<size_t>(stage)]);
+    }
+    return summarizeSamples(std::move(samples));
+}
+
+auto FrameProfiler::summarizeFrames() const -> Summary {
+    std::vector<float> samples;
+    samples.reserve(m_frames.size());
+    for (const Frame& frame : m_frames) {
+        samples.push_back(frame.milliseconds);
+    }
+    return summarizeSamples(std::move(samples));
+}
+
+auto FrameProfiler::writeCsv(const std::filesystem::path& path) const -> VoidResult {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {}", path.string())
+        ));
+    }
+
+    file << "frame";
+    for (size_t stage = 0; stage < kStageCount; ++stage) {
+        file << ',' << getStageName(static_cast<FrameStage>(stage));
+    }
+    file << ",total\n";
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        file << i;
+        for (const float milliseconds : m_frames[i].stageMilliseconds) {
+            file << std::format(",{:.4f}", milliseconds);
+        }
+        file << std::format(",{:.4f}\n", m_frames[i].milliseconds);
+    }
+
+    if (!file.good()) {
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to write {}", path.string())
+        ));
+    }
+    return {};
+}
+
+auto FrameProfiler::writeJson(const std::filesystem::path& path) const -> VoidResult {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {}", path.string())
+        ));
+    }
+
+    file << "{\n  \"metadata\": {";
+    for (size_t i = 0; i < m_metadata.size(); ++i) {
+        file << std::format("{}\n    \"{}\": \"{}\"", i > 0 ? "," : "",
+                            escapeJson(m_metadata[i].first), escapeJson(m_metadata[i].second));
+    }
+    file << (m_metadata.empty() ? "},\n" : "\n  },\n");
+    file << std::format("  \"frames\": {},\n  \"unit\": \"ms\",\n  \"stages\": {{\n",
+                        m_frames.size());
+    for (size_t stage = 0; stage < kStageCount; ++stage) {
+        file << std::format("    \"{}\": {},\n", getStageName(static_cast<FrameStage>(stage)),
+                            formatSummary(summarize(static_cast<FrameStage>(stage))));
+    }
+    file << std::format("    \"total\": {}\n  }}\n}}\n", formatSummary(summarizeFrames()));
+
+    if (!file.good()) {
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to write {}", path.string())
+        ));
+    }
+    return {};
+}
+
+auto FrameProfiler::getStageName(FrameStage stage) noexcept -> const char* {
+    switch (stage) {
+    case FrameStage::PollEvents:
+        return "pollEvents";
+    case FrameStage::Update:
+        return "update";
+    case FrameStage::Streaming:
+        return "streaming";
+    case FrameStage::LodSelection:
+        return "lodSelection";
+    case FrameStage::Culling:
+        return "culling";
+    case FrameStage::Render:
+        return "render";
+    case FrameStage::Count:
+        break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Error.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class FrameStage : uint8_t {
+    PollEvents,
+    Update,
+    Streaming,
+    LodSelection,
+    Culling,
+    Render,
+    Count,
+};
+
+// Per-frame CPU time of every stage of the main loop, kept for the whole run so benchmarks
+// can report percentiles and gate on regressions. Stage times are exclusive: a scope nested
+// in another is subtracted from its parent, so the stages of a frame add up to at most its
+// total and the remainder is untracked work.
+class FrameProfiler {
+public:
+    static constexpr size_t kStageCount = static_cast<size_t>(FrameStage::Count);
+
+    struct Frame {
+        std::array<float, kStageCount> stageMilliseconds{};
+        float milliseconds{0.0f};
+    };
+
+    struct Summary {
+        float mean{0.0f};
+        float p50{0.0f};
+        float p95{0.0f};
+        float p99{0.0f};
+        float max{0.0f};
+    };
+
+    // Times a stage until destroyed; a null profiler makes it a no-op
+    class Scope {
+    public:
+        Scope(FrameProfiler* profiler, FrameStage stage) noexcept;
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameProfiler* m_profiler;
+        Scope* m_parent{nullptr};
+        FrameStage m_stage;
+        std::chrono::steady_clock::time_point m_start;
+        float m_childMilliseconds{0.0f};
+    };
+
+    explicit FrameProfiler(uint32_t expectedFrames = 0);
+
+    void beginFrame();
+    void endFrame();
+
+    // Written to the JSON summary, e.g. the scene and backend of the run
+    void setMetadata(std::string key, std::string value);
+
+    [[nodiscard]] auto getFrames() const noexcept -> const std::vector<Frame>& {
+        return m_frames;
+    }
+    [[nodiscard]] auto summarize(FrameStage stage) const -> Summary;
+    [[nodiscard]] auto summarizeFrames() const -> Summary;
+
+    // One row per frame with every stage and the frame total, in milliseconds
+    [[nodiscard]] auto writeCsv(const std::filesystem::path& path) const -> VoidResult;
+    // Metadata and the summary of every stage and of whole frames
+    [[nodiscard]] auto writeJson(const std::filesystem::path& path) const -> VoidResult;
+
+    [[nodiscard]] static auto getStageName(FrameStage stage) noexcept -> const char*;
+
+private:
+    std::vector<Frame> m_frames;
+    std::vector<std::pair<std::string, std::string>> m_metadata;
+    std::chrono::steady_clock::time_point m_frameStart;
+    Scope* m_activeScope{nullptr};
+    bool m_inFrame{false};
+};
@@ -0,0 +1,142 @@
+#include "JobSystem.hpp"
+#include "Logger.hpp"
+#include <tracy/Tracy.hpp>
+#include <format>
+#include <string>
+
+namespace {
+
+// Queue index of the current thread within the job system that owns it. Threads that are not
+// workers (the main thread) share queue 0.
+thread_local const JobSystem* t_ownerSystem = nullptr;
+thread_local uint32_t t_queueIndex = 0;
+
+} // namespace
+
+auto JobSystem::create(uint32_t threadCount) -> std::unique_ptr<JobSystem> {
+    ZoneScoped;
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    Logger::debug("Creating job system with {} threads", threadCount);
+    return std::unique_ptr<JobSystem>(new JobSystem(threadCount));
+}
+
+JobSystem::JobSystem(uint32_t threadCount) {
+    m_queues.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    m_workers.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        m_workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    ZoneScoped;
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_running.store(false, std::memory_order_release);
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+auto JobSystem::getCurrentThreadIndex() const noexcept -> uint32_t {
+    return t_ownerSystem == this ? t_queueIndex : 0;
+}
+
+void JobSystem::submit(WaitGroup& group, JobFunction job) {
+    group.m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    WorkerQueue& queue = *m_queues[getCurrentThreadIndex()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back(Job{std::move(job), &group});
+    }
+
+    {
+        // Publishing under the sleep mutex prevents a worker from missing the wakeup between
+        // checking the counter and going to sleep
+        std::lock_guard lock(m_sleepMutex);
+        m_queuedJobs.fetch_add(1, std::memory_order_release);
+    }
+    m_wakeCondition.notify_one();
+}
+
+void JobSystem::wait(WaitGroup& group) {
+    ZoneScoped;
+    const uint32_t queueIndex = getCurrentThreadIndex();
+    while (!group.isDone()) {
+        if (!tryRunJob(queueIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+auto JobSystem::tryRunJob(uint32_t queueIndex) -> bool {
+    Job job;
+    bool found = false;
+
+    // Own queue first (newest job, still warm in cache), then steal the oldest job elsewhere
+    {
+        WorkerQueue& own = *m_queues[queueIndex];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            found = true;
+        }
+    }
+
+    const auto queueCount = static_cast<uint32_t>(m_queues.size());
+    for (uint32_t offset = 1; !found && offset < queueCount; ++offset) {
+        WorkerQueue& victim = *m_queues[(queueIndex + offset) % queueCount];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    job.function();
+    job.group->m_pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::workerLoop(uint32_t queueIndex) {
+    t_ownerSystem = this;
+    t_queueIndex = queueIndex;
+
+    const std::string threadName = std::format("Job Worker {}", queueIndex);
+    tracy::SetThreadName(threadName.c_str());
+
+    while (true) {
+        if (tryRunJob(queueIndex)) {
+            continue;
+        }
+
+        std::unique_lock lock(m_sleepMutex);
+        m_wakeCondition.wait(lock, [this]() {
+            return !m_running.load(std::memory_order_acquire) ||
+                   m_queuedJobs.load(std::memory_order_acquire) > 0;
+        });
+
+        if (!m_running.load(std::memory_order_acquire)) {
+            return;
+        }
+    }
+}
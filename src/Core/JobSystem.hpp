@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its own jobs LIFO for
+// cache locality while idle workers steal FIFO from the other end. Threads that wait on a
+// WaitGroup execute pending jobs instead of blocking, so jobs may freely spawn and wait on
+// nested jobs.
+class JobSystem {
+public:
+    using JobFunction = std::function<void()>;
+
+    class WaitGroup {
+    public:
+        [[nodiscard]] auto isDone() const noexcept -> bool {
+            return m_pending.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class JobSystem;
+        std::atomic<uint32_t> m_pending{0};
+    };
+
+    // threadCount includes the calling thread; 0 selects the hardware concurrency
+    [[nodiscard]] static auto create(uint32_t threadCount = 0) -> std::unique_ptr<JobSystem>;
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    void submit(WaitGroup& group, JobFunction job);
+    void wait(WaitGroup& group);
+
+    // Calls function(index) for every index in [0, count), batchSize indices per job. The
+    // result must not depend on which thread runs which batch.
+    template<typename Function>
+    void parallelFor(uint32_t count, uint32_t batchSize, Function&& function);
+
+    [[nodiscard]] auto getThreadCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(m_queues.size());
+    }
+    // Index in [0, getThreadCount()) of the calling thread, for per-thread resources that
+    // jobs use without locking. Threads outside the pool share index 0 with the creator.
+    [[nodiscard]] auto getCurrentThreadIndex() const noexcept -> uint32_t;
+
+private:
+    struct Job {
+        JobFunction function;
+        WaitGroup* group{nullptr};
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    explicit JobSystem(uint32_t threadCount);
+
+    void workerLoop(uint32_t queueIndex);
+    [[nodiscard]] auto tryRunJob(uint32_t queueIndex) -> bool;
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    // Signed: a job can be stolen before its submitter has published the increment
+    std::atomic<int32_t> m_queuedJobs{0};
+    std::atomic<bool> m_running{true};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeCondition;
+};
+
+template<typename Function>
+void JobSystem::parallelFor(uint32_t count, uint32_t batchSize, Function&& function) {
+    if (count == 0) {
+        return;
+    }
+
+    batchSize = std::max(batchSize, 1u);
+    if (count <= batchSize || getThreadCount() == 1) {
+        for (uint32_t i = 0; i < count; ++i) {
+            function(i);
+        }
+        return;
+    }
+
+    WaitGroup group;
+    for (uint32_t begin = 0; begin < count; begin += batchSize) {
+        const uint32_t end = std::min(begin + batchSize, count);
+        submit(group, [&function, begin, end]() {
+            for (uint32_t i = begin; i < end; ++i) {
+                function(i);
+            }
+        });
+    }
+    wait(group);
+}
+
+// Deterministic parallel sort: fixed-size runs are sorted concurrently and merged pairwise,
+// so the result only depends on the comparator, never on the thread count. jobSystem may be
+// null to sort on the calling thread.
+template<typename T, typename Compare>
+void parallelSort(JobSystem* jobSystem, std::span<T> values, Compare compare) {
+    constexpr size_t kRunSize = 1 << 16;
+    if (jobSystem == nullptr || values.size() <= kRunSize) {
+        std::sort(values.begin(), values.end(), compare);
+        return;
+    }
+
+    const auto runCount = static_cast<uint32_t>((values.size() + kRunSize - 1) / kRunSize);
+    jobSystem->parallelFor(runCount, 1, [&](uint32_t run) {
+        const size_t begin = run * kRunSize;
+        const size_t end = std::min(begin + kRunSize, values.size());
+        std::sort(values.begin() + begin, values.begin() + end, compare);
+    });
+
+    std::vector<T> scratch(values.size());
+    std::span<T> source = values;
+    std::span<T> target = scratch;
+    for (size_t width = kRunSize; width < values.size(); width *= 2) {
+        const auto mergeCount =
+            static_cast<uint32_t>((values.size() + 2 * width - 1) / (2 * width));
+        jobSystem->parallelFor(mergeCount, 1, [&](uint32_t merge) {
+            const size_t begin = merge * 2 * width;
+            const size_t middle = std::min(begin + width, values.size());
+            const size_t end = std::min(begin + 2 * width, values.size());
+            std::merge(source.begin() + begin, source.begin() + middle, source.begin() + middle,
+                       source.begin() + end, target.begin() + begin, compare);
+        });
+        std::swap(source, target);
+    }
+
+    if (source.data() != values.data()) {
+        std::copy(source.begin(), source.end(), values.begin());
+    }
+}
+
+template<typename T>
+void parallelSort(JobSystem* jobSystem, std::span<T> values) {
+    parallelSort(jobSystem, values, std::less<T>{});
+}
+
+// parallelFor that also accepts a null job system and then runs on the calling thread
+template<typename Function>
+void parallelFor(JobSystem* jobSystem, uint32_t count, uint32_t batchSize, Function&& function) {
+    if (jobSystem == nullptr) {
+        for (uint32_t i = 0; i < count; ++i) {
+            function(i);
+        }
+        return;
+    }
+    jobSystem->parallelFor(count, batchSize, std::forward<Function>(function));
+}
@@ -0,0 +1,302 @@
+#include "Json.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <format>
+
+namespace {
+
+// Deep enough for any manifest, shallow enough that hostile input cannot exhaust the stack
+constexpr uint32_t kMaxDepth = 256;
+
+const JsonValue kNull;
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+} // namespace
+
+// Recursive descent over the text; errors carry the byte offset they were found at
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : m_it(text.data()), m_begin(text.data()),
+                                                 m_end(text.data() + text.size()) {}
+
+    auto parseDocument() -> Result<JsonValue> {
+        JsonValue value;
+        if (!parseValue(value, 0)) {
+            return std::unexpected(m_error);
+        }
+        skipWhitespace();
+        if (m_it != m_end) {
+            return std::unexpected(fail("trailing characters after the document"));
+        }
+        return value;
+    }
+
+private:
+    auto fail(std::string_view reason) -> Error {
+        m_error = makeError(
+            ErrorCode::FileParseFailed,
+            std::format("JSON offset {}: {}", m_it - m_begin, reason)
+        );
+        return m_error;
+    }
+
+    void skipWhitespace() noexcept {
+        while (m_it != m_end && (*m_it == ' ' || *m_it == '\t' || *m_it == '\n' || *m_it == '\r')) {
+            ++m_it;
+        }
+    }
+
+    auto consumeLiteral(std::string_view literal) noexcept -> bool {
+        if (static_cast<size_t>(m_end - m_it) < literal.size() ||
+            std::string_view(m_it, literal.size()) != literal) {
+            return false;
+        }
+        m_it += literal.size();
+        return true;
+    }
+
+    auto parseValue(JsonValue& value, uint32_t depth) -> bool {
+        if (depth > kMaxDepth) {
+            fail("nesting too deep");
+            return false;
+        }
+        skipWhitespace();
+        if (m_it == m_end) {
+            fail("unexpected end of input");
+            return false;
+        }
+
+        switch (*m_it) {
+        case '{':
+            return parseObject(value, depth);
+        case '[':
+            return parseArray(value, depth);
+        case '"':
+            value.m_type = JsonValue::Type::String;
+            return parseString(value.m_string);
+        case 't':
+        case 'f':
+            value.m_type = JsonValue::Type::Bool;
+            value.m_bool = *m_it == 't';
+            if (!consumeLiteral(value.m_bool ? "true" : "false")) {
+                fail("invalid literal");
+                return false;
+            }
+            return true;
+        case 'n':
+            if (!consumeLiteral("null")) {
+                fail("invalid literal");
+                return false;
+            }
+            return true;
+        default:
+            return parseNumber(value);
+        }
+    }
+
+    auto parseNumber(JsonValue& value) -> bool {
+        value.m_type = JsonValue::Type::Number;
+        auto [ptr, ec] = std::from_chars(m_it, m_end, value.m_number);
+        if (ec != std::errc{} || !std::isfinite(value.m_number)) {
+            fail("invalid number");
+            return false;
+        }
+        m_it = ptr;
+        return true;
+    }
+
+    auto parseHex4(uint32_t& codeUnit) -> bool {
+        if (m_end - m_it < 4) {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(m_it, m_it + 4, codeUnit, 16);
+        if (ec != std::errc{} || ptr != m_it + 4) {
+            return false;
+        }
+        m_it += 4;
+        return true;
+    }
+
+    auto parseString(std::string& out) -> bool {
+        ++m_it; // Opening quote
+        while (true) {
+            // Copy runs without escapes in one go
+            const char* runBegin = m_it;
+            while (m_it != m_end && *m_it != '"' && *m_it != '\\') {
+                ++m_it;
+            }
+            out.append(runBegin, m_it);
+            if (m_it == m_end) {
+                fail("unterminated string");
+                return false;
+            }
+            if (*m_it++ == '"') {
+                return true;
+            }
+
+            if (m_it == m_end) {
+                fail("unterminated escape");
+                return false;
+            }
+            const char escape = *m_it++;
+            switch (escape) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!parseHex4(codePoint)) {
+                    fail("invalid unicode escape");
+                    return false;
+                }
+                // High surrogate: the low half follows as another escape
+                if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                    uint32_t low = 0;
+                    if (!consumeLiteral("\\u") || !parseHex4(low) || low < 0xDC00 ||
+                        low >= 0xE000) {
+                        fail("invalid surrogate pair");
+                        return false;
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                fail("invalid escape");
+                return false;
+            }
+        }
+    }
+
+    auto parseArray(JsonValue& value, uint32_t depth) -> bool {
+        value.m_type = JsonValue::Type::Array;
+        ++m_it;
+        skipWhitespace();
+        if (m_it != m_end && *m_it == ']') {
+            ++m_it;
+            return true;
+        }
+        while (true) {
+            if (!parseValue(value.m_elements.emplace_back(), depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (m_it != m_end && *m_it == ',') {
+                ++m_it;
+            } else if (m_it != m_end && *m_it == ']') {
+                ++m_it;
+                return true;
+            } else {
+                fail("expected ',' or ']'");
+                return false;
+            }
+        }
+    }
+
+    auto parseObject(JsonValue& value, uint32_t depth) -> bool {
+        value.m_type = JsonValue::Type::Object;
+        ++m_it;
+        skipWhitespace();
+        if (m_it != m_end && *m_it == '}') {
+            ++m_it;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            if (m_it == m_end || *m_it != '"') {
+                fail("expected member name");
+                return false;
+            }
+            if (!parseString(value.m_keys.emplace_back())) {
+                return false;
+            }
+            skipWhitespace();
+            if (m_it == m_end || *m_it != ':') {
+                fail("expected ':'");
+                return false;
+            }
+            ++m_it;
+            if (!parseValue(value.m_elements.emplace_back(), depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (m_it != m_end && *m_it == ',') {
+                ++m_it;
+            } else if (m_it != m_end && *m_it == '}') {
+                ++m_it;
+                return true;
+            } else {
+                fail("expected ',' or '}'");
+                return false;
+            }
+        }
+    }
+
+    const char* m_it;
+    const char* m_begin;
+    const char* m_end;
+    Error m_error;
+};
+
+auto JsonValue::parse(std::string_view text) -> Result<JsonValue> {
+    ZoneScoped;
+    return JsonParser(text).parseDocument();
+}
+
+auto JsonValue::asNumber(double fallback) const noexcept -> double {
+    return m_type == Type::Number ? m_number : fallback;
+}
+
+auto JsonValue::asUint(uint64_t fallback) const noexcept -> uint64_t {
+    if (m_type != Type::Number || m_number < 0.0 || m_number != std::floor(m_number) ||
+        m_number >= 18446744073709551616.0) {
+        return fallback;
+    }
+    return static_cast<uint64_t>(m_number);
+}
+
+auto JsonValue::asBool(bool fallback) const noexcept -> bool {
+    return m_type == Type::Bool ? m_bool : fallback;
+}
+
+auto JsonValue::operator[](size_t index) const noexcept -> const JsonValue& {
+    return m_type == Type::Array && index < m_elements.size() ? m_elements[index] : kNull;
+}
+
+auto JsonValue::operator[](std::string_view key) const noexcept -> const JsonValue& {
+    for (size_t i = 0; i < m_keys.size(); ++i) {
+        if (m_keys[i] == key) {
+            return m_elements[i];
+        }
+    }
+    return kNull;
+}
+
+auto JsonValue::contains(std::string_view key) const noexcept -> bool {
+    return std::ranges::find(m_keys, key) != m_keys.end();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Error.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only JSON document tree, enough for asset manifests such as glTF. Lookups of missing
+// members or out-of-range elements return a null value, so optional fields chain without checks.
+class JsonValue {
+public:
+    enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+    [[nodiscard]] static auto parse(std::string_view text) -> Result<JsonValue>;
+
+    [[nodiscard]] auto getType() const noexcept -> Type { return m_type; }
+    [[nodiscard]] auto isNull() const noexcept -> bool { return m_type == Type::Null; }
+    [[nodiscard]] auto isNumber() const noexcept -> bool { return m_type == Type::Number; }
+    [[nodiscard]] auto isString() const noexcept -> bool { return m_type == Type::String; }
+    [[nodiscard]] auto isArray() const noexcept -> bool { return m_type == Type::Array; }
+    [[nodiscard]] auto isObject() const noexcept -> bool { return m_type == Type::Object; }
+
+    // fallback when the value is of another type
+    [[nodiscard]] auto asNumber(double fallback = 0.0) const noexcept -> double;
+    [[nodiscard]] auto asUint(uint64_t fallback = 0) const noexcept -> uint64_t;
+    [[nodiscard]] auto asBool(bool fallback = false) const noexcept -> bool;
+    [[nodiscard]] auto asString() const noexcept -> std::string_view { return m_string; }
+
+    // Element count of arrays and member count of objects
+    [[nodiscard]] auto size() const noexcept -> size_t { return m_elements.size(); }
+    [[nodiscard]] auto operator[](size_t index) const noexcept -> const JsonValue&;
+    [[nodiscard]] auto operator[](std::string_view key) const noexcept -> const JsonValue&;
+    [[nodiscard]] auto contains(std::string_view key) const noexcept -> bool;
+    // Member names of objects, parallel to the elements
+    [[nodiscard]] auto getKeys() const noexcept -> const std::vector<std::string>& {
+        return m_keys;
+    }
+
+private:
+    friend class JsonParser;
+
+    Type m_type{Type::Null};
+    bool m_bool{false};
+    double m_number{0.0};
+    std::string m_string;
+    std::vector<std::string> m_keys;
+    std::vector<JsonValue> m_elements;
+};
@@ -0,0 +1,429 @@
+#include "ClusterCulling.hpp"
+#include <tracy/Tracy.hpp>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VG_CULL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VG_CULL_TARGET(isa)
+#else
+#define VG_CULL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VG_CULL_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Lane numbers of the set bits of every 8-bit visibility mask, in order; adding the block's
+// first index and storing all eight lanes compacts a block without branches
+alignas(32) constexpr auto kCompactTable = [] {
+    std::array<std::array<uint32_t, 8>, 256> table{};
+    for (uint32_t mask = 0; mask < 256; ++mask) {
+        uint32_t count = 0;
+        for (uint32_t lane = 0; lane < 8; ++lane) {
+            if ((mask & (1u << lane)) != 0) {
+                table[mask][count++] = lane;
+            }
+        }
+    }
+    return table;
+}();
+
+// GLM reference that the SIMD kernels must match exactly
+auto cullScalar(const ClusterCullBounds& bounds, const CullView& view, uint32_t* output)
+    -> uint32_t {
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < bounds.count; ++i) {
+        const glm::vec3 center{bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]};
+        const float radius = bounds.radius[i];
+
+        bool visible = true;
+        for (const glm::vec4& plane : view.planes) {
+            const glm::vec3 normal{plane.x, plane.y, plane.z};
+            visible = visible && glm::dot(normal, center) + plane.w >= -radius;
+        }
+        if (visible && view.coneCulling) {
+            const glm::vec3 axis{bounds.coneAxisX[i], bounds.coneAxisY[i], bounds.coneAxisZ[i]};
+            const glm::vec3 offset = center - view.cameraPosition;
+            visible = !(glm::dot(offset, axis) >=
+                        bounds.coneCutoff[i] * glm::length(offset) + radius);
+        }
+        if (visible) {
+            output[written++] = i;
+        }
+    }
+    return written;
+}
+
+#if VG_CULL_X86
+
+VG_CULL_TARGET("avx2")
+auto cullAvx2(const ClusterCullBounds& bounds, const CullView& view, uint32_t* output)
+    -> uint32_t {
+    __m256 planes[6][4];
+    for (size_t p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = _mm256_set1_ps(view.planes[p][c]);
+        }
+    }
+    const __m256 cameraX = _mm256_set1_ps(view.cameraPosition.x);
+    const __m256 cameraY = _mm256_set1_ps(view.cameraPosition.y);
+    const __m256 cameraZ = _mm256_set1_ps(view.cameraPosition.z);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    uint32_t written = 0;
+    for (uint32_t base = 0; base < bounds.paddedCount(); base += 8) {
+        const __m256 centerX = _mm256_loadu_ps(bounds.centerX.data() + base);
+        const __m256 centerY = _mm256_loadu_ps(bounds.centerY.data() + base);
+        const __m256 centerZ = _mm256_loadu_ps(bounds.centerZ.data() + base);
+        const __m256 radius = _mm256_loadu_ps(bounds.radius.data() + base);
+        const __m256 negativeRadius = _mm256_xor_ps(radius, signBit);
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const auto& plane : planes) {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(plane[0], centerX),
+                                            _mm256_mul_ps(plane[1], centerY));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(plane[2], centerZ));
+            distance = _mm256_add_ps(distance, plane[3]);
+            const __m256 inside = _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ);
+            visible = _mm256_and_ps(visible, inside);
+        }
+        if (_mm256_testz_ps(visible, visible)) {
+            continue;
+        }
+
+        if (view.coneCulling) {
+            const __m256 offsetX = _mm256_sub_ps(centerX, cameraX);
+            const __m256 offsetY = _mm256_sub_ps(centerY, cameraY);
+            const __m256 offsetZ = _mm256_sub_ps(centerZ, cameraZ);
+            __m256 along = _mm256_add_ps(
+                _mm256_mul_ps(offsetX, _mm256_loadu_ps(bounds.coneAxisX.data() + base)),
+                _mm256_mul_ps(offsetY, _mm256_loadu_ps(bounds.coneAxisY.data() + base)));
+            along = _mm256_add_ps(
+                along, _mm256_mul_ps(offsetZ, _mm256_loadu_ps(bounds.coneAxisZ.data() + base)));
+            __m256 lengthSquared = _mm256_add_ps(_mm256_mul_ps(offsetX, offsetX),
+                                                 _mm256_mul_ps(offsetY, offsetY));
+            lengthSquared = _mm256_add_ps(lengthSquared, _mm256_mul_ps(offsetZ, offsetZ));
+            const __m256 limit = _mm256_add_ps(
+                _mm256_mul_ps(_mm256_loadu_ps(bounds.coneCutoff.data() + base),
+                              _mm256_sqrt_ps(lengthSquared)),
+                radius);
+            visible = _mm256_andnot_ps(_mm256_cmp_ps(along, limit, _CMP_GE_OQ), visible);
+        }
+
+        const auto mask = static_cast<uint32_t>(_mm256_movemask_ps(visible));
+        const __m256i lanes = _mm256_load_si256(
+            reinterpret_cast<const __m256i*>(kCompactTable[mask].data()));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + written),
+                            _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(base))));
+        written += std::popcount(mask);
+    }
+    return written;
+}
+
+struct SseView {
+    __m128 planes[6][4];
+    __m128 cameraX;
+    __m128 cameraY;
+    __m128 cameraZ;
+    bool coneCulling;
+};
+
+// Visibility bits of the four clusters from first; a function of its own because lambdas do
+// not inherit the target attribute
+VG_CULL_TARGET("sse4.1")
+auto testSse41(const ClusterCullBounds& bounds, const SseView& view, uint32_t first)
+    -> uint32_t {
+    const __m128 centerX = _mm_loadu_ps(bounds.centerX.data() + first);
+    const __m128 centerY = _mm_loadu_ps(bounds.centerY.data() + first);
+    const __m128 centerZ = _mm_loadu_ps(bounds.centerZ.data() + first);
+    const __m128 radius = _mm_loadu_ps(bounds.radius.data() + first);
+    const __m128 negativeRadius = _mm_xor_ps(radius, _mm_set1_ps(-0.0f));
+
+    __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (const auto& plane : view.planes) {
+        __m128 distance = _mm_add_ps(_mm_mul_ps(plane[0], centerX), _mm_mul_ps(plane[1], centerY));
+        distance = _mm_add_ps(distance, _mm_mul_ps(plane[2], centerZ));
+        distance = _mm_add_ps(distance, plane[3]);
+        visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+    }
+    const __m128i visibleBits = _mm_castps_si128(visible);
+    if (_mm_testz_si128(visibleBits, visibleBits) || !view.coneCulling) {
+        return static_cast<uint32_t>(_mm_movemask_ps(visible));
+    }
+
+    const __m128 offsetX = _mm_sub_ps(centerX, view.cameraX);
+    const __m128 offsetY = _mm_sub_ps(centerY, view.cameraY);
+    const __m128 offsetZ = _mm_sub_ps(centerZ, view.cameraZ);
+    const __m128 axisX = _mm_loadu_ps(bounds.coneAxisX.data() + first);
+    const __m128 axisY = _mm_loadu_ps(bounds.coneAxisY.data() + first);
+    const __m128 axisZ = _mm_loadu_ps(bounds.coneAxisZ.data() + first);
+    __m128 along = _mm_add_ps(_mm_mul_ps(offsetX, axisX), _mm_mul_ps(offsetY, axisY));
+    along = _mm_add_ps(along, _mm_mul_ps(offsetZ, axisZ));
+    __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY));
+    lengthSquared = _mm_add_ps(lengthSquared, _mm_mul_ps(offsetZ, offsetZ));
+    const __m128 cutoff = _mm_loadu_ps(bounds.coneCutoff.data() + first);
+    const __m128 limit = _mm_add_ps(_mm_mul_ps(cutoff, _mm_sqrt_ps(lengthSquared)), radius);
+    visible = _mm_andnot_ps(_mm_cmpge_ps(along, limit), visible);
+    return static_cast<uint32_t>(_mm_movemask_ps(visible));
+}
+
+// Two four-wide halves per block of eight
+VG_CULL_TARGET("sse4.1")
+auto cullSse41(const ClusterCullBounds& bounds, const CullView& view, uint32_t* output)
+    -> uint32_t {
+    SseView sseView;
+    for (size_t p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            sseView.planes[p][c] = _mm_set1_ps(view.planes[p][c]);
+        }
+    }
+    sseView.cameraX = _mm_set1_ps(view.cameraPosition.x);
+    sseView.cameraY = _mm_set1_ps(view.cameraPosition.y);
+    sseView.cameraZ = _mm_set1_ps(view.cameraPosition.z);
+    sseView.coneCulling = view.coneCulling;
+
+    uint32_t written = 0;
+    for (uint32_t base = 0; base < bounds.paddedCount(); base += 8) {
+        const uint32_t mask =
+            testSse41(bounds, sseView, base) | testSse41(bounds, sseView, base + 4) << 4;
+        const auto* lanes = reinterpret_cast<const __m128i*>(kCompactTable[mask].data());
+        const __m128i first = _mm_set1_epi32(static_cast<int>(base));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + written),
+                         _mm_add_epi32(_mm_load_si128(lanes), first));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + written + 4),
+                         _mm_add_epi32(_mm_load_si128(lanes + 1), first));
+        written += std::popcount(mask);
+    }
+    return written;
+}
+
+auto detectKernel() -> CullKernel {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    // AVX needs the OS to save the YMM registers as well as CPU support
+    const bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                       (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return avx2 ? CullKernel::Avx2 : sse41 ? CullKernel::Sse41 : CullKernel::Scalar;
+}
+
+#elif VG_CULL_NEON
+
+// Two four-wide halves per block of eight
+auto cullNeon(const ClusterCullBounds& bounds, const CullView& view, uint32_t* output)
+    -> uint32_t {
+    float32x4_t planes[6][4];
+    for (size_t p = 0; p < 6; ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[p][c] = vdupq_n_f32(view.planes[p][c]);
+        }
+    }
+    const float32x4_t cameraX = vdupq_n_f32(view.cameraPosition.x);
+    const float32x4_t cameraY = vdupq_n_f32(view.cameraPosition.y);
+    const float32x4_t cameraZ = vdupq_n_f32(view.cameraPosition.z);
+    constexpr uint32_t kLaneBits[4] = {1, 2, 4, 8};
+    const uint32x4_t laneBits = vld1q_u32(kLaneBits);
+
+    auto testHalf = [&](uint32_t first) {
+        const float32x4_t centerX = vld1q_f32(bounds.centerX.data() + first);
+        const float32x4_t centerY = vld1q_f32(bounds.centerY.data() + first);
+        const float32x4_t centerZ = vld1q_f32(bounds.centerZ.data() + first);
+        const float32x4_t radius = vld1q_f32(bounds.radius.data() + first);
+        const float32x4_t negativeRadius = vnegq_f32(radius);
+
+        uint32x4_t visible = vdupq_n_u32(~0u);
+        for (const auto& plane : planes) {
+            float32x4_t distance =
+                vaddq_f32(vmulq_f32(plane[0], centerX), vmulq_f32(plane[1], centerY));
+            distance = vaddq_f32(distance, vmulq_f32(plane[2], centerZ));
+            distance = vaddq_f32(distance, plane[3]);
+            visible = vandq_u32(visible, vcgeq_f32(distance, negativeRadius));
+        }
+        if (vmaxvq_u32(visible) == 0 || !view.coneCulling) {
+            return vaddvq_u32(vandq_u32(visible, laneBits));
+        }
+
+        const float32x4_t offsetX = vsubq_f32(centerX, cameraX);
+        const float32x4_t offsetY = vsubq_f32(centerY, cameraY);
+        const float32x4_t offsetZ = vsubq_f32(centerZ, cameraZ);
+        const float32x4_t axisX = vld1q_f32(bounds.coneAxisX.data() + first);
+        const float32x4_t axisY = vld1q_f32(bounds.coneAxisY.data() + first);
+        const float32x4_t axisZ = vld1q_f32(bounds.coneAxisZ.data() + first);
+        float32x4_t along = vaddq_f32(vmulq_f32(offsetX, axisX), vmulq_f32(offsetY, axisY));
+        along = vaddq_f32(along, vmulq_f32(offsetZ, axisZ));
+        float32x4_t lengthSquared =
+            vaddq_f32(vmulq_f32(offsetX, offsetX), vmulq_f32(offsetY, offsetY));
+        lengthSquared = vaddq_f32(lengthSquared, vmulq_f32(offsetZ, offsetZ));
+        const float32x4_t cutoff = vld1q_f32(bounds.coneCutoff.data() + first);
+        const float32x4_t limit = vaddq_f32(vmulq_f32(cutoff, vsqrtq_f32(lengthSquared)), radius);
+        visible = vbicq_u32(visible, vcgeq_f32(along, limit));
+        return vaddvq_u32(vandq_u32(visible, laneBits));
+    };
+
+    uint32_t written = 0;
+    for (uint32_t base = 0; base < bounds.paddedCount(); base += 8) {
+        const uint32_t mask = testHalf(base) | testHalf(base + 4) << 4;
+        const uint32_t* lanes = kCompactTable[mask].data();
+        const uint32x4_t first = vdupq_n_u32(base);
+        vst1q_u32(output + written, vaddq_u32(vld1q_u32(lanes), first));
+        vst1q_u32(output + written + 4, vaddq_u32(vld1q_u32(lanes + 4), first));
+        written += std::popcount(mask);
+    }
+    return written;
+}
+
+auto detectKernel() -> CullKernel {
+    return CullKernel::Neon; // Part of the AArch64 baseline
+}
+
+#else
+
+auto detectKernel() -> CullKernel {
+    return CullKernel::Scalar;
+}
+
+#endif
+
+} // namespace
+
+void ClusterCullBounds::add(const glm::vec4& sphere, const glm::vec3& coneAxis, float cutoff) {
+    // Padding fails every plane: no distance is at least -radius = infinity
+    if (count == paddedCount()) {
+        const size_t padded = count + kBlockSize;
+        centerX.resize(padded, 0.0f);
+        centerY.resize(padded, 0.0f);
+        centerZ.resize(padded, 0.0f);
+        radius.resize(padded, -std::numeric_limits<float>::infinity());
+        coneAxisX.resize(padded, 0.0f);
+        coneAxisY.resize(padded, 0.0f);
+        coneAxisZ.resize(padded, 0.0f);
+        coneCutoff.resize(padded, 1.0f);
+    }
+
+    centerX[count] = sphere.x;
+    centerY[count] = sphere.y;
+    centerZ[count] = sphere.z;
+    radius[count] = sphere.w;
+    coneAxisX[count] = coneAxis.x;
+    coneAxisY[count] = coneAxis.y;
+    coneAxisZ[count] = coneAxis.z;
+    coneCutoff[count] = cutoff;
+    ++count;
+}
+
+void ClusterCullBounds::clear() {
+    for (std::vector<float>* component : {&centerX, &centerY, &centerZ, &radius, &coneAxisX,
+                                          &coneAxisY, &coneAxisZ, &coneCutoff}) {
+        component->clear();
+    }
+    count = 0;
+}
+
+void ClusterCullBounds::reserve(size_t clusterCount) {
+    const size_t padded = (clusterCount + kBlockSize - 1) / kBlockSize * kBlockSize;
+    for (std::vector<float>* component : {&centerX, &centerY, &centerZ, &radius, &coneAxisX,
+                                          &coneAxisY, &coneAxisZ, &coneCutoff}) {
+        component->reserve(padded);
+    }
+}
+
+auto CullView::fromViewProjection(const glm::mat4& viewProjection,
+                                  const glm::vec3& cameraPosition) -> CullView {
+    auto row = [&](int i) {
+        return glm::vec4{viewProjection[0][i], viewProjection[1][i], viewProjection[2][i],
+                         viewProjection[3][i]};
+    };
+
+    CullView view;
+    view.cameraPosition = cameraPosition;
+    view.planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                   row(3) - row(1), row(2),          row(3) - row(2)};
+    for (glm::vec4& plane : view.planes) {
+        const float length = glm::length(glm::vec3{plane.x, plane.y, plane.z});
+        plane = length > 0.0f ? plane / length : glm::vec4{0.0f, 0.0f, 0.0f, 1.0f};
+    }
+    return view;
+}
+
+auto ClusterCuller::getBestKernel() -> CullKernel {
+    static const CullKernel kernel = detectKernel();
+    return kernel;
+}
+
+auto ClusterCuller::isSupported(CullKernel kernel) -> bool {
+    const CullKernel best = getBestKernel();
+    switch (kernel) {
+    case CullKernel::Scalar:
+        return true;
+    case CullKernel::Sse41:
+        return best == CullKernel::Sse41 || best == CullKernel::Avx2;
+    case CullKernel::Avx2:
+    case CullKernel::Neon:
+        return best == kernel;
+    }
+    return false;
+}
+
+auto ClusterCuller::getKernelName(CullKernel kernel) -> const char* {
+    switch (kernel) {
+    case CullKernel::Scalar:
+        return "scalar";
+    case CullKernel::Sse41:
+        return "sse4.1";
+    case CullKernel::Avx2:
+        return "avx2";
+    case CullKernel::Neon:
+        return "neon";
+    }
+    return "unknown";
+}
+
+auto ClusterCuller::cull(const ClusterCullBounds& bounds, const CullView& view,
+                         std::vector<uint32_t>& visible, CullKernel kernel) -> uint32_t {
+    ZoneScoped;
+    // Kernels store whole blocks of eight indices and only advance by the visible ones, so
+    // the output needs room for every padded entry
+    const size_t offset = visible.size();
+    visible.resize(offset + bounds.paddedCount());
+    uint32_t* output = visible.data() + offset;
+
+    if (!isSupported(kernel)) {
+        kernel = CullKernel::Scalar;
+    }
+    uint32_t written = 0;
+    switch (kernel) {
+#if VG_CULL_X86
+    case CullKernel::Avx2:
+        written = cullAvx2(bounds, view, output);
+        break;
+    case CullKernel::Sse41:
+        written = cullSse41(bounds, view, output);
+        break;
+#elif VG_CULL_NEON
+    case CullKernel::Neon:
+        written = cullNeon(bounds, view, output);
+        break;
+#endif
+    default:
+        written = cullScalar(bounds, view, output);
+        break;
+    }
+
+    visible.resize(offset + written);
+    return written;
+}
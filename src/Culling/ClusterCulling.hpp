@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Cluster bounds in structure-of-arrays layout, one array per component, so a kernel loads
+// eight clusters' worth of one component with a single instruction. The arrays are padded to
+// a multiple of kBlockSize with entries every test rejects, so kernels never need a scalar
+// tail.
+struct ClusterCullBounds {
+    static constexpr uint32_t kBlockSize = 8;
+
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+    std::vector<float> coneAxisX;
+    std::vector<float> coneAxisY;
+    std::vector<float> coneAxisZ;
+    std::vector<float> coneCutoff;
+    uint32_t count{0};
+
+    // Sphere as (center, radius); the cone is the one built by ClusterBuilder, whose
+    // cutoff of 1 keeps clusters with widely spread normals
+    void add(const glm::vec4& sphere, const glm::vec3& coneAxis, float coneCutoff);
+    void clear();
+    void reserve(size_t clusterCount);
+
+    [[nodiscard]] auto paddedCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(radius.size());
+    }
+};
+
+// Frustum planes and camera position in the space of the bounds being tested; pass
+// viewProjection * model and the camera position in object space to cull an instance
+// without transforming its clusters.
+struct CullView {
+    std::array<glm::vec4, 6> planes{}; // Unit normals pointing inwards, w is the offset
+    glm::vec3 cameraPosition{0.0f};
+    bool coneCulling{true};
+
+    // Planes of a Vulkan clip space (depth 0 to 1); a degenerate far plane from an infinite
+    // projection is replaced by one that accepts everything
+    [[nodiscard]] static auto fromViewProjection(const glm::mat4& viewProjection,
+                                                 const glm::vec3& cameraPosition) -> CullView;
+};
+
+enum class CullKernel : uint8_t {
+    Scalar,
+    Sse41,
+    Avx2,
+    Neon,
+};
+
+// Frustum and backface cone culling of cluster bounds. A cluster is visible when its sphere
+// is not entirely behind any plane and, with cone culling on, when
+//     dot(center - camera, coneAxis) < coneCutoff * length(center - camera) + radius
+// which is the sphere form of the cone test and needs no cone apex.
+//
+// The SIMD kernels evaluate exactly the same operations in the same order as the GLM scalar
+// reference, and this file is built without floating-point contraction, so every kernel
+// produces the identical index list.
+class ClusterCuller {
+public:
+    // Widest kernel the CPU supports, detected once
+    [[nodiscard]] static auto getBestKernel() -> CullKernel;
+    [[nodiscard]] static auto isSupported(CullKernel kernel) -> bool;
+    [[nodiscard]] static auto getKernelName(CullKernel kernel) -> const char*;
+
+    // Appends the indices of the visible clusters in ascending order and returns how many were
+    // appended. Unsupported kernels fall back to the scalar reference.
+    static auto cull(const ClusterCullBounds& bounds, const CullView& view,
+                     std::vector<uint32_t>& visible, CullKernel kernel) -> uint32_t;
+    static auto cull(const ClusterCullBounds& bounds, const CullView& view,
+                     std::vector<uint32_t>& visible) -> uint32_t {
+        return cull(bounds, view, visible, getBestKernel());
+    }
+};
@@ -0,0 +1,228 @@
+#include "ClusterHierarchy.hpp"
+#include "Geometry/BoundingSphere.hpp"
+#include "Geometry/ClusterDag.hpp"
+#include "Streaming/PageFormat.hpp"
+#include "Streaming/PagedGeometry.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <format>
+#include <limits>
+
+auto ClusterHierarchy::fromDag(const ClusterDag& dag) -> ClusterHierarchy {
+    ZoneScoped;
+    ClusterHierarchy hierarchy;
+    hierarchy.m_levelCount = dag.levelCount;
+    hierarchy.m_clusters.reserve(dag.lods.size());
+
+    auto addGroup = [&](std::span<const uint32_t> clusters, const glm::vec4& lodBounds,
+                        float error, uint32_t level) {
+        hierarchy.m_groups.push_back(HierarchyGroup{
+            lodBounds, error, level, static_cast<uint32_t>(hierarchy.m_clusters.size()),
+            static_cast<uint32_t>(clusters.size())});
+        for (uint32_t cluster : clusters) {
+            const ClusterLod& lod = dag.lods[cluster];
+            hierarchy.m_clusters.push_back(
+                HierarchyCluster{lod.lodBounds, lod.error, 0, cluster, kNoChildPage});
+        }
+    };
+
+    for (const ClusterGroup& group : dag.groups) {
+        addGroup(std::span(dag.groupClusters).subspan(group.clusterOffset, group.clusterCount),
+                 group.lodBounds, group.error, group.level);
+    }
+    // Split like the page writer does, so both sources give the same hierarchy
+    for (size_t offset = 0; offset < dag.roots.size(); offset += kMaxRootGroupClusters) {
+        const std::span<const uint32_t> roots = std::span(dag.roots).subspan(
+            offset, std::min<size_t>(kMaxRootGroupClusters, dag.roots.size() - offset));
+        std::vector<glm::vec4> rootSpheres;
+        for (uint32_t root : roots) {
+            rootSpheres.push_back(dag.lods[root].lodBounds);
+        }
+        addGroup(roots, mergeSpheres(rootSpheres), std::numeric_limits<float>::infinity(),
+                 dag.levelCount - 1);
+    }
+
+    std::vector<bool> hasChild(dag.lods.size(), false);
+    for (const ClusterGroup& group : dag.groups) {
+        for (uint32_t parent = group.parentClusterOffset;
+             parent < group.parentClusterOffset + group.parentClusterCount; ++parent) {
+            hasChild[parent] = true;
+        }
+    }
+    for (HierarchyCluster& cluster : hierarchy.m_clusters) {
+        if (hasChild[cluster.index]) {
+            cluster.childPage = 0;
+        }
+    }
+
+    hierarchy.buildBvh();
+    return hierarchy;
+}
+
+auto ClusterHierarchy::fromPagedGeometry(const PagedGeometry& geometry)
+    -> Result<ClusterHierarchy> {
+    ZoneScoped;
+    ClusterHierarchy hierarchy;
+    const PageFileHeader& header = geometry.getHeader();
+    hierarchy.m_levelCount = header.levelCount;
+    hierarchy.m_clusters.reserve(header.clusterCount);
+    hierarchy.m_groups.reserve(header.groupCount);
+
+    const auto pageTable = geometry.getPageTable();
+    const auto groups = geometry.getGroups();
+    const auto childGroups = geometry.getClusterChildGroups();
+    const auto leafLods = geometry.getLeafClusterLods();
+    uint32_t leaf = 0;
+    for (uint32_t page = 0; page < geometry.getPageCount(); ++page) {
+        const PageTableEntry& entry = pageTable[page];
+        const auto clusterBase = static_cast<uint32_t>(hierarchy.m_clusters.size());
+        for (uint32_t i = 0; i < entry.clusterCount; ++i) {
+            // A parent's LOD data is that of the group it was simplified from
+            const uint32_t childGroup = childGroups[clusterBase + i];
+            if (childGroup == kNoChildGroup) {
+                const PageLeafLod& lod = leafLods[leaf++];
+                hierarchy.m_clusters.push_back(
+                    HierarchyCluster{lod.lodBounds, lod.error, page, i, kNoChildPage});
+            } else {
+                const PageGroup& group = groups[childGroup];
+                hierarchy.m_clusters.push_back(
+                    HierarchyCluster{group.lodBounds, group.error, page, i, group.page});
+            }
+        }
+
+        for (uint32_t i = entry.groupOffset; i < entry.groupOffset + entry.groupCount; ++i) {
+            const PageGroup& group = groups[i];
+            if (group.page != page ||
+                static_cast<uint64_t>(group.firstCluster) + group.clusterCount >
+                    entry.clusterCount ||
+                group.level >= std::max(header.levelCount, 1u)) {
+                return std::unexpected(makeError(
+                    ErrorCode::FileParseFailed,
+                    std::format("Group {} lies outside its page {}", i, page)
+                ));
+            }
+            hierarchy.m_groups.push_back(HierarchyGroup{group.lodBounds, group.error,
+                                                        group.level,
+                                                        clusterBase + group.firstCluster,
+                                                        group.clusterCount});
+        }
+    }
+
+    hierarchy.buildBvh();
+    return hierarchy;
+}
+
+void ClusterHierarchy::buildBvh() {
+    ZoneScoped;
+    m_levelCount = std::max(m_levelCount, 1u);
+    std::vector<std::vector<uint32_t>> levelGroups(m_levelCount);
+    for (uint32_t i = 0; i < m_groups.size(); ++i) {
+        levelGroups[std::min(m_groups[i].level, m_levelCount - 1)].push_back(i);
+    }
+    std::erase_if(levelGroups, [](const auto& groups) { return groups.empty(); });
+
+    // The level roots are allocated first so they are contiguous children of node 0
+    m_nodes.clear();
+    m_nodes.resize(1 + levelGroups.size());
+    std::vector<HierarchyGroup> orderedGroups;
+    orderedGroups.reserve(m_groups.size());
+    for (uint32_t i = 0; i < levelGroups.size(); ++i) {
+        buildNode(1 + i, levelGroups[i], orderedGroups);
+    }
+    m_groups = std::move(orderedGroups);
+
+    HierarchyNode& root = m_nodes[0];
+    root.first = 1;
+    root.count = static_cast<uint32_t>(levelGroups.size());
+    std::vector<glm::vec4> childBounds;
+    for (uint32_t i = 0; i < root.count; ++i) {
+        childBounds.push_back(m_nodes[1 + i].bounds);
+        root.maxError = std::max(root.maxError, m_nodes[1 + i].maxError);
+    }
+    root.bounds = mergeSpheres(childBounds);
+}
+
+void ClusterHierarchy::buildNode(uint32_t nodeIndex, std::span<uint32_t> groupIndices,
+                                 std::vector<HierarchyGroup>& orderedGroups) {
+    // Sphere around the box of the group spheres: tighter than merging them one by one
+    glm::vec3 boxMin{std::numeric_limits<float>::max()};
+    glm::vec3 boxMax{std::numeric_limits<float>::lowest()};
+    glm::vec3 centerMin = boxMin;
+    glm::vec3 centerMax = boxMax;
+    float maxError = 0.0f;
+    for (uint32_t index : groupIndices) {
+        const glm::vec4& sphere = m_groups[index].lodBounds;
+        const glm::vec3 center{sphere.x, sphere.y, sphere.z};
+        boxMin = glm::min(boxMin, center - sphere.w);
+        boxMax = glm::max(boxMax, center + sphere.w);
+        centerMin = glm::min(centerMin, center);
+        centerMax = glm::max(centerMax, center);
+        maxError = std::max(maxError, m_groups[index].error);
+    }
+
+    const glm::vec3 center = (boxMin + boxMax) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t index : groupIndices) {
+        const glm::vec4& sphere = m_groups[index].lodBounds;
+        radius = std::max(radius, glm::length(glm::vec3{sphere.x, sphere.y, sphere.z} - center) +
+                                      sphere.w);
+    }
+
+    HierarchyNode node;
+    node.bounds = glm::vec4{center, radius};
+    node.maxError = maxError;
+
+    if (groupIndices.size() <= kLeafGroupCount) {
+        node.first = static_cast<uint32_t>(orderedGroups.size());
+        node.count = static_cast<uint32_t>(groupIndices.size());
+        node.isLeaf = 1;
+        for (uint32_t index : groupIndices) {
+            orderedGroups.push_back(m_groups[index]);
+        }
+        m_nodes[nodeIndex] = node;
+        return;
+    }
+
+    // Median split along the widest axis of the group centers
+    const glm::vec3 extent = centerMax - centerMin;
+    const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0
+                     : extent.y >= extent.z                        ? 1
+                                                                   : 2;
+    const size_t middle = groupIndices.size() / 2;
+    std::nth_element(groupIndices.begin(), groupIndices.begin() + middle, groupIndices.end(),
+                     [this, axis](uint32_t lhs, uint32_t rhs) {
+                         return m_groups[lhs].lodBounds[axis] < m_groups[rhs].lodBounds[axis];
+                     });
+
+    node.first = static_cast<uint32_t>(m_nodes.size());
+    node.count = 2;
+    m_nodes[nodeIndex] = node;
+    m_nodes.resize(m_nodes.size() + 2);
+    buildNode(node.first, groupIndices.first(middle), orderedGroups);
+    buildNode(node.first + 1, groupIndices.subspan(middle), orderedGroups);
+}
+
+auto ClusterHierarchy::getTaskNodes(uint32_t minCount) const -> std::vector<uint32_t> {
+    std::vector<uint32_t> frontier{0};
+    std::vector<uint32_t> next;
+    while (frontier.size() < minCount) {
+        next.clear();
+        bool expanded = false;
+        for (uint32_t index : frontier) {
+            const HierarchyNode& node = m_nodes[index];
+            if (node.isLeaf) {
+                next.push_back(index);
+                continue;
+            }
+            for (uint32_t child = node.first; child < node.first + node.count; ++child) {
+                next.push_back(child);
+            }
+            expanded = true;
+        }
+        if (!expanded) {
+            break;
+        }
+        frontier.swap(next);
+    }
+    return frontier;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Error.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct ClusterDag;
+class PagedGeometry;
+
+// A set of clusters simplified together; its members belong to the cut for threshold t when
+//     projected(error, lodBounds) > t && projected(clusterError, clusterLodBounds) <= t
+struct HierarchyGroup {
+    glm::vec4 lodBounds{0.0f};
+    float error{0.0f};
+    uint32_t level{0};
+    uint32_t firstCluster{0}; // Index into ClusterHierarchy::getClusters()
+    uint32_t clusterCount{0};
+};
+
+constexpr uint32_t kNoChildPage = ~0u;
+
+struct HierarchyCluster {
+    glm::vec4 lodBounds{0.0f};
+    float error{0.0f};
+    // Cluster in the source: the mesh cluster of a DAG, or the page and the index within the
+    // page of a cooked file
+    uint32_t page{0};
+    uint32_t index{0};
+    // Page holding the group this cluster was simplified from, which it stands in for while
+    // that page is not resident; kNoChildPage for the finest level. A DAG is a single page 0.
+    uint32_t childPage{kNoChildPage};
+};
+
+// BVH node over groups. The test for whether any group below can contribute to the cut uses
+// the enclosing sphere and the largest group error, which can only overestimate the projected
+// error of every group in the subtree, so skipping a failed node never drops a cluster.
+struct HierarchyNode {
+    glm::vec4 bounds{0.0f}; // Sphere around the lodBounds of every group below
+    float maxError{0.0f};
+    uint32_t first{0};      // First child node, or first group for leaves
+    uint32_t count{0};
+    uint32_t isLeaf{0};
+};
+
+static_assert(sizeof(HierarchyGroup) == 32);
+static_assert(sizeof(HierarchyCluster) == 32);
+static_assert(sizeof(HierarchyNode) == 32);
+
+// Runtime LOD hierarchy of one mesh: its groups and clusters with their LOD errors, plus a
+// BVH over the groups for cut selection. Every LOD level gets a BVH of its own, so coarse
+// levels with large errors do not keep the fine levels' nodes from being skipped; node 0 is
+// the root whose children are the level BVHs.
+class ClusterHierarchy {
+public:
+    static constexpr uint32_t kLeafGroupCount = 4;
+
+    [[nodiscard]] static auto fromDag(const ClusterDag& dag) -> ClusterHierarchy;
+    // Built from the hierarchy section alone; no page is read
+    [[nodiscard]] static auto fromPagedGeometry(const PagedGeometry& geometry)
+        -> Result<ClusterHierarchy>;
+
+    [[nodiscard]] auto getNodes() const noexcept -> std::span<const HierarchyNode> {
+        return m_nodes;
+    }
+    [[nodiscard]] auto getGroups() const noexcept -> std::span<const HierarchyGroup> {
+        return m_groups;
+    }
+    [[nodiscard]] auto getClusters() const noexcept -> std::span<const HierarchyCluster> {
+        return m_clusters;
+    }
+    [[nodiscard]] auto getLevelCount() const noexcept -> uint32_t { return m_levelCount; }
+
+    // Disjoint subtrees covering every group, at least minCount of them where the tree allows,
+    // for splitting a traversal into independent tasks
+    [[nodiscard]] auto getTaskNodes(uint32_t minCount) const -> std::vector<uint32_t>;
+
+private:
+    ClusterHierarchy() = default;
+    void buildBvh();
+    void buildNode(uint32_t nodeIndex, std::span<uint32_t> groupIndices,
+                   std::vector<HierarchyGroup>& orderedGroups);
+
+    std::vector<HierarchyNode> m_nodes;
+    std::vector<HierarchyGroup> m_groups;
+    std::vector<HierarchyCluster> m_clusters;
+    uint32_t m_levelCount{0};
+};
@@ -0,0 +1,207 @@
+#include "LodSelector.hpp"
+#include "ClusterHierarchy.hpp"
+#include "Core/JobSystem.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// The camera in an instance's object space, where spheres and errors can be used as stored
+struct ObjectView {
+    glm::vec3 eye{0.0f};
+    float nearDistance{0.0f};
+    float thresholdPerDistance{0.0f}; // Object-space error that projects to the threshold at 1
+};
+
+auto makeObjectView(const LodCamera& camera, const LodInstance& instance) -> ObjectView {
+    const glm::mat4& transform = instance.transform;
+    const glm::vec3 axisX{transform[0].x, transform[0].y, transform[0].z};
+    const glm::vec3 axisY{transform[1].x, transform[1].y, transform[1].z};
+    const glm::vec3 axisZ{transform[2].x, transform[2].y, transform[2].z};
+    const glm::vec3 translation{transform[3].x, transform[3].y, transform[3].z};
+    const float scaleSquared = glm::dot(axisX, axisX);
+    const float scale = std::sqrt(scaleSquared);
+
+    // Inverse of rotation * scale is transpose(rotation) / scale
+    const glm::vec3 offset = camera.position - translation;
+    ObjectView view;
+    view.eye = glm::vec3{glm::dot(axisX, offset), glm::dot(axisY, offset),
+                         glm::dot(axisZ, offset)} / scaleSquared;
+    // Both distances and errors scale with the instance, so only the near distance changes
+    view.nearDistance = camera.nearDistance / scale;
+    view.thresholdPerDistance = camera.errorThreshold / camera.projectionScale;
+    return view;
+}
+
+// projected(error, sphere) > threshold without a square root: the error stays visible up to
+// the distance error / thresholdPerDistance from the sphere's surface
+auto exceedsThreshold(const ObjectView& view, float error, const glm::vec4& sphere) -> bool {
+    const float limit = error / view.thresholdPerDistance;
+    if (!(view.nearDistance < limit)) {
+        return false;
+    }
+    const glm::vec3 offset = glm::vec3{sphere.x, sphere.y, sphere.z} - view.eye;
+    const float reach = limit + sphere.w;
+    return glm::dot(offset, offset) < reach * reach;
+}
+
+auto isResident(std::span<const uint8_t> residentPages, uint32_t page) -> bool {
+    return residentPages.empty() || residentPages[page] != 0;
+}
+
+// A group whose page is missing is skipped, and every cluster simplified from that group
+// stays in the cut instead: all of them carry its error and lodBounds, so they fall back
+// together and the cut stays crack-free.
+void selectGroup(const ClusterHierarchy& hierarchy, const HierarchyGroup& group,
+                 const ObjectView& view, uint32_t instance, std::span<const uint8_t> residentPages,
+                 std::vector<SelectedCluster>& output, LodSelector::Stats& stats) {
+    ++stats.groupsTested;
+    if (!exceedsThreshold(view, group.error, group.lodBounds)) {
+        return;
+    }
+
+    const auto clusters = hierarchy.getClusters().subspan(group.firstCluster, group.clusterCount);
+    if (!isResident(residentPages, clusters.front().page)) {
+        return;
+    }
+    stats.clustersTested += clusters.size();
+    for (uint32_t i = 0; i < clusters.size(); ++i) {
+        const HierarchyCluster& cluster = clusters[i];
+        if (!exceedsThreshold(view, cluster.error, cluster.lodBounds)) {
+            output.push_back(SelectedCluster{instance, group.firstCluster + i});
+        } else if (cluster.childPage != kNoChildPage &&
+                   !isResident(residentPages, cluster.childPage)) {
+            output.push_back(SelectedCluster{instance, group.firstCluster + i});
+            ++stats.clustersFallback;
+        }
+    }
+}
+
+void traverse(const ClusterHierarchy& hierarchy, uint32_t rootNode, const ObjectView& view,
+              uint32_t instance, std::span<const uint8_t> residentPages,
+              std::vector<SelectedCluster>& output, LodSelector::Stats& stats) {
+    const auto nodes = hierarchy.getNodes();
+    const auto groups = hierarchy.getGroups();
+
+    // Median splits keep the depth logarithmic; the root adds one child per LOD level
+    std::array<uint32_t, 256> stack;
+    uint32_t stackSize = 0;
+    stack[stackSize++] = rootNode;
+    while (stackSize > 0) {
+        const HierarchyNode& node = nodes[stack[--stackSize]];
+        ++stats.nodesVisited;
+        if (!exceedsThreshold(view, node.maxError, node.bounds)) {
+            continue;
+        }
+
+        if (node.isLeaf) {
+            for (uint32_t group = node.first; group < node.first + node.count; ++group) {
+                selectGroup(hierarchy, groups[group], view, instance, residentPages, output,
+                            stats);
+            }
+            continue;
+        }
+        // Pushed in reverse so children are visited in order, which keeps the output in
+        // group order like the brute force path
+        for (uint32_t child = node.first + node.count; child-- > node.first;) {
+            stack[stackSize++] = child;
+        }
+    }
+}
+
+void accumulate(LodSelector::Stats& total, const LodSelector::Stats& stats) {
+    total.nodesVisited += stats.nodesVisited;
+    total.groupsTested += stats.groupsTested;
+    total.clustersTested += stats.clustersTested;
+    total.clustersSelected += stats.clustersSelected;
+    total.clustersFallback += stats.clustersFallback;
+}
+
+} // namespace
+
+auto LodCamera::fromPerspective(const glm::vec3& position, float fovY, float viewportHeight,
+                                float nearDistance, float errorThreshold) -> LodCamera {
+    return LodCamera{position, viewportHeight / (2.0f * std::tan(fovY * 0.5f)), nearDistance,
+                     errorThreshold};
+}
+
+auto LodSelector::projectError(const LodCamera& camera, const LodInstance& instance,
+                               float error, const glm::vec4& lodBounds) -> float {
+    const ObjectView view = makeObjectView(camera, instance);
+    const float distance = glm::length(glm::vec3{lodBounds} - view.eye) - lodBounds.w;
+    // Distances and errors scale alike, so the ratio is the same in object and world space
+    return error * camera.projectionScale / std::max(distance, view.nearDistance);
+}
+
+auto LodSelector::select(const ClusterHierarchy& hierarchy,
+                         std::span<const LodInstance> instances, const LodCamera& camera,
+                         JobSystem* jobSystem, std::vector<SelectedCluster>& output,
+                         std::span<const uint8_t> residentPages) -> Stats {
+    ZoneScoped;
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+    const auto start = Clock::now();
+
+    const std::vector<uint32_t> taskNodes = hierarchy.getTaskNodes(m_config.subtreesPerInstance);
+    const uint64_t taskCount = instances.size() * taskNodes.size();
+    const uint32_t tasksPerJob = std::max(m_config.tasksPerJob, 1u);
+    const auto jobCount = static_cast<uint32_t>((taskCount + tasksPerJob - 1) / tasksPerJob);
+
+    if (m_jobOutputs.size() < jobCount) {
+        m_jobOutputs.resize(jobCount);
+    }
+    parallelFor(jobSystem, jobCount, 1, [&](uint32_t job) {
+        ZoneScopedN("LOD Selection Job");
+        TaskOutput& jobOutput = m_jobOutputs[job];
+        jobOutput.clusters.clear();
+        jobOutput.stats = Stats{};
+
+        const uint64_t end = std::min<uint64_t>((job + 1ull) * tasksPerJob, taskCount);
+        for (uint64_t task = job * static_cast<uint64_t>(tasksPerJob); task < end; ++task) {
+            const auto instance = static_cast<uint32_t>(task / taskNodes.size());
+            const uint32_t node = taskNodes[task % taskNodes.size()];
+            traverse(hierarchy, node, makeObjectView(camera, instances[instance]), instance,
+                     residentPages, jobOutput.clusters, jobOutput.stats);
+        }
+        jobOutput.stats.clustersSelected = jobOutput.clusters.size();
+    });
+
+    // Tasks are instance-major and cover subtrees in order, so concatenating the jobs gives
+    // the same cut in the same order for any thread count
+    Stats stats;
+    output.clear();
+    for (uint32_t job = 0; job < jobCount; ++job) {
+        const TaskOutput& jobOutput = m_jobOutputs[job];
+        output.insert(output.end(), jobOutput.clusters.begin(), jobOutput.clusters.end());
+        accumulate(stats, jobOutput.stats);
+    }
+
+    stats.milliseconds = Milliseconds(Clock::now() - start).count();
+    return stats;
+}
+
+auto LodSelector::selectBruteForce(const ClusterHierarchy& hierarchy,
+                                   std::span<const LodInstance> instances,
+                                   const LodCamera& camera, std::vector<SelectedCluster>& output,
+                                   std::span<const uint8_t> residentPages) -> Stats {
+    ZoneScoped;
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+    const auto start = Clock::now();
+
+    Stats stats;
+    output.clear();
+    for (uint32_t instance = 0; instance < instances.size(); ++instance) {
+        const ObjectView view = makeObjectView(camera, instances[instance]);
+        for (const HierarchyGroup& group : hierarchy.getGroups()) {
+            selectGroup(hierarchy, group, view, instance, residentPages, output, stats);
+        }
+    }
+
+    stats.clustersSelected = output.size();
+    stats.milliseconds = Milliseconds(Clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class ClusterHierarchy;
+class JobSystem;
+
+// View parameters for LOD selection. An error of e at distance d covers
+// e * projectionScale / d pixels; clusters are refined until that is at most errorThreshold.
+struct LodCamera {
+    glm::vec3 position{0.0f};
+    float projectionScale{1.0f}; // viewportHeight / (2 * tan(fovY / 2))
+    float nearDistance{0.1f};    // Anything closer is treated as being at this distance
+    float errorThreshold{1.0f};  // Pixels
+
+    [[nodiscard]] static auto fromPerspective(const glm::vec3& position, float fovY,
+                                              float viewportHeight, float nearDistance,
+                                              float errorThreshold) -> LodCamera;
+};
+
+// Rotation, uniform scale and translation; the scale is taken from the first column
+struct LodInstance {
+    glm::mat4 transform{1.0f};
+};
+
+struct SelectedCluster {
+    uint32_t instance{0};
+    uint32_t cluster{0}; // Index into ClusterHierarchy::getClusters()
+};
+
+// Selects the crack-free LOD cut of every instance: the clusters whose group's projected error
+// is above the threshold while their own is not. Traversal descends the hierarchy BVH and
+// skips subtrees whose largest error cannot project above the threshold. Instances and the
+// top subtrees of the hierarchy are split into independent tasks for the job system; the
+// output is ordered the same for any thread count.
+//
+// With a residency mask, groups on missing pages are not refined into: the clusters simplified
+// from them stay in the cut as fallbacks until the page arrives.
+//
+// This is the CPU reference for GPU cut selection and the fallback where compute culling is
+// unavailable. Visibility is left to the culling stages that consume the cut.
+class LodSelector {
+public:
+    struct Config {
+        // Tasks per instance; more balances better across workers at some traversal overhead
+        uint32_t subtreesPerInstance{16};
+        uint32_t tasksPerJob{8};
+    };
+
+    struct Stats {
+        uint64_t nodesVisited{0};
+        uint64_t groupsTested{0};
+        uint64_t clustersTested{0};
+        uint64_t clustersSelected{0};
+        uint64_t clustersFallback{0}; // Selected in place of a group whose page is missing
+        float milliseconds{0.0f};
+    };
+
+    LodSelector() = default;
+    explicit LodSelector(const Config& config) : m_config(config) {}
+
+    // Replaces output with the cut; a null job system runs on the calling thread.
+    // residentPages holds one nonzero byte per resident page and may be empty when every page
+    // is available, e.g. for a hierarchy built from a DAG.
+    auto select(const ClusterHierarchy& hierarchy, std::span<const LodInstance> instances,
+                const LodCamera& camera, JobSystem* jobSystem,
+                std::vector<SelectedCluster>& output,
+                std::span<const uint8_t> residentPages = {}) -> Stats;
+
+    // Size in pixels of an object-space error over the given LOD sphere of an instance, the
+    // measure the cut refines by; e.g. for ranking page requests
+    [[nodiscard]] static auto projectError(const LodCamera& camera, const LodInstance& instance,
+                                           float error, const glm::vec4& lodBounds) -> float;
+
+    // Tests every group and cluster without the BVH; the result matches select()
+    static auto selectBruteForce(const ClusterHierarchy& hierarchy,
+                                 std::span<const LodInstance> instances, const LodCamera& camera,
+                                 std::vector<SelectedCluster>& output,
+                                 std::span<const uint8_t> residentPages = {}) -> Stats;
+
+private:
+    struct TaskOutput {
+        std::vector<SelectedCluster> clusters;
+        Stats stats;
+    };
+
+    Config m_config;
+    std::vector<TaskOutput> m_jobOutputs; // Reused across calls to avoid reallocating
+};
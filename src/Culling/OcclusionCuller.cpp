@@ -0,0 +1,479 @@
+#include "OcclusionCuller.hpp"
+#include "Core/JobSystem.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VG_RASTER_SSE 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VG_RASTER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Four horizontally adjacent pixels. SSE2 and NEON are part of the x86-64 and AArch64
+// baselines, so unlike the cluster culling kernels these need no runtime dispatch.
+#if VG_RASTER_SSE
+
+using Float4 = __m128;
+
+auto splat(float value) -> Float4 {
+    return _mm_set1_ps(value);
+}
+
+auto pixelOffsets() -> Float4 {
+    return _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+}
+
+auto add(Float4 a, Float4 b) -> Float4 {
+    return _mm_add_ps(a, b);
+}
+
+auto multiplyAdd(Float4 a, Float4 b, Float4 c) -> Float4 {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+// Keeps the nearer depth in the lanes where all three edge functions are non-negative
+void depthTest(float* pixels, Float4 edge0, Float4 edge1, Float4 edge2, Float4 depth) {
+    const Float4 zero = _mm_setzero_ps();
+    const Float4 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero),
+                                                _mm_cmpge_ps(edge1, zero)),
+                                     _mm_cmpge_ps(edge2, zero));
+    const Float4 current = _mm_loadu_ps(pixels);
+    const Float4 nearest = _mm_min_ps(depth, current);
+    _mm_storeu_ps(pixels, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+}
+
+#elif VG_RASTER_NEON
+
+using Float4 = float32x4_t;
+
+auto splat(float value) -> Float4 {
+    return vdupq_n_f32(value);
+}
+
+auto pixelOffsets() -> Float4 {
+    constexpr float kOffsets[4] = {0.5f, 1.5f, 2.5f, 3.5f};
+    return vld1q_f32(kOffsets);
+}
+
+auto add(Float4 a, Float4 b) -> Float4 {
+    return vaddq_f32(a, b);
+}
+
+auto multiplyAdd(Float4 a, Float4 b, Float4 c) -> Float4 {
+    return vaddq_f32(vmulq_f32(a, b), c);
+}
+
+void depthTest(float* pixels, Float4 edge0, Float4 edge1, Float4 edge2, Float4 depth) {
+    const Float4 zero = vdupq_n_f32(0.0f);
+    const uint32x4_t inside =
+        vandq_u32(vandq_u32(vcgeq_f32(edge0, zero), vcgeq_f32(edge1, zero)),
+                  vcgeq_f32(edge2, zero));
+    const Float4 current = vld1q_f32(pixels);
+    vst1q_f32(pixels, vbslq_f32(inside, vminq_f32(depth, current), current));
+}
+
+#else
+
+struct Float4 {
+    float lanes[4];
+};
+
+auto splat(float value) -> Float4 {
+    return Float4{{value, value, value, value}};
+}
+
+auto pixelOffsets() -> Float4 {
+    return Float4{{0.5f, 1.5f, 2.5f, 3.5f}};
+}
+
+auto add(Float4 a, Float4 b) -> Float4 {
+    for (int i = 0; i < 4; ++i) {
+        a.lanes[i] += b.lanes[i];
+    }
+    return a;
+}
+
+auto multiplyAdd(Float4 a, Float4 b, Float4 c) -> Float4 {
+    for (int i = 0; i < 4; ++i) {
+        a.lanes[i] = a.lanes[i] * b.lanes[i] + c.lanes[i];
+    }
+    return a;
+}
+
+void depthTest(float* pixels, Float4 edge0, Float4 edge1, Float4 edge2, Float4 depth) {
+    for (int i = 0; i < 4; ++i) {
+        if (edge0.lanes[i] >= 0.0f && edge1.lanes[i] >= 0.0f && edge2.lanes[i] >= 0.0f) {
+            pixels[i] = std::min(depth.lanes[i], pixels[i]);
+        }
+    }
+}
+
+#endif
+
+// Edge from a to b as (a, b, c); positive on the side of the third vertex of a triangle with
+// positive area
+auto makeEdge(const glm::vec3& from, const glm::vec3& to) -> glm::vec3 {
+    const float a = from.y - to.y;
+    const float b = to.x - from.x;
+    return glm::vec3{a, b, -(a * from.x + b * from.y)};
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(const Config& config)
+    : m_width((std::max(config.width, 1u) + kTileWidth - 1) / kTileWidth * kTileWidth),
+      m_height((std::max(config.height, 1u) + kTileHeight - 1) / kTileHeight * kTileHeight),
+      m_tilesX(m_width / kTileWidth), m_tilesY(m_height / kTileHeight),
+      m_triangleBudget(config.triangleBudget) {
+    m_bins.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+
+    uint32_t width = m_width;
+    uint32_t height = m_height;
+    while (true) {
+        m_levels.push_back(Level{width, height,
+                                 std::vector<float>(static_cast<size_t>(width) * height, 1.0f)});
+        if (width == 1 && height == 1) {
+            break;
+        }
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProjection,
+                                 const glm::vec3& cameraPosition) {
+    m_viewProjection = viewProjection;
+    m_cameraPosition = cameraPosition;
+    m_occluders.clear();
+    m_stats = Stats{};
+}
+
+void OcclusionCuller::addOccluder(const Occluder& occluder) {
+    m_occluders.push_back(occluder);
+    ++m_stats.occludersSubmitted;
+}
+
+void OcclusionCuller::rasterize(JobSystem* jobSystem) {
+    ZoneScoped;
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+    const auto start = Clock::now();
+
+    // Largest projected size first: radius over distance, with occluders around the camera
+    // ahead of everything
+    std::vector<float> sizes(m_occluders.size());
+    for (size_t i = 0; i < m_occluders.size(); ++i) {
+        const glm::vec4& bounds = m_occluders[i].bounds;
+        const float distance =
+            glm::length(glm::vec3{bounds.x, bounds.y, bounds.z} - m_cameraPosition);
+        sizes[i] = distance > bounds.w ? bounds.w / distance
+                                       : std::numeric_limits<float>::infinity();
+    }
+    std::vector<uint32_t> order(m_occluders.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, [&](uint32_t lhs, uint32_t rhs) {
+        return sizes[lhs] > sizes[rhs];
+    });
+
+    std::vector<uint32_t> selected;
+    uint64_t triangleCount = 0;
+    for (uint32_t index : order) {
+        const uint64_t triangles = m_occluders[index].indices.size() / 3;
+        if (triangleCount + triangles <= m_triangleBudget) {
+            selected.push_back(index);
+            triangleCount += triangles;
+        }
+    }
+    m_stats.occludersRasterized = static_cast<uint32_t>(selected.size());
+
+    {
+        ZoneScopedN("Occluder Setup");
+        if (m_occluderTriangles.size() < selected.size()) {
+            m_occluderTriangles.resize(selected.size());
+        }
+        std::vector<uint32_t> rejected(selected.size(), 0);
+        parallelFor(jobSystem, static_cast<uint32_t>(selected.size()), 16, [&](uint32_t i) {
+            m_occluderTriangles[i].clear();
+            setupOccluder(m_occluders[selected[i]], m_occluderTriangles[i], rejected[i]);
+        });
+
+        m_triangles.clear();
+        for (size_t i = 0; i < selected.size(); ++i) {
+            m_triangles.insert(m_triangles.end(), m_occluderTriangles[i].begin(),
+                               m_occluderTriangles[i].end());
+            m_stats.trianglesRejected += rejected[i];
+        }
+        m_stats.trianglesRasterized = static_cast<uint32_t>(m_triangles.size());
+    }
+
+    {
+        ZoneScopedN("Occluder Binning");
+        for (std::vector<uint32_t>& bin : m_bins) {
+            bin.clear();
+        }
+        for (uint32_t i = 0; i < m_triangles.size(); ++i) {
+            const RasterTriangle& triangle = m_triangles[i];
+            for (int32_t y = triangle.minY / static_cast<int32_t>(kTileHeight);
+                 y <= triangle.maxY / static_cast<int32_t>(kTileHeight); ++y) {
+                for (int32_t x = triangle.minX / static_cast<int32_t>(kTileWidth);
+                     x <= triangle.maxX / static_cast<int32_t>(kTileWidth); ++x) {
+                    m_bins[static_cast<size_t>(y) * m_tilesX + x].push_back(i);
+                }
+            }
+        }
+    }
+
+    parallelFor(jobSystem, m_tilesX * m_tilesY, 1, [this](uint32_t tile) { fillTile(tile); });
+    const auto rasterEnd = Clock::now();
+    buildPyramid();
+
+    m_stats.rasterMilliseconds = Milliseconds(rasterEnd - start).count();
+    m_stats.pyramidMilliseconds = Milliseconds(Clock::now() - rasterEnd).count();
+    TracyPlot("Occlusion Raster ms", m_stats.rasterMilliseconds);
+    TracyPlot("Occluder Triangles", static_cast<int64_t>(m_stats.trianglesRasterized));
+}
+
+void OcclusionCuller::setupOccluder(const Occluder& occluder,
+                                    std::vector<RasterTriangle>& triangles,
+                                    uint32_t& rejected) const {
+    // Vertices are transformed per triangle: occluders such as clusters index a small part of
+    // a shared position array
+    const glm::mat4 transform = m_viewProjection * occluder.transform;
+    for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3) {
+        std::array<glm::vec4, 3> vertices;
+        for (uint32_t v = 0; v < 3; ++v) {
+            vertices[v] = transform * glm::vec4{occluder.positions[occluder.indices[i + v]], 1.0f};
+        }
+
+        // Entirely outside one plane of the frustum
+        auto allOutside = [&](auto&& outside) {
+            return outside(vertices[0]) && outside(vertices[1]) && outside(vertices[2]);
+        };
+        if (allOutside([](const glm::vec4& v) { return v.x > v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.x < -v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.y > v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.y < -v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.z > v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.z < 0.0f; })) {
+            ++rejected;
+            continue;
+        }
+        if (vertices[0].z >= 0.0f && vertices[1].z >= 0.0f && vertices[2].z >= 0.0f) {
+            setupTriangle(vertices, triangles, rejected);
+            continue;
+        }
+
+        // Clip against the near plane z = 0; the polygon has at most four vertices and is
+        // drawn as a fan
+        std::array<glm::vec4, 4> polygon;
+        uint32_t polygonSize = 0;
+        for (uint32_t v = 0; v < 3; ++v) {
+            const glm::vec4& current = vertices[v];
+            const glm::vec4& next = vertices[(v + 1) % 3];
+            if (current.z >= 0.0f) {
+                polygon[polygonSize++] = current;
+            }
+            if ((current.z >= 0.0f) != (next.z >= 0.0f)) {
+                const float t = current.z / (current.z - next.z);
+                polygon[polygonSize++] = current + (next - current) * t;
+            }
+        }
+        for (uint32_t v = 1; v + 1 < polygonSize; ++v) {
+            setupTriangle({polygon[0], polygon[v], polygon[v + 1]}, triangles, rejected);
+        }
+    }
+}
+
+void OcclusionCuller::setupTriangle(const std::array<glm::vec4, 3>& clip,
+                                    std::vector<RasterTriangle>& triangles,
+                                    uint32_t& rejected) const {
+    // Vulkan viewport transform: y points down in both clip space and the depth buffer
+    std::array<glm::vec3, 3> screen;
+    for (uint32_t i = 0; i < 3; ++i) {
+        const float inverseW = 1.0f / clip[i].w;
+        screen[i] = glm::vec3{(clip[i].x * inverseW * 0.5f + 0.5f) * static_cast<float>(m_width),
+                              (clip[i].y * inverseW * 0.5f + 0.5f) * static_cast<float>(m_height),
+                              clip[i].z * inverseW};
+    }
+
+    float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) -
+                 (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y);
+    // Occluders hide from both sides, so back faces are flipped rather than dropped
+    if (area < 0.0f) {
+        std::swap(screen[1], screen[2]);
+        area = -area;
+    }
+    if (!(area > 1e-6f)) {
+        ++rejected;
+        return;
+    }
+
+    // Pixels whose centre lies within the triangle's bounds
+    const float minX = std::min({screen[0].x, screen[1].x, screen[2].x});
+    const float maxX = std::max({screen[0].x, screen[1].x, screen[2].x});
+    const float minY = std::min({screen[0].y, screen[1].y, screen[2].y});
+    const float maxY = std::max({screen[0].y, screen[1].y, screen[2].y});
+    RasterTriangle triangle;
+    triangle.minX = static_cast<int32_t>(std::max(std::ceil(minX - 0.5f), 0.0f));
+    triangle.minY = static_cast<int32_t>(std::max(std::ceil(minY - 0.5f), 0.0f));
+    triangle.maxX = static_cast<int32_t>(
+        std::min(std::floor(maxX - 0.5f), static_cast<float>(m_width - 1)));
+    triangle.maxY = static_cast<int32_t>(
+        std::min(std::floor(maxY - 0.5f), static_cast<float>(m_height - 1)));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        ++rejected;
+        return;
+    }
+
+    // The edge opposite each vertex, scaled by 1 / area, gives its barycentric weight
+    triangle.edges = {makeEdge(screen[0], screen[1]), makeEdge(screen[1], screen[2]),
+                      makeEdge(screen[2], screen[0])};
+    const float inverseArea = 1.0f / area;
+    triangle.depth = (triangle.edges[1] * screen[0].z + triangle.edges[2] * screen[1].z +
+                      triangle.edges[0] * screen[2].z) * inverseArea;
+    triangles.push_back(triangle);
+}
+
+void OcclusionCuller::fillTile(uint32_t tile) {
+    const auto tileX = static_cast<int32_t>(tile % m_tilesX * kTileWidth);
+    const auto tileY = static_cast<int32_t>(tile / m_tilesX * kTileHeight);
+    float* depth = m_levels[0].depth.data();
+    for (int32_t y = tileY; y < tileY + static_cast<int32_t>(kTileHeight); ++y) {
+        std::fill_n(depth + static_cast<size_t>(y) * m_width + tileX, kTileWidth, 1.0f);
+    }
+
+    const Float4 offsets = pixelOffsets();
+    for (uint32_t index : m_bins[tile]) {
+        const RasterTriangle& triangle = m_triangles[index];
+        // Tiles are a multiple of four pixels wide, so aligning down stays within the tile
+        const int32_t startX = std::max(triangle.minX, tileX) & ~3;
+        const int32_t endX = std::min(triangle.maxX, tileX + static_cast<int32_t>(kTileWidth) - 1);
+        const int32_t startY = std::max(triangle.minY, tileY);
+        const int32_t endY =
+            std::min(triangle.maxY, tileY + static_cast<int32_t>(kTileHeight) - 1);
+
+        const Float4 edgeA0 = splat(triangle.edges[0].x);
+        const Float4 edgeA1 = splat(triangle.edges[1].x);
+        const Float4 edgeA2 = splat(triangle.edges[2].x);
+        const Float4 depthA = splat(triangle.depth.x);
+        for (int32_t y = startY; y <= endY; ++y) {
+            const float centerY = static_cast<float>(y) + 0.5f;
+            const Float4 row0 = splat(triangle.edges[0].y * centerY + triangle.edges[0].z);
+            const Float4 row1 = splat(triangle.edges[1].y * centerY + triangle.edges[1].z);
+            const Float4 row2 = splat(triangle.edges[2].y * centerY + triangle.edges[2].z);
+            const Float4 rowDepth = splat(triangle.depth.y * centerY + triangle.depth.z);
+            float* pixels = depth + static_cast<size_t>(y) * m_width;
+            for (int32_t x = startX; x <= endX; x += 4) {
+                const Float4 centerX = add(splat(static_cast<float>(x)), offsets);
+                depthTest(pixels + x, multiplyAdd(edgeA0, centerX, row0),
+                          multiplyAdd(edgeA1, centerX, row1), multiplyAdd(edgeA2, centerX, row2),
+                          multiplyAdd(depthA, centerX, rowDepth));
+            }
+        }
+    }
+}
+
+void OcclusionCuller::buildPyramid() {
+    ZoneScoped;
+    // Each texel keeps the farthest depth of the four below it; odd edges fold the last row
+    // or column into the texel that covers it
+    for (size_t level = 1; level < m_levels.size(); ++level) {
+        const Level& source = m_levels[level - 1];
+        Level& target = m_levels[level];
+        for (uint32_t y = 0; y < target.height; ++y) {
+            const uint32_t y0 = std::min(y * 2, source.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+            const float* row0 = source.depth.data() + static_cast<size_t>(y0) * source.width;
+            const float* row1 = source.depth.data() + static_cast<size_t>(y1) * source.width;
+            float* output = target.depth.data() + static_cast<size_t>(y) * target.width;
+            for (uint32_t x = 0; x < target.width; ++x) {
+                const uint32_t x0 = std::min(x * 2, source.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+                output[x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+            }
+        }
+    }
+}
+
+auto OcclusionCuller::isOccluded(const OcclusionBox& box) const -> bool {
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    float nearestDepth = std::numeric_limits<float>::max();
+    for (uint32_t corner = 0; corner < 8; ++corner) {
+        const glm::vec3 position{(corner & 1) != 0 ? box.max.x : box.min.x,
+                                 (corner & 2) != 0 ? box.max.y : box.min.y,
+                                 (corner & 4) != 0 ? box.max.z : box.min.z};
+        const glm::vec4 clip = m_viewProjection * glm::vec4{position, 1.0f};
+        if (!(clip.z >= 0.0f) || !(clip.w > 0.0f)) {
+            return false;
+        }
+        const float inverseW = 1.0f / clip.w;
+        const float x = (clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(m_width);
+        const float y = (clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>(m_height);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearestDepth = std::min(nearestDepth, clip.z * inverseW);
+    }
+    // Off screen is for frustum culling to decide
+    if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(m_width) ||
+        minY >= static_cast<float>(m_height)) {
+        return false;
+    }
+
+    // Every pixel the rectangle touches, then the level where that is at most 2x2 texels
+    auto x0 = static_cast<uint32_t>(std::max(minX, 0.0f));
+    auto y0 = static_cast<uint32_t>(std::max(minY, 0.0f));
+    auto x1 = static_cast<uint32_t>(std::min(maxX, static_cast<float>(m_width - 1)));
+    auto y1 = static_cast<uint32_t>(std::min(maxY, static_cast<float>(m_height - 1)));
+    uint32_t level = 0;
+    while ((x1 - x0 > 1 || y1 - y0 > 1) && level + 1 < m_levels.size()) {
+        x0 >>= 1;
+        y0 >>= 1;
+        x1 >>= 1;
+        y1 >>= 1;
+        ++level;
+    }
+
+    const Level& hiZ = m_levels[level];
+    float farthest = 0.0f;
+    for (uint32_t y = y0; y <= y1; ++y) {
+        for (uint32_t x = x0; x <= x1; ++x) {
+            farthest = std::max(farthest, hiZ.depth[static_cast<size_t>(y) * hiZ.width + x]);
+        }
+    }
+    return nearestDepth > farthest;
+}
+
+auto OcclusionCuller::cullBoxes(std::span<const OcclusionBox> boxes,
+                                std::vector<uint32_t>& visible) -> uint32_t {
+    ZoneScoped;
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+    const auto start = Clock::now();
+
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < boxes.size(); ++i) {
+        if (!isOccluded(boxes[i])) {
+            visible.push_back(i);
+            ++written;
+        }
+    }
+
+    m_stats.boxesTested += boxes.size();
+    m_stats.boxesOccluded += boxes.size() - written;
+    m_stats.testMilliseconds += Milliseconds(Clock::now() - start).count();
+    TracyPlot("Occluded Fraction", m_stats.occludedFraction());
+    return written;
+}
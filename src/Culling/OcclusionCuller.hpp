@@ -0,0 +1,127 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+// Triangles that hide what is behind them. The spans must stay valid until rasterize().
+struct Occluder {
+    std::span<const glm::vec3> positions;
+    std::span<const uint32_t> indices; // Triangle list
+    glm::mat4 transform{1.0f};
+    glm::vec4 bounds{0.0f}; // World-space sphere, used to rank occluders by projected size
+};
+
+struct OcclusionBox {
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+};
+
+// CPU hierarchical-Z occlusion culling. Each frame the largest occluders within a triangle
+// budget are rasterized into a low-resolution depth buffer, a pyramid of farthest depths is
+// built over it, and boxes whose nearest point lies behind every texel they cover are
+// reported as occluded.
+//
+// Rasterization bins the clipped triangles into tiles that are filled in parallel, four
+// pixels per SIMD instruction. Depth follows Vulkan clip space: 0 at the near plane, cleared
+// to 1. Coverage is sampled at pixel centres like the GPU does, so an occluder can hide
+// a sliver of less than a pixel along its silhouette; everything else errs towards visible.
+//
+// Feeding the previous frame's visible occluders in gives the two-phase scheme without
+// requiring the GPU pipeline.
+class OcclusionCuller {
+public:
+    static constexpr uint32_t kTileWidth = 32;
+    static constexpr uint32_t kTileHeight = 16;
+
+    struct Config {
+        uint32_t width{256};  // Rounded up to whole tiles
+        uint32_t height{128};
+        uint32_t triangleBudget{16384};
+    };
+
+    struct Stats {
+        uint32_t occludersSubmitted{0};
+        uint32_t occludersRasterized{0};
+        uint32_t trianglesRasterized{0};
+        uint32_t trianglesRejected{0}; // Clipped away entirely or degenerate
+        uint64_t boxesTested{0};
+        uint64_t boxesOccluded{0};
+        float rasterMilliseconds{0.0f}; // Setup, binning and tile filling
+        float pyramidMilliseconds{0.0f};
+        float testMilliseconds{0.0f};
+
+        [[nodiscard]] auto occludedFraction() const noexcept -> double {
+            return boxesTested > 0 ? static_cast<double>(boxesOccluded) / boxesTested : 0.0;
+        }
+    };
+
+    explicit OcclusionCuller(const Config& config);
+
+    // Starts a frame: drops the occluders and the statistics of the previous one
+    void beginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+    void addOccluder(const Occluder& occluder);
+    // Picks the occluders to draw, fills the depth buffer and builds the pyramid
+    void rasterize(JobSystem* jobSystem);
+
+    // Boxes are in world space; boxes crossing the near plane are never occluded
+    [[nodiscard]] auto isOccluded(const OcclusionBox& box) const -> bool;
+    // Appends the indices of the boxes that are not occluded and returns how many
+    auto cullBoxes(std::span<const OcclusionBox> boxes, std::vector<uint32_t>& visible)
+        -> uint32_t;
+
+    [[nodiscard]] auto getStats() const noexcept -> const Stats& { return m_stats; }
+    [[nodiscard]] auto getWidth() const noexcept -> uint32_t { return m_width; }
+    [[nodiscard]] auto getHeight() const noexcept -> uint32_t { return m_height; }
+    // Level 0 is the depth buffer; every level halves the previous one, rounding up
+    [[nodiscard]] auto getLevelCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(m_levels.size());
+    }
+    [[nodiscard]] auto getLevel(uint32_t level) const noexcept -> std::span<const float> {
+        return m_levels[level].depth;
+    }
+
+private:
+    // Edge functions and depth as planes (a, b, c) evaluated as a * x + b * y + c at pixel
+    // centres; a pixel is covered when all three edge functions are non-negative
+    struct RasterTriangle {
+        std::array<glm::vec3, 3> edges;
+        glm::vec3 depth;
+        int32_t minX;
+        int32_t minY;
+        int32_t maxX; // Inclusive
+        int32_t maxY;
+    };
+
+    struct Level {
+        uint32_t width{0};
+        uint32_t height{0};
+        std::vector<float> depth;
+    };
+
+    void setupOccluder(const Occluder& occluder, std::vector<RasterTriangle>& triangles,
+                       uint32_t& rejected) const;
+    void setupTriangle(const std::array<glm::vec4, 3>& clip,
+                       std::vector<RasterTriangle>& triangles, uint32_t& rejected) const;
+    void fillTile(uint32_t tile);
+    void buildPyramid();
+
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+    uint32_t m_triangleBudget;
+
+    glm::mat4 m_viewProjection{1.0f};
+    glm::vec3 m_cameraPosition{0.0f};
+    std::vector<Occluder> m_occluders;
+    std::vector<std::vector<RasterTriangle>> m_occluderTriangles; // Reused across frames
+    std::vector<RasterTriangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_bins; // Triangle indices per tile
+    std::vector<Level> m_levels;
+    Stats m_stats;
+};
@@ -14,6 +14,12 @@ enum class ErrorCode {
     SurfaceCreationFailed,
     ValidationLayersNotAvailable,
     DebugMessengerCreationFailed,
+    VulkanResourceCreationFailed,
+    InvalidArgument,
+    InvalidMeshData,
+    FileOpenFailed,
+    FileParseFailed,
+    FileWriteFailed,
     Unknown
 };
 
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <span>
+
+// Spheres are packed as (center, radius)
+
+// Smallest sphere containing both a and b
+[[nodiscard]] inline auto mergeSpheres(const glm::vec4& a, const glm::vec4& b) -> glm::vec4 {
+    const glm::vec3 centerA{a.x, a.y, a.z};
+    const glm::vec3 centerB{b.x, b.y, b.z};
+    const glm::vec3 offset = centerB - centerA;
+    const float distance = glm::length(offset);
+
+    if (distance + b.w <= a.w) {
+        return a;
+    }
+    if (distance + a.w <= b.w) {
+        return b;
+    }
+
+    const float radius = (distance + a.w + b.w) * 0.5f;
+    const glm::vec3 center = centerA + offset * ((radius - a.w) / distance);
+    return {center, radius};
+}
+
+// Conservative enclosing sphere; every input sphere is guaranteed to be contained
+[[nodiscard]] inline auto mergeSpheres(std::span<const glm::vec4> spheres) -> glm::vec4 {
+    if (spheres.empty()) {
+        return glm::vec4{0.0f};
+    }
+
+    glm::vec4 result = spheres[0];
+    for (size_t i = 1; i < spheres.size(); ++i) {
+        result = mergeSpheres(result, spheres[i]);
+    }
+    return result;
+}
@@ -0,0 +1,674 @@
+#include "ClusterBuilder.hpp"
+#include "Core/JobSystem.hpp"
+#include "Morton.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+constexpr uint8_t kUnusedLocal = 0xff;
+constexpr uint16_t kNoNeighbour = 0xffff;
+
+// Triangles per independently clustered chunk of a large mesh
+constexpr uint32_t kChunkTriangles = 1 << 16;
+
+auto triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) -> glm::vec3 {
+    const glm::vec3 normal = glm::cross(b - a, c - a);
+    const float length = glm::length(normal);
+    return length > 0.0f ? normal / length : glm::vec3{0.0f};
+}
+
+// Reorders the triangles of a single cluster into generalized strips, where each triangle
+// shares an edge with the one before it wherever possible, then renumbers the cluster vertices
+// in first-use order. Pages store the strips with one new index per continuing triangle (see
+// PageFormat.hpp), and the order also improves post-transform reuse.
+void optimizeClusterLocality(std::vector<uint32_t>& vertices, std::vector<uint8_t>& triangles) {
+    const auto triangleCount = static_cast<uint32_t>(triangles.size() / 3);
+    const auto vertexCount = static_cast<uint32_t>(vertices.size());
+    if (triangleCount <= 1) {
+        return;
+    }
+
+    // Local vertex -> triangle adjacency; clusters are small enough for fixed-size scratch
+    std::array<uint16_t, ClusterBuilder::kMaxVerticesLimit + 1> offsets{};
+    std::array<uint16_t, ClusterBuilder::kMaxVerticesLimit + 1> cursor{};
+    std::array<uint16_t, ClusterBuilder::kMaxTrianglesLimit * 3> adjacency{};
+    for (uint8_t index : triangles) {
+        ++offsets[index + 1];
+    }
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = static_cast<uint16_t>(offsets[v + 1] + offsets[v]);
+        cursor[v] = offsets[v];
+    }
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            adjacency[cursor[triangles[t * 3 + corner]]++] = static_cast<uint16_t>(t);
+        }
+    }
+
+    // A strip can only continue across an edge the neighbour traverses in the opposite
+    // direction, so triangles with flipped winding do not count as neighbours
+    auto hasEdge = [&](uint32_t t, uint8_t from, uint8_t to) {
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            if (triangles[t * 3 + corner] == from && triangles[t * 3 + (corner + 1) % 3] == to) {
+                return true;
+            }
+        }
+        return false;
+    };
+    std::array<std::array<uint16_t, 3>, ClusterBuilder::kMaxTrianglesLimit> neighbours;
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        for (uint32_t edge = 0; edge < 3; ++edge) {
+            const uint8_t from = triangles[t * 3 + edge];
+            const uint8_t to = triangles[t * 3 + (edge + 1) % 3];
+            neighbours[t][edge] = kNoNeighbour;
+            for (uint32_t i = offsets[from]; i < offsets[from + 1]; ++i) {
+                if (adjacency[i] != t && hasEdge(adjacency[i], to, from)) {
+                    neighbours[t][edge] = adjacency[i];
+                    break;
+                }
+            }
+        }
+    }
+
+    std::array<bool, ClusterBuilder::kMaxTrianglesLimit> emitted{};
+    std::array<uint8_t, ClusterBuilder::kMaxTrianglesLimit> openNeighbours{};
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        for (uint16_t neighbour : neighbours[t]) {
+            openNeighbours[t] += neighbour != kNoNeighbour;
+        }
+    }
+
+    // Strips start where they have the fewest ways to continue, typically on the cluster
+    // border, and grow towards the neighbour with the fewest open neighbours of its own, so
+    // they do not strand single triangles behind them
+    auto findStart = [&] {
+        uint32_t best = kInvalidIndex;
+        for (uint32_t t = 0; t < triangleCount; ++t) {
+            if (!emitted[t] &&
+                (best == kInvalidIndex || openNeighbours[t] < openNeighbours[best])) {
+                best = t;
+            }
+        }
+        return best;
+    };
+
+    std::vector<uint8_t> ordered;
+    ordered.reserve(triangles.size());
+    uint32_t current = findStart();
+    for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+        emitted[current] = true;
+        ordered.insert(ordered.end(), triangles.begin() + current * 3,
+                       triangles.begin() + current * 3 + 3);
+
+        uint32_t next = kInvalidIndex;
+        for (uint16_t neighbour : neighbours[current]) {
+            if (neighbour == kNoNeighbour || emitted[neighbour]) {
+                continue;
+            }
+            --openNeighbours[neighbour];
+            if (next == kInvalidIndex || openNeighbours[neighbour] < openNeighbours[next]) {
+                next = neighbour;
+            }
+        }
+        current = next != kInvalidIndex ? next : findStart();
+    }
+
+    // Renumber vertices in first-use order
+    std::array<uint8_t, ClusterBuilder::kMaxVerticesLimit + 1> remap;
+    remap.fill(kUnusedLocal);
+    std::vector<uint32_t> reorderedVertices;
+    reorderedVertices.reserve(vertexCount);
+    for (uint8_t& index : ordered) {
+        if (remap[index] == kUnusedLocal) {
+            remap[index] = static_cast<uint8_t>(reorderedVertices.size());
+            reorderedVertices.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(reorderedVertices);
+    triangles = std::move(ordered);
+}
+
+// Greedy cluster growth in the spirit of meshoptimizer's meshlet builder: a cluster grows
+// across adjacent triangles preferring those that add no new vertices, staying compact and
+// normal-coherent; new clusters are seeded along a Morton curve over triangle centroids.
+class ClusterGrower {
+public:
+    ClusterGrower(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                  const ClusterBuilder::Config& config, std::span<const uint32_t> globalIds,
+                  std::span<const glm::vec3> globalPositions, ClusterMesh& output)
+        : m_positions(positions)
+        , m_indices(indices)
+        , m_config(config)
+        , m_globalIds(globalIds)
+        , m_globalPositions(globalPositions)
+        , m_output(output) {}
+
+    void run() {
+        ZoneScoped;
+        const auto triangleCount = static_cast<uint32_t>(m_indices.size() / 3);
+        if (triangleCount == 0) {
+            return;
+        }
+
+        buildAdjacency();
+        buildTriangleData();
+        buildSeedOrder();
+
+        m_emitted.assign(triangleCount, false);
+        m_localIndex.assign(m_positions.size(), kUnusedLocal);
+
+        uint32_t seedCursor = 0;
+        uint32_t lastTriangle = kInvalidIndex;
+
+        for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+            Candidate candidate;
+            if (lastTriangle != kInvalidIndex) {
+                candidate = findCandidate(std::span(m_indices.data() + lastTriangle * 3, 3));
+            }
+            if (candidate.fitting == kInvalidIndex && !m_clusterVertices.empty()) {
+                const Candidate fallback = findCandidate(m_clusterVertices);
+                candidate.fitting = fallback.fitting;
+                if (candidate.unfit == kInvalidIndex) {
+                    candidate.unfit = fallback.unfit;
+                }
+            }
+
+            uint32_t next = candidate.fitting;
+            if (next == kInvalidIndex && candidate.unfit != kInvalidIndex) {
+                // Neighbours exist but overflow the cluster: continue next to it
+                flush();
+                next = candidate.unfit;
+            } else if (next == kInvalidIndex) {
+                while (m_emitted[m_seedOrder[seedCursor]]) {
+                    ++seedCursor;
+                }
+                next = m_seedOrder[seedCursor];
+                if (!m_clusterVertices.empty() && (!fits(next) || isFar(next))) {
+                    flush();
+                }
+            }
+
+            addTriangle(next);
+            lastTriangle = next;
+
+            if (m_clusterTriangles.size() / 3 >= m_config.maxTriangles) {
+                flush();
+            }
+        }
+
+        flush();
+    }
+
+private:
+    struct Candidate {
+        uint32_t fitting{kInvalidIndex};
+        uint32_t unfit{kInvalidIndex};
+    };
+
+    void buildAdjacency() {
+        ZoneScoped;
+        const size_t vertexCount = m_positions.size();
+        m_adjacencyOffsets.assign(vertexCount + 1, 0);
+        for (uint32_t index : m_indices) {
+            ++m_adjacencyOffsets[index + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            m_adjacencyOffsets[v + 1] += m_adjacencyOffsets[v];
+        }
+
+        m_liveCounts.assign(vertexCount, 0);
+        m_adjacency.resize(m_indices.size());
+        for (size_t i = 0; i < m_indices.size(); ++i) {
+            const uint32_t v = m_indices[i];
+            m_adjacency[m_adjacencyOffsets[v] + m_liveCounts[v]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    void buildTriangleData() {
+        ZoneScoped;
+        const size_t triangleCount = m_indices.size() / 3;
+        m_centroids.resize(triangleCount);
+        m_normals.resize(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            const glm::vec3& a = m_positions[m_indices[t * 3 + 0]];
+            const glm::vec3& b = m_positions[m_indices[t * 3 + 1]];
+            const glm::vec3& c = m_positions[m_indices[t * 3 + 2]];
+            m_centroids[t] = (a + b + c) * (1.0f / 3.0f);
+            m_normals[t] = triangleNormal(a, b, c);
+        }
+    }
+
+    void buildSeedOrder() {
+        ZoneScoped;
+        glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+        glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+        for (const glm::vec3& centroid : m_centroids) {
+            boundsMin = glm::min(boundsMin, centroid);
+            boundsMax = glm::max(boundsMax, centroid);
+        }
+
+        const glm::vec3 inverseExtent = mortonInverseExtent(boundsMin, boundsMax);
+        std::vector<uint64_t> keys(m_centroids.size());
+        for (size_t t = 0; t < m_centroids.size(); ++t) {
+            const uint64_t code = mortonCode(m_centroids[t], boundsMin, inverseExtent);
+            keys[t] = (code << 32) | t;
+        }
+        std::sort(keys.begin(), keys.end());
+
+        m_seedOrder.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            m_seedOrder[i] = static_cast<uint32_t>(keys[i] & 0xffffffffu);
+        }
+    }
+
+    [[nodiscard]] auto newVertexCount(uint32_t triangle) const -> uint32_t {
+        uint32_t count = 0;
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            count += m_localIndex[m_indices[triangle * 3 + corner]] == kUnusedLocal;
+        }
+        return count;
+    }
+
+    [[nodiscard]] auto fits(uint32_t triangle) const -> bool {
+        return m_clusterVertices.size() + newVertexCount(triangle) <= m_config.maxVertices &&
+               m_clusterTriangles.size() / 3 < m_config.maxTriangles;
+    }
+
+    [[nodiscard]] auto clusterCenter() const -> glm::vec3 {
+        return (m_clusterMin + m_clusterMax) * 0.5f;
+    }
+
+    [[nodiscard]] auto clusterRadius() const -> float {
+        return std::max(glm::length(m_clusterMax - m_clusterMin) * 0.5f, 1e-12f);
+    }
+
+    [[nodiscard]] auto isFar(uint32_t triangle) const -> bool {
+        return glm::length(m_centroids[triangle] - clusterCenter()) > 2.0f * clusterRadius();
+    }
+
+    [[nodiscard]] auto score(uint32_t triangle) const -> float {
+        bool finishesVertex = false;
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            finishesVertex |= m_liveCounts[m_indices[triangle * 3 + corner]] == 1;
+        }
+
+        const float spread = std::min(
+            glm::length(m_centroids[triangle] - clusterCenter()) / clusterRadius(), 1.0f);
+        const float normalLength = glm::length(m_clusterNormal);
+        const float coherence = normalLength > 0.0f
+                                    ? glm::dot(m_normals[triangle], m_clusterNormal / normalLength)
+                                    : 1.0f;
+
+        return static_cast<float>(newVertexCount(triangle)) * 2.0f +
+               (finishesVertex ? 0.0f : 1.0f) + 0.5f * spread +
+               m_config.coneWeight * (1.0f - coherence);
+    }
+
+    [[nodiscard]] auto findCandidate(std::span<const uint32_t> vertices) const -> Candidate {
+        Candidate result;
+        float bestFitting = std::numeric_limits<float>::max();
+        float bestUnfit = std::numeric_limits<float>::max();
+
+        for (uint32_t v : vertices) {
+            const uint32_t begin = m_adjacencyOffsets[v];
+            for (uint32_t i = begin; i < begin + m_liveCounts[v]; ++i) {
+                const uint32_t triangle = m_adjacency[i];
+                const float value = score(triangle);
+                if (fits(triangle)) {
+                    if (value < bestFitting || (value == bestFitting && triangle < result.fitting)) {
+                        bestFitting = value;
+                        result.fitting = triangle;
+                    }
+                } else if (value < bestUnfit || (value == bestUnfit && triangle < result.unfit)) {
+                    bestUnfit = value;
+                    result.unfit = triangle;
+                }
+            }
+        }
+        return result;
+    }
+
+    void addTriangle(uint32_t triangle) {
+        if (m_clusterTriangles.empty()) {
+            m_clusterMin = glm::vec3{std::numeric_limits<float>::max()};
+            m_clusterMax = glm::vec3{std::numeric_limits<float>::lowest()};
+            m_clusterNormal = glm::vec3{0.0f};
+        }
+
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            const uint32_t v = m_indices[triangle * 3 + corner];
+            if (m_localIndex[v] == kUnusedLocal) {
+                m_localIndex[v] = static_cast<uint8_t>(m_clusterVertices.size());
+                m_clusterVertices.push_back(v);
+                m_clusterMin = glm::min(m_clusterMin, m_positions[v]);
+                m_clusterMax = glm::max(m_clusterMax, m_positions[v]);
+            }
+            m_clusterTriangles.push_back(m_localIndex[v]);
+
+            // Swap-remove the triangle from the live part of the vertex adjacency list
+            const uint32_t begin = m_adjacencyOffsets[v];
+            const uint32_t last = begin + --m_liveCounts[v];
+            for (uint32_t i = begin; i <= last; ++i) {
+                if (m_adjacency[i] == triangle) {
+                    std::swap(m_adjacency[i], m_adjacency[last]);
+                    break;
+                }
+            }
+        }
+
+        m_clusterNormal += m_normals[triangle];
+        m_emitted[triangle] = true;
+    }
+
+    void flush() {
+        if (m_clusterTriangles.empty()) {
+            return;
+        }
+
+        for (uint32_t v : m_clusterVertices) {
+            m_localIndex[v] = kUnusedLocal;
+        }
+
+        if (!m_globalIds.empty()) {
+            for (uint32_t& v : m_clusterVertices) {
+                v = m_globalIds[v];
+            }
+        }
+
+        optimizeClusterLocality(m_clusterVertices, m_clusterTriangles);
+
+        Cluster cluster;
+        cluster.vertexOffset = static_cast<uint32_t>(m_output.vertices.size());
+        cluster.triangleOffset = static_cast<uint32_t>(m_output.triangles.size() / 3);
+        cluster.vertexCount = static_cast<uint32_t>(m_clusterVertices.size());
+        cluster.triangleCount = static_cast<uint32_t>(m_clusterTriangles.size() / 3);
+        cluster.bounds = ClusterBuilder::computeBounds(m_globalPositions, m_clusterVertices,
+                                                       m_clusterTriangles);
+
+        m_output.clusters.push_back(cluster);
+        m_output.vertices.insert(m_output.vertices.end(), m_clusterVertices.begin(),
+                                 m_clusterVertices.end());
+        m_output.triangles.insert(m_output.triangles.end(), m_clusterTriangles.begin(),
+                                  m_clusterTriangles.end());
+
+        m_clusterVertices.clear();
+        m_clusterTriangles.clear();
+    }
+
+    std::span<const glm::vec3> m_positions;
+    std::span<const uint32_t> m_indices;
+    const ClusterBuilder::Config& m_config;
+    std::span<const uint32_t> m_globalIds;
+    std::span<const glm::vec3> m_globalPositions;
+    ClusterMesh& m_output;
+
+    std::vector<uint32_t> m_adjacencyOffsets;
+    std::vector<uint32_t> m_adjacency;
+    std::vector<uint32_t> m_liveCounts;
+    std::vector<glm::vec3> m_centroids;
+    std::vector<glm::vec3> m_normals;
+    std::vector<uint32_t> m_seedOrder;
+    std::vector<bool> m_emitted;
+    std::vector<uint8_t> m_localIndex;
+
+    std::vector<uint32_t> m_clusterVertices;
+    std::vector<uint8_t> m_clusterTriangles;
+    glm::vec3 m_clusterMin{0.0f};
+    glm::vec3 m_clusterMax{0.0f};
+    glm::vec3 m_clusterNormal{0.0f};
+};
+
+} // namespace
+
+auto ClusterBuilder::validateConfig(const Config& config) -> VoidResult {
+    if (config.maxVertices < 3 || config.maxVertices > kMaxVerticesLimit ||
+        config.maxTriangles < 1 || config.maxTriangles > kMaxTrianglesLimit) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            std::format("Cluster limits out of range: {} vertices, {} triangles",
+                        config.maxVertices, config.maxTriangles)
+        ));
+    }
+    return {};
+}
+
+void ClusterMesh::append(const ClusterMesh& other) {
+    const auto vertexBase = static_cast<uint32_t>(vertices.size());
+    const auto triangleBase = static_cast<uint32_t>(triangles.size() / 3);
+    for (Cluster cluster : other.clusters) {
+        cluster.vertexOffset += vertexBase;
+        cluster.triangleOffset += triangleBase;
+        clusters.push_back(cluster);
+    }
+    vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
+    triangles.insert(triangles.end(), other.triangles.begin(), other.triangles.end());
+}
+
+auto ClusterBuilder::build(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                           const Config& config, JobSystem* jobSystem) -> Result<ClusterMesh> {
+    ZoneScoped;
+    if (indices.size() % 3 != 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            "Index count is not a multiple of 3"
+        ));
+    }
+
+    const auto vertexCount = static_cast<uint32_t>(positions.size());
+    if (std::ranges::any_of(indices, [vertexCount](uint32_t index) { return index >= vertexCount; })) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            "Mesh index out of range"
+        ));
+    }
+
+    if (auto result = validateConfig(config); !result) {
+        return std::unexpected(result.error());
+    }
+
+    ClusterMesh mesh;
+    const auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount <= kChunkTriangles) {
+        if (auto result = append(mesh, positions, indices, config); !result) {
+            return std::unexpected(result.error());
+        }
+        return mesh;
+    }
+
+    auto centroid = [&](uint32_t triangle) {
+        return (positions[indices[triangle * 3 + 0]] + positions[indices[triangle * 3 + 1]] +
+                positions[indices[triangle * 3 + 2]]) * (1.0f / 3.0f);
+    };
+
+    // Centroid bounds, reduced per fixed-size batch
+    const uint32_t batchCount = (triangleCount + kChunkTriangles - 1) / kChunkTriangles;
+    std::vector<glm::vec3> batchMin(batchCount, glm::vec3{std::numeric_limits<float>::max()});
+    std::vector<glm::vec3> batchMax(batchCount, glm::vec3{std::numeric_limits<float>::lowest()});
+    parallelFor(jobSystem, batchCount, 1, [&](uint32_t batch) {
+        const uint32_t end = std::min((batch + 1) * kChunkTriangles, triangleCount);
+        for (uint32_t t = batch * kChunkTriangles; t < end; ++t) {
+            batchMin[batch] = glm::min(batchMin[batch], centroid(t));
+            batchMax[batch] = glm::max(batchMax[batch], centroid(t));
+        }
+    });
+
+    glm::vec3 boundsMin = batchMin[0];
+    glm::vec3 boundsMax = batchMax[0];
+    for (uint32_t batch = 1; batch < batchCount; ++batch) {
+        boundsMin = glm::min(boundsMin, batchMin[batch]);
+        boundsMax = glm::max(boundsMax, batchMax[batch]);
+    }
+
+    const glm::vec3 inverseExtent = mortonInverseExtent(boundsMin, boundsMax);
+    std::vector<uint64_t> keys(triangleCount);
+    parallelFor(jobSystem, batchCount, 1, [&](uint32_t batch) {
+        const uint32_t end = std::min((batch + 1) * kChunkTriangles, triangleCount);
+        for (uint32_t t = batch * kChunkTriangles; t < end; ++t) {
+            const uint32_t code = mortonCode(centroid(t), boundsMin, inverseExtent);
+            keys[t] = (static_cast<uint64_t>(code) << 32) | t;
+        }
+    });
+    parallelSort(jobSystem, std::span(keys));
+
+    // Chunks are consecutive runs along the Morton curve
+    std::vector<ClusterMesh> chunks(batchCount);
+    parallelFor(jobSystem, batchCount, 1, [&](uint32_t chunk) {
+        const uint32_t begin = chunk * kChunkTriangles;
+        const uint32_t end = std::min(begin + kChunkTriangles, triangleCount);
+        std::vector<uint32_t> chunkIndices;
+        chunkIndices.reserve(static_cast<size_t>(end - begin) * 3);
+        for (uint32_t i = begin; i < end; ++i) {
+            const auto triangle = static_cast<uint32_t>(keys[i] & 0xffffffffu);
+            chunkIndices.insert(chunkIndices.end(), indices.begin() + triangle * 3,
+                                indices.begin() + triangle * 3 + 3);
+        }
+        // Cannot fail, the config was validated above
+        (void)append(chunks[chunk], positions, chunkIndices, config);
+    });
+
+    mesh.clusters.reserve(triangleCount / std::max(config.maxTriangles / 2, 1u));
+    mesh.triangles.reserve(indices.size());
+    for (const ClusterMesh& chunk : chunks) {
+        mesh.append(chunk);
+    }
+
+    return mesh;
+}
+
+auto ClusterBuilder::append(ClusterMesh& mesh, std::span<const glm::vec3> positions,
+                            std::span<const uint32_t> indices, const Config& config) -> VoidResult {
+    ZoneScoped;
+    if (auto result = validateConfig(config); !result) {
+        return result;
+    }
+
+    // Small index subsets of a large vertex buffer (DAG groups) are compacted first so that
+    // the per-vertex scratch arrays scale with the subset, not the whole mesh
+    if (indices.size() * 2 >= positions.size()) {
+        ClusterGrower(positions, indices, config, {}, positions, mesh).run();
+        return {};
+    }
+
+    std::vector<uint32_t> globalIds(indices.begin(), indices.end());
+    std::ranges::sort(globalIds);
+    globalIds.erase(std::unique(globalIds.begin(), globalIds.end()), globalIds.end());
+
+    std::vector<uint32_t> localIndices(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        localIndices[i] = static_cast<uint32_t>(
+            std::ranges::lower_bound(globalIds, indices[i]) - globalIds.begin());
+    }
+
+    std::vector<glm::vec3> localPositions(globalIds.size());
+    for (size_t v = 0; v < globalIds.size(); ++v) {
+        localPositions[v] = positions[globalIds[v]];
+    }
+
+    ClusterGrower(localPositions, localIndices, config, globalIds, positions, mesh).run();
+    return {};
+}
+
+auto ClusterBuilder::computeBounds(std::span<const glm::vec3> positions,
+                                   std::span<const uint32_t> vertices,
+                                   std::span<const uint8_t> triangles) -> ClusterBounds {
+    ClusterBounds bounds;
+    if (vertices.empty()) {
+        return bounds;
+    }
+
+    // Ritter's sphere: start from the most separated pair of axis extremes, grow to fit
+    std::array<uint32_t, 3> minVertex{};
+    std::array<uint32_t, 3> maxVertex{};
+    for (uint32_t i = 1; i < vertices.size(); ++i) {
+        const glm::vec3& p = positions[vertices[i]];
+        for (int axis = 0; axis < 3; ++axis) {
+            if (p[axis] < positions[vertices[minVertex[axis]]][axis]) {
+                minVertex[axis] = i;
+            }
+            if (p[axis] > positions[vertices[maxVertex[axis]]][axis]) {
+                maxVertex[axis] = i;
+            }
+        }
+    }
+
+    int widestAxis = 0;
+    float widestSpan = -1.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float span = glm::length(positions[vertices[maxVertex[axis]]] -
+                                       positions[vertices[minVertex[axis]]]);
+        if (span > widestSpan) {
+            widestSpan = span;
+            widestAxis = axis;
+        }
+    }
+
+    glm::vec3 center = (positions[vertices[minVertex[widestAxis]]] +
+                        positions[vertices[maxVertex[widestAxis]]]) * 0.5f;
+    float radius = widestSpan * 0.5f;
+    for (uint32_t v : vertices) {
+        const float distance = glm::length(positions[v] - center);
+        if (distance > radius) {
+            const float grown = (radius + distance) * 0.5f;
+            center += (positions[v] - center) * ((grown - radius) / distance);
+            radius = grown;
+        }
+    }
+
+    bounds.center = center;
+    bounds.radius = radius;
+
+    // Normal cone from the average triangle normal and its widest deviation
+    const size_t triangleCount = triangles.size() / 3;
+    glm::vec3 normalSum{0.0f};
+    for (size_t t = 0; t < triangleCount; ++t) {
+        normalSum += triangleNormal(positions[vertices[triangles[t * 3 + 0]]],
+                                    positions[vertices[triangles[t * 3 + 1]]],
+                                    positions[vertices[triangles[t * 3 + 2]]]);
+    }
+
+    const float sumLength = glm::length(normalSum);
+    if (sumLength <= 0.0f) {
+        return bounds;
+    }
+
+    const glm::vec3 axis = normalSum / sumLength;
+    float minDot = 1.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const glm::vec3 normal = triangleNormal(positions[vertices[triangles[t * 3 + 0]]],
+                                                positions[vertices[triangles[t * 3 + 1]]],
+                                                positions[vertices[triangles[t * 3 + 2]]]);
+        if (normal != glm::vec3{0.0f}) {
+            minDot = std::min(minDot, glm::dot(normal, axis));
+        }
+    }
+
+    // Cones wider than ~84 degrees half-angle reject too little to be worth testing
+    if (minDot <= 0.1f) {
+        return bounds;
+    }
+
+    // Push the apex back so every triangle plane faces away from it
+    float maxT = 0.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const glm::vec3& p0 = positions[vertices[triangles[t * 3 + 0]]];
+        const glm::vec3 normal = triangleNormal(p0, positions[vertices[triangles[t * 3 + 1]]],
+                                                positions[vertices[triangles[t * 3 + 2]]]);
+        const float dn = glm::dot(axis, normal);
+        if (dn > 0.0f) {
+            maxT = std::max(maxT, glm::dot(center - p0, normal) / dn);
+        }
+    }
+
+    bounds.coneApex = center - axis * maxT;
+    bounds.coneAxis = axis;
+    bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    return bounds;
+}
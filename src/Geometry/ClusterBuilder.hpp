@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Error.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+struct ClusterBounds {
+    glm::vec3 center{0.0f};
+    float radius{0.0f};
+
+    // Backface cone: the cluster is invisible from the camera when
+    // dot(normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff.
+    // Clusters whose normals spread too far get coneCutoff = 1 and never pass the test.
+    glm::vec3 coneApex{0.0f};
+    glm::vec3 coneAxis{0.0f};
+    float coneCutoff{1.0f};
+};
+
+struct Cluster {
+    uint32_t vertexOffset{0};   // First entry in ClusterMesh::vertices
+    uint32_t triangleOffset{0}; // First triangle in ClusterMesh::triangles (3 bytes each)
+    uint32_t vertexCount{0};
+    uint32_t triangleCount{0};
+    ClusterBounds bounds;
+};
+
+// Clusters reference the source vertex buffer through a per-cluster vertex list; triangles
+// use 8-bit indices into that list.
+struct ClusterMesh {
+    std::vector<Cluster> clusters;
+    std::vector<uint32_t> vertices;
+    std::vector<uint8_t> triangles;
+
+    [[nodiscard]] auto triangleCount() const noexcept -> size_t { return triangles.size() / 3; }
+
+    // Appends the clusters of other, rebasing their offsets
+    void append(const ClusterMesh& other);
+};
+
+class ClusterBuilder {
+public:
+    struct Config {
+        uint32_t maxVertices{64};
+        uint32_t maxTriangles{124};
+        // Bias towards keeping normals coherent (tighter cones) over spatial compactness
+        float coneWeight{0.25f};
+    };
+
+    static constexpr uint32_t kMaxVerticesLimit = 255;
+    static constexpr uint32_t kMaxTrianglesLimit = 512;
+
+    // Large meshes are split into spatially coherent chunks that are clustered independently,
+    // in parallel when a job system is given. Chunking only depends on the mesh, so the output
+    // is identical for any thread count.
+    [[nodiscard]] static auto build(std::span<const glm::vec3> positions,
+                                    std::span<const uint32_t> indices, const Config& config,
+                                    JobSystem* jobSystem = nullptr) -> Result<ClusterMesh>;
+
+    // Appends clusters for the given triangles to an existing cluster mesh. Indices must be in
+    // range; only the limits in config are validated.
+    [[nodiscard]] static auto append(ClusterMesh& mesh, std::span<const glm::vec3> positions,
+                                     std::span<const uint32_t> indices, const Config& config)
+        -> VoidResult;
+
+    [[nodiscard]] static auto computeBounds(std::span<const glm::vec3> positions,
+                                            std::span<const uint32_t> vertices,
+                                            std::span<const uint8_t> triangles) -> ClusterBounds;
+
+private:
+    [[nodiscard]] static auto validateConfig(const Config& config) -> VoidResult;
+};
@@ -0,0 +1,294 @@
+#include "ClusterDag.hpp"
+#include "BoundingSphere.hpp"
+#include "ClusterGrouper.hpp"
+#include "Core/JobSystem.hpp"
+#include "Logger.hpp"
+#include "MeshSimplifier.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+// A level must shrink the cluster count at least this much to be accepted as is
+constexpr float kMinLevelReduction = 0.9f;
+
+// Maps every vertex to the lowest-numbered vertex at the same position. Attribute seams
+// duplicate positions; simplifying in welded space lets coarse levels collapse across seams
+// without opening holes along them.
+auto buildWeldRemap(std::span<const glm::vec3> positions, JobSystem* jobSystem)
+    -> std::vector<uint32_t> {
+    ZoneScoped;
+    std::vector<uint32_t> order(positions.size());
+    std::iota(order.begin(), order.end(), 0u);
+    auto key = [&](uint32_t v) { return std::tie(positions[v].x, positions[v].y, positions[v].z); };
+    parallelSort(jobSystem, std::span(order), [&](uint32_t lhs, uint32_t rhs) {
+        return key(lhs) != key(rhs) ? key(lhs) < key(rhs) : lhs < rhs;
+    });
+
+    std::vector<uint32_t> remap(positions.size());
+    for (size_t i = 0; i < order.size();) {
+        size_t runEnd = i + 1;
+        while (runEnd < order.size() && positions[order[runEnd]] == positions[order[i]]) {
+            ++runEnd;
+        }
+        for (size_t j = i; j < runEnd; ++j) {
+            remap[order[j]] = order[i];
+        }
+        i = runEnd;
+    }
+    return remap;
+}
+
+// Output of simplifying one group, produced on a worker and merged in group order
+struct GroupSimplification {
+    ClusterMesh parents;
+    glm::vec4 lodBounds{0.0f};
+    float error{0.0f};
+};
+
+} // namespace
+
+auto ClusterDagBuilder::build(std::span<const glm::vec3> positions,
+                              std::span<const uint32_t> indices, const Config& config,
+                              JobSystem* jobSystem) -> Result<ClusterDag> {
+    ZoneScoped;
+    const ClusterGrouper::Config& grouping = config.grouping;
+    if (grouping.targetSize < 2 || grouping.minSize > grouping.targetSize ||
+        grouping.maxSize < grouping.targetSize) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            "DAG group sizes must satisfy 2 <= target and min <= target <= max"
+        ));
+    }
+    if (config.simplifyRatio <= 0.0f || config.simplifyRatio >= 1.0f) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            "DAG simplify ratio must be within (0, 1)"
+        ));
+    }
+
+    auto clusterResult = ClusterBuilder::build(positions, indices, config.cluster, jobSystem);
+    if (!clusterResult) {
+        return std::unexpected(clusterResult.error());
+    }
+
+    ClusterDag dag;
+    dag.mesh = std::move(*clusterResult);
+    dag.lods.resize(dag.mesh.clusters.size());
+    for (size_t i = 0; i < dag.mesh.clusters.size(); ++i) {
+        const ClusterBounds& bounds = dag.mesh.clusters[i].bounds;
+        dag.lods[i].lodBounds = glm::vec4{bounds.center, bounds.radius};
+    }
+
+    const std::vector<uint32_t> weld = buildWeldRemap(positions, jobSystem);
+    std::vector<uint32_t> owner(positions.size(), kInvalidIndex);
+    std::vector<bool> shared(positions.size(), false);
+
+    std::vector<uint32_t> currentLevel(dag.mesh.clusters.size());
+    std::iota(currentLevel.begin(), currentLevel.end(), 0u);
+    dag.levelCount = 1;
+
+    // Groups and simplifies one level, appending the parent clusters to the DAG
+    auto buildLevel = [&](std::vector<uint32_t>& clusters, uint32_t level,
+                          const ClusterGrouper::Config& groupingConfig,
+                          ClusterDagLevel& levelInfo) -> std::vector<uint32_t> {
+        ZoneScopedN("DAG Level");
+        std::vector<glm::vec3> centers(clusters.size());
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            centers[i] = glm::vec3{dag.lods[clusters[i]].lodBounds};
+        }
+        const ClusterGrouping groups =
+            ClusterGrouper::group(dag.mesh, weld, centers, clusters, groupingConfig, jobSystem);
+        const std::vector<uint32_t>& offsets = groups.offsets;
+        const size_t groupCount = groups.groupCount();
+
+        levelInfo = ClusterDagLevel{};
+        levelInfo.clusterCount = static_cast<uint32_t>(clusters.size());
+        levelInfo.groupCount = groups.groupCount();
+        levelInfo.edgeCount = groups.edgeCount;
+        levelInfo.lockedEdgeCount = groups.lockedEdgeCount;
+        for (uint32_t clusterIndex : clusters) {
+            levelInfo.triangleCount += dag.mesh.clusters[clusterIndex].triangleCount;
+        }
+
+        // Vertices referenced by more than one group are locked so neighbouring groups stay
+        // watertight no matter how each of them is simplified
+        std::vector<uint32_t> touchedVertices;
+        for (size_t group = 0; group < groupCount; ++group) {
+            for (uint32_t i = offsets[group]; i < offsets[group + 1]; ++i) {
+                const Cluster& cluster = dag.mesh.clusters[clusters[i]];
+                for (uint32_t v = 0; v < cluster.vertexCount; ++v) {
+                    const uint32_t vertex = weld[dag.mesh.vertices[cluster.vertexOffset + v]];
+                    if (owner[vertex] == kInvalidIndex) {
+                        owner[vertex] = static_cast<uint32_t>(group);
+                        touchedVertices.push_back(vertex);
+                    } else if (owner[vertex] != group) {
+                        shared[vertex] = true;
+                    }
+                }
+            }
+        }
+
+        // Groups only read the shared DAG state, so they simplify independently
+        std::vector<GroupSimplification> simplifications(groupCount);
+        parallelFor(jobSystem, static_cast<uint32_t>(groupCount), 1, [&](uint32_t group) {
+            ZoneScopedN("Simplify Group");
+            std::vector<uint32_t> groupIndices;
+            std::vector<glm::vec4> memberSpheres;
+            float memberError = 0.0f;
+            for (uint32_t i = offsets[group]; i < offsets[group + 1]; ++i) {
+                const Cluster& cluster = dag.mesh.clusters[clusters[i]];
+                for (uint32_t t = 0; t < cluster.triangleCount * 3; ++t) {
+                    const uint8_t local = dag.mesh.triangles[cluster.triangleOffset * 3 + t];
+                    groupIndices.push_back(weld[dag.mesh.vertices[cluster.vertexOffset + local]]);
+                }
+                memberSpheres.push_back(dag.lods[clusters[i]].lodBounds);
+                memberError = std::max(memberError, dag.lods[clusters[i]].error);
+            }
+
+            std::vector<uint32_t> groupVertices(groupIndices.begin(), groupIndices.end());
+            std::ranges::sort(groupVertices);
+            groupVertices.erase(std::unique(groupVertices.begin(), groupVertices.end()),
+                                groupVertices.end());
+            std::vector<uint32_t> lockedVertices;
+            std::ranges::copy_if(groupVertices, std::back_inserter(lockedVertices),
+                                 [&](uint32_t v) { return shared[v]; });
+
+            MeshSimplifier::Config simplifyConfig;
+            simplifyConfig.targetIndexCount =
+                static_cast<size_t>(static_cast<float>(groupIndices.size() / 3) *
+                                    config.simplifyRatio) * 3;
+            const MeshSimplifier::Output simplified =
+                MeshSimplifier::simplify(positions, groupIndices, lockedVertices, simplifyConfig);
+
+            GroupSimplification& result = simplifications[group];
+            result.lodBounds = mergeSpheres(memberSpheres);
+            result.error = std::max(simplified.error, memberError);
+            // Cannot fail, the cluster config was validated by the level 0 build
+            (void)ClusterBuilder::append(result.parents, positions, simplified.indices,
+                                         config.cluster);
+        });
+
+        std::vector<uint32_t> nextLevel;
+        for (size_t group = 0; group < groupCount; ++group) {
+            const std::span<const uint32_t> members(clusters.data() + offsets[group],
+                                                    offsets[group + 1] - offsets[group]);
+            GroupSimplification& simplification = simplifications[group];
+
+            ClusterGroup clusterGroup;
+            clusterGroup.level = level;
+            clusterGroup.clusterOffset = static_cast<uint32_t>(dag.groupClusters.size());
+            clusterGroup.clusterCount = static_cast<uint32_t>(members.size());
+            clusterGroup.parentClusterOffset = static_cast<uint32_t>(dag.mesh.clusters.size());
+            clusterGroup.parentClusterCount =
+                static_cast<uint32_t>(simplification.parents.clusters.size());
+            clusterGroup.lodBounds = simplification.lodBounds;
+            clusterGroup.error = simplification.error;
+            levelInfo.parentTriangleCount += simplification.parents.triangleCount();
+            dag.mesh.append(simplification.parents);
+            simplification.parents = {};
+
+            const auto groupIndex = static_cast<uint32_t>(dag.groups.size());
+            for (uint32_t clusterIndex : members) {
+                ClusterLod& lod = dag.lods[clusterIndex];
+                lod.group = groupIndex;
+                lod.parentError = clusterGroup.error;
+                lod.parentLodBounds = clusterGroup.lodBounds;
+                dag.groupClusters.push_back(clusterIndex);
+            }
+
+            for (uint32_t i = 0; i < clusterGroup.parentClusterCount; ++i) {
+                ClusterLod lod;
+                lod.lodBounds = clusterGroup.lodBounds;
+                lod.error = clusterGroup.error;
+                lod.level = level + 1;
+                dag.lods.push_back(lod);
+                nextLevel.push_back(clusterGroup.parentClusterOffset + i);
+            }
+
+            dag.groups.push_back(clusterGroup);
+        }
+
+        for (uint32_t vertex : touchedVertices) {
+            owner[vertex] = kInvalidIndex;
+            shared[vertex] = false;
+        }
+
+        Logger::debug("DAG level {}: {} clusters in {} groups -> {} clusters", level,
+                      clusters.size(), groupCount, nextLevel.size());
+        return nextLevel;
+    };
+
+    while (currentLevel.size() > 1 && dag.levelCount < config.maxLevels) {
+        const uint32_t level = dag.levelCount - 1;
+
+        // Remember the sizes so a level that fails to reduce can be rolled back
+        const size_t clusterCountBefore = dag.mesh.clusters.size();
+        const size_t vertexCountBefore = dag.mesh.vertices.size();
+        const size_t triangleCountBefore = dag.mesh.triangles.size();
+        const size_t groupCountBefore = dag.groups.size();
+        const size_t groupClusterCountBefore = dag.groupClusters.size();
+
+        auto rollback = [&]() {
+            dag.mesh.clusters.resize(clusterCountBefore);
+            dag.mesh.vertices.resize(vertexCountBefore);
+            dag.mesh.triangles.resize(triangleCountBefore);
+            dag.lods.resize(clusterCountBefore);
+            dag.groups.resize(groupCountBefore);
+            dag.groupClusters.resize(groupClusterCountBefore);
+            for (uint32_t clusterIndex : currentLevel) {
+                ClusterLod& lod = dag.lods[clusterIndex];
+                lod.group = ClusterLod::kNoGroup;
+                lod.parentError = std::numeric_limits<float>::max();
+                lod.parentLodBounds = glm::vec4{0.0f};
+            }
+        };
+
+        // Locked group borders can stall simplification; retry the level with larger groups
+        // (fewer, shorter borders relative to their area) until it makes real progress
+        std::vector<uint32_t> nextLevel;
+        ClusterDagLevel levelInfo;
+        for (uint32_t groupSize = grouping.targetSize;; groupSize *= 2) {
+            ClusterGrouper::Config groupingConfig = grouping;
+            groupingConfig.targetSize = groupSize;
+            groupingConfig.maxSize = std::max(grouping.maxSize, groupSize);
+            nextLevel = buildLevel(currentLevel, level, groupingConfig, levelInfo);
+
+            // Near the root a single group may halve its triangles but still need as many
+            // clusters; keep going as long as the triangles shrink
+            const bool lastAttempt = groupSize >= currentLevel.size();
+            const bool reducedTriangles =
+                static_cast<float>(levelInfo.parentTriangleCount) <=
+                kMinLevelReduction * static_cast<float>(levelInfo.triangleCount);
+            if (static_cast<float>(nextLevel.size()) <=
+                    kMinLevelReduction * static_cast<float>(currentLevel.size()) ||
+                (lastAttempt && (nextLevel.size() < currentLevel.size() || reducedTriangles))) {
+                break;
+            }
+
+            rollback();
+            nextLevel.clear();
+            if (lastAttempt) {
+                break;
+            }
+        }
+
+        if (nextLevel.empty()) {
+            Logger::warn("DAG level {} could not be simplified, stopping with {} roots", level,
+                         currentLevel.size());
+            break;
+        }
+
+        dag.levels.push_back(levelInfo);
+        currentLevel = std::move(nextLevel);
+        ++dag.levelCount;
+    }
+
+    dag.roots = std::move(currentLevel);
+    std::ranges::sort(dag.roots);
+    return dag;
+}
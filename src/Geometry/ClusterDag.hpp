@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ClusterBuilder.hpp"
+#include "ClusterGrouper.hpp"
+#include "Error.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Per-cluster LOD data, parallel to ClusterDag::mesh.clusters. A cluster is part of the
+// crack-free cut for an error threshold when
+//     projected(parentError, parentLodBounds) > threshold && projected(error, lodBounds) <= threshold
+// Errors and spheres grow monotonically from leaves to roots, so exactly one cluster is picked
+// along every path of the DAG.
+struct ClusterLod {
+    static constexpr uint32_t kNoGroup = std::numeric_limits<uint32_t>::max();
+
+    glm::vec4 lodBounds{0.0f};
+    glm::vec4 parentLodBounds{0.0f};
+    float error{0.0f};
+    float parentError{std::numeric_limits<float>::max()};
+    uint32_t level{0};
+    // Group this cluster was simplified in; kNoGroup for roots
+    uint32_t group{kNoGroup};
+};
+
+// Clusters of one level that were simplified together. Simplifying the group produced the
+// contiguous cluster range [parentClusterOffset, parentClusterOffset + parentClusterCount).
+struct ClusterGroup {
+    uint32_t level{0};
+    uint32_t clusterOffset{0}; // First entry in ClusterDag::groupClusters
+    uint32_t clusterCount{0};
+    uint32_t parentClusterOffset{0};
+    uint32_t parentClusterCount{0};
+    glm::vec4 lodBounds{0.0f};
+    float error{0.0f};
+};
+
+// Statistics of simplifying one level into the next
+struct ClusterDagLevel {
+    uint32_t clusterCount{0};
+    uint32_t groupCount{0};
+    uint64_t triangleCount{0};
+    uint64_t parentTriangleCount{0};
+    uint32_t edgeCount{0};
+    uint32_t lockedEdgeCount{0}; // Edges on group boundaries
+};
+
+struct ClusterDag {
+    ClusterMesh mesh;
+    std::vector<ClusterLod> lods;
+    std::vector<ClusterGroup> groups;
+    std::vector<uint32_t> groupClusters;
+    std::vector<uint32_t> roots;
+    std::vector<ClusterDagLevel> levels; // levelCount - 1 entries, the root level has none
+    uint32_t levelCount{0};
+};
+
+class ClusterDagBuilder {
+public:
+    struct Config {
+        ClusterBuilder::Config cluster;
+        ClusterGrouper::Config grouping;
+        // Fraction of a group's triangles kept by each simplification step
+        float simplifyRatio{0.5f};
+        uint32_t maxLevels{32};
+    };
+
+    // Groups of a level are simplified in parallel when a job system is given; their results
+    // are merged in group order, so the DAG is identical for any thread count.
+    [[nodiscard]] static auto build(std::span<const glm::vec3> positions,
+                                    std::span<const uint32_t> indices, const Config& config,
+                                    JobSystem* jobSystem = nullptr) -> Result<ClusterDag>;
+};
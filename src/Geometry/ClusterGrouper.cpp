@@ -0,0 +1,488 @@
+#include "ClusterGrouper.hpp"
+#include "Core/JobSystem.hpp"
+#include "Morton.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+constexpr uint64_t kInvalidEdge = std::numeric_limits<uint64_t>::max();
+
+// A shared edge outweighs a proximity link, so spatial neighbours only decide between pieces
+// that are not connected through the mesh
+constexpr uint32_t kSharedEdgeWeight = 4;
+constexpr uint32_t kProximityWeight = 1;
+
+// Coarsening stops once a pass merges less than this fraction of the nodes
+constexpr float kMinCoarsening = 0.95f;
+constexpr uint32_t kRefinementPasses = 4;
+
+struct WeightedPair {
+    uint32_t first{0}; // Always less than second
+    uint32_t second{0};
+    uint32_t weight{0};
+};
+
+// Sorts pairs and merges duplicates by summing their weights
+void mergePairs(std::vector<WeightedPair>& pairs) {
+    std::ranges::sort(pairs, [](const WeightedPair& lhs, const WeightedPair& rhs) {
+        return lhs.first != rhs.first ? lhs.first < rhs.first : lhs.second < rhs.second;
+    });
+
+    size_t count = 0;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (count > 0 && pairs[count - 1].first == pairs[i].first &&
+            pairs[count - 1].second == pairs[i].second) {
+            pairs[count - 1].weight += pairs[i].weight;
+        } else {
+            pairs[count++] = pairs[i];
+        }
+    }
+    pairs.resize(count);
+}
+
+// Weighted undirected graph in compressed sparse row form
+struct Graph {
+    std::vector<uint32_t> nodeWeights;
+    std::vector<uint32_t> adjacencyOffsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<uint32_t> edgeWeights;
+
+    [[nodiscard]] auto nodeCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(nodeWeights.size());
+    }
+
+    // pairs must be merged
+    static auto build(std::vector<uint32_t> nodeWeights, std::span<const WeightedPair> pairs)
+        -> Graph {
+        Graph graph;
+        graph.nodeWeights = std::move(nodeWeights);
+        graph.adjacencyOffsets.assign(graph.nodeWeights.size() + 1, 0);
+        for (const WeightedPair& pair : pairs) {
+            ++graph.adjacencyOffsets[pair.first + 1];
+            ++graph.adjacencyOffsets[pair.second + 1];
+        }
+        std::partial_sum(graph.adjacencyOffsets.begin(), graph.adjacencyOffsets.end(),
+                         graph.adjacencyOffsets.begin());
+
+        graph.adjacency.resize(graph.adjacencyOffsets.back());
+        graph.edgeWeights.resize(graph.adjacencyOffsets.back());
+        std::vector<uint32_t> cursor(graph.adjacencyOffsets.begin(),
+                                     graph.adjacencyOffsets.end() - 1);
+        for (const WeightedPair& pair : pairs) {
+            graph.adjacency[cursor[pair.first]] = pair.second;
+            graph.edgeWeights[cursor[pair.first]++] = pair.weight;
+            graph.adjacency[cursor[pair.second]] = pair.first;
+            graph.edgeWeights[cursor[pair.second]++] = pair.weight;
+        }
+        return graph;
+    }
+};
+
+struct EdgeEntry {
+    uint64_t edge{kInvalidEdge};
+    uint32_t cluster{0};
+};
+
+// Counts the edges shared by every pair of clusters. Returns the number of unique edges.
+auto findSharedEdges(const ClusterMesh& mesh, std::span<const uint32_t> weld,
+                     std::span<const uint32_t> clusters, JobSystem* jobSystem,
+                     std::vector<WeightedPair>& sharedEdges) -> uint32_t {
+    ZoneScoped;
+    const auto clusterCount = static_cast<uint32_t>(clusters.size());
+    std::vector<uint32_t> entryOffsets(clusterCount + 1, 0);
+    for (uint32_t i = 0; i < clusterCount; ++i) {
+        entryOffsets[i + 1] = entryOffsets[i] + mesh.clusters[clusters[i]].triangleCount * 3;
+    }
+
+    std::vector<EdgeEntry> entries(entryOffsets.back());
+    parallelFor(jobSystem, clusterCount, 16, [&](uint32_t i) {
+        const Cluster& cluster = mesh.clusters[clusters[i]];
+        auto vertex = [&](uint32_t corner) {
+            const uint32_t local = mesh.triangles[cluster.triangleOffset * 3 + corner];
+            const uint32_t global = mesh.vertices[cluster.vertexOffset + local];
+            return weld.empty() ? global : weld[global];
+        };
+
+        EdgeEntry* output = entries.data() + entryOffsets[i];
+        for (uint32_t t = 0; t < cluster.triangleCount; ++t) {
+            for (uint32_t e = 0; e < 3; ++e) {
+                const uint32_t a = vertex(t * 3 + e);
+                const uint32_t b = vertex(t * 3 + (e + 1) % 3);
+                // Collapsed edges keep kInvalidEdge and sort to the end
+                if (a != b) {
+                    output->edge = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+                    output->cluster = i;
+                }
+                ++output;
+            }
+        }
+    });
+
+    parallelSort(jobSystem, std::span(entries), [](const EdgeEntry& lhs, const EdgeEntry& rhs) {
+        return lhs.edge != rhs.edge ? lhs.edge < rhs.edge : lhs.cluster < rhs.cluster;
+    });
+
+    uint32_t edgeCount = 0;
+    std::vector<uint32_t> edgeClusters;
+    for (size_t i = 0; i < entries.size() && entries[i].edge != kInvalidEdge;) {
+        size_t runEnd = i;
+        edgeClusters.clear();
+        for (; runEnd < entries.size() && entries[runEnd].edge == entries[i].edge; ++runEnd) {
+            if (edgeClusters.empty() || edgeClusters.back() != entries[runEnd].cluster) {
+                edgeClusters.push_back(entries[runEnd].cluster);
+            }
+        }
+
+        ++edgeCount;
+        for (size_t a = 0; a < edgeClusters.size(); ++a) {
+            for (size_t b = a + 1; b < edgeClusters.size(); ++b) {
+                sharedEdges.push_back(WeightedPair{edgeClusters[a], edgeClusters[b], 1});
+            }
+        }
+        i = runEnd;
+    }
+
+    mergePairs(sharedEdges);
+    return edgeCount;
+}
+
+// Heavy-edge matching: every node is merged with the unmatched neighbour it shares the most
+// weight with, as long as the merged node stays within maxWeight. Returns the coarse node of
+// every fine node.
+auto coarsen(const Graph& graph, uint32_t maxWeight, Graph& coarse) -> std::vector<uint32_t> {
+    ZoneScoped;
+    const uint32_t nodeCount = graph.nodeCount();
+
+    // Light nodes pick first so they are not left without a partner
+    std::vector<uint32_t> order(nodeCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, [&](uint32_t lhs, uint32_t rhs) {
+        return graph.nodeWeights[lhs] < graph.nodeWeights[rhs];
+    });
+
+    std::vector<uint32_t> match(nodeCount, kInvalidIndex);
+    for (uint32_t node : order) {
+        if (match[node] != kInvalidIndex) {
+            continue;
+        }
+
+        uint32_t best = kInvalidIndex;
+        uint32_t bestWeight = 0;
+        for (uint32_t e = graph.adjacencyOffsets[node]; e < graph.adjacencyOffsets[node + 1]; ++e) {
+            const uint32_t neighbour = graph.adjacency[e];
+            if (match[neighbour] != kInvalidIndex ||
+                graph.nodeWeights[node] + graph.nodeWeights[neighbour] > maxWeight) {
+                continue;
+            }
+            if (graph.edgeWeights[e] > bestWeight ||
+                (graph.edgeWeights[e] == bestWeight && best != kInvalidIndex &&
+                 graph.nodeWeights[neighbour] < graph.nodeWeights[best])) {
+                best = neighbour;
+                bestWeight = graph.edgeWeights[e];
+            }
+        }
+
+        match[node] = best == kInvalidIndex ? node : best;
+        if (best != kInvalidIndex) {
+            match[best] = node;
+        }
+    }
+
+    std::vector<uint32_t> map(nodeCount, kInvalidIndex);
+    uint32_t coarseCount = 0;
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        if (map[node] == kInvalidIndex) {
+            map[node] = coarseCount;
+            map[match[node]] = coarseCount;
+            ++coarseCount;
+        }
+    }
+
+    std::vector<uint32_t> coarseWeights(coarseCount, 0);
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        coarseWeights[map[node]] += graph.nodeWeights[node];
+    }
+
+    std::vector<WeightedPair> pairs;
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        for (uint32_t e = graph.adjacencyOffsets[node]; e < graph.adjacencyOffsets[node + 1]; ++e) {
+            const uint32_t neighbour = graph.adjacency[e];
+            if (node < neighbour && map[node] != map[neighbour]) {
+                pairs.push_back(WeightedPair{std::min(map[node], map[neighbour]),
+                                             std::max(map[node], map[neighbour]),
+                                             graph.edgeWeights[e]});
+            }
+        }
+    }
+    mergePairs(pairs);
+
+    coarse = Graph::build(std::move(coarseWeights), pairs);
+    return map;
+}
+
+// Accumulates the edge weight from node to each adjacent part into connection, recording the
+// touched parts
+void gatherConnections(const Graph& graph, std::span<const uint32_t> parts, uint32_t node,
+                       std::vector<uint32_t>& connection, std::vector<uint32_t>& touched) {
+    touched.clear();
+    for (uint32_t e = graph.adjacencyOffsets[node]; e < graph.adjacencyOffsets[node + 1]; ++e) {
+        const uint32_t part = parts[graph.adjacency[e]];
+        if (connection[part] == 0) {
+            touched.push_back(part);
+        }
+        connection[part] += graph.edgeWeights[e];
+    }
+}
+
+// Merges parts lighter than minWeight into the neighbouring part they are most connected to
+void mergeSmallParts(const Graph& graph, std::vector<uint32_t>& parts,
+                     std::vector<uint32_t>& partWeights, uint32_t minWeight, uint32_t maxWeight) {
+    ZoneScoped;
+    const uint32_t nodeCount = graph.nodeCount();
+    std::vector<std::vector<uint32_t>> members(partWeights.size());
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        members[parts[node]].push_back(node);
+    }
+
+    std::vector<uint32_t> order(partWeights.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, [&](uint32_t lhs, uint32_t rhs) {
+        return partWeights[lhs] < partWeights[rhs];
+    });
+
+    std::vector<uint32_t> connection(partWeights.size(), 0);
+    std::vector<uint32_t> nodeTouched;
+    std::vector<uint32_t> touched;
+    for (uint32_t part : order) {
+        if (partWeights[part] == 0 || partWeights[part] >= minWeight) {
+            continue;
+        }
+
+        touched.clear();
+        for (uint32_t node : members[part]) {
+            gatherConnections(graph, parts, node, connection, nodeTouched);
+            for (uint32_t other : nodeTouched) {
+                if (std::ranges::find(touched, other) == touched.end()) {
+                    touched.push_back(other);
+                }
+            }
+        }
+
+        uint32_t best = kInvalidIndex;
+        for (uint32_t other : touched) {
+            if (other == part || partWeights[part] + partWeights[other] > maxWeight) {
+                continue;
+            }
+            if (best == kInvalidIndex || connection[other] > connection[best] ||
+                (connection[other] == connection[best] &&
+                 partWeights[other] < partWeights[best])) {
+                best = other;
+            }
+        }
+        for (uint32_t other : touched) {
+            connection[other] = 0;
+        }
+
+        if (best == kInvalidIndex) {
+            continue;
+        }
+        for (uint32_t node : members[part]) {
+            parts[node] = best;
+        }
+        members[best].insert(members[best].end(), members[part].begin(), members[part].end());
+        members[part].clear();
+        partWeights[best] += partWeights[part];
+        partWeights[part] = 0;
+    }
+}
+
+// Greedy boundary refinement: moves nodes to the adjacent part they are most connected to
+// while both parts stay within [minWeight, maxWeight]
+void refine(const Graph& graph, std::vector<uint32_t>& parts, std::vector<uint32_t>& partWeights,
+            uint32_t minWeight, uint32_t maxWeight) {
+    ZoneScoped;
+    std::vector<uint32_t> connection(partWeights.size(), 0);
+    std::vector<uint32_t> touched;
+    for (uint32_t pass = 0; pass < kRefinementPasses; ++pass) {
+        uint32_t moveCount = 0;
+        for (uint32_t node = 0; node < graph.nodeCount(); ++node) {
+            const uint32_t own = parts[node];
+            const uint32_t weight = graph.nodeWeights[node];
+            gatherConnections(graph, parts, node, connection, touched);
+
+            uint32_t best = own;
+            if (partWeights[own] >= minWeight + weight) {
+                for (uint32_t part : touched) {
+                    if (part != own && connection[part] > connection[best] &&
+                        partWeights[part] + weight <= maxWeight) {
+                        best = part;
+                    }
+                }
+            }
+            for (uint32_t part : touched) {
+                connection[part] = 0;
+            }
+            connection[own] = 0;
+
+            if (best != own) {
+                parts[node] = best;
+                partWeights[own] -= weight;
+                partWeights[best] += weight;
+                ++moveCount;
+            }
+        }
+        if (moveCount == 0) {
+            break;
+        }
+    }
+}
+
+// Multilevel k-way partition: coarsen by heavy-edge matching until every node is about one
+// group, merge leftovers that are too small, then project back level by level and refine the
+// boundaries on each. Returns the part of every node.
+auto partitionGraph(Graph graph, const ClusterGrouper::Config& config) -> std::vector<uint32_t> {
+    ZoneScoped;
+    const uint32_t nodeCount = graph.nodeCount();
+    const uint32_t targetParts =
+        std::max((nodeCount + config.targetSize - 1) / config.targetSize, 1u);
+    const uint32_t refineMaxWeight = std::min(
+        config.maxSize, std::max(config.targetSize + config.targetSize / 2, config.minSize));
+
+    std::vector<Graph> levels;
+    std::vector<std::vector<uint32_t>> maps;
+    levels.push_back(std::move(graph));
+    while (levels.back().nodeCount() > targetParts) {
+        Graph coarse;
+        std::vector<uint32_t> map = coarsen(levels.back(), config.targetSize, coarse);
+        const uint32_t fineCount = levels.back().nodeCount();
+        if (coarse.nodeCount() == fineCount) {
+            break;
+        }
+
+        levels.push_back(std::move(coarse));
+        maps.push_back(std::move(map));
+        if (static_cast<float>(levels.back().nodeCount()) >
+            kMinCoarsening * static_cast<float>(fineCount)) {
+            break;
+        }
+    }
+
+    // Every coarsest node starts as a part of its own
+    std::vector<uint32_t> parts(levels.back().nodeCount());
+    std::iota(parts.begin(), parts.end(), 0u);
+    std::vector<uint32_t> partWeights = levels.back().nodeWeights;
+    mergeSmallParts(levels.back(), parts, partWeights, config.minSize, config.maxSize);
+    refine(levels.back(), parts, partWeights, config.minSize, refineMaxWeight);
+
+    for (size_t level = levels.size() - 1; level > 0; --level) {
+        const std::vector<uint32_t>& map = maps[level - 1];
+        std::vector<uint32_t> fineParts(map.size());
+        for (size_t node = 0; node < map.size(); ++node) {
+            fineParts[node] = parts[map[node]];
+        }
+        parts = std::move(fineParts);
+        refine(levels[level - 1], parts, partWeights, config.minSize, refineMaxWeight);
+    }
+
+    return parts;
+}
+
+} // namespace
+
+auto ClusterGrouper::group(const ClusterMesh& mesh, std::span<const uint32_t> weld,
+                           std::span<const glm::vec3> centers, std::vector<uint32_t>& clusters,
+                           const Config& config, JobSystem* jobSystem) -> ClusterGrouping {
+    ZoneScoped;
+    const auto clusterCount = static_cast<uint32_t>(clusters.size());
+    ClusterGrouping grouping;
+    if (clusterCount == 0) {
+        return grouping;
+    }
+
+    // Morton rank of every cluster orders groups and clusters within them
+    glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+    glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+    for (const glm::vec3& center : centers) {
+        boundsMin = glm::min(boundsMin, center);
+        boundsMax = glm::max(boundsMax, center);
+    }
+    const glm::vec3 inverseExtent = mortonInverseExtent(boundsMin, boundsMax);
+    std::vector<uint64_t> keys(clusterCount);
+    for (uint32_t i = 0; i < clusterCount; ++i) {
+        const uint32_t code = mortonCode(centers[i], boundsMin, inverseExtent);
+        keys[i] = (static_cast<uint64_t>(code) << 32) | i;
+    }
+    std::ranges::sort(keys);
+    std::vector<uint32_t> mortonOrder(clusterCount);
+    for (uint32_t i = 0; i < clusterCount; ++i) {
+        mortonOrder[i] = static_cast<uint32_t>(keys[i] & 0xffffffffu);
+    }
+
+    std::vector<WeightedPair> sharedEdges;
+    grouping.edgeCount = findSharedEdges(mesh, weld, clusters, jobSystem, sharedEdges);
+
+    std::vector<uint32_t> parts(clusterCount);
+    if (config.method == Method::SpatialSort) {
+        for (uint32_t i = 0; i < clusterCount; ++i) {
+            parts[mortonOrder[i]] = i / config.targetSize;
+        }
+        // Fold a small trailing group into its predecessor
+        const uint32_t lastSize = clusterCount % config.targetSize;
+        if (clusterCount > config.targetSize && lastSize != 0 && lastSize < config.targetSize / 2) {
+            for (uint32_t i = clusterCount - lastSize; i < clusterCount; ++i) {
+                --parts[mortonOrder[i]];
+            }
+        }
+    } else {
+        // Link clusters that are neighbours along the Morton curve so that disconnected pieces
+        // are grouped with whatever is closest
+        std::vector<WeightedPair> pairs;
+        pairs.reserve(sharedEdges.size() + clusterCount);
+        for (const WeightedPair& shared : sharedEdges) {
+            pairs.push_back(WeightedPair{shared.first, shared.second,
+                                         shared.weight * kSharedEdgeWeight});
+        }
+        for (uint32_t i = 1; i < clusterCount; ++i) {
+            pairs.push_back(WeightedPair{std::min(mortonOrder[i - 1], mortonOrder[i]),
+                                         std::max(mortonOrder[i - 1], mortonOrder[i]),
+                                         kProximityWeight});
+        }
+        mergePairs(pairs);
+        parts = partitionGraph(Graph::build(std::vector<uint32_t>(clusterCount, 1), pairs),
+                               config);
+    }
+
+    for (const WeightedPair& shared : sharedEdges) {
+        if (parts[shared.first] != parts[shared.second]) {
+            grouping.lockedEdgeCount += shared.weight;
+        }
+    }
+
+    // Number groups in Morton order of their first cluster and sort clusters by group
+    std::vector<uint32_t> groupRank(clusterCount, kInvalidIndex);
+    uint32_t groupCount = 0;
+    for (uint32_t cluster : mortonOrder) {
+        if (groupRank[parts[cluster]] == kInvalidIndex) {
+            groupRank[parts[cluster]] = groupCount++;
+        }
+    }
+
+    std::vector<uint32_t> ordered(mortonOrder);
+    std::ranges::stable_sort(ordered, [&](uint32_t lhs, uint32_t rhs) {
+        return groupRank[parts[lhs]] < groupRank[parts[rhs]];
+    });
+
+    std::vector<uint32_t> reordered(clusterCount);
+    grouping.offsets.assign(groupCount + 1, 0);
+    for (uint32_t i = 0; i < clusterCount; ++i) {
+        reordered[i] = clusters[ordered[i]];
+        ++grouping.offsets[groupRank[parts[ordered[i]]] + 1];
+    }
+    std::partial_sum(grouping.offsets.begin(), grouping.offsets.end(), grouping.offsets.begin());
+    clusters = std::move(reordered);
+    return grouping;
+}
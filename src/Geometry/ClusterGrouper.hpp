@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ClusterBuilder.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+struct ClusterGrouping {
+    // Group g covers clusters [offsets[g], offsets[g + 1]) of the reordered cluster list
+    std::vector<uint32_t> offsets;
+    // Unique edges of the level, and those shared by clusters of different groups. The latter
+    // have both vertices locked during simplification.
+    uint32_t edgeCount{0};
+    uint32_t lockedEdgeCount{0};
+
+    [[nodiscard]] auto groupCount() const noexcept -> uint32_t {
+        return offsets.empty() ? 0 : static_cast<uint32_t>(offsets.size() - 1);
+    }
+};
+
+// Splits the clusters of one DAG level into groups that are simplified together. Boundaries
+// between groups stay locked, so good groups share as few edges with each other as possible.
+class ClusterGrouper {
+public:
+    enum class Method {
+        // Chunks of targetSize along a Morton curve over the cluster centers
+        SpatialSort,
+        // Multilevel k-way partition of the cluster adjacency graph, weighted by shared edges
+        GraphPartition,
+    };
+
+    struct Config {
+        Method method{Method::GraphPartition};
+        uint32_t targetSize{8};
+        uint32_t minSize{4};
+        uint32_t maxSize{32};
+    };
+
+    // Reorders clusters (indices into mesh.clusters) so that every group is contiguous.
+    // centers holds one position per entry of clusters; weld maps mesh vertices to a canonical
+    // vertex per position and may be empty.
+    [[nodiscard]] static auto group(const ClusterMesh& mesh, std::span<const uint32_t> weld,
+                                    std::span<const glm::vec3> centers,
+                                    std::vector<uint32_t>& clusters, const Config& config,
+                                    JobSystem* jobSystem = nullptr) -> ClusterGrouping;
+};
@@ -0,0 +1,188 @@
+#include "MeshData.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <numbers>
+
+auto MeshData::validate() const -> VoidResult {
+    ZoneScoped;
+    if (indices.size() % 3 != 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            std::format("Index count {} is not a multiple of 3", indices.size())
+        ));
+    }
+
+    if ((!normals.empty() && normals.size() != positions.size()) ||
+        (!uvs.empty() && uvs.size() != positions.size()) ||
+        (!tangents.empty() && tangents.size() != positions.size())) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            "Vertex attribute arrays do not match the position count"
+        ));
+    }
+
+    const auto vertexCount = static_cast<uint32_t>(positions.size());
+    for (uint32_t index : indices) {
+        if (index >= vertexCount) {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidMeshData,
+                std::format("Index {} out of range for {} vertices", index, vertexCount)
+            ));
+        }
+    }
+
+    return {};
+}
+
+void MeshData::computeNormals() {
+    ZoneScoped;
+    normals.assign(positions.size(), glm::vec3{0.0f});
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec3& a = positions[indices[i + 0]];
+        const glm::vec3& b = positions[indices[i + 1]];
+        const glm::vec3& c = positions[indices[i + 2]];
+        // The cross product length is twice the area, which weights the contribution
+        const glm::vec3 faceNormal = glm::cross(b - a, c - a);
+        normals[indices[i + 0]] += faceNormal;
+        normals[indices[i + 1]] += faceNormal;
+        normals[indices[i + 2]] += faceNormal;
+    }
+
+    for (glm::vec3& normal : normals) {
+        const float length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3{0.0f, 1.0f, 0.0f};
+    }
+}
+
+void MeshData::computeTangents() {
+    ZoneScoped;
+    std::vector<glm::vec3> uTangents(positions.size(), glm::vec3{0.0f});
+    std::vector<glm::vec3> vTangents(positions.size(), glm::vec3{0.0f});
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const uint32_t a = indices[i + 0];
+        const uint32_t b = indices[i + 1];
+        const uint32_t c = indices[i + 2];
+        const glm::vec3 edge1 = positions[b] - positions[a];
+        const glm::vec3 edge2 = positions[c] - positions[a];
+        const glm::vec2 duv1 = uvs[b] - uvs[a];
+        const glm::vec2 duv2 = uvs[c] - uvs[a];
+        const float determinant = duv1.x * duv2.y - duv2.x * duv1.y;
+        if (determinant == 0.0f) {
+            continue;
+        }
+        // Unnormalized by the determinant's magnitude, so larger uv areas weigh more
+        const float sign = determinant > 0.0f ? 1.0f : -1.0f;
+        const glm::vec3 uTangent = (edge1 * duv2.y - edge2 * duv1.y) * sign;
+        const glm::vec3 vTangent = (edge2 * duv1.x - edge1 * duv2.x) * sign;
+        for (uint32_t vertex : {a, b, c}) {
+            uTangents[vertex] += uTangent;
+            vTangents[vertex] += vTangent;
+        }
+    }
+
+    tangents.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const glm::vec3& normal = normals[i];
+        glm::vec3 tangent = uTangents[i] - normal * glm::dot(normal, uTangents[i]);
+        float length = glm::length(tangent);
+        if (length == 0.0f) {
+            // Any direction in the tangent plane will do where the uvs are degenerate
+            const glm::vec3 axis = std::abs(normal.x) < 0.9f ? glm::vec3{1.0f, 0.0f, 0.0f}
+                                                             : glm::vec3{0.0f, 1.0f, 0.0f};
+            tangent = glm::cross(normal, axis);
+            length = glm::length(tangent);
+        }
+        tangent /= length;
+        const float handedness =
+            glm::dot(glm::cross(normal, tangent), vTangents[i]) < 0.0f ? -1.0f : 1.0f;
+        tangents[i] = glm::vec4{tangent, handedness};
+    }
+}
+
+auto MeshData::createSphere(uint32_t segments) -> MeshData {
+    ZoneScoped;
+    segments = std::max(segments, 3u);
+    const uint32_t rings = segments / 2 + 1;
+
+    MeshData mesh;
+    mesh.positions.reserve(static_cast<size_t>(rings + 1) * (segments + 1));
+
+    for (uint32_t ring = 0; ring <= rings; ++ring) {
+        const float theta = std::numbers::pi_v<float> * static_cast<float>(ring) / rings;
+        for (uint32_t segment = 0; segment <= segments; ++segment) {
+            const float phi = 2.0f * std::numbers::pi_v<float> * static_cast<float>(segment) / segments;
+            const glm::vec3 normal{std::sin(theta) * std::cos(phi), std::cos(theta),
+                                   std::sin(theta) * std::sin(phi)};
+            mesh.positions.push_back(normal);
+            mesh.normals.push_back(normal);
+            mesh.uvs.emplace_back(static_cast<float>(segment) / segments,
+                                  static_cast<float>(ring) / rings);
+        }
+    }
+
+    mesh.indices.reserve(static_cast<size_t>(rings) * segments * 6);
+    for (uint32_t ring = 0; ring < rings; ++ring) {
+        for (uint32_t segment = 0; segment < segments; ++segment) {
+            const uint32_t a = ring * (segments + 1) + segment;
+            const uint32_t b = a + segments + 1;
+            if (ring != 0) {
+                mesh.indices.insert(mesh.indices.end(), {a, a + 1, b});
+            }
+            if (ring != rings - 1) {
+                mesh.indices.insert(mesh.indices.end(), {a + 1, b + 1, b});
+            }
+        }
+    }
+
+    return mesh;
+}
+
+auto MeshData::createTerrain(uint32_t resolution) -> MeshData {
+    ZoneScoped;
+    resolution = std::max(resolution, 2u);
+    const float step = 1.0f / static_cast<float>(resolution - 1);
+
+    // Sum of a few octaves of sine waves, enough detail to exercise simplification
+    auto height = [](float x, float z) {
+        float h = 0.0f;
+        float amplitude = 0.08f;
+        float frequency = 6.0f;
+        for (int octave = 0; octave < 4; ++octave) {
+            h += amplitude * std::sin(x * frequency + octave) * std::cos(z * frequency * 1.3f);
+            amplitude *= 0.45f;
+            frequency *= 2.1f;
+        }
+        return h;
+    };
+
+    MeshData mesh;
+    const size_t vertexCount = static_cast<size_t>(resolution) * resolution;
+    mesh.positions.reserve(vertexCount);
+    mesh.normals.reserve(vertexCount);
+    mesh.uvs.reserve(vertexCount);
+
+    for (uint32_t z = 0; z < resolution; ++z) {
+        for (uint32_t x = 0; x < resolution; ++x) {
+            const float fx = static_cast<float>(x) * step;
+            const float fz = static_cast<float>(z) * step;
+            const float dx = height(fx + step, fz) - height(fx - step, fz);
+            const float dz = height(fx, fz + step) - height(fx, fz - step);
+            mesh.positions.emplace_back(fx - 0.5f, height(fx, fz), fz - 0.5f);
+            mesh.normals.push_back(glm::normalize(glm::vec3{-dx, 2.0f * step, -dz}));
+            mesh.uvs.emplace_back(fx, fz);
+        }
+    }
+
+    mesh.indices.reserve(static_cast<size_t>(resolution - 1) * (resolution - 1) * 6);
+    for (uint32_t z = 0; z + 1 < resolution; ++z) {
+        for (uint32_t x = 0; x + 1 < resolution; ++x) {
+            const uint32_t a = z * resolution + x;
+            const uint32_t b = a + resolution;
+            mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+
+    return mesh;
+}
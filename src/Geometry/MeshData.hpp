@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Error.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Indexed triangle mesh as consumed by the cooker. Attribute arrays are either empty or
+// exactly as long as positions.
+struct MeshData {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec4> tangents; // Handedness in w, +1 or -1
+    std::vector<uint32_t> indices;
+
+    [[nodiscard]] auto vertexCount() const noexcept -> size_t { return positions.size(); }
+    [[nodiscard]] auto triangleCount() const noexcept -> size_t { return indices.size() / 3; }
+
+    [[nodiscard]] auto validate() const -> VoidResult;
+
+    // Area-weighted vertex normals, replacing any existing ones
+    void computeNormals();
+    // Per-vertex tangents along increasing u from the uv derivatives, orthogonalized against
+    // the normals, replacing any existing ones. Needs normals and uvs.
+    void computeTangents();
+
+    // Procedural meshes for throughput measurements on machines without source assets
+    [[nodiscard]] static auto createSphere(uint32_t segments) -> MeshData;
+    [[nodiscard]] static auto createTerrain(uint32_t resolution) -> MeshData;
+};
@@ -0,0 +1,1942 @@
+#include "MeshImporter.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/Json.hpp"
+#include "Logger.hpp"
+#include "Streaming/MappedFile.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Seconds = std::chrono::duration<double>;
+
+// Vertices are addressed by 32-bit indices
+constexpr uint64_t kMaxVertexCount = std::numeric_limits<uint32_t>::max();
+
+// Elements of binary data handled per job
+constexpr uint64_t kBinaryBatchSize = 1 << 16;
+
+auto tooManyVertices(const std::filesystem::path& path, uint64_t count) -> Error {
+    return makeError(
+        ErrorCode::InvalidMeshData,
+        std::format("{} has {} vertices, more than 32-bit indices can address", path.string(),
+                    count)
+    );
+}
+
+// First parse error of a chunk; line is relative to the chunk
+struct ChunkError {
+    uint64_t line{0};
+    std::string reason;
+};
+
+// Reports the error of the earliest failed chunk, so the message does not depend on timing
+auto firstChunkError(const std::filesystem::path& path,
+                     std::span<const std::optional<ChunkError>> errors,
+                     std::span<const uint64_t> chunkFirstLines) -> std::optional<Error> {
+    for (size_t chunk = 0; chunk < errors.size(); ++chunk) {
+        if (errors[chunk]) {
+            return makeError(
+                ErrorCode::FileParseFailed,
+                std::format("{}:{}: {}", path.string(),
+                            chunkFirstLines[chunk] + errors[chunk]->line + 1,
+                            errors[chunk]->reason)
+            );
+        }
+    }
+    return std::nullopt;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Text parsing
+
+struct TextChunk {
+    const char* begin{nullptr};
+    const char* end{nullptr};
+};
+
+// Cuts text into chunks of about chunkSize bytes, each ending after a line break
+auto splitLines(std::string_view text, size_t chunkSize) -> std::vector<TextChunk> {
+    std::vector<TextChunk> chunks;
+    const char* it = text.data();
+    const char* end = text.data() + text.size();
+    while (it != end) {
+        const char* chunkEnd = it + std::min<size_t>(chunkSize, static_cast<size_t>(end - it));
+        if (chunkEnd != end) {
+            const void* lineEnd = std::memchr(chunkEnd, '\n', static_cast<size_t>(end - chunkEnd));
+            chunkEnd = lineEnd != nullptr ? static_cast<const char*>(lineEnd) + 1 : end;
+        }
+        chunks.push_back({it, chunkEnd});
+        it = chunkEnd;
+    }
+    return chunks;
+}
+
+// Points at the line's '\n', or at end for the last line
+auto findLineEnd(const char* it, const char* end) -> const char* {
+    const void* lineEnd = std::memchr(it, '\n', static_cast<size_t>(end - it));
+    return lineEnd != nullptr ? static_cast<const char*>(lineEnd) : end;
+}
+
+auto isSpace(char c) -> bool {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+auto skipSpaces(const char* it, const char* end) -> const char* {
+    while (it != end && isSpace(*it)) {
+        ++it;
+    }
+    return it;
+}
+
+auto skipToken(const char* it, const char* end) -> const char* {
+    while (it != end && !isSpace(*it)) {
+        ++it;
+    }
+    return it;
+}
+
+// Skips leading spaces; from_chars itself rejects a leading '+'
+template<typename T>
+auto parseNumber(const char*& it, const char* end, T& value) -> bool {
+    it = skipSpaces(it, end);
+    if (it != end && *it == '+') {
+        ++it;
+    }
+    auto [ptr, ec] = std::from_chars(it, end, value);
+    if (ec != std::errc{}) {
+        return false;
+    }
+    it = ptr;
+    return true;
+}
+
+// Lines per chunk turned into the global line number of every chunk's first line
+auto prefixLines(std::span<const uint64_t> lineCounts) -> std::vector<uint64_t> {
+    std::vector<uint64_t> firstLines(lineCounts.size() + 1, 0);
+    for (size_t chunk = 0; chunk < lineCounts.size(); ++chunk) {
+        firstLines[chunk + 1] = firstLines[chunk] + lineCounts[chunk];
+    }
+    return firstLines;
+}
+
+// ---------------------------------------------------------------------------------------------
+// OBJ
+
+enum class ObjLine : uint8_t { Other, Position, Uv, Normal, Face };
+
+// Advances it past the keyword
+auto classifyObjLine(const char*& it, const char* end) -> ObjLine {
+    it = skipSpaces(it, end);
+    if (end - it < 2) {
+        return ObjLine::Other;
+    }
+    if (it[0] == 'f' && isSpace(it[1])) {
+        it += 2;
+        return ObjLine::Face;
+    }
+    if (it[0] != 'v') {
+        return ObjLine::Other;
+    }
+    if (isSpace(it[1])) {
+        it += 2;
+        return ObjLine::Position;
+    }
+    if (end - it > 2 && isSpace(it[2]) && (it[1] == 't' || it[1] == 'n')) {
+        const ObjLine type = it[1] == 't' ? ObjLine::Uv : ObjLine::Normal;
+        it += 3;
+        return type;
+    }
+    return ObjLine::Other;
+}
+
+// Elements in a chunk; prefix sums of these give every chunk's first output slot
+struct ObjCounts {
+    uint64_t lines{0};
+    uint64_t positions{0};
+    uint64_t uvs{0};
+    uint64_t normals{0};
+    uint64_t triangles{0};
+    // A face corner indexes a texture coordinate or normal
+    bool cornerAttributes{false};
+
+    void add(const ObjCounts& other) noexcept {
+        lines += other.lines;
+        positions += other.positions;
+        uvs += other.uvs;
+        normals += other.normals;
+        triangles += other.triangles;
+        cornerAttributes |= other.cornerAttributes;
+    }
+};
+
+auto countObjChunk(TextChunk chunk) -> ObjCounts {
+    ObjCounts counts;
+    for (const char* line = chunk.begin; line != chunk.end; ++counts.lines) {
+        const char* lineEnd = findLineEnd(line, chunk.end);
+        const char* it = line;
+        switch (classifyObjLine(it, lineEnd)) {
+        case ObjLine::Position:
+            ++counts.positions;
+            break;
+        case ObjLine::Uv:
+            ++counts.uvs;
+            break;
+        case ObjLine::Normal:
+            ++counts.normals;
+            break;
+        case ObjLine::Face: {
+            uint64_t corners = 0;
+            while ((it = skipSpaces(it, lineEnd)) != lineEnd) {
+                const char* tokenEnd = skipToken(it, lineEnd);
+                counts.cornerAttributes |= std::find(it, tokenEnd, '/') != tokenEnd;
+                it = tokenEnd;
+                ++corners;
+            }
+            counts.triangles += corners >= 3 ? corners - 2 : 0;
+            break;
+        }
+        case ObjLine::Other:
+            break;
+        }
+        line = lineEnd == chunk.end ? lineEnd : lineEnd + 1;
+    }
+    return counts;
+}
+
+struct ObjCorner {
+    int64_t position{-1};
+    int64_t uv{-1};
+    int64_t normal{-1};
+};
+
+// Destination of the parse passes. Attributes go to the raw arrays, which faces index; with
+// corner attributes every triangle corner becomes a vertex of the mesh.
+struct ObjTarget {
+    ObjCounts totals;
+    bool parseAttributes{true};
+    bool parseFaces{true};
+    bool corners{false};
+    glm::vec3* positions{nullptr};
+    glm::vec2* uvs{nullptr};
+    glm::vec3* normals{nullptr};
+    MeshData* mesh{nullptr};
+};
+
+// OBJ indices are 1-based, or relative to the elements defined so far when negative
+auto resolveObjIndex(int64_t value, uint64_t definedCount, uint64_t totalCount) -> int64_t {
+    const int64_t index = value < 0 ? static_cast<int64_t>(definedCount) + value : value - 1;
+    return value != 0 && index >= 0 && index < static_cast<int64_t>(totalCount) ? index : -1;
+}
+
+// Parses "v", "v/vt", "v//vn" or "v/vt/vn"
+auto parseObjCorner(const char*& it, const char* end, const ObjCounts& defined,
+                    const ObjCounts& totals, ObjCorner& corner) -> bool {
+    int64_t value = 0;
+    auto [ptr, ec] = std::from_chars(it, end, value);
+    if (ec != std::errc{}) {
+        return false;
+    }
+    it = ptr;
+    corner = {resolveObjIndex(value, defined.positions, totals.positions), -1, -1};
+    if (corner.position < 0) {
+        return false;
+    }
+
+    if (it != end && *it == '/') {
+        ++it;
+        if (it != end && *it != '/' && !isSpace(*it)) {
+            const auto uv = std::from_chars(it, end, value);
+            corner.uv = uv.ec == std::errc{} ? resolveObjIndex(value, defined.uvs, totals.uvs)
+                                             : -1;
+            if (corner.uv < 0) {
+                return false;
+            }
+            it = uv.ptr;
+        }
+        if (it != end && *it == '/') {
+            ++it;
+            const auto normal = std::from_chars(it, end, value);
+            corner.normal = normal.ec == std::errc{}
+                                ? resolveObjIndex(value, defined.normals, totals.normals)
+                                : -1;
+            if (corner.normal < 0) {
+                return false;
+            }
+            it = normal.ptr;
+        }
+    }
+    return it == end || isSpace(*it);
+}
+
+void writeObjCorner(const ObjTarget& target, const ObjCorner& corner, size_t vertex) {
+    MeshData& mesh = *target.mesh;
+    mesh.positions[vertex] = target.positions[corner.position];
+    if (!mesh.uvs.empty()) {
+        mesh.uvs[vertex] = corner.uv >= 0 ? target.uvs[corner.uv] : glm::vec2{0.0f};
+    }
+    if (!mesh.normals.empty()) {
+        mesh.normals[vertex] = corner.normal >= 0 ? target.normals[corner.normal]
+                                                  : glm::vec3{0.0f};
+    }
+}
+
+// first holds the counts of every chunk before this one
+auto parseObjChunk(TextChunk chunk, const ObjCounts& first, const ObjTarget& target)
+    -> std::optional<ChunkError> {
+    ObjCounts defined = first;
+    uint64_t lineIndex = 0;
+    for (const char* line = chunk.begin; line != chunk.end; ++lineIndex) {
+        const char* lineEnd = findLineEnd(line, chunk.end);
+        const char* it = line;
+        const ObjLine type = classifyObjLine(it, lineEnd);
+
+        if (type == ObjLine::Position || type == ObjLine::Normal) {
+            glm::vec3 value{};
+            if (target.parseAttributes &&
+                (!parseNumber(it, lineEnd, value.x) || !parseNumber(it, lineEnd, value.y) ||
+                 !parseNumber(it, lineEnd, value.z))) {
+                return ChunkError{lineIndex, "malformed vertex"};
+            }
+            if (type == ObjLine::Position) {
+                if (target.parseAttributes) {
+                    target.positions[defined.positions] = value;
+                }
+                ++defined.positions;
+            } else {
+                if (target.parseAttributes) {
+                    target.normals[defined.normals] = value;
+                }
+                ++defined.normals;
+            }
+        } else if (type == ObjLine::Uv) {
+            glm::vec2 value{};
+            if (target.parseAttributes &&
+                (!parseNumber(it, lineEnd, value.x) || !parseNumber(it, lineEnd, value.y))) {
+                return ChunkError{lineIndex, "malformed texture coordinate"};
+            }
+            if (target.parseAttributes) {
+                target.uvs[defined.uvs] = value;
+            }
+            ++defined.uvs;
+        } else if (type == ObjLine::Face && target.parseFaces) {
+            // Triangulated as a fan around the first corner
+            ObjCorner firstCorner;
+            ObjCorner previous;
+            uint32_t cornerCount = 0;
+            while ((it = skipSpaces(it, lineEnd)) != lineEnd) {
+                ObjCorner corner;
+                if (!parseObjCorner(it, lineEnd, defined, target.totals, corner)) {
+                    return ChunkError{lineIndex, "malformed face or index out of range"};
+                }
+                if (cornerCount >= 2) {
+                    const size_t base = defined.triangles * 3;
+                    if (target.corners) {
+                        writeObjCorner(target, firstCorner, base + 0);
+                        writeObjCorner(target, previous, base + 1);
+                        writeObjCorner(target, corner, base + 2);
+                    } else {
+                        uint32_t* indices = target.mesh->indices.data() + base;
+                        indices[0] = static_cast<uint32_t>(firstCorner.position);
+                        indices[1] = static_cast<uint32_t>(previous.position);
+                        indices[2] = static_cast<uint32_t>(corner.position);
+                    }
+                    ++defined.triangles;
+                }
+                if (cornerCount == 0) {
+                    firstCorner = corner;
+                }
+                previous = corner;
+                ++cornerCount;
+            }
+        }
+        line = lineEnd == chunk.end ? lineEnd : lineEnd + 1;
+    }
+    return std::nullopt;
+}
+
+auto importObj(const std::filesystem::path& path, std::string_view text, JobSystem* jobSystem,
+               const MeshImportConfig& config) -> Result<MeshData> {
+    ZoneScoped;
+    const std::vector<TextChunk> chunks = splitLines(text, config.chunkSize);
+    const auto chunkCount = static_cast<uint32_t>(chunks.size());
+
+    std::vector<ObjCounts> counts(chunkCount);
+    {
+        ZoneScopedN("Count");
+        parallelFor(jobSystem, chunkCount, 1, [&](uint32_t chunk) {
+            counts[chunk] = countObjChunk(chunks[chunk]);
+        });
+    }
+
+    // Exclusive prefix sums: the first slot of every chunk in each output array
+    std::vector<ObjCounts> firsts(chunkCount);
+    ObjTarget target;
+    std::vector<uint64_t> lineCounts(chunkCount);
+    for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+        firsts[chunk] = target.totals;
+        target.totals.add(counts[chunk]);
+        lineCounts[chunk] = counts[chunk].lines;
+    }
+    const ObjCounts& totals = target.totals;
+    const std::vector<uint64_t> firstLines = prefixLines(lineCounts);
+
+    // Face corners that index attributes each become a vertex; otherwise faces index the
+    // positions directly and any attributes are unreferenced
+    target.corners = totals.cornerAttributes && (totals.uvs > 0 || totals.normals > 0);
+    const uint64_t vertexCount = target.corners ? totals.triangles * 3 : totals.positions;
+    if (vertexCount > kMaxVertexCount || totals.positions > kMaxVertexCount) {
+        return std::unexpected(tooManyVertices(path, std::max(vertexCount, totals.positions)));
+    }
+
+    MeshData mesh;
+    std::vector<glm::vec3> positions(totals.positions);
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    mesh.indices.resize(totals.triangles * 3);
+    if (target.corners) {
+        uvs.resize(totals.uvs);
+        normals.resize(totals.normals);
+        mesh.positions.resize(vertexCount);
+        mesh.uvs.resize(totals.uvs > 0 ? vertexCount : 0);
+        mesh.normals.resize(totals.normals > 0 ? vertexCount : 0);
+    }
+    target.positions = positions.data();
+    target.uvs = uvs.data();
+    target.normals = normals.data();
+    target.mesh = &mesh;
+
+    // Corners may reference attributes of any chunk, so they are resolved once all are in
+    std::vector<std::optional<ChunkError>> errors(chunkCount);
+    auto parsePass = [&](bool parseAttributes, bool parseFaces) -> VoidResult {
+        target.parseAttributes = parseAttributes;
+        target.parseFaces = parseFaces;
+        parallelFor(jobSystem, chunkCount, 1, [&](uint32_t chunk) {
+            errors[chunk] = parseObjChunk(chunks[chunk], firsts[chunk], target);
+        });
+        if (auto error = firstChunkError(path, errors, firstLines)) {
+            return std::unexpected(*error);
+        }
+        return {};
+    };
+    {
+        ZoneScopedN("Parse");
+        if (auto result = parsePass(true, !target.corners); !result) {
+            return std::unexpected(result.error());
+        }
+        if (target.corners) {
+            if (auto result = parsePass(false, true); !result) {
+                return std::unexpected(result.error());
+            }
+            const auto batchCount = static_cast<uint32_t>(
+                (mesh.indices.size() + kBinaryBatchSize - 1) / kBinaryBatchSize);
+            parallelFor(jobSystem, batchCount, 1, [&](uint32_t batch) {
+                const size_t begin = batch * kBinaryBatchSize;
+                const size_t end = std::min(begin + kBinaryBatchSize, mesh.indices.size());
+                for (size_t i = begin; i < end; ++i) {
+                    mesh.indices[i] = static_cast<uint32_t>(i);
+                }
+            });
+        } else {
+            mesh.positions = std::move(positions);
+        }
+    }
+    return mesh;
+}
+
+// ---------------------------------------------------------------------------------------------
+// PLY
+
+enum class PlyType : uint8_t { Int8, Uint8, Int16, Uint16, Int32, Uint32, Float32, Float64 };
+
+auto parsePlyType(std::string_view name) -> std::optional<PlyType> {
+    constexpr std::pair<std::string_view, PlyType> kTypes[] = {
+        {"char", PlyType::Int8},     {"int8", PlyType::Int8},
+        {"uchar", PlyType::Uint8},   {"uint8", PlyType::Uint8},
+        {"short", PlyType::Int16},   {"int16", PlyType::Int16},
+        {"ushort", PlyType::Uint16}, {"uint16", PlyType::Uint16},
+        {"int", PlyType::Int32},     {"int32", PlyType::Int32},
+        {"uint", PlyType::Uint32},   {"uint32", PlyType::Uint32},
+        {"float", PlyType::Float32}, {"float32", PlyType::Float32},
+        {"double", PlyType::Float64}, {"float64", PlyType::Float64},
+    };
+    for (const auto& [typeName, type] : kTypes) {
+        if (typeName == name) {
+            return type;
+        }
+    }
+    return std::nullopt;
+}
+
+auto getPlyTypeSize(PlyType type) -> uint32_t {
+    constexpr uint32_t kSizes[] = {1, 1, 2, 2, 4, 4, 4, 8};
+    return kSizes[static_cast<size_t>(type)];
+}
+
+template<typename T>
+auto loadValue(const uint8_t* bytes, bool swapBytes) -> T {
+    using Bits = std::conditional_t<sizeof(T) == 1, uint8_t,
+                 std::conditional_t<sizeof(T) == 2, uint16_t,
+                 std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+    Bits bits;
+    std::memcpy(&bits, bytes, sizeof(bits));
+    if (swapBytes) {
+        bits = std::byteswap(bits);
+    }
+    return std::bit_cast<T>(bits);
+}
+
+auto readPlyValue(const uint8_t* bytes, PlyType type, bool swapBytes) -> double {
+    switch (type) {
+    case PlyType::Int8: return loadValue<int8_t>(bytes, swapBytes);
+    case PlyType::Uint8: return loadValue<uint8_t>(bytes, swapBytes);
+    case PlyType::Int16: return loadValue<int16_t>(bytes, swapBytes);
+    case PlyType::Uint16: return loadValue<uint16_t>(bytes, swapBytes);
+    case PlyType::Int32: return loadValue<int32_t>(bytes, swapBytes);
+    case PlyType::Uint32: return loadValue<uint32_t>(bytes, swapBytes);
+    case PlyType::Float32: return loadValue<float>(bytes, swapBytes);
+    case PlyType::Float64: return loadValue<double>(bytes, swapBytes);
+    }
+    return 0.0;
+}
+
+struct PlyProperty {
+    std::string name;
+    PlyType type{PlyType::Float32};
+    bool isList{false};
+    PlyType countType{PlyType::Uint8};
+};
+
+struct PlyElement {
+    std::string name;
+    uint64_t count{0};
+    std::vector<PlyProperty> properties;
+
+    // Bytes per item in binary files; 0 when items have lists and vary in size
+    [[nodiscard]] auto getStride() const -> uint32_t {
+        uint32_t stride = 0;
+        for (const PlyProperty& property : properties) {
+            if (property.isList) {
+                return 0;
+            }
+            stride += getPlyTypeSize(property.type);
+        }
+        return stride;
+    }
+
+    [[nodiscard]] auto findProperty(std::initializer_list<std::string_view> names) const
+        -> int32_t {
+        for (std::string_view name : names) {
+            for (size_t i = 0; i < properties.size(); ++i) {
+                if (properties[i].name == name) {
+                    return static_cast<int32_t>(i);
+                }
+            }
+        }
+        return -1;
+    }
+};
+
+enum class PlyEncoding : uint8_t { Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+struct PlyHeader {
+    PlyEncoding encoding{PlyEncoding::Ascii};
+    std::vector<PlyElement> elements;
+    size_t dataOffset{0};
+};
+
+auto parsePlyHeader(const std::filesystem::path& path, std::string_view text)
+    -> Result<PlyHeader> {
+    auto fail = [&](uint64_t line, std::string_view reason) {
+        return std::unexpected(makeError(
+            ErrorCode::FileParseFailed,
+            std::format("{}:{}: {}", path.string(), line + 1, reason)
+        ));
+    };
+
+    PlyHeader header;
+    bool hasFormat = false;
+    const char* end = text.data() + text.size();
+    const char* line = text.data();
+    for (uint64_t lineIndex = 0; line != end; ++lineIndex) {
+        const char* lineEnd = findLineEnd(line, end);
+        std::vector<std::string_view> tokens;
+        for (const char* it = skipSpaces(line, lineEnd); it != lineEnd;
+             it = skipSpaces(it, lineEnd)) {
+            const char* tokenEnd = skipToken(it, lineEnd);
+            tokens.emplace_back(it, static_cast<size_t>(tokenEnd - it));
+            it = tokenEnd;
+        }
+        line = lineEnd == end ? end : lineEnd + 1;
+
+        if (lineIndex == 0) {
+            if (tokens.size() != 1 || tokens[0] != "ply") {
+                return fail(lineIndex, "not a PLY file");
+            }
+            continue;
+        }
+        if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info") {
+            continue;
+        }
+
+        if (tokens[0] == "end_header") {
+            if (!hasFormat) {
+                return fail(lineIndex, "missing format");
+            }
+            header.dataOffset = static_cast<size_t>(line - text.data());
+            return header;
+        }
+        if (tokens[0] == "format" && tokens.size() == 3) {
+            if (tokens[1] == "ascii") {
+                header.encoding = PlyEncoding::Ascii;
+            } else if (tokens[1] == "binary_little_endian") {
+                header.encoding = PlyEncoding::BinaryLittleEndian;
+            } else if (tokens[1] == "binary_big_endian") {
+                header.encoding = PlyEncoding::BinaryBigEndian;
+            } else {
+                return fail(lineIndex, std::format("unknown format {}", tokens[1]));
+            }
+            hasFormat = true;
+        } else if (tokens[0] == "element" && tokens.size() == 3) {
+            PlyElement& element = header.elements.emplace_back();
+            element.name = tokens[1];
+            auto [ptr, ec] = std::from_chars(tokens[2].data(),
+                                             tokens[2].data() + tokens[2].size(), element.count);
+            if (ec != std::errc{}) {
+                return fail(lineIndex, "invalid element count");
+            }
+        } else if (tokens[0] == "property" && !header.elements.empty()) {
+            PlyProperty property;
+            std::optional<PlyType> type;
+            std::optional<PlyType> countType = PlyType::Uint8;
+            if (tokens.size() == 5 && tokens[1] == "list") {
+                property.isList = true;
+                countType = parsePlyType(tokens[2]);
+                type = parsePlyType(tokens[3]);
+                property.name = tokens[4];
+            } else if (tokens.size() == 3) {
+                type = parsePlyType(tokens[1]);
+                property.name = tokens[2];
+            }
+            if (!type || !countType) {
+                return fail(lineIndex, "invalid property");
+            }
+            property.type = *type;
+            property.countType = *countType;
+            header.elements.back().properties.push_back(std::move(property));
+        } else {
+            return fail(lineIndex, "unexpected header line");
+        }
+    }
+    return fail(0, "missing end_header");
+}
+
+// Where the properties the mesh needs are among a vertex element's properties
+struct PlyVertexLayout {
+    std::array<int32_t, 3> position{-1, -1, -1};
+    std::array<int32_t, 3> normal{-1, -1, -1};
+    std::array<int32_t, 2> uv{-1, -1};
+
+    [[nodiscard]] auto hasNormals() const noexcept -> bool {
+        return normal[0] >= 0 && normal[1] >= 0 && normal[2] >= 0;
+    }
+    [[nodiscard]] auto hasUvs() const noexcept -> bool { return uv[0] >= 0 && uv[1] >= 0; }
+};
+
+auto getPlyVertexLayout(const PlyElement& vertices) -> PlyVertexLayout {
+    PlyVertexLayout layout;
+    layout.position = {vertices.findProperty({"x"}), vertices.findProperty({"y"}),
+                       vertices.findProperty({"z"})};
+    layout.normal = {vertices.findProperty({"nx"}), vertices.findProperty({"ny"}),
+                     vertices.findProperty({"nz"})};
+    layout.uv = {vertices.findProperty({"u", "s", "texture_u", "texture_s"}),
+                 vertices.findProperty({"v", "t", "texture_v", "texture_t"})};
+    return layout;
+}
+
+// Stores the values of one vertex, given per property of the element
+template<typename Values>
+void storePlyVertex(const PlyVertexLayout& layout, const Values& values, MeshData& mesh,
+                    size_t vertex) {
+    mesh.positions[vertex] = {static_cast<float>(values[layout.position[0]]),
+                              static_cast<float>(values[layout.position[1]]),
+                              static_cast<float>(values[layout.position[2]])};
+    if (!mesh.normals.empty()) {
+        mesh.normals[vertex] = {static_cast<float>(values[layout.normal[0]]),
+                                static_cast<float>(values[layout.normal[1]]),
+                                static_cast<float>(values[layout.normal[2]])};
+    }
+    if (!mesh.uvs.empty()) {
+        mesh.uvs[vertex] = {static_cast<float>(values[layout.uv[0]]),
+                            static_cast<float>(values[layout.uv[1]])};
+    }
+}
+
+// A face element holds the vertex index list, possibly among scalar properties
+struct PlyFaceLayout {
+    int32_t list{-1};
+    uint32_t bytesBefore{0}; // Binary size of the scalar properties before the list
+    uint32_t bytesAfter{0};
+    bool scalarsOnly{true};  // Every other property is a scalar
+};
+
+auto getPlyFaceLayout(const PlyElement& faces) -> PlyFaceLayout {
+    PlyFaceLayout layout;
+    layout.list = faces.findProperty({"vertex_indices", "vertex_index"});
+    for (int32_t i = 0; i < static_cast<int32_t>(faces.properties.size()); ++i) {
+        const PlyProperty& property = faces.properties[i];
+        if (i == layout.list) {
+            continue;
+        }
+        layout.scalarsOnly &= !property.isList;
+        (i < layout.list ? layout.bytesBefore : layout.bytesAfter) += getPlyTypeSize(property.type);
+    }
+    return layout;
+}
+
+// Bytes of a binary element's data starting at it; nothing if it runs past end
+auto measurePlyElement(const PlyElement& element, const uint8_t* it, const uint8_t* end,
+                       bool swapBytes) -> std::optional<uint64_t> {
+    if (const uint32_t stride = element.getStride(); stride != 0 || element.properties.empty()) {
+        const uint64_t size = element.count * stride;
+        return size <= static_cast<uint64_t>(end - it) ? std::optional(size) : std::nullopt;
+    }
+    const uint8_t* begin = it;
+    for (uint64_t item = 0; item < element.count; ++item) {
+        for (const PlyProperty& property : element.properties) {
+            uint64_t size = getPlyTypeSize(property.type);
+            if (property.isList) {
+                const uint32_t countSize = getPlyTypeSize(property.countType);
+                if (static_cast<uint64_t>(end - it) < countSize) {
+                    return std::nullopt;
+                }
+                size *= static_cast<uint64_t>(readPlyValue(it, property.countType, swapBytes));
+                it += countSize;
+            }
+            if (static_cast<uint64_t>(end - it) < size) {
+                return std::nullopt;
+            }
+            it += size;
+        }
+    }
+    return static_cast<uint64_t>(it - begin);
+}
+
+auto plyTruncated(const std::filesystem::path& path, std::string_view element) -> Error {
+    return makeError(
+        ErrorCode::FileParseFailed,
+        std::format("{}: {} data is truncated", path.string(), element)
+    );
+}
+
+auto plyIndexOutOfRange(const std::filesystem::path& path) -> Error {
+    return makeError(
+        ErrorCode::FileParseFailed,
+        std::format("{}: face index out of range", path.string())
+    );
+}
+
+auto importBinaryPly(const std::filesystem::path& path, const PlyHeader& header,
+                     std::span<const uint8_t> data, JobSystem* jobSystem, MeshData& mesh)
+    -> VoidResult {
+    const bool swapBytes = (header.encoding == PlyEncoding::BinaryBigEndian) !=
+                           (std::endian::native == std::endian::big);
+    const uint8_t* it = data.data();
+    const uint8_t* end = data.data() + data.size();
+
+    for (size_t elementIndex = 0; elementIndex < header.elements.size(); ++elementIndex) {
+        const PlyElement& element = header.elements[elementIndex];
+
+        if (element.name == "vertex") {
+            ZoneScopedN("Vertices");
+            const uint32_t stride = element.getStride();
+            if (stride == 0) {
+                return std::unexpected(makeError(
+                    ErrorCode::FileParseFailed,
+                    std::format("{}: list properties on vertices are not supported",
+                                path.string())
+                ));
+            }
+            if (element.count * stride > static_cast<uint64_t>(end - it)) {
+                return std::unexpected(plyTruncated(path, "vertex"));
+            }
+
+            std::vector<uint32_t> offsets(element.properties.size(), 0);
+            for (size_t i = 1; i < offsets.size(); ++i) {
+                offsets[i] = offsets[i - 1] + getPlyTypeSize(element.properties[i - 1].type);
+            }
+            const PlyVertexLayout layout = getPlyVertexLayout(element);
+            const uint8_t* vertices = it;
+            // Each vertex reads only the properties the mesh keeps
+            struct Reader {
+                const uint8_t* item;
+                std::span<const uint32_t> offsets;
+                std::span<const PlyProperty> properties;
+                bool swapBytes;
+                auto operator[](int32_t property) const -> double {
+                    return readPlyValue(item + offsets[property], properties[property].type,
+                                        swapBytes);
+                }
+            };
+            parallelFor(jobSystem,
+                        static_cast<uint32_t>((element.count + kBinaryBatchSize - 1) /
+                                              kBinaryBatchSize),
+                        1, [&](uint32_t batch) {
+                const uint64_t begin = batch * kBinaryBatchSize;
+                const uint64_t batchEnd = std::min(begin + kBinaryBatchSize, element.count);
+                for (uint64_t vertex = begin; vertex < batchEnd; ++vertex) {
+                    const Reader reader{vertices + vertex * stride, offsets, element.properties,
+                                        swapBytes};
+                    storePlyVertex(layout, reader, mesh, vertex);
+                }
+            });
+            it += element.count * stride;
+            continue;
+        }
+
+        if (element.name != "face") {
+            const auto size = measurePlyElement(element, it, end, swapBytes);
+            if (!size) {
+                return std::unexpected(plyTruncated(path, element.name));
+            }
+            it += *size;
+            continue;
+        }
+
+        ZoneScopedN("Faces");
+        const PlyFaceLayout layout = getPlyFaceLayout(element);
+        const PlyProperty& list = element.properties[layout.list];
+        const uint32_t countSize = getPlyTypeSize(list.countType);
+        const uint32_t indexSize = getPlyTypeSize(list.type);
+        const uint64_t vertexCount = mesh.positions.size();
+
+        // Scans are triangulated already. When the bytes left add up to triangles exactly,
+        // faces have a fixed size and are parsed in parallel; every face still checks its
+        // count, and a file that only looked like that is parsed sequentially instead.
+        const uint64_t triangleStride =
+            layout.bytesBefore + countSize + 3ull * indexSize + layout.bytesAfter;
+        uint64_t bytesAfterFaces = 0;
+        bool fixedSizeAfter = true;
+        for (size_t next = elementIndex + 1; next < header.elements.size(); ++next) {
+            const uint32_t stride = header.elements[next].getStride();
+            fixedSizeAfter &= stride != 0 || header.elements[next].properties.empty();
+            bytesAfterFaces += header.elements[next].count * stride;
+        }
+        bool parsed = false;
+        if (layout.scalarsOnly && fixedSizeAfter &&
+            element.count * triangleStride + bytesAfterFaces == static_cast<uint64_t>(end - it)) {
+            mesh.indices.resize(element.count * 3);
+            std::atomic<bool> notTriangles{false};
+            std::atomic<bool> outOfRange{false};
+            const uint8_t* faces = it;
+            parallelFor(jobSystem,
+                        static_cast<uint32_t>((element.count + kBinaryBatchSize - 1) /
+                                              kBinaryBatchSize),
+                        1, [&](uint32_t batch) {
+                const uint64_t begin = batch * kBinaryBatchSize;
+                const uint64_t batchEnd = std::min(begin + kBinaryBatchSize, element.count);
+                for (uint64_t face = begin; face < batchEnd; ++face) {
+                    const uint8_t* item = faces + face * triangleStride + layout.bytesBefore;
+                    if (readPlyValue(item, list.countType, swapBytes) != 3.0) {
+                        notTriangles.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                    item += countSize;
+                    for (uint32_t corner = 0; corner < 3; ++corner) {
+                        const double index =
+                            readPlyValue(item + corner * indexSize, list.type, swapBytes);
+                        if (index < 0.0 || index >= static_cast<double>(vertexCount)) {
+                            outOfRange.store(true, std::memory_order_relaxed);
+                            return;
+                        }
+                        mesh.indices[face * 3 + corner] = static_cast<uint32_t>(index);
+                    }
+                }
+            });
+            if (outOfRange.load() && !notTriangles.load()) {
+                return std::unexpected(plyIndexOutOfRange(path));
+            }
+            parsed = !notTriangles.load();
+            if (parsed) {
+                it += element.count * triangleStride;
+            }
+        }
+
+        if (!parsed) {
+            mesh.indices.clear();
+            mesh.indices.reserve(element.count * 3);
+            for (uint64_t face = 0; face < element.count; ++face) {
+                for (int32_t i = 0; i < static_cast<int32_t>(element.properties.size()); ++i) {
+                    const PlyProperty& property = element.properties[i];
+                    if (!property.isList) {
+                        if (static_cast<uint64_t>(end - it) < getPlyTypeSize(property.type)) {
+                            return std::unexpected(plyTruncated(path, "face"));
+                        }
+                        it += getPlyTypeSize(property.type);
+                        continue;
+                    }
+                    const uint32_t size = getPlyTypeSize(property.type);
+                    if (static_cast<uint64_t>(end - it) < getPlyTypeSize(property.countType)) {
+                        return std::unexpected(plyTruncated(path, "face"));
+                    }
+                    const auto count =
+                        static_cast<uint64_t>(readPlyValue(it, property.countType, swapBytes));
+                    it += getPlyTypeSize(property.countType);
+                    if (static_cast<uint64_t>(end - it) < count * size) {
+                        return std::unexpected(plyTruncated(path, "face"));
+                    }
+                    if (i == layout.list) {
+                        std::array<uint32_t, 2> fan{};
+                        for (uint64_t corner = 0; corner < count; ++corner) {
+                            const double index =
+                                readPlyValue(it + corner * size, property.type, swapBytes);
+                            if (index < 0.0 || index >= static_cast<double>(vertexCount)) {
+                                return std::unexpected(plyIndexOutOfRange(path));
+                            }
+                            const auto vertex = static_cast<uint32_t>(index);
+                            if (corner >= 2) {
+                                mesh.indices.insert(mesh.indices.end(), {fan[0], fan[1], vertex});
+                            }
+                            fan[corner == 0 ? 0 : 1] = vertex;
+                        }
+                    }
+                    it += count * size;
+                }
+            }
+        }
+    }
+    return {};
+}
+
+auto importAsciiPly(const std::filesystem::path& path, const PlyHeader& header,
+                    std::string_view text, JobSystem* jobSystem,
+                    const MeshImportConfig& config, MeshData& mesh) -> VoidResult {
+    // Every line is one item, so the line numbers where chunks start tell which element each
+    // line belongs to
+    const std::vector<TextChunk> chunks = splitLines(text, config.chunkSize);
+    const auto chunkCount = static_cast<uint32_t>(chunks.size());
+    std::vector<uint64_t> lineCounts(chunkCount);
+    parallelFor(jobSystem, chunkCount, 1, [&](uint32_t chunk) {
+        const TextChunk& range = chunks[chunk];
+        lineCounts[chunk] = static_cast<uint64_t>(std::count(range.begin, range.end, '\n')) +
+                            (range.end[-1] != '\n');
+    });
+    const std::vector<uint64_t> firstLines = prefixLines(lineCounts);
+
+    struct ElementLines {
+        const PlyElement* element{nullptr};
+        uint64_t firstLine{0};
+    };
+    ElementLines vertices;
+    ElementLines faces;
+    uint64_t lineCount = 0;
+    for (const PlyElement& element : header.elements) {
+        if (element.name == "vertex") {
+            vertices = {&element, lineCount};
+        } else if (element.name == "face") {
+            faces = {&element, lineCount};
+        }
+        lineCount += element.count;
+    }
+    if (lineCount > firstLines.back()) {
+        return std::unexpected(plyTruncated(path, "element"));
+    }
+
+    const PlyVertexLayout vertexLayout = getPlyVertexLayout(*vertices.element);
+    const PlyFaceLayout faceLayout =
+        faces.element != nullptr ? getPlyFaceLayout(*faces.element) : PlyFaceLayout{};
+    auto isVertexLine = [&](uint64_t line) {
+        return line - vertices.firstLine < vertices.element->count;
+    };
+    auto isFaceLine = [&](uint64_t line) {
+        return faces.element != nullptr && line - faces.firstLine < faces.element->count;
+    };
+
+    // Counts the triangles of each chunk's faces in the first pass and writes vertices and
+    // triangles in the second
+    std::vector<uint64_t> triangleCounts(chunkCount, 0);
+    std::vector<uint64_t> firstTriangles(chunkCount, 0);
+    std::vector<std::optional<ChunkError>> errors(chunkCount);
+    auto pass = [&](uint32_t chunk, bool write) -> std::optional<ChunkError> {
+        uint64_t triangle = firstTriangles[chunk];
+        std::array<double, 64> values{};
+        const char* line = chunks[chunk].begin;
+        const char* end = chunks[chunk].end;
+        for (uint64_t lineIndex = 0; line != end; ++lineIndex) {
+            const char* lineEnd = findLineEnd(line, end);
+            const char* it = line;
+            line = lineEnd == end ? end : lineEnd + 1;
+            const uint64_t globalLine = firstLines[chunk] + lineIndex;
+
+            if (write && isVertexLine(globalLine)) {
+                const auto& properties = vertices.element->properties;
+                for (size_t i = 0; i < properties.size() && i < values.size(); ++i) {
+                    if (!parseNumber(it, lineEnd, values[i])) {
+                        return ChunkError{lineIndex, "malformed vertex"};
+                    }
+                }
+                storePlyVertex(vertexLayout, values, mesh, globalLine - vertices.firstLine);
+            } else if (isFaceLine(globalLine)) {
+                for (int32_t i = 0; i < faceLayout.list; ++i) {
+                    it = skipToken(skipSpaces(it, lineEnd), lineEnd);
+                }
+                uint64_t count = 0;
+                if (!parseNumber(it, lineEnd, count)) {
+                    return ChunkError{lineIndex, "malformed face"};
+                }
+                if (!write) {
+                    triangle += count >= 3 ? count - 2 : 0;
+                    continue;
+                }
+                std::array<uint32_t, 2> fan{};
+                for (uint64_t corner = 0; corner < count; ++corner) {
+                    uint32_t vertex = 0;
+                    if (!parseNumber(it, lineEnd, vertex) || vertex >= mesh.positions.size()) {
+                        return ChunkError{lineIndex, "malformed face or index out of range"};
+                    }
+                    if (corner >= 2) {
+                        uint32_t* indices = mesh.indices.data() + triangle++ * 3;
+                        indices[0] = fan[0];
+                        indices[1] = fan[1];
+                        indices[2] = vertex;
+                    }
+                    fan[corner == 0 ? 0 : 1] = vertex;
+                }
+            }
+        }
+        if (!write) {
+            triangleCounts[chunk] = triangle - firstTriangles[chunk];
+        }
+        return std::nullopt;
+    };
+
+    if (vertices.element->properties.size() > 64) {
+        return std::unexpected(makeError(
+            ErrorCode::FileParseFailed,
+            std::format("{}: too many vertex properties", path.string())
+        ));
+    }
+    for (const bool write : {false, true}) {
+        parallelFor(jobSystem, chunkCount, 1, [&](uint32_t chunk) {
+            errors[chunk] = pass(chunk, write);
+        });
+        if (auto error = firstChunkError(path, errors, firstLines)) {
+            return std::unexpected(*error);
+        }
+        if (!write) {
+            uint64_t triangles = 0;
+            for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+                firstTriangles[chunk] = triangles;
+                triangles += triangleCounts[chunk];
+            }
+            mesh.indices.resize(triangles * 3);
+        }
+    }
+    return {};
+}
+
+auto importPly(const std::filesystem::path& path, std::span<const uint8_t> data,
+               JobSystem* jobSystem, const MeshImportConfig& config) -> Result<MeshData> {
+    ZoneScoped;
+    const std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+    auto header = parsePlyHeader(path, text);
+    if (!header) {
+        return std::unexpected(header.error());
+    }
+
+    auto vertices = std::ranges::find(header->elements, "vertex", &PlyElement::name);
+    auto faces = std::ranges::find(header->elements, "face", &PlyElement::name);
+    if (vertices == header->elements.end() || faces == header->elements.end()) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            std::format("{} has no vertex or no face element", path.string())
+        ));
+    }
+    const PlyVertexLayout layout = getPlyVertexLayout(*vertices);
+    const PlyFaceLayout faceLayout = getPlyFaceLayout(*faces);
+    if (std::ranges::find(layout.position, -1) != layout.position.end() ||
+        faceLayout.list < 0 || !faces->properties[faceLayout.list].isList) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            std::format("{} lacks vertex positions or face vertex indices", path.string())
+        ));
+    }
+    if (vertices->count > kMaxVertexCount) {
+        return std::unexpected(tooManyVertices(path, vertices->count));
+    }
+
+    MeshData mesh;
+    mesh.positions.resize(vertices->count);
+    mesh.normals.resize(layout.hasNormals() ? vertices->count : 0);
+    mesh.uvs.resize(layout.hasUvs() ? vertices->count : 0);
+
+    const VoidResult result =
+        header->encoding == PlyEncoding::Ascii
+            ? importAsciiPly(path, *header, text.substr(header->dataOffset), jobSystem, config,
+                             mesh)
+            : importBinaryPly(path, *header, data.subspan(header->dataOffset), jobSystem, mesh);
+    if (!result) {
+        return std::unexpected(result.error());
+    }
+    return mesh;
+}
+
+// ---------------------------------------------------------------------------------------------
+// glTF
+
+constexpr uint32_t kGlbMagic = 0x46546C67; // "glTF"
+constexpr uint32_t kGlbJsonChunk = 0x4E4F534A;
+constexpr uint32_t kGlbBinaryChunk = 0x004E4942;
+
+constexpr uint32_t kGltfByte = 5120;
+constexpr uint32_t kGltfUnsignedByte = 5121;
+constexpr uint32_t kGltfShort = 5122;
+constexpr uint32_t kGltfUnsignedShort = 5123;
+constexpr uint32_t kGltfUnsignedInt = 5125;
+constexpr uint32_t kGltfFloat = 5126;
+constexpr uint64_t kGltfTriangles = 4;
+
+// Guards against cyclic node hierarchies
+constexpr uint32_t kMaxNodeDepth = 64;
+
+auto gltfError(const std::filesystem::path& path, std::string_view reason) -> Error {
+    return makeError(ErrorCode::FileParseFailed, std::format("{}: {}", path.string(), reason));
+}
+
+auto getGltfComponentSize(uint64_t componentType) -> uint32_t {
+    switch (componentType) {
+    case kGltfByte:
+    case kGltfUnsignedByte:
+        return 1;
+    case kGltfShort:
+    case kGltfUnsignedShort:
+        return 2;
+    case kGltfUnsignedInt:
+    case kGltfFloat:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+auto getGltfComponentCount(std::string_view type) -> uint32_t {
+    if (type == "SCALAR") {
+        return 1;
+    }
+    if (type.size() == 4 && type.starts_with("VEC") && type[3] >= '2' && type[3] <= '4') {
+        return static_cast<uint32_t>(type[3] - '0');
+    }
+    return 0;
+}
+
+// Typed, strided view of an accessor's elements inside a buffer
+struct GltfAccessor {
+    const uint8_t* data{nullptr};
+    uint64_t count{0};
+    uint32_t stride{0};
+    uint32_t componentType{0};
+    uint32_t componentCount{0};
+    bool normalized{false};
+
+    [[nodiscard]] auto isValid() const noexcept -> bool { return data != nullptr; }
+
+    // glTF data is little-endian, like every platform the cooker runs on
+    [[nodiscard]] auto read(uint64_t element, uint32_t component) const noexcept -> float {
+        const uint8_t* bytes =
+            data + element * stride + component * getGltfComponentSize(componentType);
+        switch (componentType) {
+        case kGltfFloat:
+            return loadValue<float>(bytes, false);
+        case kGltfUnsignedByte:
+            return normalized ? bytes[0] / 255.0f : bytes[0];
+        case kGltfUnsignedShort: {
+            const auto value = loadValue<uint16_t>(bytes, false);
+            return normalized ? value / 65535.0f : value;
+        }
+        case kGltfByte: {
+            const auto value = static_cast<float>(loadValue<int8_t>(bytes, false));
+            return normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case kGltfShort: {
+            const auto value = static_cast<float>(loadValue<int16_t>(bytes, false));
+            return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+        }
+        default:
+            return static_cast<float>(loadValue<uint32_t>(bytes, false));
+        }
+    }
+
+    [[nodiscard]] auto readIndex(uint64_t element) const noexcept -> uint32_t {
+        const uint8_t* bytes = data + element * stride;
+        switch (componentType) {
+        case kGltfUnsignedByte:
+            return bytes[0];
+        case kGltfUnsignedShort:
+            return loadValue<uint16_t>(bytes, false);
+        default:
+            return loadValue<uint32_t>(bytes, false);
+        }
+    }
+};
+
+// The JSON and every buffer it refers to, kept mapped or decoded for the parse
+struct GltfDocument {
+    JsonValue json;
+    std::vector<std::span<const uint8_t>> buffers;
+    std::vector<MappedFile> bufferFiles;
+    std::vector<std::vector<uint8_t>> decodedBuffers;
+    uint64_t externalBytes{0};
+};
+
+auto decodeBase64(std::string_view text) -> std::optional<std::vector<uint8_t>> {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(text.size() / 4 * 3);
+    uint32_t accumulator = 0;
+    uint32_t bits = 0;
+    for (char c : text) {
+        uint32_t value = 0;
+        if (c >= 'A' && c <= 'Z') {
+            value = static_cast<uint32_t>(c - 'A');
+        } else if (c >= 'a' && c <= 'z') {
+            value = static_cast<uint32_t>(c - 'a' + 26);
+        } else if (c >= '0' && c <= '9') {
+            value = static_cast<uint32_t>(c - '0' + 52);
+        } else if (c == '+') {
+            value = 62;
+        } else if (c == '/') {
+            value = 63;
+        } else if (c == '=') {
+            break;
+        } else {
+            return std::nullopt;
+        }
+        accumulator = (accumulator << 6) | value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            bytes.push_back(static_cast<uint8_t>(accumulator >> bits));
+        }
+    }
+    return bytes;
+}
+
+// Relative URIs may escape characters as %XX
+auto decodeUri(std::string_view uri) -> std::string {
+    std::string decoded;
+    for (size_t i = 0; i < uri.size(); ++i) {
+        uint8_t value = 0;
+        if (uri[i] == '%' && i + 2 < uri.size() &&
+            std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ptr ==
+                uri.data() + i + 3) {
+            decoded += static_cast<char>(value);
+            i += 2;
+        } else {
+            decoded += uri[i];
+        }
+    }
+    return decoded;
+}
+
+struct GltfChunks {
+    std::string_view json;
+    std::span<const uint8_t> binary;
+};
+
+// A .gltf is all JSON; a .glb has a header, then a JSON chunk and an optional binary chunk,
+// each with length and type
+auto splitGltfChunks(const std::filesystem::path& path, std::span<const uint8_t> data)
+    -> Result<GltfChunks> {
+    GltfChunks chunks{{reinterpret_cast<const char*>(data.data()), data.size()}, {}};
+    if (data.size() < 12 || loadValue<uint32_t>(data.data(), false) != kGlbMagic) {
+        return chunks;
+    }
+
+    const uint64_t length = std::min<uint64_t>(loadValue<uint32_t>(data.data() + 8, false),
+                                               data.size());
+    uint64_t offset = 12;
+    while (offset + 8 <= length) {
+        const uint32_t chunkLength = loadValue<uint32_t>(data.data() + offset, false);
+        const uint32_t chunkType = loadValue<uint32_t>(data.data() + offset + 4, false);
+        offset += 8;
+        if (chunkLength > length - offset) {
+            return std::unexpected(gltfError(path, "truncated GLB chunk"));
+        }
+        if (chunkType == kGlbJsonChunk) {
+            chunks.json = {reinterpret_cast<const char*>(data.data() + offset), chunkLength};
+        } else if (chunkType == kGlbBinaryChunk && chunks.binary.empty()) {
+            chunks.binary = data.subspan(offset, chunkLength);
+        }
+        offset += (chunkLength + 3) & ~3u;
+    }
+    return chunks;
+}
+
+auto isExternalUri(std::string_view uri) -> bool {
+    return !uri.starts_with("data:");
+}
+
+auto loadGltfDocument(const std::filesystem::path& path, std::span<const uint8_t> data)
+    -> Result<GltfDocument> {
+    ZoneScoped;
+    GltfDocument document;
+    auto chunks = splitGltfChunks(path, data);
+    if (!chunks) {
+        return std::unexpected(chunks.error());
+    }
+    const std::span<const uint8_t> binaryChunk = chunks->binary;
+
+    auto json = JsonValue::parse(chunks->json);
+    if (!json) {
+        return std::unexpected(gltfError(path, json.error().toString()));
+    }
+    document.json = std::move(*json);
+
+    const JsonValue& buffers = document.json["buffers"];
+    document.buffers.resize(buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        const JsonValue& buffer = buffers[i];
+        const uint64_t byteLength = buffer["byteLength"].asUint();
+        if (!buffer.contains("uri")) {
+            // The GLB binary chunk, padded to four bytes
+            if (i != 0 || binaryChunk.size() < byteLength) {
+                return std::unexpected(gltfError(path, "buffer without data"));
+            }
+            document.buffers[i] = binaryChunk.first(byteLength);
+            continue;
+        }
+
+        const std::string_view uri = buffer["uri"].asString();
+        if (!isExternalUri(uri)) {
+            const size_t comma = uri.find(',');
+            auto bytes = comma != std::string_view::npos &&
+                                 uri.substr(0, comma).ends_with(";base64")
+                             ? decodeBase64(uri.substr(comma + 1))
+                             : std::nullopt;
+            if (!bytes || bytes->size() < byteLength) {
+                return std::unexpected(gltfError(path, "invalid data URI"));
+            }
+            document.buffers[i] = std::span(*bytes).first(byteLength);
+            document.decodedBuffers.push_back(std::move(*bytes));
+            continue;
+        }
+
+        auto file = MappedFile::open(path.parent_path() / decodeUri(uri));
+        if (!file) {
+            return std::unexpected(file.error());
+        }
+        if (file->getSize() < byteLength) {
+            return std::unexpected(gltfError(path, std::format("buffer {} is truncated", uri)));
+        }
+        file->prefetch(0, byteLength);
+        document.buffers[i] = file->getData().first(byteLength);
+        document.externalBytes += byteLength;
+        document.bufferFiles.push_back(std::move(*file));
+    }
+    return document;
+}
+
+auto resolveGltfAccessor(const std::filesystem::path& path, const GltfDocument& document,
+                         const JsonValue& index) -> Result<GltfAccessor> {
+    const JsonValue& accessor = document.json["accessors"][index.asUint(~0ull)];
+    const JsonValue& view = document.json["bufferViews"][accessor["bufferView"].asUint(~0ull)];
+    if (!accessor.isObject() || !view.isObject() || accessor.contains("sparse")) {
+        return std::unexpected(gltfError(path, "missing, sparse or bufferless accessor"));
+    }
+
+    GltfAccessor result;
+    result.count = accessor["count"].asUint();
+    result.componentType = static_cast<uint32_t>(accessor["componentType"].asUint());
+    result.componentCount = getGltfComponentCount(accessor["type"].asString());
+    result.normalized = accessor["normalized"].asBool();
+    const uint32_t elementSize = getGltfComponentSize(result.componentType) *
+                                 result.componentCount;
+    result.stride = static_cast<uint32_t>(view["byteStride"].asUint(elementSize));
+    if (elementSize == 0 || result.stride < elementSize) {
+        return std::unexpected(gltfError(path, "unsupported accessor type"));
+    }
+
+    const uint64_t bufferIndex = view["buffer"].asUint(~0ull);
+    const uint64_t viewOffset = view["byteOffset"].asUint();
+    const uint64_t viewLength = view["byteLength"].asUint();
+    const uint64_t accessorOffset = accessor["byteOffset"].asUint();
+    const uint64_t accessorSize =
+        result.count == 0 ? 0 : (result.count - 1) * result.stride + elementSize;
+    if (bufferIndex >= document.buffers.size() ||
+        viewOffset + viewLength > document.buffers[bufferIndex].size() ||
+        accessorOffset + accessorSize > viewLength) {
+        return std::unexpected(gltfError(path, "accessor out of buffer bounds"));
+    }
+    result.data = document.buffers[bufferIndex].data() + viewOffset + accessorOffset;
+    return result;
+}
+
+// One primitive of a mesh instance, with where its vertices and indices go in the output
+struct GltfPrimitive {
+    GltfAccessor positions;
+    GltfAccessor normals;
+    GltfAccessor uvs;
+    GltfAccessor indices; // Invalid for non-indexed primitives
+    glm::mat4 transform{1.0f};
+    // Cofactors of the transform's upper 3x3, which transform normals without an inverse
+    std::array<glm::vec3, 3> normalTransform{};
+    bool flipWinding{false}; // Mirroring transforms turn triangles inside out
+    bool identity{true};     // Data is copied untouched
+    uint64_t firstVertex{0};
+    uint64_t firstIndex{0};
+
+    [[nodiscard]] auto getIndexCount() const noexcept -> uint64_t {
+        return indices.isValid() ? indices.count : positions.count;
+    }
+};
+
+auto getGltfNodeTransform(const JsonValue& node) -> glm::mat4 {
+    glm::mat4 transform(1.0f);
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.size() == 16) {
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                transform[column][row] = static_cast<float>(matrix[column * 4 + row].asNumber());
+            }
+        }
+        return transform;
+    }
+
+    // T * R * S, with the rotation as a unit quaternion (x, y, z, w)
+    const JsonValue& t = node["translation"];
+    const JsonValue& r = node["rotation"];
+    const JsonValue& s = node["scale"];
+    const float x = static_cast<float>(r[0].asNumber(0.0));
+    const float y = static_cast<float>(r[1].asNumber(0.0));
+    const float z = static_cast<float>(r[2].asNumber(0.0));
+    const float w = static_cast<float>(r[3].asNumber(1.0));
+    const std::array<glm::vec3, 3> rotation{
+        glm::vec3{1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y)},
+        glm::vec3{2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x)},
+        glm::vec3{2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y)},
+    };
+    for (int column = 0; column < 3; ++column) {
+        transform[column] =
+            glm::vec4(rotation[column] * static_cast<float>(s[column].asNumber(1.0)), 0.0f);
+    }
+    transform[3] = glm::vec4(static_cast<float>(t[0].asNumber()),
+                             static_cast<float>(t[1].asNumber()),
+                             static_cast<float>(t[2].asNumber()), 1.0f);
+    return transform;
+}
+
+void collectGltfInstances(const JsonValue& json, uint64_t nodeIndex,
+                          const glm::mat4& parentTransform, uint32_t depth,
+                          std::vector<std::pair<uint64_t, glm::mat4>>& instances) {
+    const JsonValue& node = json["nodes"][nodeIndex];
+    if (!node.isObject() || depth > kMaxNodeDepth) {
+        return;
+    }
+    const glm::mat4 transform = parentTransform * getGltfNodeTransform(node);
+    if (node.contains("mesh")) {
+        instances.emplace_back(node["mesh"].asUint(), transform);
+    }
+    const JsonValue& children = node["children"];
+    for (size_t i = 0; i < children.size(); ++i) {
+        collectGltfInstances(json, children[i].asUint(~0ull), transform, depth + 1, instances);
+    }
+}
+
+auto importGltf(const std::filesystem::path& path, std::span<const uint8_t> data,
+                JobSystem* jobSystem, uint64_t& externalBytes) -> Result<MeshData> {
+    ZoneScoped;
+    auto document = loadGltfDocument(path, data);
+    if (!document) {
+        return std::unexpected(document.error());
+    }
+    const JsonValue& json = document->json;
+    externalBytes = document->externalBytes;
+
+    // Meshes placed by the default scene; files without scenes list meshes on their own
+    std::vector<std::pair<uint64_t, glm::mat4>> instances;
+    const JsonValue& scene = json["scenes"][json["scene"].asUint(0)];
+    if (scene.isObject()) {
+        const JsonValue& roots = scene["nodes"];
+        for (size_t i = 0; i < roots.size(); ++i) {
+            collectGltfInstances(json, roots[i].asUint(~0ull), glm::mat4(1.0f), 0, instances);
+        }
+    } else {
+        for (size_t mesh = 0; mesh < json["meshes"].size(); ++mesh) {
+            instances.emplace_back(mesh, glm::mat4(1.0f));
+        }
+    }
+
+    std::vector<GltfPrimitive> primitives;
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    bool allNormals = true;
+    bool allUvs = true;
+    size_t skipped = 0;
+    for (const auto& [meshIndex, transform] : instances) {
+        const JsonValue& meshPrimitives = json["meshes"][meshIndex]["primitives"];
+        for (size_t i = 0; i < meshPrimitives.size(); ++i) {
+            const JsonValue& primitive = meshPrimitives[i];
+            const JsonValue& attributes = primitive["attributes"];
+            if (primitive["mode"].asUint(kGltfTriangles) != kGltfTriangles ||
+                !attributes.contains("POSITION")) {
+                ++skipped;
+                continue;
+            }
+
+            GltfPrimitive& output = primitives.emplace_back();
+            auto positions = resolveGltfAccessor(path, *document, attributes["POSITION"]);
+            if (!positions) {
+                return std::unexpected(positions.error());
+            }
+            output.positions = *positions;
+            if (output.positions.componentType != kGltfFloat ||
+                output.positions.componentCount != 3) {
+                return std::unexpected(gltfError(path, "positions must be float VEC3"));
+            }
+            if (attributes.contains("NORMAL")) {
+                auto normals = resolveGltfAccessor(path, *document, attributes["NORMAL"]);
+                if (!normals) {
+                    return std::unexpected(normals.error());
+                }
+                output.normals = normals->componentCount == 3 ? *normals : GltfAccessor{};
+            }
+            if (attributes.contains("TEXCOORD_0")) {
+                auto uvs = resolveGltfAccessor(path, *document, attributes["TEXCOORD_0"]);
+                if (!uvs) {
+                    return std::unexpected(uvs.error());
+                }
+                output.uvs = uvs->componentCount == 2 ? *uvs : GltfAccessor{};
+            }
+            if (primitive.contains("indices")) {
+                auto indices = resolveGltfAccessor(path, *document, primitive["indices"]);
+                if (!indices) {
+                    return std::unexpected(indices.error());
+                }
+                output.indices = *indices;
+                if (output.indices.componentCount != 1 ||
+                    (output.indices.componentType != kGltfUnsignedByte &&
+                     output.indices.componentType != kGltfUnsignedShort &&
+                     output.indices.componentType != kGltfUnsignedInt)) {
+                    return std::unexpected(gltfError(path, "indices must be unsigned scalars"));
+                }
+            }
+            if ((output.normals.isValid() && output.normals.count != output.positions.count) ||
+                (output.uvs.isValid() && output.uvs.count != output.positions.count)) {
+                return std::unexpected(gltfError(path, "attribute counts differ"));
+            }
+
+            output.transform = transform;
+            output.identity = transform == glm::mat4(1.0f);
+            const glm::vec3 c0(transform[0]);
+            const glm::vec3 c1(transform[1]);
+            const glm::vec3 c2(transform[2]);
+            const float determinant = glm::dot(c0, glm::cross(c1, c2));
+            const float sign = determinant < 0.0f ? -1.0f : 1.0f;
+            output.normalTransform = {glm::cross(c1, c2) * sign, glm::cross(c2, c0) * sign,
+                                      glm::cross(c0, c1) * sign};
+            output.flipWinding = determinant < 0.0f;
+            output.firstVertex = vertexCount;
+            output.firstIndex = indexCount;
+            vertexCount += output.positions.count;
+            indexCount += output.getIndexCount() / 3 * 3;
+            allNormals &= output.normals.isValid();
+            allUvs &= output.uvs.isValid();
+        }
+    }
+    if (skipped > 0) {
+        Logger::warn("{}: skipped {} primitives that are not triangle lists", path.string(),
+                     skipped);
+    }
+    if (vertexCount > kMaxVertexCount) {
+        return std::unexpected(tooManyVertices(path, vertexCount));
+    }
+
+    MeshData mesh;
+    mesh.positions.resize(vertexCount);
+    mesh.normals.resize(allNormals ? vertexCount : 0);
+    mesh.uvs.resize(allUvs ? vertexCount : 0);
+    mesh.indices.resize(indexCount);
+
+    // Every primitive's vertices and indices are cut into batches for the workers
+    struct Batch {
+        uint32_t primitive{0};
+        bool indices{false};
+        uint64_t begin{0};
+        uint64_t end{0};
+    };
+    std::vector<Batch> batches;
+    for (uint32_t i = 0; i < primitives.size(); ++i) {
+        const GltfPrimitive& primitive = primitives[i];
+        for (uint64_t begin = 0; begin < primitive.positions.count; begin += kBinaryBatchSize) {
+            batches.push_back({i, false, begin,
+                               std::min(begin + kBinaryBatchSize, primitive.positions.count)});
+        }
+        const uint64_t triangles = primitive.getIndexCount() / 3;
+        for (uint64_t begin = 0; begin < triangles; begin += kBinaryBatchSize) {
+            batches.push_back({i, true, begin, std::min(begin + kBinaryBatchSize, triangles)});
+        }
+    }
+
+    std::atomic<bool> outOfRange{false};
+    parallelFor(jobSystem, static_cast<uint32_t>(batches.size()), 1, [&](uint32_t batchIndex) {
+        const Batch& batch = batches[batchIndex];
+        const GltfPrimitive& primitive = primitives[batch.primitive];
+        if (batch.indices) {
+            const uint64_t vertices = primitive.positions.count;
+            const auto base = static_cast<uint32_t>(primitive.firstVertex);
+            for (uint64_t triangle = batch.begin; triangle < batch.end; ++triangle) {
+                std::array<uint32_t, 3> corners{};
+                for (uint32_t corner = 0; corner < 3; ++corner) {
+                    const uint64_t element = triangle * 3 + corner;
+                    corners[corner] = primitive.indices.isValid()
+                                          ? primitive.indices.readIndex(element)
+                                          : static_cast<uint32_t>(element);
+                    if (corners[corner] >= vertices) {
+                        outOfRange.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+                if (primitive.flipWinding) {
+                    std::swap(corners[1], corners[2]);
+                }
+                uint32_t* indices = mesh.indices.data() + primitive.firstIndex + triangle * 3;
+                for (uint32_t corner = 0; corner < 3; ++corner) {
+                    indices[corner] = base + corners[corner];
+                }
+            }
+            return;
+        }
+
+        for (uint64_t vertex = batch.begin; vertex < batch.end; ++vertex) {
+            const size_t output = primitive.firstVertex + vertex;
+            const glm::vec3 position(primitive.positions.read(vertex, 0),
+                                     primitive.positions.read(vertex, 1),
+                                     primitive.positions.read(vertex, 2));
+            if (primitive.identity) {
+                mesh.positions[output] = position;
+                if (!mesh.normals.empty()) {
+                    mesh.normals[output] = {primitive.normals.read(vertex, 0),
+                                            primitive.normals.read(vertex, 1),
+                                            primitive.normals.read(vertex, 2)};
+                }
+            } else {
+                mesh.positions[output] = glm::vec3(primitive.transform * glm::vec4(position, 1.0f));
+            }
+            if (!mesh.normals.empty() && !primitive.identity) {
+                const glm::vec3 normal = primitive.normalTransform[0] *
+                                             primitive.normals.read(vertex, 0) +
+                                         primitive.normalTransform[1] *
+                                             primitive.normals.read(vertex, 1) +
+                                         primitive.normalTransform[2] *
+                                             primitive.normals.read(vertex, 2);
+                const float length = glm::length(normal);
+                mesh.normals[output] = length > 0.0f ? normal / length : normal;
+            }
+            if (!mesh.uvs.empty()) {
+                mesh.uvs[output] = {primitive.uvs.read(vertex, 0), primitive.uvs.read(vertex, 1)};
+            }
+        }
+    });
+    if (outOfRange.load()) {
+        return std::unexpected(gltfError(path, "index out of range"));
+    }
+    return mesh;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Welding
+
+constexpr uint32_t kWeldBatchSize = 1 << 16;
+
+// -0 and +0 compare equal, so they must hash and compare as the same bits
+auto getFloatBits(float value) -> uint32_t {
+    return std::bit_cast<uint32_t>(value + 0.0f);
+}
+
+auto hashVertex(const MeshData& mesh, size_t vertex) -> uint64_t {
+    uint64_t hash = 0;
+    auto mix = [&hash](float value) {
+        hash = (hash ^ getFloatBits(value)) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 29;
+    };
+    const glm::vec3& position = mesh.positions[vertex];
+    mix(position.x);
+    mix(position.y);
+    mix(position.z);
+    return hash;
+}
+
+auto equalVertices(const MeshData& mesh, size_t a, size_t b) -> bool {
+    auto same = [](const auto& lhs, const auto& rhs, int components) {
+        for (int i = 0; i < components; ++i) {
+            if (getFloatBits(lhs[i]) != getFloatBits(rhs[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+    return same(mesh.positions[a], mesh.positions[b], 3) &&
+           (mesh.normals.empty() || same(mesh.normals[a], mesh.normals[b], 3)) &&
+           (mesh.uvs.empty() || same(mesh.uvs[a], mesh.uvs[b], 2));
+}
+
+} // namespace
+
+auto MeshImporter::weld(MeshData& mesh, JobSystem* jobSystem) -> size_t {
+    ZoneScoped;
+    const size_t vertexCount = mesh.positions.size();
+    if (vertexCount == 0) {
+        return 0;
+    }
+    const auto batchCount = static_cast<uint32_t>((vertexCount + kWeldBatchSize - 1) /
+                                                  kWeldBatchSize);
+    auto forEachVertex = [&](auto&& function) {
+        parallelFor(jobSystem, batchCount, 1, [&](uint32_t batch) {
+            const size_t begin = static_cast<size_t>(batch) * kWeldBatchSize;
+            const size_t end = std::min(begin + kWeldBatchSize, vertexCount);
+            for (size_t vertex = begin; vertex < end; ++vertex) {
+                function(vertex);
+            }
+        });
+    };
+
+    // Open addressing, keyed on the position hash. Slots hold vertex + 1, 0 when empty; equal
+    // vertices probe the same sequence and keep the lowest index in their slot.
+    const size_t capacity = std::bit_ceil(vertexCount * 2);
+    const size_t mask = capacity - 1;
+    std::vector<std::atomic<uint32_t>> table(capacity);
+    std::vector<uint64_t> hashes(vertexCount);
+    {
+        ZoneScopedN("Insert");
+        forEachVertex([&](size_t vertex) {
+            hashes[vertex] = hashVertex(mesh, vertex);
+            const auto entry = static_cast<uint32_t>(vertex + 1);
+            for (size_t slot = hashes[vertex] & mask;; slot = (slot + 1) & mask) {
+                uint32_t current = table[slot].load(std::memory_order_acquire);
+                if (current == 0) {
+                    if (table[slot].compare_exchange_strong(current, entry,
+                                                            std::memory_order_acq_rel)) {
+                        return;
+                    }
+                    // Lost the race: current now holds the winner
+                }
+                if (hashes[current - 1] == hashes[vertex] &&
+                    equalVertices(mesh, current - 1, vertex)) {
+                    while (entry < current &&
+                           !table[slot].compare_exchange_weak(current, entry,
+                                                             std::memory_order_acq_rel)) {
+                    }
+                    return;
+                }
+            }
+        });
+    }
+
+    // Every vertex maps to the lowest one equal to it; those are kept, in order
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint32_t> keptPerBatch(batchCount, 0);
+    {
+        ZoneScopedN("Resolve");
+        forEachVertex([&](size_t vertex) {
+            for (size_t slot = hashes[vertex] & mask;; slot = (slot + 1) & mask) {
+                const uint32_t entry = table[slot].load(std::memory_order_relaxed);
+                if (hashes[entry - 1] == hashes[vertex] &&
+                    equalVertices(mesh, entry - 1, vertex)) {
+                    remap[vertex] = entry - 1;
+                    return;
+                }
+            }
+        });
+    }
+    std::vector<std::atomic<uint32_t>>().swap(table);
+    hashes = {};
+
+    // Batches number their kept vertices in parallel once every batch knows its first number
+    parallelFor(jobSystem, batchCount, 1, [&](uint32_t batch) {
+        const size_t begin = static_cast<size_t>(batch) * kWeldBatchSize;
+        const size_t end = std::min(begin + kWeldBatchSize, vertexCount);
+        for (size_t vertex = begin; vertex < end; ++vertex) {
+            keptPerBatch[batch] += remap[vertex] == vertex;
+        }
+    });
+    std::vector<uint32_t> firstKept(batchCount, 0);
+    uint32_t keptCount = 0;
+    for (uint32_t batch = 0; batch < batchCount; ++batch) {
+        firstKept[batch] = keptCount;
+        keptCount += keptPerBatch[batch];
+    }
+    if (keptCount == vertexCount) {
+        return 0;
+    }
+
+    MeshData welded;
+    welded.positions.resize(keptCount);
+    welded.normals.resize(mesh.normals.empty() ? 0 : keptCount);
+    welded.uvs.resize(mesh.uvs.empty() ? 0 : keptCount);
+    std::vector<uint32_t> newIndex(vertexCount);
+    parallelFor(jobSystem, batchCount, 1, [&](uint32_t batch) {
+        const size_t begin = static_cast<size_t>(batch) * kWeldBatchSize;
+        const size_t end = std::min(begin + kWeldBatchSize, vertexCount);
+        uint32_t next = firstKept[batch];
+        for (size_t vertex = begin; vertex < end; ++vertex) {
+            if (remap[vertex] != vertex) {
+                continue;
+            }
+            welded.positions[next] = mesh.positions[vertex];
+            if (!welded.normals.empty()) {
+                welded.normals[next] = mesh.normals[vertex];
+            }
+            if (!welded.uvs.empty()) {
+                welded.uvs[next] = mesh.uvs[vertex];
+            }
+            newIndex[vertex] = next++;
+        }
+    });
+
+    const auto indexBatchCount = static_cast<uint32_t>(
+        (mesh.indices.size() + kWeldBatchSize - 1) / kWeldBatchSize);
+    parallelFor(jobSystem, indexBatchCount, 1, [&](uint32_t batch) {
+        const size_t begin = static_cast<size_t>(batch) * kWeldBatchSize;
+        const size_t end = std::min(begin + kWeldBatchSize, mesh.indices.size());
+        for (size_t i = begin; i < end; ++i) {
+            mesh.indices[i] = newIndex[remap[mesh.indices[i]]];
+        }
+    });
+
+    mesh.positions = std::move(welded.positions);
+    mesh.normals = std::move(welded.normals);
+    mesh.uvs = std::move(welded.uvs);
+    return vertexCount - keptCount;
+}
+
+auto MeshImporter::detectFormat(const std::filesystem::path& path)
+    -> std::optional<MeshFormat> {
+    std::string extension = path.extension().string();
+    std::ranges::transform(extension, extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (extension == ".obj") {
+        return MeshFormat::Obj;
+    }
+    if (extension == ".ply") {
+        return MeshFormat::Ply;
+    }
+    if (extension == ".gltf" || extension == ".glb") {
+        return MeshFormat::Gltf;
+    }
+    return std::nullopt;
+}
+
+auto MeshImporter::findDependencies(const std::filesystem::path& path,
+                                    std::span<const uint8_t> data)
+    -> Result<std::vector<std::filesystem::path>> {
+    std::vector<std::filesystem::path> dependencies;
+    if (detectFormat(path) != MeshFormat::Gltf) {
+        return dependencies;
+    }
+
+    auto chunks = splitGltfChunks(path, data);
+    if (!chunks) {
+        return std::unexpected(chunks.error());
+    }
+    auto json = JsonValue::parse(chunks->json);
+    if (!json) {
+        return std::unexpected(gltfError(path, json.error().toString()));
+    }
+    const JsonValue& buffers = (*json)["buffers"];
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        const JsonValue& uri = buffers[i]["uri"];
+        if (uri.isString() && isExternalUri(uri.asString())) {
+            dependencies.push_back(path.parent_path() / decodeUri(uri.asString()));
+        }
+    }
+    return dependencies;
+}
+
+auto MeshImporter::getFormatName(MeshFormat format) noexcept -> std::string_view {
+    switch (format) {
+    case MeshFormat::Obj:
+        return "OBJ";
+    case MeshFormat::Ply:
+        return "PLY";
+    case MeshFormat::Gltf:
+        return "glTF";
+    }
+    return "unknown";
+}
+
+auto MeshImporter::load(const std::filesystem::path& path, JobSystem* jobSystem,
+                        const MeshImportConfig& config, MeshImportStats* stats)
+    -> Result<MeshData> {
+    ZoneScoped;
+    const auto format = detectFormat(path);
+    if (!format) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            std::format("Unsupported mesh format: {}", path.string())
+        ));
+    }
+
+    const auto start = Clock::now();
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    // Chunks are parsed front to back by every worker at once
+    file->prefetch(0, file->getSize());
+    const std::span<const uint8_t> data = file->getData();
+
+    MeshImportStats result;
+    result.format = *format;
+    result.sourceBytes = data.size();
+    Result<MeshData> mesh;
+    switch (*format) {
+    case MeshFormat::Obj:
+        mesh = importObj(path, {reinterpret_cast<const char*>(data.data()), data.size()},
+                         jobSystem, config);
+        break;
+    case MeshFormat::Ply:
+        mesh = importPly(path, data, jobSystem, config);
+        break;
+    case MeshFormat::Gltf: {
+        uint64_t externalBytes = 0;
+        mesh = importGltf(path, data, jobSystem, externalBytes);
+        result.sourceBytes += externalBytes;
+        break;
+    }
+    }
+    if (!mesh) {
+        return std::unexpected(mesh.error());
+    }
+    result.parseSeconds = Seconds(Clock::now() - start).count();
+
+    if (config.weld) {
+        const auto weldStart = Clock::now();
+        result.weldedVertexCount = weld(*mesh, jobSystem);
+        result.weldSeconds = Seconds(Clock::now() - weldStart).count();
+    }
+
+    Logger::info("Imported {} ({}): {} vertices, {} triangles", path.filename().string(),
+                 getFormatName(*format), mesh->vertexCount(), mesh->triangleCount());
+    Logger::info("  Parsed {:.1f} MiB in {:.1f} ms ({:.0f} MB/s), welding removed {} vertices "
+                 "in {:.1f} ms",
+                 static_cast<double>(result.sourceBytes) / (1024 * 1024),
+                 result.parseSeconds * 1e3, result.getParseMegabytesPerSecond(),
+                 result.weldedVertexCount, result.weldSeconds * 1e3);
+    if (stats != nullptr) {
+        *stats = result;
+    }
+    return mesh;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Error.hpp"
+#include "MeshData.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class JobSystem;
+
+struct MeshImportConfig {
+    // Merges vertices whose position and attributes are bit-identical
+    bool weld{true};
+    // Source bytes parsed per job
+    uint32_t chunkSize{4u << 20};
+};
+
+enum class MeshFormat : uint8_t { Obj, Ply, Gltf };
+
+struct MeshImportStats {
+    MeshFormat format{MeshFormat::Obj};
+    uint64_t sourceBytes{0}; // Including external glTF buffers
+    double parseSeconds{0.0};
+    double weldSeconds{0.0};
+    size_t weldedVertexCount{0}; // Removed by welding
+
+    [[nodiscard]] auto getParseMegabytesPerSecond() const noexcept -> double {
+        return parseSeconds > 0.0 ? static_cast<double>(sourceBytes) / parseSeconds * 1e-6 : 0.0;
+    }
+};
+
+// Source mesh importers for the cooker. Files are memory mapped and cut into chunks that are
+// parsed concurrently straight into MeshData's arrays: a counting pass sizes every chunk's
+// output, so the parse pass writes each vertex and index in place with no per-vertex
+// allocations and the result does not depend on the thread count.
+//
+// OBJ:  v/vt/vn/f lines; polygons are triangulated as fans. Corners that index attributes
+//       become vertices of their own, which welding merges again.
+// PLY:  ascii and binary of either endianness; a vertex element with scalar properties and
+//       a face element with a vertex index list.
+// glTF: .gltf with external or embedded buffers, and .glb. Triangle primitives of the
+//       default scene are flattened with their node transforms applied.
+class MeshImporter {
+public:
+    // Picks the format from the extension. Logs the parse throughput; stats may be null.
+    [[nodiscard]] static auto load(const std::filesystem::path& path, JobSystem* jobSystem,
+                                   const MeshImportConfig& config = {},
+                                   MeshImportStats* stats = nullptr) -> Result<MeshData>;
+    [[nodiscard]] static auto detectFormat(const std::filesystem::path& path)
+        -> std::optional<MeshFormat>;
+    [[nodiscard]] static auto getFormatName(MeshFormat format) noexcept -> std::string_view;
+    // Other files that loading the source reads, given its contents: the external buffers of
+    // a glTF. Used to key cooked output on everything the mesh came from.
+    [[nodiscard]] static auto findDependencies(const std::filesystem::path& path,
+                                               std::span<const uint8_t> data)
+        -> Result<std::vector<std::filesystem::path>>;
+
+    // Merges bit-identical vertices through a hash table that workers insert into
+    // concurrently. Each vertex maps to the first vertex equal to it, and kept vertices stay
+    // in their original order, so the result is deterministic. Returns the number removed.
+    static auto weld(MeshData& mesh, JobSystem* jobSystem) -> size_t;
+};
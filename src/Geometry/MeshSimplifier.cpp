@@ -0,0 +1,359 @@
+#include "MeshSimplifier.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace {
+
+// Border edges are constrained much harder than surface planes so open boundaries keep their
+// silhouette
+constexpr double kBorderWeight = 10.0;
+
+// Symmetric 4x4 quadric for squared distance to a set of weighted planes
+struct Quadric {
+    double a00{0.0}, a01{0.0}, a02{0.0}, a11{0.0}, a12{0.0}, a22{0.0};
+    double b0{0.0}, b1{0.0}, b2{0.0};
+    double c{0.0};
+    double weight{0.0};
+
+    void addPlane(const glm::vec3& normal, float distance, double planeWeight) {
+        const double x = normal.x, y = normal.y, z = normal.z, d = distance;
+        a00 += planeWeight * x * x;
+        a01 += planeWeight * x * y;
+        a02 += planeWeight * x * z;
+        a11 += planeWeight * y * y;
+        a12 += planeWeight * y * z;
+        a22 += planeWeight * z * z;
+        b0 += planeWeight * x * d;
+        b1 += planeWeight * y * d;
+        b2 += planeWeight * z * d;
+        c += planeWeight * d * d;
+        weight += planeWeight;
+    }
+
+    auto operator+=(const Quadric& other) -> Quadric& {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    // Weighted mean squared distance of p to the accumulated planes
+    [[nodiscard]] auto evaluate(const glm::vec3& p) const -> double {
+        const double x = p.x, y = p.y, z = p.z;
+        const double error = a00 * x * x + a11 * y * y + a22 * z * z +
+                             2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                             2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return weight > 0.0 ? std::abs(error) / weight : 0.0;
+    }
+};
+
+struct Collapse {
+    uint32_t from{0};
+    uint32_t to{0};
+    double cost{0.0};
+};
+
+auto edgeKey(uint32_t a, uint32_t b) -> uint64_t {
+    return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+class Simplifier {
+public:
+    Simplifier(std::vector<glm::vec3> positions, std::vector<uint32_t> indices,
+               std::vector<bool> locked)
+        : m_positions(std::move(positions))
+        , m_indices(std::move(indices))
+        , m_locked(std::move(locked))
+        , m_quadrics(m_positions.size()) {}
+
+    [[nodiscard]] auto run(size_t targetIndexCount, double maxErrorSquared) -> double {
+        ZoneScoped;
+        buildQuadrics();
+
+        double resultError = 0.0;
+        while (m_indices.size() > targetIndexCount) {
+            const size_t goal = (m_indices.size() - targetIndexCount + 2) / 3;
+            const auto pass = collapsePass(goal, maxErrorSquared);
+            if (!pass) {
+                break;
+            }
+            resultError = std::max(resultError, *pass);
+            removeDegenerateTriangles();
+        }
+        return resultError;
+    }
+
+    [[nodiscard]] auto indices() const -> const std::vector<uint32_t>& { return m_indices; }
+
+private:
+    void buildQuadrics() {
+        const size_t triangleCount = m_indices.size() / 3;
+        std::vector<uint64_t> edges;
+        edges.reserve(m_indices.size());
+
+        for (size_t t = 0; t < triangleCount; ++t) {
+            const uint32_t* tri = &m_indices[t * 3];
+            const glm::vec3& p0 = m_positions[tri[0]];
+            glm::vec3 normal = glm::cross(m_positions[tri[1]] - p0, m_positions[tri[2]] - p0);
+            const float doubleArea = glm::length(normal);
+            if (doubleArea <= 0.0f) {
+                continue;
+            }
+            normal /= doubleArea;
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                m_quadrics[tri[corner]].addPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+                edges.push_back(edgeKey(tri[corner], tri[(corner + 1) % 3]));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        // Edges used by a single triangle get a plane through the edge, perpendicular to the
+        // surface, so that collapses cannot pull the border inwards
+        for (size_t t = 0; t < triangleCount; ++t) {
+            const uint32_t* tri = &m_indices[t * 3];
+            const glm::vec3& p0 = m_positions[tri[0]];
+            const glm::vec3 faceNormal =
+                glm::cross(m_positions[tri[1]] - p0, m_positions[tri[2]] - p0);
+            if (glm::length(faceNormal) <= 0.0f) {
+                continue;
+            }
+
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                const uint32_t a = tri[corner];
+                const uint32_t b = tri[(corner + 1) % 3];
+                const auto range = std::equal_range(edges.begin(), edges.end(), edgeKey(a, b));
+                if (range.second - range.first != 1) {
+                    continue;
+                }
+
+                const glm::vec3 edge = m_positions[b] - m_positions[a];
+                glm::vec3 normal = glm::cross(edge, faceNormal);
+                const float length = glm::length(normal);
+                if (length <= 0.0f) {
+                    continue;
+                }
+                normal /= length;
+                const double weight = kBorderWeight * glm::dot(edge, edge);
+                const float distance = -glm::dot(normal, m_positions[a]);
+                m_quadrics[a].addPlane(normal, distance, weight);
+                m_quadrics[b].addPlane(normal, distance, weight);
+            }
+        }
+    }
+
+    void buildAdjacency() {
+        const size_t vertexCount = m_positions.size();
+        m_adjacencyOffsets.assign(vertexCount + 1, 0);
+        for (uint32_t index : m_indices) {
+            ++m_adjacencyOffsets[index + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            m_adjacencyOffsets[v + 1] += m_adjacencyOffsets[v];
+        }
+
+        std::vector<uint32_t> cursor(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+        m_adjacency.resize(m_indices.size());
+        for (size_t i = 0; i < m_indices.size(); ++i) {
+            m_adjacency[cursor[m_indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    [[nodiscard]] auto gatherCollapses() const -> std::vector<Collapse> {
+        std::vector<uint64_t> edges;
+        edges.reserve(m_indices.size());
+        for (size_t t = 0; t < m_indices.size(); t += 3) {
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                edges.push_back(edgeKey(m_indices[t + corner], m_indices[t + (corner + 1) % 3]));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        std::vector<Collapse> collapses;
+        collapses.reserve(edges.size());
+        for (uint64_t key : edges) {
+            const auto a = static_cast<uint32_t>(key >> 32);
+            const auto b = static_cast<uint32_t>(key & 0xffffffffu);
+            if (m_locked[a] && m_locked[b]) {
+                continue;
+            }
+
+            Quadric combined = m_quadrics[a];
+            combined += m_quadrics[b];
+            const double costAB = m_locked[a] ? HUGE_VAL : combined.evaluate(m_positions[b]);
+            const double costBA = m_locked[b] ? HUGE_VAL : combined.evaluate(m_positions[a]);
+            collapses.push_back(costAB <= costBA ? Collapse{a, b, costAB} : Collapse{b, a, costBA});
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+            if (lhs.cost != rhs.cost) {
+                return lhs.cost < rhs.cost;
+            }
+            return lhs.from != rhs.from ? lhs.from < rhs.from : lhs.to < rhs.to;
+        });
+        return collapses;
+    }
+
+    // Rejects collapses that flip or badly distort any surviving triangle around from
+    [[nodiscard]] auto isCollapseValid(uint32_t from, uint32_t to) const -> bool {
+        for (uint32_t i = m_adjacencyOffsets[from]; i < m_adjacencyOffsets[from + 1]; ++i) {
+            const uint32_t* tri = &m_indices[m_adjacency[i] * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                continue;
+            }
+
+            glm::vec3 before[3];
+            glm::vec3 after[3];
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                before[corner] = m_positions[tri[corner]];
+                after[corner] = tri[corner] == from ? m_positions[to] : before[corner];
+            }
+
+            const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if (glm::dot(normalBefore, normalAfter) <=
+                0.25f * glm::length(normalBefore) * glm::length(normalAfter)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Performs a batch of independent collapses in cost order. Returns the largest collapse
+    // cost, or nothing when no collapse was possible.
+    [[nodiscard]] auto collapsePass(size_t goal, double maxErrorSquared) -> std::optional<double> {
+        ZoneScoped;
+        buildAdjacency();
+        const std::vector<Collapse> collapses = gatherCollapses();
+
+        std::vector<bool> touched(m_positions.size(), false);
+        std::vector<uint32_t> remap(m_positions.size());
+        for (uint32_t v = 0; v < remap.size(); ++v) {
+            remap[v] = v;
+        }
+
+        std::optional<double> passError;
+        size_t removed = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > maxErrorSquared) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to] ||
+                !isCollapseValid(collapse.from, collapse.to)) {
+                continue;
+            }
+
+            // Lock the whole one-ring so later collapses in this pass see unmodified triangles
+            for (uint32_t i = m_adjacencyOffsets[collapse.from];
+                 i < m_adjacencyOffsets[collapse.from + 1]; ++i) {
+                const uint32_t* tri = &m_indices[m_adjacency[i] * 3];
+                removed += tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to;
+                for (uint32_t corner = 0; corner < 3; ++corner) {
+                    touched[tri[corner]] = true;
+                }
+            }
+
+            remap[collapse.from] = collapse.to;
+            m_quadrics[collapse.to] += m_quadrics[collapse.from];
+            passError = std::max(passError.value_or(0.0), collapse.cost);
+
+            if (removed >= goal) {
+                break;
+            }
+        }
+
+        for (uint32_t& index : m_indices) {
+            index = remap[index];
+        }
+        return passError;
+    }
+
+    void removeDegenerateTriangles() {
+        size_t write = 0;
+        for (size_t read = 0; read < m_indices.size(); read += 3) {
+            const uint32_t a = m_indices[read + 0];
+            const uint32_t b = m_indices[read + 1];
+            const uint32_t c = m_indices[read + 2];
+            if (a != b && b != c && c != a) {
+                m_indices[write++] = a;
+                m_indices[write++] = b;
+                m_indices[write++] = c;
+            }
+        }
+        m_indices.resize(write);
+    }
+
+    std::vector<glm::vec3> m_positions;
+    std::vector<uint32_t> m_indices;
+    std::vector<bool> m_locked;
+    std::vector<Quadric> m_quadrics;
+    std::vector<uint32_t> m_adjacencyOffsets;
+    std::vector<uint32_t> m_adjacency;
+};
+
+} // namespace
+
+auto MeshSimplifier::simplify(std::span<const glm::vec3> positions,
+                              std::span<const uint32_t> indices,
+                              std::span<const uint32_t> lockedVertices, const Config& config)
+    -> Output {
+    ZoneScoped;
+    Output output;
+    if (indices.size() <= config.targetIndexCount) {
+        output.indices.assign(indices.begin(), indices.end());
+        return output;
+    }
+
+    // Work on a compact copy of the referenced vertices, normalized to a unit box so the
+    // quadrics stay well conditioned regardless of asset scale
+    std::vector<uint32_t> globalIds(indices.begin(), indices.end());
+    std::ranges::sort(globalIds);
+    globalIds.erase(std::unique(globalIds.begin(), globalIds.end()), globalIds.end());
+
+    glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+    glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+    for (uint32_t v : globalIds) {
+        boundsMin = glm::min(boundsMin, positions[v]);
+        boundsMax = glm::max(boundsMax, positions[v]);
+    }
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float scale = std::max({extent.x, extent.y, extent.z});
+    const float inverseScale = scale > 0.0f ? 1.0f / scale : 1.0f;
+
+    std::vector<glm::vec3> localPositions(globalIds.size());
+    std::vector<bool> locked(globalIds.size());
+    for (size_t v = 0; v < globalIds.size(); ++v) {
+        localPositions[v] = (positions[globalIds[v]] - boundsMin) * inverseScale;
+        locked[v] = std::ranges::binary_search(lockedVertices, globalIds[v]);
+    }
+
+    std::vector<uint32_t> localIndices(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        localIndices[i] = static_cast<uint32_t>(
+            std::ranges::lower_bound(globalIds, indices[i]) - globalIds.begin());
+    }
+
+    const double maxError = static_cast<double>(config.maxError) * inverseScale;
+    const double maxErrorSquared =
+        config.maxError == std::numeric_limits<float>::max() ? HUGE_VAL : maxError * maxError;
+
+    Simplifier simplifier(std::move(localPositions), std::move(localIndices), std::move(locked));
+    const double errorSquared = simplifier.run(config.targetIndexCount, maxErrorSquared);
+
+    output.indices.reserve(simplifier.indices().size());
+    for (uint32_t index : simplifier.indices()) {
+        output.indices.push_back(globalIds[index]);
+    }
+    output.error = static_cast<float>(std::sqrt(errorSquared)) * (scale > 0.0f ? scale : 1.0f);
+    return output;
+}
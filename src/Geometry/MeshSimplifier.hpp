@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Quadric error metric edge-collapse simplifier. Collapses always move a vertex onto an existing
+// neighbour, so the output references the input vertex buffer and needs no new vertices.
+class MeshSimplifier {
+public:
+    struct Config {
+        size_t targetIndexCount{0};
+        float maxError{std::numeric_limits<float>::max()};
+    };
+
+    struct Output {
+        std::vector<uint32_t> indices;
+        // Largest object-space deviation introduced by any collapse
+        float error{0.0f};
+    };
+
+    // lockedVertices must be sorted; locked vertices never move, but neighbours may collapse
+    // onto them
+    [[nodiscard]] static auto simplify(std::span<const glm::vec3> positions,
+                                       std::span<const uint32_t> indices,
+                                       std::span<const uint32_t> lockedVertices,
+                                       const Config& config) -> Output;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+
+// 30-bit Morton codes for spatially sorting triangles, clusters and groups
+[[nodiscard]] constexpr auto expandMortonBits(uint32_t value) noexcept -> uint32_t {
+    value = (value * 0x00010001u) & 0xFF0000FFu;
+    value = (value * 0x00000101u) & 0x0F00F00Fu;
+    value = (value * 0x00000011u) & 0xC30C30C3u;
+    value = (value * 0x00000005u) & 0x49249249u;
+    return value;
+}
+
+// Point is normalized against [boundsMin, boundsMin + 1 / inverseExtent]
+[[nodiscard]] inline auto mortonCode(const glm::vec3& point, const glm::vec3& boundsMin,
+                                     const glm::vec3& inverseExtent) noexcept -> uint32_t {
+    auto quantize = [](float value) {
+        return static_cast<uint32_t>(std::clamp(value * 1023.0f + 0.5f, 0.0f, 1023.0f));
+    };
+    const glm::vec3 normalized = (point - boundsMin) * inverseExtent;
+    return (expandMortonBits(quantize(normalized.x)) << 2) |
+           (expandMortonBits(quantize(normalized.y)) << 1) |
+           expandMortonBits(quantize(normalized.z));
+}
+
+[[nodiscard]] inline auto mortonInverseExtent(const glm::vec3& boundsMin,
+                                              const glm::vec3& boundsMax) noexcept -> glm::vec3 {
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float largest = std::max({extent.x, extent.y, extent.z, 1e-20f});
+    // Uniform scale keeps the curve isotropic for elongated meshes
+    return glm::vec3{1.0f / largest};
+}
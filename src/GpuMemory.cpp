@@ -0,0 +1,343 @@
+#include "GpuMemory.hpp"
+#include "Logger.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <vector>
+
+namespace {
+
+constexpr std::array<const char*, static_cast<size_t>(MemoryPool::Count)> kPoolNames{
+    "cluster page", "staging", "transient"};
+// Tracy keeps plot names by pointer
+constexpr std::array<const char*, static_cast<size_t>(MemoryPool::Count)> kPoolPlotNames{
+    "GPU Cluster Page Pool MiB", "GPU Staging Pool MiB", "GPU Transient Pool MiB"};
+
+[[nodiscard]] constexpr auto toMebibytes(VkDeviceSize bytes) noexcept -> double {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+[[nodiscard]] constexpr auto getPoolIndex(MemoryPool pool) noexcept -> size_t {
+    return static_cast<size_t>(pool);
+}
+
+} // namespace
+
+auto GpuMemory::create(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device,
+                       bool memoryBudget, const GpuMemoryConfig& config)
+    -> Result<std::unique_ptr<GpuMemory>> {
+    ZoneScoped;
+    std::unique_ptr<GpuMemory> memory(new GpuMemory());
+
+    VmaAllocatorCreateInfo allocatorInfo{};
+    allocatorInfo.flags = memoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0;
+    allocatorInfo.physicalDevice = physicalDevice;
+    allocatorInfo.device = device;
+    allocatorInfo.instance = instance;
+    allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+
+    if (vmaCreateAllocator(&allocatorInfo, &memory->m_allocator) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to create memory allocator"
+        ));
+    }
+
+    if (auto result = memory->createPools(config); !result) {
+        return std::unexpected(result.error());
+    }
+
+    // Fills in the budget before the first frame
+    memory->beginFrame();
+    Logger::info("GPU memory: {:.0f} of {:.0f} MiB device-local budget in use{}",
+                 toMebibytes(memory->m_deviceLocalBudget.usage),
+                 toMebibytes(memory->m_deviceLocalBudget.budget),
+                 memoryBudget ? "" : " (estimated, no VK_EXT_memory_budget)");
+    return memory;
+}
+
+GpuMemory::~GpuMemory() {
+    for (VmaPool pool : m_pools) {
+        if (pool != VK_NULL_HANDLE) {
+            vmaDestroyPool(m_allocator, pool);
+        }
+    }
+    if (m_allocator != VK_NULL_HANDLE) {
+        vmaDestroyAllocator(m_allocator);
+    }
+}
+
+auto GpuMemory::createPools(const GpuMemoryConfig& config) -> VoidResult {
+    struct PoolDesc {
+        MemoryPool pool;
+        VkDeviceSize blockSize;
+        uint32_t maxBlockCount;
+    };
+    const std::array<PoolDesc, static_cast<size_t>(MemoryPool::Count)> descs{{
+        {MemoryPool::ClusterPages, config.clusterPageBlockSize, config.maxClusterPageBlocks},
+        {MemoryPool::Staging, config.stagingBlockSize, config.maxStagingBlocks},
+        {MemoryPool::Transient, config.transientBlockSize, config.maxTransientBlocks},
+    }};
+
+    for (const PoolDesc& desc : descs) {
+        // Memory types are picked for a representative resource of the pool
+        VmaAllocationCreateInfo allocationInfo{};
+        uint32_t memoryType = 0;
+        VkResult found = VK_SUCCESS;
+        if (desc.pool == MemoryPool::Transient) {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+            imageInfo.extent = VkExtent3D{256, 256, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+                              VK_IMAGE_USAGE_SAMPLED_BIT;
+            allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            found = vmaFindMemoryTypeIndexForImageInfo(m_allocator, &imageInfo, &allocationInfo,
+                                                       &memoryType);
+        } else {
+            VkBufferCreateInfo bufferInfo{};
+            bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.size = 64 * 1024;
+            if (desc.pool == MemoryPool::Staging) {
+                bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+                allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+                allocationInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+                // Writes need no flushing
+                allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            } else {
+                bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+                allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+                allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            }
+            found = vmaFindMemoryTypeIndexForBufferInfo(m_allocator, &bufferInfo,
+                                                        &allocationInfo, &memoryType);
+        }
+
+        const char* name = kPoolNames[getPoolIndex(desc.pool)];
+        if (found != VK_SUCCESS) {
+            return std::unexpected(makeError(
+                ErrorCode::VulkanResourceCreationFailed,
+                std::format("No memory type for the {} pool", name)
+            ));
+        }
+
+        VmaPoolCreateInfo poolInfo{};
+        poolInfo.memoryTypeIndex = memoryType;
+        poolInfo.blockSize = desc.blockSize;
+        poolInfo.maxBlockCount = desc.maxBlockCount;
+        if (vmaCreatePool(m_allocator, &poolInfo, &m_pools[getPoolIndex(desc.pool)]) !=
+            VK_SUCCESS) {
+            return std::unexpected(makeError(
+                ErrorCode::VulkanResourceCreationFailed,
+                std::format("Failed to create the {} pool", name)
+            ));
+        }
+        vmaSetPoolName(m_allocator, m_pools[getPoolIndex(desc.pool)], name);
+        m_blockSizes[getPoolIndex(desc.pool)] = desc.blockSize;
+
+        Logger::info("GPU {} pool: memory type {}, up to {} x {} MiB", name, memoryType,
+                     desc.maxBlockCount, desc.blockSize >> 20);
+    }
+
+    return {};
+}
+
+auto GpuMemory::createBuffer(MemoryPool pool, VkDeviceSize size, VkBufferUsageFlags usage,
+                             std::span<const uint32_t> queueFamilies) -> Result<GpuBuffer> {
+    ZoneScoped;
+    std::vector<uint32_t> families(queueFamilies.begin(), queueFamilies.end());
+    std::ranges::sort(families);
+    families.erase(std::ranges::unique(families).begin(), families.end());
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (families.size() > 1) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(families.size());
+        bufferInfo.pQueueFamilyIndices = families.data();
+    }
+
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.pool = m_pools[getPoolIndex(pool)];
+    if (pool == MemoryPool::Staging) {
+        allocationInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT |
+                               VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+    }
+
+    GpuBuffer buffer;
+    VmaAllocationInfo allocated{};
+    const VkResult result = vmaCreateBuffer(m_allocator, &bufferInfo, &allocationInfo,
+                                            &buffer.buffer, &buffer.allocation, &allocated);
+    if (result != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            std::format("Failed to allocate {} bytes from the {} pool{}", size,
+                        kPoolNames[getPoolIndex(pool)],
+                        result == VK_ERROR_OUT_OF_DEVICE_MEMORY ? ": pool is full" : "")
+        ));
+    }
+    buffer.data = allocated.pMappedData;
+    buffer.size = size;
+    return buffer;
+}
+
+void GpuMemory::destroyBuffer(GpuBuffer& buffer) noexcept {
+    if (buffer.buffer != VK_NULL_HANDLE) {
+        vmaDestroyBuffer(m_allocator, buffer.buffer, buffer.allocation);
+    }
+    buffer = GpuBuffer{};
+}
+
+auto GpuMemory::createImage(const VkImageCreateInfo& imageInfo) -> Result<GpuImage> {
+    ZoneScoped;
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    GpuImage image;
+    if (vmaCreateImage(m_allocator, &imageInfo, &allocationInfo, &image.image,
+                       &image.allocation, nullptr) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to create image"
+        ));
+    }
+    return image;
+}
+
+void GpuMemory::destroyImage(GpuImage& image) noexcept {
+    if (image.image != VK_NULL_HANDLE) {
+        vmaDestroyImage(m_allocator, image.image, image.allocation);
+    }
+    image = GpuImage{};
+}
+
+auto GpuMemory::allocateTransientHeap(const VkMemoryRequirements& requirements)
+    -> Result<VmaAllocation> {
+    ZoneScoped;
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.pool = m_pools[getPoolIndex(MemoryPool::Transient)];
+
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    if (vmaAllocateMemory(m_allocator, &requirements, &allocationInfo, &allocation, nullptr) !=
+        VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            std::format("Failed to allocate a {:.1f} MiB transient heap",
+                        toMebibytes(requirements.size))
+        ));
+    }
+    return allocation;
+}
+
+auto GpuMemory::bindTransientImage(VmaAllocation heap, VkDeviceSize offset, VkImage image)
+    -> VoidResult {
+    if (vmaBindImageMemory2(m_allocator, heap, offset, image, nullptr) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to bind a transient image"
+        ));
+    }
+    return {};
+}
+
+auto GpuMemory::bindTransientBuffer(VmaAllocation heap, VkDeviceSize offset, VkBuffer buffer)
+    -> VoidResult {
+    if (vmaBindBufferMemory2(m_allocator, heap, offset, buffer, nullptr) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to bind a transient buffer"
+        ));
+    }
+    return {};
+}
+
+void GpuMemory::free(VmaAllocation allocation) noexcept {
+    if (allocation != VK_NULL_HANDLE) {
+        vmaFreeMemory(m_allocator, allocation);
+    }
+}
+
+void GpuMemory::beginFrame() {
+    ZoneScoped;
+    vmaSetCurrentFrameIndex(m_allocator, ++m_frameIndex);
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+    vmaGetHeapBudgets(m_allocator, budgets.data());
+    const VkPhysicalDeviceMemoryProperties* properties = nullptr;
+    vmaGetMemoryProperties(m_allocator, &properties);
+
+    m_deviceLocalBudget = MemoryBudget{};
+    for (uint32_t heap = 0; heap < properties->memoryHeapCount; ++heap) {
+        if (properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            m_deviceLocalBudget.usage += budgets[heap].usage;
+            m_deviceLocalBudget.budget += budgets[heap].budget;
+        }
+    }
+
+    TracyPlot("GPU Memory Usage MiB", toMebibytes(m_deviceLocalBudget.usage));
+    TracyPlot("GPU Memory Budget MiB", toMebibytes(m_deviceLocalBudget.budget));
+    for (size_t pool = 0; pool < m_pools.size(); ++pool) {
+        if (m_pools[pool] != VK_NULL_HANDLE) {
+            TracyPlot(kPoolPlotNames[pool],
+                      toMebibytes(getPoolUsage(static_cast<MemoryPool>(pool)).blockBytes));
+        }
+    }
+
+    // Warn on the transition only, not every frame spent over budget
+    const bool overBudget = m_deviceLocalBudget.usage > m_deviceLocalBudget.budget;
+    if (overBudget && !m_overBudget) {
+        Logger::warn("GPU memory over budget: {:.0f} of {:.0f} MiB",
+                     toMebibytes(m_deviceLocalBudget.usage),
+                     toMebibytes(m_deviceLocalBudget.budget));
+    }
+    m_overBudget = overBudget;
+}
+
+auto GpuMemory::getPoolUsage(MemoryPool pool) const -> PoolUsage {
+    VmaStatistics statistics{};
+    vmaGetPoolStatistics(m_allocator, m_pools[getPoolIndex(pool)], &statistics);
+    return PoolUsage{statistics.allocationBytes, statistics.blockBytes};
+}
+
+auto GpuMemory::getBlockSize(MemoryPool pool) const -> VkDeviceSize {
+    return m_blockSizes[getPoolIndex(pool)];
+}
+
+auto LinearAllocator::create(GpuMemory& memory, VkDeviceSize capacity, VkBufferUsageFlags usage,
+                             std::span<const uint32_t> queueFamilies) -> Result<LinearAllocator> {
+    auto buffer = memory.createBuffer(MemoryPool::Staging, capacity, usage, queueFamilies);
+    if (!buffer) {
+        return std::unexpected(buffer.error());
+    }
+
+    LinearAllocator allocator;
+    allocator.m_buffer = *buffer;
+    return allocator;
+}
+
+void LinearAllocator::destroy(GpuMemory& memory) noexcept {
+    memory.destroyBuffer(m_buffer);
+    m_offset = 0;
+}
+
+auto LinearAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment)
+    -> std::optional<Allocation> {
+    const VkDeviceSize offset = (m_offset + alignment - 1) & ~(alignment - 1);
+    if (offset + size > m_buffer.size) {
+        return std::nullopt;
+    }
+    m_offset = offset + size;
+    return Allocation{m_buffer.buffer, offset, static_cast<std::byte*>(m_buffer.data) + offset};
+}
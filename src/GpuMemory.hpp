@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include "Error.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+
+// Pools with blocks of their own, so each kind of resource is bounded separately and can
+// neither starve nor fragment the others
+enum class MemoryPool : uint8_t {
+    ClusterPages, // Device-local storage buffers for resident geometry pages
+    Staging,      // Host-visible, written sequentially, read by transfers
+    Transient,    // Device-local heaps that render graph resources are aliased into
+    Count,
+};
+
+struct GpuMemoryConfig {
+    // The page pool is the one that grows with streamed geometry: its block count caps it
+    VkDeviceSize clusterPageBlockSize{64ull << 20};
+    uint32_t maxClusterPageBlocks{16};
+    VkDeviceSize stagingBlockSize{32ull << 20};
+    uint32_t maxStagingBlocks{8};
+    VkDeviceSize transientBlockSize{256ull << 20};
+    uint32_t maxTransientBlocks{4};
+};
+
+struct GpuBuffer {
+    VkBuffer buffer{VK_NULL_HANDLE};
+    VmaAllocation allocation{VK_NULL_HANDLE};
+    void* data{nullptr}; // Persistently mapped for host-visible pools
+    VkDeviceSize size{0};
+};
+
+struct GpuImage {
+    VkImage image{VK_NULL_HANDLE};
+    VmaAllocation allocation{VK_NULL_HANDLE};
+};
+
+// Device-local heaps as reported by VK_EXT_memory_budget, or estimated by VMA without it
+struct MemoryBudget {
+    VkDeviceSize usage{0};
+    VkDeviceSize budget{0};
+};
+
+struct PoolUsage {
+    VkDeviceSize allocationBytes{0};
+    VkDeviceSize blockBytes{0}; // Device memory the pool holds, used or not
+};
+
+// VMA allocator with one pool per MemoryPool. Allocations beyond a pool's block limit fail
+// instead of growing device memory without bound.
+class GpuMemory {
+public:
+    // memoryBudget tells whether VK_EXT_memory_budget is enabled on the device
+    [[nodiscard]] static auto create(VkInstance instance, VkPhysicalDevice physicalDevice,
+                                     VkDevice device, bool memoryBudget,
+                                     const GpuMemoryConfig& config = {})
+        -> Result<std::unique_ptr<GpuMemory>>;
+    ~GpuMemory();
+
+    GpuMemory(const GpuMemory&) = delete;
+    GpuMemory& operator=(const GpuMemory&) = delete;
+    GpuMemory(GpuMemory&&) = delete;
+    GpuMemory& operator=(GpuMemory&&) = delete;
+
+    // Buffers used by queues of several families are shared concurrently, so none of them
+    // needs an ownership transfer; queueFamilies may repeat a family
+    [[nodiscard]] auto createBuffer(MemoryPool pool, VkDeviceSize size,
+                                    VkBufferUsageFlags usage,
+                                    std::span<const uint32_t> queueFamilies = {})
+        -> Result<GpuBuffer>;
+    void destroyBuffer(GpuBuffer& buffer) noexcept;
+    // Long-lived images outside the pools, e.g. offscreen targets; VMA decides whether they
+    // get dedicated memory
+    [[nodiscard]] auto createImage(const VkImageCreateInfo& imageInfo) -> Result<GpuImage>;
+    void destroyImage(GpuImage& image) noexcept;
+
+    // Memory for a render graph's transient heap of CompiledRenderGraph::heapSize bytes.
+    // requirements combines those of every resource placed in it.
+    [[nodiscard]] auto allocateTransientHeap(const VkMemoryRequirements& requirements)
+        -> Result<VmaAllocation>;
+    // Binds a resource at its CompiledRenderGraph::Allocation offset in the heap
+    [[nodiscard]] auto bindTransientImage(VmaAllocation heap, VkDeviceSize offset,
+                                          VkImage image) -> VoidResult;
+    [[nodiscard]] auto bindTransientBuffer(VmaAllocation heap, VkDeviceSize offset,
+                                           VkBuffer buffer) -> VoidResult;
+    void free(VmaAllocation allocation) noexcept;
+
+    // Called once per frame: advances VMA's frame index, which refreshes the budget, and
+    // plots usage against it
+    void beginFrame();
+
+    [[nodiscard]] auto getDeviceLocalBudget() const noexcept -> const MemoryBudget& {
+        return m_deviceLocalBudget;
+    }
+    [[nodiscard]] auto getPoolUsage(MemoryPool pool) const -> PoolUsage;
+    // No single allocation from the pool can be larger
+    [[nodiscard]] auto getBlockSize(MemoryPool pool) const -> VkDeviceSize;
+    [[nodiscard]] auto getAllocator() const noexcept -> VmaAllocator { return m_allocator; }
+
+private:
+    GpuMemory() = default;
+
+    [[nodiscard]] auto createPools(const GpuMemoryConfig& config) -> VoidResult;
+
+    VmaAllocator m_allocator{VK_NULL_HANDLE};
+    std::array<VmaPool, static_cast<size_t>(MemoryPool::Count)> m_pools{};
+    std::array<VkDeviceSize, static_cast<size_t>(MemoryPool::Count)> m_blockSizes{};
+    uint32_t m_frameIndex{0};
+    MemoryBudget m_deviceLocalBudget;
+    bool m_overBudget{false};
+};
+
+// Bump allocator over one persistently mapped staging buffer, reset as a whole once the GPU
+// has consumed everything it handed out. Backs the per-frame upload rings.
+class LinearAllocator {
+public:
+    struct Allocation {
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VkDeviceSize offset{0};
+        void* data{nullptr};
+    };
+
+    LinearAllocator() = default;
+    [[nodiscard]] static auto create(GpuMemory& memory, VkDeviceSize capacity,
+                                     VkBufferUsageFlags usage,
+                                     std::span<const uint32_t> queueFamilies = {})
+        -> Result<LinearAllocator>;
+    void destroy(GpuMemory& memory) noexcept;
+
+    // Nothing when the buffer is exhausted; alignment must be a power of two
+    [[nodiscard]] auto allocate(VkDeviceSize size, VkDeviceSize alignment = 16)
+        -> std::optional<Allocation>;
+    void reset() noexcept { m_offset = 0; }
+
+    [[nodiscard]] auto getUsed() const noexcept -> VkDeviceSize { return m_offset; }
+    [[nodiscard]] auto getCapacity() const noexcept -> VkDeviceSize { return m_buffer.size; }
+
+private:
+    GpuBuffer m_buffer;
+    VkDeviceSize m_offset{0};
+};
@@ -0,0 +1,156 @@
+#include "GpuPagePool.hpp"
+#include "Logger.hpp"
+#include "Streaming/PageCache.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+auto GpuPagePool::create(VulkanContext& context, uint32_t slotCount, uint32_t pageSize)
+    -> Result<std::unique_ptr<GpuPagePool>> {
+    ZoneScoped;
+    std::unique_ptr<GpuPagePool> pool(new GpuPagePool(context));
+    GpuMemory& memory = context.getMemory();
+    pool->m_pageSize = pageSize;
+    pool->m_slotsPerBuffer = static_cast<uint32_t>(std::min<VkDeviceSize>(
+        memory.getBlockSize(MemoryPool::ClusterPages) / pageSize, slotCount));
+    if (pool->m_slotsPerBuffer == 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            std::format("Pages of {} bytes do not fit a cluster page pool block", pageSize)
+        ));
+    }
+
+    // Written by the transfer queue, read by whichever queue decodes or culls
+    const auto families = context.getQueueFamilies();
+    for (uint32_t first = 0; first < slotCount; first += pool->m_slotsPerBuffer) {
+        const uint32_t count = std::min(pool->m_slotsPerBuffer, slotCount - first);
+        auto buffer = memory.createBuffer(
+            MemoryPool::ClusterPages, static_cast<VkDeviceSize>(count) * pageSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, families);
+        if (!buffer) {
+            return std::unexpected(buffer.error());
+        }
+        pool->m_buffers.push_back(*buffer);
+    }
+    pool->m_slotPages.assign(slotCount, kEmptySlot);
+
+    auto commandPool = context.createCommandPool(QueueType::Transfer,
+                                                 VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    if (!commandPool) {
+        return std::unexpected(commandPool.error());
+    }
+    pool->m_commandPool = *commandPool;
+
+    VkCommandBufferAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocateInfo.commandPool = pool->m_commandPool;
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = context.getFramesInFlight();
+    if (vkAllocateCommandBuffers(context.getDevice(), &allocateInfo,
+                                 pool->m_commandBuffers.data()) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to allocate page upload command buffers"
+        ));
+    }
+
+    Logger::info("GPU page pool: {} slots in {} buffers, uploaded on {} transfer queue",
+                 slotCount, pool->m_buffers.size(),
+                 context.hasDedicatedQueue(QueueType::Transfer) ? "a dedicated" : "a shared");
+    return pool;
+}
+
+GpuPagePool::~GpuPagePool() {
+    if (m_commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(m_context.getDevice(), m_commandPool, nullptr);
+    }
+    for (GpuBuffer& buffer : m_buffers) {
+        m_context.getMemory().destroyBuffer(buffer);
+    }
+}
+
+void GpuPagePool::update(const PageCache& cache, std::span<const uint8_t> residentPages) {
+    ZoneScoped;
+    const uint32_t frame = m_context.getCurrentFrame();
+    const VkCommandBuffer commandBuffer = m_commandBuffers[frame];
+    std::vector<uint32_t> uploadedSlots;
+    uint64_t uploadedBytes = 0;
+    bool replacesPages = false;
+    for (uint32_t page = 0; page < residentPages.size(); ++page) {
+        if (residentPages[page] == 0) {
+            continue;
+        }
+        const uint32_t slot = cache.getSlot(page);
+        if (m_slotPages[slot] == page) {
+            continue;
+        }
+        const PageView view = *cache.getPage(page);
+        const auto staging = m_context.allocateUpload(view.data.size());
+        if (!staging) {
+            ++m_stats.deferredPages;
+            continue;
+        }
+        std::memcpy(staging->data, view.data.data(), view.data.size());
+
+        if (uploadedSlots.empty()) {
+            // The frame's fence normally covers the buffer's last submission, but not when
+            // that frame's own submission failed
+            if (!m_context.waitForQueue(QueueType::Transfer, m_submittedValues[frame])) {
+                Logger::error("Timed out waiting for a page upload");
+                return;
+            }
+            vkResetCommandBuffer(commandBuffer, 0);
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+            // Earlier uploads into a slot written again here must land first
+            VkMemoryBarrier2 barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+            barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            VkDependencyInfo dependencyInfo{};
+            dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependencyInfo.memoryBarrierCount = 1;
+            dependencyInfo.pMemoryBarriers = &barrier;
+            vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+        }
+        const VkBufferCopy region{staging->offset, getSlotOffset(slot), view.data.size()};
+        vkCmdCopyBuffer(commandBuffer, staging->buffer, getSlotBuffer(slot), 1, &region);
+
+        replacesPages |= m_slotPages[slot] != kEmptySlot;
+        m_slotPages[slot] = page;
+        uploadedSlots.push_back(slot);
+        uploadedBytes += view.data.size();
+    }
+    if (uploadedSlots.empty()) {
+        return;
+    }
+    vkEndCommandBuffer(commandBuffer);
+
+    // A replaced page may still be read by frames in flight; new slots have no readers yet
+    std::vector<QueueWait> waits;
+    if (replacesPages) {
+        waits.push_back(QueueWait{QueueType::Graphics,
+                                  m_context.getSubmittedValue(QueueType::Graphics),
+                                  VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT});
+    }
+    const auto submitted = m_context.submit(QueueType::Transfer, std::span(&commandBuffer, 1),
+                                            waits);
+    if (!submitted) {
+        Logger::error("Page upload failed, retrying next frame: {}",
+                      submitted.error().toString());
+        for (uint32_t slot : uploadedSlots) {
+            m_slotPages[slot] = kEmptySlot;
+        }
+        return;
+    }
+    m_submittedValues[frame] = *submitted;
+    m_stats.uploadedPages += uploadedSlots.size();
+    m_stats.uploadedBytes += uploadedBytes;
+    m_context.addFrameWait(QueueWait{QueueType::Transfer, *submitted});
+}
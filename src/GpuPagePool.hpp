@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "Error.hpp"
+#include "GpuMemory.hpp"
+#include "VulkanContext.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+class PageCache;
+
+// Device-local copy of the page cache, laid out by cache slot, for GPU decoding and culling.
+//
+// Pages that became resident are staged in the frame's upload ring and copied on the transfer
+// queue, which overlaps with rendering on devices with a copy engine of their own. The frame
+// waits for the copies on the transfer timeline before any of its work runs. Slots are spread
+// over buffers of one cluster page pool block each, since no allocation may span blocks.
+class GpuPagePool {
+public:
+    struct Stats {
+        uint64_t uploadedPages{0};
+        uint64_t uploadedBytes{0};
+        uint64_t deferredPages{0}; // Left for a later frame because the upload ring was full
+    };
+
+    [[nodiscard]] static auto create(VulkanContext& context, uint32_t slotCount,
+                                     uint32_t pageSize) -> Result<std::unique_ptr<GpuPagePool>>;
+    // The GPU must be done with the pool, e.g. after VulkanContext::waitIdle()
+    ~GpuPagePool();
+
+    GpuPagePool(const GpuPagePool&) = delete;
+    GpuPagePool& operator=(const GpuPagePool&) = delete;
+    GpuPagePool(GpuPagePool&&) = delete;
+    GpuPagePool& operator=(GpuPagePool&&) = delete;
+
+    // Uploads every resident page whose slot holds another page, or none, on the GPU.
+    // residentPages has an entry per page, non-zero when resident. Valid between
+    // VulkanContext::beginFrame() and endFrame().
+    void update(const PageCache& cache, std::span<const uint8_t> residentPages);
+
+    // Buffer and offset of a slot's page
+    [[nodiscard]] auto getSlotBuffer(uint32_t slot) const -> VkBuffer {
+        return m_buffers[slot / m_slotsPerBuffer].buffer;
+    }
+    [[nodiscard]] auto getSlotOffset(uint32_t slot) const -> VkDeviceSize {
+        return static_cast<VkDeviceSize>(slot % m_slotsPerBuffer) * m_pageSize;
+    }
+    [[nodiscard]] auto getStats() const noexcept -> const Stats& { return m_stats; }
+
+private:
+    static constexpr uint32_t kEmptySlot = ~0u;
+
+    explicit GpuPagePool(VulkanContext& context) : m_context(context) {}
+
+    VulkanContext& m_context;
+    uint32_t m_pageSize{0};
+    uint32_t m_slotsPerBuffer{0};
+    std::vector<GpuBuffer> m_buffers;
+    std::vector<uint32_t> m_slotPages; // Page each slot holds on the GPU, or kEmptySlot
+    VkCommandPool m_commandPool{VK_NULL_HANDLE};
+    // Per frame in flight, with the transfer timeline value its last submission signals
+    std::array<VkCommandBuffer, VulkanContext::kMaxFramesInFlight> m_commandBuffers{};
+    std::array<uint64_t, VulkanContext::kMaxFramesInFlight> m_submittedValues{};
+    Stats m_stats;
+};
@@ -0,0 +1,276 @@
+#include "PipelineCache.hpp"
+#include "Logger.hpp"
+#include <tracy/Tracy.hpp>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string_view>
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x43504756; // "VGPC"
+constexpr uint32_t kFileVersion = 1;
+
+// Precedes the driver's data, which starts with a VkPipelineCacheHeaderVersionOne of its own
+struct PipelineCacheFileHeader {
+    uint32_t magic{kFileMagic};
+    uint32_t version{kFileVersion};
+    uint32_t vendorId{0};
+    uint32_t deviceId{0};
+    uint32_t driverVersion{0};
+    uint8_t pipelineCacheUuid[VK_UUID_SIZE]{};
+    uint64_t dataSize{0};
+    uint64_t checksum{0};
+};
+
+// Layout of VkPipelineCacheHeaderVersionOne, read field by field since the driver writes it
+// without padding guarantees
+constexpr size_t kDriverHeaderSize = 16 + VK_UUID_SIZE;
+
+// FNV-1a over the driver's data
+[[nodiscard]] auto checksum(std::span<const uint8_t> bytes) noexcept -> uint64_t {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+[[nodiscard]] auto readUint32(const uint8_t* bytes) noexcept -> uint32_t {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] auto getFileName(const VkPhysicalDeviceProperties& properties) -> std::string {
+    std::string uuid;
+    for (uint8_t byte : properties.pipelineCacheUUID) {
+        uuid += std::format("{:02x}", byte);
+    }
+    return std::format("pipelines-{}-{:08x}.bin", uuid, properties.driverVersion);
+}
+
+} // namespace
+
+auto PipelineCache::create(VkPhysicalDevice physicalDevice, VkDevice device,
+                           std::filesystem::path directory)
+    -> Result<std::unique_ptr<PipelineCache>> {
+    ZoneScoped;
+    std::unique_ptr<PipelineCache> cache(new PipelineCache());
+    cache->m_device = device;
+    vkGetPhysicalDeviceProperties(physicalDevice, &cache->m_properties);
+    if (!directory.empty()) {
+        cache->m_path = directory / getFileName(cache->m_properties);
+    }
+
+    const std::vector<uint8_t> data = cache->loadData();
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache->m_cache) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to create pipeline cache"
+        ));
+    }
+
+    if (!data.empty()) {
+        Logger::info("Pipeline cache loaded from {} ({} KiB)", cache->m_path.string(),
+                     data.size() / 1024);
+    }
+    return cache;
+}
+
+PipelineCache::~PipelineCache() {
+    waitForCompilation();
+    for (const Entry& entry : m_entries) {
+        if (const VkPipeline pipeline = entry.pipeline.load(); pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(m_device, pipeline, nullptr);
+        }
+    }
+    if (m_cache != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(m_device, m_cache, nullptr);
+    }
+}
+
+auto PipelineCache::loadData() const -> std::vector<uint8_t> {
+    ZoneScoped;
+    if (m_path.empty()) {
+        return {};
+    }
+    std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        Logger::info("No pipeline cache at {}, pipelines compile from scratch", m_path.string());
+        return {};
+    }
+
+    const auto fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+    PipelineCacheFileHeader header;
+    if (fileSize < sizeof(header) ||
+        !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        Logger::warn("Ignoring truncated pipeline cache {}", m_path.string());
+        return {};
+    }
+
+    auto reject = [&](std::string_view reason) {
+        Logger::warn("Ignoring pipeline cache {}: {}", m_path.string(), reason);
+        return std::vector<uint8_t>{};
+    };
+    if (header.magic != kFileMagic || header.version != kFileVersion) {
+        return reject("not a pipeline cache of this version");
+    }
+    if (header.vendorId != m_properties.vendorID || header.deviceId != m_properties.deviceID ||
+        header.driverVersion != m_properties.driverVersion ||
+        std::memcmp(header.pipelineCacheUuid, m_properties.pipelineCacheUUID, VK_UUID_SIZE) !=
+            0) {
+        return reject("written by another device or driver");
+    }
+    if (header.dataSize != fileSize - sizeof(header) || header.dataSize < kDriverHeaderSize) {
+        return reject("size mismatch");
+    }
+
+    std::vector<uint8_t> data(header.dataSize);
+    if (!file.read(reinterpret_cast<char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()))) {
+        return reject("read failed");
+    }
+    if (checksum(data) != header.checksum) {
+        return reject("checksum mismatch");
+    }
+
+    // The driver's header must agree with the device as well
+    if (readUint32(data.data()) < kDriverHeaderSize ||
+        readUint32(data.data() + 4) != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        readUint32(data.data() + 8) != m_properties.vendorID ||
+        readUint32(data.data() + 12) != m_properties.deviceID ||
+        std::memcmp(data.data() + 16, m_properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return reject("driver header mismatch");
+    }
+
+    return data;
+}
+
+auto PipelineCache::save() -> VoidResult {
+    ZoneScoped;
+    if (m_path.empty()) {
+        return {};
+    }
+    // The data is only complete once nothing adds to the cache
+    waitForCompilation();
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to query pipeline cache size"
+        ));
+    }
+    std::vector<uint8_t> data(size);
+    if (vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to read pipeline cache data"
+        ));
+    }
+    data.resize(size);
+
+    PipelineCacheFileHeader header;
+    header.vendorId = m_properties.vendorID;
+    header.deviceId = m_properties.deviceID;
+    header.driverVersion = m_properties.driverVersion;
+    std::memcpy(header.pipelineCacheUuid, m_properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = data.size();
+    header.checksum = checksum(data);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path.parent_path(), error);
+    std::filesystem::path temporary = m_path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return std::unexpected(makeError(
+                ErrorCode::FileOpenFailed,
+                std::format("Failed to open {} for writing", temporary.string())
+            ));
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        if (!file.flush()) {
+            return std::unexpected(makeError(
+                ErrorCode::FileWriteFailed,
+                std::format("Failed to write {}", temporary.string())
+            ));
+        }
+    }
+
+    std::filesystem::rename(temporary, m_path, error);
+    if (error) {
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to replace {}: {}", m_path.string(), error.message())
+        ));
+    }
+
+    Logger::info("Pipeline cache saved to {} ({} KiB)", m_path.string(), data.size() / 1024);
+    return {};
+}
+
+auto PipelineCache::compileAsync(JobSystem* jobSystem, std::string name,
+                                 PipelineFactory factory) -> uint32_t {
+    const auto id = static_cast<uint32_t>(m_entries.size());
+    Entry& entry = m_entries.emplace_back();
+    entry.name = std::move(name);
+
+    if (jobSystem == nullptr) {
+        compile(entry, factory);
+        return id;
+    }
+
+    // Jobs only ever go to one job system, which outlives the cache
+    m_jobSystem = jobSystem;
+    jobSystem->submit(m_compilations, [this, &entry, factory = std::move(factory)]() {
+        compile(entry, factory);
+    });
+    return id;
+}
+
+void PipelineCache::compile(Entry& entry, const PipelineFactory& factory) {
+    ZoneScopedN("Compile Pipeline");
+    ZoneText(entry.name.data(), entry.name.size());
+    const auto start = std::chrono::steady_clock::now();
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    const VkResult result = factory(m_cache, pipeline);
+    if (result == VK_SUCCESS) {
+        entry.pipeline.store(pipeline, std::memory_order_release);
+        Logger::debug("Compiled pipeline {} in {:.1f} ms", entry.name,
+                      std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - start).count());
+    } else {
+        Logger::error("Failed to compile pipeline {}: {}", entry.name, static_cast<int>(result));
+    }
+    entry.done.store(true, std::memory_order_release);
+}
+
+auto PipelineCache::getPipeline(uint32_t id) const -> VkPipeline {
+    return m_entries[id].pipeline.load(std::memory_order_acquire);
+}
+
+auto PipelineCache::isReady(uint32_t id) const -> bool {
+    return m_entries[id].done.load(std::memory_order_acquire);
+}
+
+void PipelineCache::waitForCompilation() {
+    ZoneScoped;
+    if (m_jobSystem != nullptr && !m_compilations.isDone()) {
+        m_jobSystem->wait(m_compilations);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "Core/JobSystem.hpp"
+#include "Error.hpp"
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// VkPipelineCache persisted between runs, plus pipeline compilation on the job system.
+//
+// The file is named after the device's pipeline cache UUID and driver version, so caches of
+// different GPUs and drivers live side by side, and is checked against both again on load,
+// together with the driver's own cache header and a checksum. Anything that does not match
+// is ignored and the cache starts empty, since drivers may crash on foreign cache data.
+class PipelineCache {
+public:
+    // Fills in the pipeline and returns the vkCreate*Pipelines result; called with the cache
+    // on a worker thread
+    using PipelineFactory = std::function<VkResult(VkPipelineCache cache, VkPipeline& pipeline)>;
+
+    // directory may be empty to keep the cache in memory only
+    [[nodiscard]] static auto create(VkPhysicalDevice physicalDevice, VkDevice device,
+                                     std::filesystem::path directory)
+        -> Result<std::unique_ptr<PipelineCache>>;
+    // Waits for pending compilations and destroys every pipeline compiled through the cache
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+    PipelineCache(PipelineCache&&) = delete;
+    PipelineCache& operator=(PipelineCache&&) = delete;
+
+    // Waits for pending compilations, then writes the cache atomically: a crash mid-write
+    // leaves the previous file intact
+    [[nodiscard]] auto save() -> VoidResult;
+
+    // Compiles on the job system and returns an id for getPipeline(); runs the factory right
+    // away without one. Startup can go on rendering with whatever is ready.
+    [[nodiscard]] auto compileAsync(JobSystem* jobSystem, std::string name,
+                                    PipelineFactory factory) -> uint32_t;
+    // VK_NULL_HANDLE until compiled, or when compilation failed
+    [[nodiscard]] auto getPipeline(uint32_t id) const -> VkPipeline;
+    [[nodiscard]] auto isReady(uint32_t id) const -> bool;
+    // Blocks, helping with jobs, until every compilation so far has finished. Must be called
+    // before the job system goes away if it may still be compiling.
+    void waitForCompilation();
+
+    [[nodiscard]] auto getHandle() const noexcept -> VkPipelineCache { return m_cache; }
+    [[nodiscard]] auto getPath() const noexcept -> const std::filesystem::path& {
+        return m_path;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        std::atomic<VkPipeline> pipeline{VK_NULL_HANDLE};
+        std::atomic<bool> done{false};
+    };
+
+    PipelineCache() = default;
+
+    // Contents of the cache file when it is valid for this device, nothing otherwise
+    [[nodiscard]] auto loadData() const -> std::vector<uint8_t>;
+    void compile(Entry& entry, const PipelineFactory& factory);
+
+    VkDevice m_device{VK_NULL_HANDLE};
+    VkPipelineCache m_cache{VK_NULL_HANDLE};
+    VkPhysicalDeviceProperties m_properties{};
+    std::filesystem::path m_path;
+
+    // Grows only, so workers can hold on to their entry while more are added
+    std::deque<Entry> m_entries;
+    JobSystem* m_jobSystem{nullptr};
+    JobSystem::WaitGroup m_compilations;
+};
@@ -0,0 +1,346 @@
+#include "SoftwareRasterizer.hpp"
+#include "Core/JobSystem.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr int32_t kSubpixelBits = 8;
+constexpr int32_t kSubpixelScale = 1 << kSubpixelBits;
+constexpr int32_t kHalfPixel = kSubpixelScale / 2;
+// Snapped coordinates stay within 2^22 subpixels, so edge function products fit in 64 bits
+constexpr float kGuardBandPixels = 8192.0f;
+
+auto floorDivide(int64_t value, int64_t divisor) -> int64_t {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+auto ceilDivide(int64_t value, int64_t divisor) -> int64_t {
+    return -floorDivide(-value, divisor);
+}
+
+void atomicMin(uint64_t& target, uint64_t value) {
+    std::atomic_ref<uint64_t> atomic(target);
+    uint64_t current = atomic.load(std::memory_order_relaxed);
+    while (value < current &&
+           !atomic.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Edge from a to b as a * (x - ax) + b * (y - ay), non-negative inside a triangle with
+// positive area; the bias excludes samples exactly on edges that are not top or left
+struct Edge {
+    int64_t a;
+    int64_t b;
+    int64_t bias;
+
+    Edge(int32_t ax, int32_t ay, int32_t bx, int32_t by)
+        : a(static_cast<int64_t>(ay) - by), b(static_cast<int64_t>(bx) - ax),
+          bias(a > 0 || (a == 0 && b > 0) ? 0 : -1) {}
+};
+
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(const Config& config)
+    : m_config(config), m_tilesX((std::max(config.width, 1u) + kTileSize - 1) / kTileSize),
+      m_tilesY((std::max(config.height, 1u) + kTileSize - 1) / kTileSize) {
+    m_config.width = std::max(config.width, 1u);
+    m_config.height = std::max(config.height, 1u);
+    m_visibility.assign(static_cast<size_t>(m_config.width) * m_config.height, kEmpty);
+    m_bins.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+}
+
+void SoftwareRasterizer::beginFrame(const glm::mat4& viewProjection) {
+    ZoneScoped;
+    m_viewProjection = viewProjection;
+    m_clusters.clear();
+    m_stats = Stats{};
+    std::ranges::fill(m_visibility, kEmpty);
+}
+
+auto SoftwareRasterizer::addCluster(const RasterCluster& cluster) -> uint32_t {
+    const auto clusterId = static_cast<uint32_t>(m_clusters.size());
+    if (clusterId >= kMaxClusters) {
+        ++m_stats.clustersDropped;
+        return clusterId;
+    }
+    m_clusters.push_back(cluster);
+    ++m_stats.clustersSubmitted;
+    return clusterId;
+}
+
+auto SoftwareRasterizer::getDepth(uint64_t value) noexcept -> float {
+    return std::bit_cast<float>(static_cast<uint32_t>(value >> 32));
+}
+
+void SoftwareRasterizer::render(JobSystem* jobSystem) {
+    ZoneScoped;
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+    const auto start = Clock::now();
+
+    const auto clusterCount = static_cast<uint32_t>(m_clusters.size());
+    const uint32_t clustersPerJob = std::max(m_config.clustersPerJob, 1u);
+    const uint32_t jobCount = (clusterCount + clustersPerJob - 1) / clustersPerJob;
+    if (m_jobOutputs.size() < jobCount) {
+        m_jobOutputs.resize(jobCount);
+    }
+    parallelFor(jobSystem, jobCount, 1, [&](uint32_t job) {
+        ZoneScopedN("Raster Setup Job");
+        JobOutput& output = m_jobOutputs[job];
+        output.binned.clear();
+        output.stats = Stats{};
+        const uint32_t end = std::min((job + 1) * clustersPerJob, clusterCount);
+        for (uint32_t cluster = job * clustersPerJob; cluster < end; ++cluster) {
+            setupCluster(m_clusters[cluster], cluster, output);
+        }
+    });
+    const auto setupEnd = Clock::now();
+
+    // Binning is serial but only sees the few triangles too large for the micro path
+    for (std::vector<const SetupTriangle*>& bin : m_bins) {
+        bin.clear();
+    }
+    for (uint32_t job = 0; job < jobCount; ++job) {
+        const JobOutput& output = m_jobOutputs[job];
+        m_stats.trianglesSubmitted += output.stats.trianglesSubmitted;
+        m_stats.trianglesCulled += output.stats.trianglesCulled;
+        m_stats.trianglesClipped += output.stats.trianglesClipped;
+        m_stats.microTriangles += output.stats.microTriangles;
+        m_stats.binnedTriangles += output.binned.size();
+        for (const SetupTriangle& triangle : output.binned) {
+            for (int32_t y = triangle.minY / static_cast<int32_t>(kTileSize);
+                 y <= triangle.maxY / static_cast<int32_t>(kTileSize); ++y) {
+                for (int32_t x = triangle.minX / static_cast<int32_t>(kTileSize);
+                     x <= triangle.maxX / static_cast<int32_t>(kTileSize); ++x) {
+                    m_bins[static_cast<size_t>(y) * m_tilesX + x].push_back(&triangle);
+                    ++m_stats.binEntries;
+                }
+            }
+        }
+    }
+    const auto binEnd = Clock::now();
+
+    parallelFor(jobSystem, m_tilesX * m_tilesY, 1, [&](uint32_t tile) {
+        if (m_bins[tile].empty()) {
+            return;
+        }
+        ZoneScopedN("Raster Tile");
+        const auto tileX = static_cast<int32_t>(tile % m_tilesX * kTileSize);
+        const auto tileY = static_cast<int32_t>(tile / m_tilesX * kTileSize);
+        const int32_t tileMaxX = tileX + static_cast<int32_t>(kTileSize) - 1;
+        const int32_t tileMaxY = tileY + static_cast<int32_t>(kTileSize) - 1;
+        for (const SetupTriangle* triangle : m_bins[tile]) {
+            rasterizeTriangle(*triangle, std::max(triangle->minX, tileX),
+                              std::max(triangle->minY, tileY), std::min(triangle->maxX, tileMaxX),
+                              std::min(triangle->maxY, tileMaxY));
+        }
+    });
+
+    const auto end = Clock::now();
+    m_stats.setupMilliseconds = Milliseconds(setupEnd - start).count();
+    m_stats.binMilliseconds = Milliseconds(binEnd - setupEnd).count();
+    m_stats.tileMilliseconds = Milliseconds(end - binEnd).count();
+    m_stats.milliseconds = Milliseconds(end - start).count();
+    TracyPlot("Raster Triangles", static_cast<int64_t>(m_stats.trianglesSubmitted));
+    TracyPlot("Raster ms", m_stats.milliseconds);
+}
+
+void SoftwareRasterizer::setupCluster(const RasterCluster& cluster, uint32_t clusterId,
+                                      JobOutput& output) {
+    const glm::mat4 transform = m_viewProjection * cluster.transform;
+    const size_t vertexCount = cluster.vertices.empty() ? cluster.positions.size()
+                                                        : cluster.vertices.size();
+    std::array<glm::vec4, 256> clip;
+    if (vertexCount > clip.size()) {
+        output.stats.trianglesCulled += cluster.triangles.size() / 3;
+        return;
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const size_t vertex = cluster.vertices.empty() ? i : cluster.vertices[i];
+        const glm::vec3& position = cluster.positions[vertex];
+        clip[i] = transform * glm::vec4{position, 1.0f};
+    }
+
+    // Near plane and guard band as dot(plane, vertex) >= 0
+    const float guardX = 1.0f + 2.0f * kGuardBandPixels / static_cast<float>(m_config.width);
+    const float guardY = 1.0f + 2.0f * kGuardBandPixels / static_cast<float>(m_config.height);
+    const std::array<glm::vec4, 5> clipPlanes{
+        glm::vec4{0.0f, 0.0f, 1.0f, 0.0f},    glm::vec4{1.0f, 0.0f, 0.0f, guardX},
+        glm::vec4{-1.0f, 0.0f, 0.0f, guardX}, glm::vec4{0.0f, 1.0f, 0.0f, guardY},
+        glm::vec4{0.0f, -1.0f, 0.0f, guardY},
+    };
+
+    const size_t triangleCount =
+        std::min<size_t>(cluster.triangles.size() / 3, size_t{1} << kTriangleBits);
+    output.stats.trianglesSubmitted += cluster.triangles.size() / 3;
+    output.stats.trianglesCulled += cluster.triangles.size() / 3 - triangleCount;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        const uint8_t* indices = cluster.triangles.data() + triangle * 3;
+        if (std::max({indices[0], indices[1], indices[2]}) >= vertexCount) {
+            ++output.stats.trianglesCulled;
+            continue;
+        }
+        const std::array<glm::vec4, 3> vertices{clip[indices[0]], clip[indices[1]],
+                                                clip[indices[2]]};
+        const auto id = static_cast<uint32_t>(clusterId << kTriangleBits | triangle);
+
+        auto allOutside = [&](auto&& outside) {
+            return outside(vertices[0]) && outside(vertices[1]) && outside(vertices[2]);
+        };
+        if (allOutside([](const glm::vec4& v) { return v.x > v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.x < -v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.y > v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.y < -v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.z > v.w; }) ||
+            allOutside([](const glm::vec4& v) { return v.z < 0.0f; })) {
+            ++output.stats.trianglesCulled;
+            continue;
+        }
+
+        bool inside = true;
+        for (const glm::vec4& plane : clipPlanes) {
+            for (const glm::vec4& vertex : vertices) {
+                inside = inside && glm::dot(plane, vertex) >= 0.0f;
+            }
+        }
+        if (inside) {
+            setupTriangle(vertices, id, output);
+            continue;
+        }
+
+        // Sutherland-Hodgman against each plane; five planes add at most five vertices
+        ++output.stats.trianglesClipped;
+        std::array<glm::vec4, 8> polygon{vertices[0], vertices[1], vertices[2]};
+        std::array<glm::vec4, 8> clipped;
+        uint32_t polygonSize = 3;
+        for (const glm::vec4& plane : clipPlanes) {
+            uint32_t clippedSize = 0;
+            for (uint32_t v = 0; v < polygonSize; ++v) {
+                const glm::vec4& current = polygon[v];
+                const glm::vec4& next = polygon[(v + 1) % polygonSize];
+                const float currentDistance = glm::dot(plane, current);
+                const float nextDistance = glm::dot(plane, next);
+                if (currentDistance >= 0.0f) {
+                    clipped[clippedSize++] = current;
+                }
+                if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+                    const float t = currentDistance / (currentDistance - nextDistance);
+                    clipped[clippedSize++] = current + (next - current) * t;
+                }
+            }
+            polygon = clipped;
+            polygonSize = clippedSize;
+        }
+        for (uint32_t v = 1; v + 1 < polygonSize; ++v) {
+            setupTriangle({polygon[0], polygon[v], polygon[v + 1]}, id, output);
+        }
+    }
+}
+
+void SoftwareRasterizer::setupTriangle(const std::array<glm::vec4, 3>& clip, uint32_t id,
+                                       JobOutput& output) {
+    SetupTriangle triangle;
+    triangle.id = id;
+    for (uint32_t i = 0; i < 3; ++i) {
+        const float inverseW = 1.0f / clip[i].w;
+        const float x = (clip[i].x * inverseW * 0.5f + 0.5f) * static_cast<float>(m_config.width);
+        const float y =
+            (clip[i].y * inverseW * 0.5f + 0.5f) * static_cast<float>(m_config.height);
+        triangle.xy[i * 2] = static_cast<int32_t>(std::floor(x * kSubpixelScale + 0.5f));
+        triangle.xy[i * 2 + 1] = static_cast<int32_t>(std::floor(y * kSubpixelScale + 0.5f));
+        triangle.depth[i] = clip[i].z * inverseW;
+    }
+
+    auto& xy = triangle.xy;
+    const int64_t area =
+        static_cast<int64_t>(xy[2] - xy[0]) * (xy[5] - xy[1]) -
+        static_cast<int64_t>(xy[4] - xy[0]) * (xy[3] - xy[1]);
+    // Negative area is counter-clockwise in Vulkan's framebuffer coordinates
+    if (area == 0 || (m_config.cullBackFaces && area > 0)) {
+        ++output.stats.trianglesCulled;
+        return;
+    }
+    if (area < 0) {
+        std::swap(xy[2], xy[4]);
+        std::swap(xy[3], xy[5]);
+        std::swap(triangle.depth[1], triangle.depth[2]);
+    }
+
+    // Pixels whose centre lies within the snapped bounds
+    const int32_t minX = std::min({xy[0], xy[2], xy[4]});
+    const int32_t maxX = std::max({xy[0], xy[2], xy[4]});
+    const int32_t minY = std::min({xy[1], xy[3], xy[5]});
+    const int32_t maxY = std::max({xy[1], xy[3], xy[5]});
+    triangle.minX = static_cast<int32_t>(
+        std::max<int64_t>(ceilDivide(minX - kHalfPixel, kSubpixelScale), 0));
+    triangle.minY = static_cast<int32_t>(
+        std::max<int64_t>(ceilDivide(minY - kHalfPixel, kSubpixelScale), 0));
+    triangle.maxX = static_cast<int32_t>(std::min<int64_t>(
+        floorDivide(maxX - kHalfPixel, kSubpixelScale), m_config.width - 1));
+    triangle.maxY = static_cast<int32_t>(std::min<int64_t>(
+        floorDivide(maxY - kHalfPixel, kSubpixelScale), m_config.height - 1));
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        ++output.stats.trianglesCulled;
+        return;
+    }
+
+    if (triangle.maxX - triangle.minX < static_cast<int32_t>(kMicroTriangleSize) &&
+        triangle.maxY - triangle.minY < static_cast<int32_t>(kMicroTriangleSize)) {
+        ++output.stats.microTriangles;
+        rasterizeTriangle(triangle, triangle.minX, triangle.minY, triangle.maxX, triangle.maxY);
+        return;
+    }
+    output.binned.push_back(triangle);
+}
+
+void SoftwareRasterizer::rasterizeTriangle(const SetupTriangle& triangle, int32_t minX,
+                                           int32_t minY, int32_t maxX, int32_t maxY) {
+    const auto& xy = triangle.xy;
+    // Each edge function is the barycentric weight of the opposite vertex times the area
+    const Edge edge01(xy[0], xy[1], xy[2], xy[3]);
+    const Edge edge12(xy[2], xy[3], xy[4], xy[5]);
+    const Edge edge20(xy[4], xy[5], xy[0], xy[1]);
+    const int64_t area = edge01.a * (xy[4] - xy[0]) + edge01.b * (xy[5] - xy[1]);
+    const float inverseArea = 1.0f / static_cast<float>(area);
+
+    const int64_t sampleX = static_cast<int64_t>(minX) * kSubpixelScale + kHalfPixel;
+    const int64_t sampleY = static_cast<int64_t>(minY) * kSubpixelScale + kHalfPixel;
+    int64_t row01 = edge01.a * (sampleX - xy[0]) + edge01.b * (sampleY - xy[1]);
+    int64_t row12 = edge12.a * (sampleX - xy[2]) + edge12.b * (sampleY - xy[3]);
+    int64_t row20 = edge20.a * (sampleX - xy[4]) + edge20.b * (sampleY - xy[5]);
+
+    for (int32_t y = minY; y <= maxY; ++y) {
+        int64_t weight01 = row01;
+        int64_t weight12 = row12;
+        int64_t weight20 = row20;
+        uint64_t* pixels = m_visibility.data() + static_cast<size_t>(y) * m_config.width;
+        for (int32_t x = minX; x <= maxX; ++x) {
+            if (weight01 + edge01.bias >= 0 && weight12 + edge12.bias >= 0 &&
+                weight20 + edge20.bias >= 0) {
+                const float depth = (static_cast<float>(weight12) * triangle.depth[0] +
+                                     static_cast<float>(weight20) * triangle.depth[1] +
+                                     static_cast<float>(weight01) * triangle.depth[2]) *
+                                    inverseArea;
+                // Samples beyond the far plane are clipped; clamping to +0 keeps the bit
+                // patterns of all depths ordered like the values
+                if (depth <= 1.0f) {
+                    const float clamped = depth > 0.0f ? depth : 0.0f;
+                    atomicMin(pixels[x],
+                              static_cast<uint64_t>(std::bit_cast<uint32_t>(clamped)) << 32 |
+                                  triangle.id);
+                }
+            }
+            weight01 += edge01.a * kSubpixelScale;
+            weight12 += edge12.a * kSubpixelScale;
+            weight20 += edge20.a * kSubpixelScale;
+        }
+        row01 += edge01.b * kSubpixelScale;
+        row12 += edge12.b * kSubpixelScale;
+        row20 += edge20.b * kSubpixelScale;
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+// One cluster to draw. The spans must stay valid until render().
+struct RasterCluster {
+    std::span<const glm::vec3> positions;
+    // Maps local vertex indices into positions, as in ClusterMesh; empty when positions holds
+    // exactly the cluster's vertices
+    std::span<const uint32_t> vertices;
+    std::span<const uint8_t> triangles; // Three local vertex indices per triangle
+    glm::mat4 transform{1.0f};           // Object to clip space is viewProjection * transform
+};
+
+// Multithreaded CPU rasterizer writing a 64-bit visibility buffer: depth in the high 32 bits
+// and (cluster << kTriangleBits | triangle) in the low ones, resolved with an atomic min so the
+// nearest surface wins and equal depths go to the lower id. The result is independent of
+// thread count and submission timing, which makes it the golden reference for the compute
+// rasterizer and a visibility path for machines without a GPU.
+//
+// Clusters are set up in parallel. Triangles whose bounds fit in kMicroTriangleSize pixels,
+// the common case for virtual geometry, are rasterized right away by the setup job; larger
+// ones are binned into tiles that are filled in a second parallel pass.
+//
+// Rasterization follows Vulkan: vertices snap to 1/256 pixel, coverage is sampled at pixel
+// centres with the top-left rule, depth is 0 at the near plane, and counter-clockwise
+// triangles face forward. Triangles are clipped against the near plane and a guard band.
+class SoftwareRasterizer {
+public:
+    static constexpr uint32_t kTileSize = 64;
+    static constexpr uint32_t kMicroTriangleSize = 16;
+    static constexpr uint32_t kTriangleBits = 9; // ClusterBuilder allows 512 triangles
+    static constexpr uint32_t kMaxClusters = 1u << (32 - kTriangleBits);
+    static constexpr uint64_t kEmpty = ~0ull;
+
+    struct Config {
+        uint32_t width{1280};
+        uint32_t height{720};
+        bool cullBackFaces{true};
+        uint32_t clustersPerJob{16};
+    };
+
+    struct Stats {
+        uint32_t clustersSubmitted{0};
+        uint32_t clustersDropped{0}; // Beyond kMaxClusters
+        uint64_t trianglesSubmitted{0};
+        uint64_t trianglesCulled{0}; // Back-facing, degenerate, outside or between samples
+        uint64_t trianglesClipped{0};
+        uint64_t microTriangles{0};
+        uint64_t binnedTriangles{0};
+        uint64_t binEntries{0};
+        float setupMilliseconds{0.0f}; // Includes micro-triangle rasterization
+        float binMilliseconds{0.0f};
+        float tileMilliseconds{0.0f};
+        float milliseconds{0.0f};
+    };
+
+    explicit SoftwareRasterizer(const Config& config);
+
+    // Clears the visibility buffer and the queued clusters
+    void beginFrame(const glm::mat4& viewProjection);
+    // Returns the cluster id written to the visibility buffer, the submission index
+    auto addCluster(const RasterCluster& cluster) -> uint32_t;
+    void render(JobSystem* jobSystem);
+
+    [[nodiscard]] auto getVisibilityBuffer() const noexcept -> std::span<const uint64_t> {
+        return m_visibility;
+    }
+    [[nodiscard]] auto getWidth() const noexcept -> uint32_t { return m_config.width; }
+    [[nodiscard]] auto getHeight() const noexcept -> uint32_t { return m_config.height; }
+    [[nodiscard]] auto getStats() const noexcept -> const Stats& { return m_stats; }
+
+    [[nodiscard]] static auto getDepth(uint64_t value) noexcept -> float;
+    [[nodiscard]] static auto getCluster(uint64_t value) noexcept -> uint32_t {
+        return static_cast<uint32_t>(value) >> kTriangleBits;
+    }
+    [[nodiscard]] static auto getTriangle(uint64_t value) noexcept -> uint32_t {
+        return static_cast<uint32_t>(value) & ((1u << kTriangleBits) - 1);
+    }
+
+private:
+    // Snapped vertices in 1/256 pixels, depth per vertex, id and inclusive pixel bounds
+    struct SetupTriangle {
+        std::array<int32_t, 6> xy;
+        glm::vec3 depth;
+        uint32_t id;
+        int32_t minX;
+        int32_t minY;
+        int32_t maxX;
+        int32_t maxY;
+    };
+
+    struct JobOutput {
+        std::vector<SetupTriangle> binned;
+        Stats stats;
+    };
+
+    void setupCluster(const RasterCluster& cluster, uint32_t clusterId, JobOutput& output);
+    void setupTriangle(const std::array<glm::vec4, 3>& clip, uint32_t id, JobOutput& output);
+    void rasterizeTriangle(const SetupTriangle& triangle, int32_t minX, int32_t minY,
+                           int32_t maxX, int32_t maxY);
+
+    Config m_config;
+    uint32_t m_tilesX;
+    uint32_t m_tilesY;
+    glm::mat4 m_viewProjection{1.0f};
+    std::vector<uint64_t> m_visibility; // Accessed through std::atomic_ref while rendering
+    std::vector<RasterCluster> m_clusters;
+    std::vector<JobOutput> m_jobOutputs; // Reused across frames
+    std::vector<std::vector<const SetupTriangle*>> m_bins;
+    Stats m_stats;
+};
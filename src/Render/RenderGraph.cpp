@@ -0,0 +1,414 @@
+#include "RenderGraph.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <functional>
+#include <optional>
+#include <queue>
+
+namespace {
+
+auto alignUp(uint64_t value, uint64_t alignment) -> uint64_t {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Layout shared by every usage in the mask, or nothing if they disagree
+auto getMaskLayout(UsageMask usages) -> std::optional<ImageLayout> {
+    std::optional<ImageLayout> layout;
+    for (UsageMask remaining = usages; remaining != 0; remaining &= remaining - 1) {
+        const auto usage = static_cast<ResourceUsage>(std::countr_zero(remaining));
+        const ImageLayout usageLayout = getUsageLayout(usage);
+        if (layout && *layout != usageLayout) {
+            return std::nullopt;
+        }
+        layout = usageLayout;
+    }
+    return layout;
+}
+
+// Synchronization state of one resource while walking the passes in execution order
+struct ResourceState {
+    UsageMask lastWrite{0};
+    UsageMask readsSinceWrite{0};
+    ImageLayout layout{ImageLayout::Undefined};
+    bool hasContents{false};
+};
+
+} // namespace
+
+auto getUsageLayout(ResourceUsage usage) noexcept -> ImageLayout {
+    switch (usage) {
+    case ResourceUsage::ColorAttachmentWrite:
+        return ImageLayout::ColorAttachment;
+    case ResourceUsage::DepthAttachmentRead:
+    case ResourceUsage::DepthAttachmentWrite:
+        return ImageLayout::DepthAttachment;
+    case ResourceUsage::SampledRead:
+        return ImageLayout::ShaderReadOnly;
+    case ResourceUsage::StorageRead:
+    case ResourceUsage::StorageWrite:
+    case ResourceUsage::IndirectRead:
+        return ImageLayout::General;
+    case ResourceUsage::TransferRead:
+        return ImageLayout::TransferSrc;
+    case ResourceUsage::TransferWrite:
+        return ImageLayout::TransferDst;
+    case ResourceUsage::Present:
+        return ImageLayout::Present;
+    case ResourceUsage::Count:
+        break;
+    }
+    return ImageLayout::Undefined;
+}
+
+auto getUsageMaskLayout(UsageMask usages) noexcept -> ImageLayout {
+    return usages != 0 ? getUsageLayout(static_cast<ResourceUsage>(std::countr_zero(usages)))
+                       : ImageLayout::Undefined;
+}
+
+auto RenderGraph::createResource(RenderGraphResourceDesc desc) -> RenderGraphHandle {
+    desc.alignment = std::max<uint64_t>(desc.alignment, 1);
+    m_resources.push_back(Resource{.desc = std::move(desc)});
+    return RenderGraphHandle{static_cast<uint32_t>(m_resources.size() - 1), 0};
+}
+
+auto RenderGraph::importResource(std::string name, ResourceKind kind, UsageMask initialUsage,
+                                 UsageMask finalUsage) -> RenderGraphHandle {
+    m_resources.push_back(Resource{
+        .desc = RenderGraphResourceDesc{.name = std::move(name), .kind = kind},
+        .imported = true,
+        .initialUsage = initialUsage,
+        .finalUsage = finalUsage,
+    });
+    return RenderGraphHandle{static_cast<uint32_t>(m_resources.size() - 1), 0};
+}
+
+auto RenderGraph::addPass(std::string name) -> uint32_t {
+    m_passes.push_back(Pass{.name = std::move(name), .accesses = {}});
+    return static_cast<uint32_t>(m_passes.size() - 1);
+}
+
+void RenderGraph::read(uint32_t pass, RenderGraphHandle handle, ResourceUsage usage) {
+    if (isWriteUsage(usage)) {
+        m_declarationError = std::format("Pass {} reads {} with a write usage",
+                                         m_passes[pass].name, getResourceName(handle.resource));
+        return;
+    }
+    addAccess(pass, handle.resource, handle.version, usage, false);
+}
+
+auto RenderGraph::write(uint32_t pass, RenderGraphHandle handle, ResourceUsage usage)
+    -> RenderGraphHandle {
+    Resource& resource = m_resources[handle.resource];
+    const auto latest = static_cast<uint32_t>(resource.writers.size() - 1);
+    if (!isWriteUsage(usage)) {
+        m_declarationError = std::format("Pass {} writes {} with a read usage",
+                                         m_passes[pass].name, resource.desc.name);
+        return handle;
+    }
+    if (handle.version != latest) {
+        m_declarationError =
+            std::format("Pass {} writes version {} of {}, which was already written",
+                        m_passes[pass].name, handle.version, resource.desc.name);
+        return handle;
+    }
+
+    addAccess(pass, handle.resource, handle.version, usage, true);
+    resource.writers.push_back(pass);
+    return RenderGraphHandle{handle.resource, latest + 1};
+}
+
+void RenderGraph::addAccess(uint32_t pass, uint32_t resource, uint32_t version,
+                            ResourceUsage usage, bool writes) {
+    std::vector<Access>& accesses = m_passes[pass].accesses;
+    const auto existing = std::ranges::find(accesses, resource, &Access::resource);
+    if (existing == accesses.end()) {
+        accesses.push_back(Access{resource, version, usageBit(usage), writes});
+        return;
+    }
+
+    // Reading what the pass itself writes, or writing what it reads, is one combined access
+    const bool readsOwnWrite = existing->writes && !writes && version == existing->version + 1;
+    if (version != existing->version && !readsOwnWrite) {
+        m_declarationError = std::format("Pass {} uses two versions of {}", m_passes[pass].name,
+                                         getResourceName(resource));
+        return;
+    }
+    if (existing->writes && writes) {
+        m_declarationError = std::format("Pass {} writes {} twice", m_passes[pass].name,
+                                         getResourceName(resource));
+        return;
+    }
+    existing->usages |= usageBit(usage);
+    existing->writes = existing->writes || writes;
+}
+
+auto RenderGraph::compile() const -> Result<CompiledRenderGraph> {
+    ZoneScoped;
+    if (!m_declarationError.empty()) {
+        return std::unexpected(makeError(ErrorCode::InvalidArgument, m_declarationError));
+    }
+
+    const auto passCount = static_cast<uint32_t>(m_passes.size());
+    const auto resourceCount = static_cast<uint32_t>(m_resources.size());
+
+    // Readers of every version, for write-after-read ordering
+    std::vector<std::vector<std::vector<uint32_t>>> readers(resourceCount);
+    for (uint32_t r = 0; r < resourceCount; ++r) {
+        readers[r].resize(m_resources[r].writers.size());
+    }
+    for (uint32_t p = 0; p < passCount; ++p) {
+        for (const Access& access : m_passes[p].accesses) {
+            const Resource& resource = m_resources[access.resource];
+            if (resource.desc.kind == ResourceKind::Image && !getMaskLayout(access.usages)) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Pass {} uses {} in two image layouts at once",
+                                m_passes[p].name, resource.desc.name)
+                ));
+            }
+            if (access.version == 0 && !access.writes && !resource.imported) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Pass {} uses {} before anything wrote it", m_passes[p].name,
+                                resource.desc.name)
+                ));
+            }
+            if (!access.writes) {
+                readers[access.resource][access.version].push_back(p);
+            }
+        }
+    }
+
+    // Data dependencies (the writer of what a pass reads or overwrites) decide what is needed;
+    // write-after-read edges only constrain the order
+    std::vector<std::vector<uint32_t>> producers(passCount);
+    std::vector<std::vector<uint32_t>> antiDependencies(passCount);
+    for (uint32_t p = 0; p < passCount; ++p) {
+        for (const Access& access : m_passes[p].accesses) {
+            const uint32_t writer = m_resources[access.resource].writers[access.version];
+            if (writer != kNoPass && writer != p) {
+                producers[p].push_back(writer);
+            }
+            if (access.writes) {
+                for (const uint32_t reader : readers[access.resource][access.version]) {
+                    if (reader != p) {
+                        antiDependencies[p].push_back(reader);
+                    }
+                }
+            }
+        }
+    }
+
+    // Anything writing an imported resource has an effect outside the graph
+    std::vector<bool> alive(passCount, false);
+    std::vector<uint32_t> stack;
+    for (uint32_t p = 0; p < passCount; ++p) {
+        const bool hasEffect = std::ranges::any_of(m_passes[p].accesses, [&](const Access& a) {
+            return a.writes && m_resources[a.resource].imported;
+        });
+        if (hasEffect) {
+            alive[p] = true;
+            stack.push_back(p);
+        }
+    }
+    while (!stack.empty()) {
+        const uint32_t p = stack.back();
+        stack.pop_back();
+        for (const uint32_t producer : producers[p]) {
+            if (!alive[producer]) {
+                alive[producer] = true;
+                stack.push_back(producer);
+            }
+        }
+    }
+
+    // Kahn's algorithm over the live passes, lowest declaration index first among ready ones
+    std::vector<std::vector<uint32_t>> successors(passCount);
+    std::vector<uint32_t> pendingCount(passCount, 0);
+    for (uint32_t p = 0; p < passCount; ++p) {
+        if (!alive[p]) {
+            continue;
+        }
+        for (const auto* edges : {&producers[p], &antiDependencies[p]}) {
+            for (const uint32_t before : *edges) {
+                if (alive[before]) {
+                    successors[before].push_back(p);
+                    ++pendingCount[p];
+                }
+            }
+        }
+    }
+
+    CompiledRenderGraph compiled;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> ready;
+    uint32_t aliveCount = 0;
+    for (uint32_t p = 0; p < passCount; ++p) {
+        if (alive[p]) {
+            ++aliveCount;
+            if (pendingCount[p] == 0) {
+                ready.push(p);
+            }
+        }
+    }
+    while (!ready.empty()) {
+        const uint32_t p = ready.top();
+        ready.pop();
+        compiled.passes.push_back(CompiledRenderGraph::Pass{.pass = p});
+        for (const uint32_t successor : successors[p]) {
+            if (--pendingCount[successor] == 0) {
+                ready.push(successor);
+            }
+        }
+    }
+    if (compiled.passes.size() != aliveCount) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            "Render graph passes depend on each other in a cycle"
+        ));
+    }
+    compiled.culledPassCount = passCount - aliveCount;
+
+    // Lifetimes in execution order
+    compiled.allocations.resize(resourceCount);
+    for (uint32_t index = 0; index < compiled.passes.size(); ++index) {
+        for (const Access& access : m_passes[compiled.passes[index].pass].accesses) {
+            CompiledRenderGraph::Allocation& allocation = compiled.allocations[access.resource];
+            allocation.firstPass = std::min(allocation.firstPass, index);
+            allocation.lastPass = std::max(allocation.lastPass, index);
+            allocation.used = true;
+        }
+    }
+
+    // Largest transients first, each at the lowest offset clear of every placed transient
+    // that is alive at the same time
+    std::vector<uint32_t> transients;
+    for (uint32_t r = 0; r < resourceCount; ++r) {
+        if (!m_resources[r].imported && compiled.allocations[r].used) {
+            transients.push_back(r);
+            compiled.transientSize += m_resources[r].desc.size;
+        }
+    }
+    std::ranges::stable_sort(transients, std::greater<>{},
+                             [&](uint32_t r) { return m_resources[r].desc.size; });
+
+    auto lifetimesOverlap = [&](uint32_t a, uint32_t b) {
+        const CompiledRenderGraph::Allocation& first = compiled.allocations[a];
+        const CompiledRenderGraph::Allocation& second = compiled.allocations[b];
+        return first.firstPass <= second.lastPass && second.firstPass <= first.lastPass;
+    };
+    auto memoryOverlaps = [&](uint32_t a, uint32_t b) {
+        const uint64_t aBegin = compiled.allocations[a].offset;
+        const uint64_t bBegin = compiled.allocations[b].offset;
+        return aBegin < bBegin + m_resources[b].desc.size &&
+               bBegin < aBegin + m_resources[a].desc.size;
+    };
+
+    std::vector<uint32_t> placed;
+    std::vector<uint32_t> concurrent;
+    std::vector<uint64_t> candidates;
+    for (const uint32_t r : transients) {
+        const RenderGraphResourceDesc& desc = m_resources[r].desc;
+        concurrent.clear();
+        candidates.assign(1, 0);
+        for (const uint32_t other : placed) {
+            if (lifetimesOverlap(r, other)) {
+                concurrent.push_back(other);
+                candidates.push_back(alignUp(compiled.allocations[other].offset +
+                                                 m_resources[other].desc.size,
+                                             desc.alignment));
+            }
+        }
+        std::ranges::sort(candidates);
+
+        for (const uint64_t offset : candidates) {
+            compiled.allocations[r].offset = offset;
+            const bool fits = std::ranges::none_of(concurrent, [&](uint32_t other) {
+                return memoryOverlaps(r, other);
+            });
+            if (fits) {
+                break;
+            }
+        }
+        compiled.heapSize = std::max(compiled.heapSize, compiled.allocations[r].offset + desc.size);
+        placed.push_back(r);
+    }
+
+    std::vector<ResourceState> states(resourceCount);
+    for (uint32_t r = 0; r < resourceCount; ++r) {
+        const Resource& resource = m_resources[r];
+        if (resource.imported && resource.initialUsage != 0) {
+            states[r].lastWrite = resource.initialUsage;
+            states[r].layout = getMaskLayout(resource.initialUsage).value_or(ImageLayout::General);
+            states[r].hasContents = true;
+        }
+    }
+
+    auto emitBarrier = [&](uint32_t r, UsageMask usages, bool writes) {
+        ResourceState& state = states[r];
+        const bool isImage = m_resources[r].desc.kind == ResourceKind::Image;
+        const ImageLayout layout =
+            isImage ? getMaskLayout(usages).value_or(ImageLayout::General) : ImageLayout::Undefined;
+
+        if (!state.hasContents) {
+            // Whatever used the memory before must finish first: the last write to each
+            // transient placed there and every read since. Their lifetimes ended before this
+            // pass, so their states are final.
+            UsageMask aliasedUsages = 0;
+            if (!m_resources[r].imported) {
+                for (const uint32_t other : transients) {
+                    if (compiled.allocations[other].lastPass <
+                            compiled.allocations[r].firstPass &&
+                        memoryOverlaps(r, other)) {
+                        aliasedUsages |= states[other].lastWrite | states[other].readsSinceWrite;
+                    }
+                }
+            }
+            // Images always need their first transition, buffers only to wait for aliased ones
+            if (isImage || aliasedUsages != 0) {
+                compiled.barriers.push_back(RenderGraphBarrier{r, aliasedUsages, usages, true});
+            }
+            state = ResourceState{usages, writes ? 0 : usages, layout, true};
+            return;
+        }
+
+        const bool layoutChanges = isImage && layout != state.layout;
+        if (writes || layoutChanges) {
+            // Layout transitions write the image, so later readers wait on the transition
+            compiled.barriers.push_back(RenderGraphBarrier{
+                r, state.lastWrite | state.readsSinceWrite, usages, false});
+            state.lastWrite = usages;
+            state.readsSinceWrite = writes ? 0 : usages;
+        } else if ((usages & ~state.readsSinceWrite) != 0) {
+            // Reads already made visible need no second barrier
+            compiled.barriers.push_back(RenderGraphBarrier{r, state.lastWrite, usages, false});
+            state.readsSinceWrite |= usages;
+        }
+        state.layout = layout;
+    };
+
+    for (CompiledRenderGraph::Pass& pass : compiled.passes) {
+        pass.firstBarrier = static_cast<uint32_t>(compiled.barriers.size());
+        for (const Access& access : m_passes[pass.pass].accesses) {
+            emitBarrier(access.resource, access.usages, access.writes);
+        }
+        pass.barrierCount = static_cast<uint32_t>(compiled.barriers.size()) - pass.firstBarrier;
+    }
+
+    compiled.firstFinalBarrier = static_cast<uint32_t>(compiled.barriers.size());
+    for (uint32_t r = 0; r < resourceCount; ++r) {
+        const Resource& resource = m_resources[r];
+        const ResourceState& state = states[r];
+        if (!resource.imported || resource.finalUsage == 0) {
+            continue;
+        }
+        const UsageMask before = state.lastWrite | state.readsSinceWrite;
+        if (before != resource.finalUsage) {
+            compiled.barriers.push_back(
+                RenderGraphBarrier{r, before, resource.finalUsage, !state.hasContents});
+        }
+    }
+
+    return compiled;
+}
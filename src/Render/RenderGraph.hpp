@@ -0,0 +1,207 @@
+#pragma once
+
+#include "Error.hpp"
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+// How a pass touches a resource. Each usage implies the pipeline stages, memory accesses and,
+// for images, the layout the backend synchronizes with.
+enum class ResourceUsage : uint8_t {
+    ColorAttachmentWrite,
+    DepthAttachmentRead,
+    DepthAttachmentWrite,
+    SampledRead,
+    StorageRead,
+    StorageWrite,
+    IndirectRead,
+    TransferRead,
+    TransferWrite,
+    Present,
+    Count,
+};
+
+// Set of ResourceUsage bits
+using UsageMask = uint32_t;
+
+[[nodiscard]] constexpr auto usageBit(ResourceUsage usage) noexcept -> UsageMask {
+    return 1u << static_cast<uint32_t>(usage);
+}
+
+[[nodiscard]] constexpr auto isWriteUsage(ResourceUsage usage) noexcept -> bool {
+    return usage == ResourceUsage::ColorAttachmentWrite ||
+           usage == ResourceUsage::DepthAttachmentWrite ||
+           usage == ResourceUsage::StorageWrite || usage == ResourceUsage::TransferWrite;
+}
+
+inline constexpr UsageMask kWriteUsages =
+    usageBit(ResourceUsage::ColorAttachmentWrite) | usageBit(ResourceUsage::DepthAttachmentWrite) |
+    usageBit(ResourceUsage::StorageWrite) | usageBit(ResourceUsage::TransferWrite);
+
+// Image layouts the usages map to; buffers have none
+enum class ImageLayout : uint8_t {
+    Undefined,
+    General,
+    ColorAttachment,
+    DepthAttachment,
+    ShaderReadOnly,
+    TransferSrc,
+    TransferDst,
+    Present,
+};
+
+[[nodiscard]] auto getUsageLayout(ResourceUsage usage) noexcept -> ImageLayout;
+// Layout of the lowest usage in the mask; the graph only combines usages of one layout
+[[nodiscard]] auto getUsageMaskLayout(UsageMask usages) noexcept -> ImageLayout;
+
+enum class ResourceKind : uint8_t {
+    Image,
+    Buffer,
+};
+
+// Transient resources live only within the graph and may share memory with others whose
+// lifetimes do not overlap. Imported ones (swapchain images, persistent buffers) are
+// synchronized but never aliased, and writing them keeps a pass alive.
+struct RenderGraphResourceDesc {
+    std::string name;
+    ResourceKind kind{ResourceKind::Image};
+    // Memory the resource needs, e.g. from vkGetImageMemoryRequirements; ignored when imported
+    uint64_t size{0};
+    uint64_t alignment{1};
+};
+
+// One version of a resource: every write produces a new version, and a pass reading a version
+// runs after the pass that wrote it
+struct RenderGraphHandle {
+    uint32_t resource{std::numeric_limits<uint32_t>::max()};
+    uint32_t version{0};
+
+    [[nodiscard]] constexpr auto isValid() const noexcept -> bool {
+        return resource != std::numeric_limits<uint32_t>::max();
+    }
+};
+
+// A transition between two uses of a resource. before holds every usage since the previous
+// synchronization that must finish first, empty on first use; discard marks contents that
+// need not survive (first use of a transient, or memory taken over from an aliased resource)
+// so images may transition from an undefined layout.
+struct RenderGraphBarrier {
+    uint32_t resource{0};
+    UsageMask before{0};
+    UsageMask after{0};
+    bool discard{false};
+};
+
+// Everything the backend needs to run a frame: the passes in execution order, each preceded
+// by one batch of barriers, and the placement of every transient resource in a shared heap
+struct CompiledRenderGraph {
+    struct Pass {
+        uint32_t pass{0}; // Index in declaration order
+        uint32_t firstBarrier{0};
+        uint32_t barrierCount{0};
+    };
+
+    struct Allocation {
+        uint64_t offset{0};
+        // Execution indices of the first and last pass using the resource
+        uint32_t firstPass{std::numeric_limits<uint32_t>::max()};
+        uint32_t lastPass{0};
+        bool used{false};
+    };
+
+    std::vector<Pass> passes;
+    std::vector<RenderGraphBarrier> barriers;
+    // Barriers after the last pass that bring imported resources to their final usage
+    uint32_t firstFinalBarrier{0};
+    std::vector<Allocation> allocations; // Per resource; only transients are placed
+    uint64_t heapSize{0};
+    uint64_t transientSize{0}; // Memory the transients would need without aliasing
+    uint32_t culledPassCount{0};
+
+    [[nodiscard]] auto getPassBarriers(const Pass& pass) const
+        -> std::span<const RenderGraphBarrier> {
+        return std::span(barriers).subspan(pass.firstBarrier, pass.barrierCount);
+    }
+    [[nodiscard]] auto getFinalBarriers() const -> std::span<const RenderGraphBarrier> {
+        return std::span(barriers).subspan(firstFinalBarrier);
+    }
+};
+
+// Frame graph of passes that declare which resources they read and write. Compiling it is
+// pure CPU work: passes whose results reach no imported resource are culled, the rest are
+// ordered topologically, the barriers in front of each pass are batched so the backend can
+// issue them with a single vkCmdPipelineBarrier2, and transient resources whose lifetimes do
+// not overlap are placed in the same memory.
+//
+// Passes may be declared in any order consistent with the handles they use. Ties in the
+// topological order go to the pass declared first.
+class RenderGraph {
+public:
+    [[nodiscard]] auto createResource(RenderGraphResourceDesc desc) -> RenderGraphHandle;
+    // initialUsage describes the contents on entry, 0 for undefined ones; finalUsage, when
+    // set, is the usage the resource is left in for whoever consumes it after the graph
+    [[nodiscard]] auto importResource(std::string name, ResourceKind kind,
+                                      UsageMask initialUsage, UsageMask finalUsage = 0)
+        -> RenderGraphHandle;
+
+    [[nodiscard]] auto addPass(std::string name) -> uint32_t;
+    void read(uint32_t pass, RenderGraphHandle handle, ResourceUsage usage);
+    // Returns the version the write produces. Only the latest version can be written.
+    [[nodiscard]] auto write(uint32_t pass, RenderGraphHandle handle, ResourceUsage usage)
+        -> RenderGraphHandle;
+
+    [[nodiscard]] auto compile() const -> Result<CompiledRenderGraph>;
+
+    [[nodiscard]] auto getPassName(uint32_t pass) const -> const std::string& {
+        return m_passes[pass].name;
+    }
+    [[nodiscard]] auto getResourceName(uint32_t resource) const -> const std::string& {
+        return m_resources[resource].desc.name;
+    }
+    [[nodiscard]] auto getResourceKind(uint32_t resource) const -> ResourceKind {
+        return m_resources[resource].desc.kind;
+    }
+    [[nodiscard]] auto isImported(uint32_t resource) const -> bool {
+        return m_resources[resource].imported;
+    }
+    [[nodiscard]] auto getPassCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(m_passes.size());
+    }
+    [[nodiscard]] auto getResourceCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(m_resources.size());
+    }
+
+private:
+    static constexpr uint32_t kNoPass = std::numeric_limits<uint32_t>::max();
+
+    struct Access {
+        uint32_t resource{0};
+        uint32_t version{0}; // Version read, or overwritten by a write
+        UsageMask usages{0};
+        bool writes{false};
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<Access> accesses;
+    };
+
+    struct Resource {
+        RenderGraphResourceDesc desc;
+        bool imported{false};
+        UsageMask initialUsage{0};
+        UsageMask finalUsage{0};
+        // Writer of each version; version 0 has none
+        std::vector<uint32_t> writers{kNoPass};
+    };
+
+    void addAccess(uint32_t pass, uint32_t resource, uint32_t version, ResourceUsage usage,
+                   bool writes);
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    // Errors in the declarations are reported by compile()
+    std::string m_declarationError;
+};
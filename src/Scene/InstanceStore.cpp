@@ -0,0 +1,449 @@
+#include "InstanceStore.hpp"
+#include "Core/JobSystem.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VG_BOUNDS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VG_BOUNDS_TARGET(isa)
+#else
+#define VG_BOUNDS_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace {
+
+// Dirty blocks per job: enough instances to amortise scheduling, few enough to spread a frame
+// where only a small part of the scene moves
+constexpr uint32_t kBlocksPerJob = 256;
+// Dirty lists shorter than the block count divided by this are sorted rather than recovered
+// by scanning every block's mask
+constexpr size_t kScanDirtyRatio = 32;
+
+struct BoundsStreams {
+    std::array<const float*, 12> transform{};
+    const uint32_t* meshes{nullptr};
+    const float* meshBounds{nullptr}; // Spheres as four floats each
+    float* centerX{nullptr};
+    float* centerY{nullptr};
+    float* centerZ{nullptr};
+    float* radius{nullptr};
+};
+
+using BoundsFunction = void (*)(const BoundsStreams&, std::span<const uint32_t>);
+
+// Reference that the SIMD kernels must match exactly: the sphere center goes through the
+// transform and the radius scales with the longest basis vector
+void updateScalar(const BoundsStreams& streams, std::span<const uint32_t> blocks) {
+    for (const uint32_t block : blocks) {
+        const uint32_t first = block * InstanceStore::kBlockSize;
+        for (uint32_t i = first; i < first + InstanceStore::kBlockSize; ++i) {
+            float t[12];
+            for (size_t component = 0; component < 12; ++component) {
+                t[component] = streams.transform[component][i];
+            }
+            const float* sphere = streams.meshBounds + static_cast<size_t>(streams.meshes[i]) * 4;
+            const float x = sphere[0];
+            const float y = sphere[1];
+            const float z = sphere[2];
+            streams.centerX[i] = t[0] * x + t[3] * y + t[6] * z + t[9];
+            streams.centerY[i] = t[1] * x + t[4] * y + t[7] * z + t[10];
+            streams.centerZ[i] = t[2] * x + t[5] * y + t[8] * z + t[11];
+
+            const float scaleX = t[0] * t[0] + t[1] * t[1] + t[2] * t[2];
+            const float scaleY = t[3] * t[3] + t[4] * t[4] + t[5] * t[5];
+            const float scaleZ = t[6] * t[6] + t[7] * t[7] + t[8] * t[8];
+            // Written like maxps so the kernels agree on every input
+            float scale = scaleX > scaleY ? scaleX : scaleY;
+            scale = scale > scaleZ ? scale : scaleZ;
+            streams.radius[i] = sphere[3] * std::sqrt(scale);
+        }
+    }
+}
+
+#if VG_BOUNDS_X86
+
+VG_BOUNDS_TARGET("avx2")
+void updateAvx2(const BoundsStreams& streams, std::span<const uint32_t> blocks) {
+    for (const uint32_t block : blocks) {
+        const uint32_t first = block * InstanceStore::kBlockSize;
+        __m256 t[12];
+        for (size_t component = 0; component < 12; ++component) {
+            t[component] = _mm256_loadu_ps(streams.transform[component] + first);
+        }
+        const __m256i offsets = _mm256_slli_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(streams.meshes + first)), 2);
+        const __m256 x = _mm256_i32gather_ps(streams.meshBounds, offsets, 4);
+        const __m256 y = _mm256_i32gather_ps(streams.meshBounds + 1, offsets, 4);
+        const __m256 z = _mm256_i32gather_ps(streams.meshBounds + 2, offsets, 4);
+        const __m256 r = _mm256_i32gather_ps(streams.meshBounds + 3, offsets, 4);
+
+        for (size_t row = 0; row < 3; ++row) {
+            __m256 center = _mm256_add_ps(_mm256_mul_ps(t[row], x), _mm256_mul_ps(t[3 + row], y));
+            center = _mm256_add_ps(center, _mm256_mul_ps(t[6 + row], z));
+            center = _mm256_add_ps(center, t[9 + row]);
+            float* output = row == 0 ? streams.centerX : row == 1 ? streams.centerY
+                                                                  : streams.centerZ;
+            _mm256_storeu_ps(output + first, center);
+        }
+
+        __m256 scales[3];
+        for (size_t column = 0; column < 3; ++column) {
+            const __m256* basis = t + column * 3;
+            scales[column] = _mm256_add_ps(_mm256_mul_ps(basis[0], basis[0]),
+                                           _mm256_mul_ps(basis[1], basis[1]));
+            scales[column] = _mm256_add_ps(scales[column], _mm256_mul_ps(basis[2], basis[2]));
+        }
+        const __m256 scale = _mm256_max_ps(_mm256_max_ps(scales[0], scales[1]), scales[2]);
+        _mm256_storeu_ps(streams.radius + first, _mm256_mul_ps(r, _mm256_sqrt_ps(scale)));
+    }
+}
+
+// Four instances from first; a function of its own because lambdas do not inherit the target
+// attribute
+VG_BOUNDS_TARGET("sse2")
+void updateQuadSse2(const BoundsStreams& streams, uint32_t first) {
+    __m128 t[12];
+    for (size_t component = 0; component < 12; ++component) {
+        t[component] = _mm_loadu_ps(streams.transform[component] + first);
+    }
+    // Transposing the four spheres turns them into one register per component
+    __m128 x = _mm_loadu_ps(streams.meshBounds + static_cast<size_t>(streams.meshes[first]) * 4);
+    __m128 y = _mm_loadu_ps(streams.meshBounds +
+                            static_cast<size_t>(streams.meshes[first + 1]) * 4);
+    __m128 z = _mm_loadu_ps(streams.meshBounds +
+                            static_cast<size_t>(streams.meshes[first + 2]) * 4);
+    __m128 r = _mm_loadu_ps(streams.meshBounds +
+                            static_cast<size_t>(streams.meshes[first + 3]) * 4);
+    _MM_TRANSPOSE4_PS(x, y, z, r);
+
+    for (size_t row = 0; row < 3; ++row) {
+        __m128 center = _mm_add_ps(_mm_mul_ps(t[row], x), _mm_mul_ps(t[3 + row], y));
+        center = _mm_add_ps(center, _mm_mul_ps(t[6 + row], z));
+        center = _mm_add_ps(center, t[9 + row]);
+        float* output = row == 0 ? streams.centerX : row == 1 ? streams.centerY : streams.centerZ;
+        _mm_storeu_ps(output + first, center);
+    }
+
+    __m128 scales[3];
+    for (size_t column = 0; column < 3; ++column) {
+        const __m128* basis = t + column * 3;
+        scales[column] =
+            _mm_add_ps(_mm_mul_ps(basis[0], basis[0]), _mm_mul_ps(basis[1], basis[1]));
+        scales[column] = _mm_add_ps(scales[column], _mm_mul_ps(basis[2], basis[2]));
+    }
+    const __m128 scale = _mm_max_ps(_mm_max_ps(scales[0], scales[1]), scales[2]);
+    _mm_storeu_ps(streams.radius + first, _mm_mul_ps(r, _mm_sqrt_ps(scale)));
+}
+
+VG_BOUNDS_TARGET("sse2")
+void updateSse2(const BoundsStreams& streams, std::span<const uint32_t> blocks) {
+    for (const uint32_t block : blocks) {
+        const uint32_t first = block * InstanceStore::kBlockSize;
+        updateQuadSse2(streams, first);
+        updateQuadSse2(streams, first + 4);
+    }
+}
+
+auto detectKernel() -> BoundsKernel {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    // AVX needs the OS to save the YMM registers as well as CPU support
+    const bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                       (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    const bool sse2 = __builtin_cpu_supports("sse2");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return avx2 ? BoundsKernel::Avx2 : sse2 ? BoundsKernel::Sse2 : BoundsKernel::Scalar;
+}
+
+#else
+
+auto detectKernel() -> BoundsKernel {
+    return BoundsKernel::Scalar;
+}
+
+#endif
+
+auto getFunction(BoundsKernel kernel) -> BoundsFunction {
+    switch (kernel) {
+#if VG_BOUNDS_X86
+    case BoundsKernel::Avx2:
+        return updateAvx2;
+    case BoundsKernel::Sse2:
+        return updateSse2;
+#endif
+    default:
+        return updateScalar;
+    }
+}
+
+} // namespace
+
+auto InstanceStore::getBestKernel() -> BoundsKernel {
+    static const BoundsKernel kernel = detectKernel();
+    return kernel;
+}
+
+auto InstanceStore::isSupported(BoundsKernel kernel) -> bool {
+    const BoundsKernel best = getBestKernel();
+    switch (kernel) {
+    case BoundsKernel::Scalar:
+        return true;
+    case BoundsKernel::Sse2:
+        return best == BoundsKernel::Sse2 || best == BoundsKernel::Avx2;
+    case BoundsKernel::Avx2:
+        return best == kernel;
+    }
+    return false;
+}
+
+auto InstanceStore::getKernelName(BoundsKernel kernel) -> const char* {
+    switch (kernel) {
+    case BoundsKernel::Scalar:
+        return "scalar";
+    case BoundsKernel::Sse2:
+        return "sse2";
+    case BoundsKernel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+auto InstanceStore::addMesh(const glm::vec4& boundingSphere) -> uint32_t {
+    m_meshBounds.push_back(boundingSphere);
+    return static_cast<uint32_t>(m_meshBounds.size() - 1);
+}
+
+auto InstanceStore::add(uint32_t mesh, const glm::mat4& transform, uint8_t flags)
+    -> InstanceHandle {
+    if (mesh >= m_meshBounds.size()) {
+        return {};
+    }
+
+    uint32_t slot = 0;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_slotIndices.size());
+        m_slotIndices.push_back(0);
+        m_slotGenerations.push_back(0);
+    }
+
+    const uint32_t index = m_count++;
+    if (index == paddedCount()) {
+        resizeArrays(index + kBlockSize);
+    }
+    m_slotIndices[slot] = index;
+    m_indexSlots.push_back(slot);
+    m_meshes[index] = mesh;
+    m_flags[index] = flags;
+    setTransformAt(index, transform);
+    markDirty(index);
+    return {slot, m_slotGenerations[slot]};
+}
+
+auto InstanceStore::remove(InstanceHandle handle) -> bool {
+    if (!isValid(handle)) {
+        return false;
+    }
+
+    const uint32_t index = m_slotIndices[handle.slot];
+    const uint32_t last = m_count - 1;
+    if (index != last) {
+        moveInstance(last, index);
+    }
+    // The vacated entry becomes padding, which must stay zeroed with a valid mesh
+    for (std::vector<float>& component : m_transforms) {
+        component[last] = 0.0f;
+    }
+    m_worldBounds.centerX[last] = 0.0f;
+    m_worldBounds.centerY[last] = 0.0f;
+    m_worldBounds.centerZ[last] = 0.0f;
+    m_worldBounds.radius[last] = 0.0f;
+    m_meshes[last] = 0;
+    m_flags[last] = 0;
+    m_indexSlots.pop_back();
+    m_count = last;
+
+    ++m_slotGenerations[handle.slot];
+    m_freeSlots.push_back(handle.slot);
+    if (m_count % kBlockSize == 0) {
+        resizeArrays(m_count);
+    }
+    return true;
+}
+
+auto InstanceStore::setTransform(InstanceHandle handle, const glm::mat4& transform) -> bool {
+    if (!isValid(handle)) {
+        return false;
+    }
+    const uint32_t index = m_slotIndices[handle.slot];
+    setTransformAt(index, transform);
+    markDirty(index);
+    return true;
+}
+
+auto InstanceStore::setFlags(InstanceHandle handle, uint8_t flags) -> bool {
+    if (!isValid(handle)) {
+        return false;
+    }
+    m_flags[m_slotIndices[handle.slot]] = flags;
+    return true;
+}
+
+void InstanceStore::clear() {
+    // Retiring the live slots keeps every outstanding handle stale
+    for (uint32_t index = 0; index < m_count; ++index) {
+        const uint32_t slot = m_indexSlots[index];
+        ++m_slotGenerations[slot];
+        m_freeSlots.push_back(slot);
+    }
+    m_indexSlots.clear();
+    m_count = 0;
+    resizeArrays(0);
+    std::ranges::fill(m_dirtyMasks, uint8_t{0});
+    m_dirtyBlocks.clear();
+    m_updatedBlocks.clear();
+}
+
+void InstanceStore::reserve(uint32_t instanceCount) {
+    const uint32_t padded = (instanceCount + kBlockSize - 1) / kBlockSize * kBlockSize;
+    for (std::vector<float>& component : m_transforms) {
+        component.reserve(padded);
+    }
+    m_worldBounds.centerX.reserve(padded);
+    m_worldBounds.centerY.reserve(padded);
+    m_worldBounds.centerZ.reserve(padded);
+    m_worldBounds.radius.reserve(padded);
+    m_meshes.reserve(padded);
+    m_flags.reserve(padded);
+    m_indexSlots.reserve(instanceCount);
+    m_slotIndices.reserve(instanceCount);
+    m_slotGenerations.reserve(instanceCount);
+}
+
+auto InstanceStore::getTransform(uint32_t index) const -> glm::mat4 {
+    glm::mat4 transform{1.0f};
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            transform[column][row] = m_transforms[static_cast<size_t>(column * 3 + row)][index];
+        }
+    }
+    return transform;
+}
+
+void InstanceStore::updateBounds(JobSystem* jobSystem, BoundsKernel kernel) {
+    ZoneScoped;
+    if (!isSupported(kernel)) {
+        kernel = BoundsKernel::Scalar;
+    }
+
+    // Blocks go through the kernels in ascending order so the arrays stream through the cache.
+    // A short list is sorted; once a sizeable part of the scene moved, scanning the masks is
+    // cheaper. Blocks that emptied after being marked have nothing left to recompute.
+    const uint32_t blockCount = paddedCount() / kBlockSize;
+    m_updatedBlocks.clear();
+    if (m_dirtyBlocks.size() * kScanDirtyRatio < blockCount) {
+        std::ranges::sort(m_dirtyBlocks);
+        for (const uint32_t block : m_dirtyBlocks) {
+            if (block < blockCount) {
+                m_updatedBlocks.push_back(block);
+            }
+        }
+    } else {
+        for (uint32_t block = 0; block < blockCount; ++block) {
+            if (m_dirtyMasks[block] != 0) {
+                m_updatedBlocks.push_back(block);
+            }
+        }
+    }
+    for (const uint32_t block : m_dirtyBlocks) {
+        m_dirtyMasks[block] = 0;
+    }
+    m_dirtyBlocks.clear();
+    if (m_updatedBlocks.empty()) {
+        return;
+    }
+
+    BoundsStreams streams;
+    for (size_t component = 0; component < 12; ++component) {
+        streams.transform[component] = m_transforms[component].data();
+    }
+    streams.meshes = m_meshes.data();
+    streams.meshBounds = &m_meshBounds.data()->x;
+    streams.centerX = m_worldBounds.centerX.data();
+    streams.centerY = m_worldBounds.centerY.data();
+    streams.centerZ = m_worldBounds.centerZ.data();
+    streams.radius = m_worldBounds.radius.data();
+
+    const BoundsFunction function = getFunction(kernel);
+    const std::span<const uint32_t> blocks = m_updatedBlocks;
+    const auto jobCount =
+        static_cast<uint32_t>((blocks.size() + kBlocksPerJob - 1) / kBlocksPerJob);
+    parallelFor(jobSystem, jobCount, 1, [&](uint32_t job) {
+        const size_t begin = static_cast<size_t>(job) * kBlocksPerJob;
+        function(streams, blocks.subspan(begin, std::min<size_t>(kBlocksPerJob,
+                                                                 blocks.size() - begin)));
+    });
+}
+
+void InstanceStore::markDirty(uint32_t index) {
+    const uint32_t block = index / kBlockSize;
+    if (m_dirtyMasks[block] == 0) {
+        m_dirtyBlocks.push_back(block);
+    }
+    m_dirtyMasks[block] |= static_cast<uint8_t>(1u << (index % kBlockSize));
+}
+
+void InstanceStore::setTransformAt(uint32_t index, const glm::mat4& transform) {
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            m_transforms[static_cast<size_t>(column * 3 + row)][index] = transform[column][row];
+        }
+    }
+}
+
+void InstanceStore::moveInstance(uint32_t from, uint32_t to) {
+    for (std::vector<float>& component : m_transforms) {
+        component[to] = component[from];
+    }
+    m_worldBounds.centerX[to] = m_worldBounds.centerX[from];
+    m_worldBounds.centerY[to] = m_worldBounds.centerY[from];
+    m_worldBounds.centerZ[to] = m_worldBounds.centerZ[from];
+    m_worldBounds.radius[to] = m_worldBounds.radius[from];
+    m_meshes[to] = m_meshes[from];
+    m_flags[to] = m_flags[from];
+
+    const uint32_t slot = m_indexSlots[from];
+    m_indexSlots[to] = slot;
+    m_slotIndices[slot] = to;
+    // Pending bounds follow the instance
+    if ((m_dirtyMasks[from / kBlockSize] & (1u << (from % kBlockSize))) != 0) {
+        markDirty(to);
+    }
+}
+
+void InstanceStore::resizeArrays(uint32_t paddedCount) {
+    for (std::vector<float>& component : m_transforms) {
+        component.resize(paddedCount, 0.0f);
+    }
+    m_worldBounds.centerX.resize(paddedCount, 0.0f);
+    m_worldBounds.centerY.resize(paddedCount, 0.0f);
+    m_worldBounds.centerZ.resize(paddedCount, 0.0f);
+    m_worldBounds.radius.resize(paddedCount, 0.0f);
+    m_meshes.resize(paddedCount, 0);
+    m_flags.resize(paddedCount, 0);
+    m_dirtyMasks.resize(std::max<size_t>(m_dirtyMasks.size(), paddedCount / kBlockSize), 0);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+enum class BoundsKernel : uint8_t {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+// InstanceStore flags; the remaining bits are free for the renderer
+constexpr uint8_t kInstanceHidden = 1;
+constexpr uint8_t kInstanceCastsShadows = 2;
+
+// Refers to an instance across removals of others. Slots are reused, and the generation tells
+// a stale handle from the instance that took over its slot.
+struct InstanceHandle {
+    uint32_t slot{std::numeric_limits<uint32_t>::max()};
+    uint32_t generation{0};
+
+    auto operator==(const InstanceHandle&) const -> bool = default;
+};
+
+// World-space bounding spheres of the instances, one array per component in dense instance
+// order and padded like the store's other arrays
+struct InstanceBounds {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+};
+
+// Scene instances in structure-of-arrays layout: affine transforms, world bounds, mesh and
+// flags each live in arrays of their own, densely packed in [0, getCount()) and padded with
+// zeroed entries to a multiple of kBlockSize. Removal moves the last instance into the hole,
+// so dense indices change while handles stay valid.
+//
+// Setting a transform only marks its block of kBlockSize instances dirty; updateBounds then
+// recomputes the world spheres of the dirty blocks and nothing else, eight instances per SIMD
+// step with contiguous loads. Clean instances in a dirty block are recomputed too, which is
+// cheaper than masking them out and yields the values they already hold. The SIMD kernels
+// evaluate the same operations in the same order as the scalar reference, and this file is
+// built without floating-point contraction, so every kernel produces bit-identical bounds.
+class InstanceStore {
+public:
+    static constexpr uint32_t kBlockSize = 8;
+
+    // Widest kernel the CPU supports, detected once
+    [[nodiscard]] static auto getBestKernel() -> BoundsKernel;
+    [[nodiscard]] static auto isSupported(BoundsKernel kernel) -> bool;
+    [[nodiscard]] static auto getKernelName(BoundsKernel kernel) -> const char*;
+
+    // Registers a mesh by its object-space bounding sphere (center, radius) and returns its
+    // handle, the index into getMeshBounds()
+    auto addMesh(const glm::vec4& boundingSphere) -> uint32_t;
+
+    // The transform must be affine; its last row is ignored. The new instance is dirty.
+    auto add(uint32_t mesh, const glm::mat4& transform, uint8_t flags = 0) -> InstanceHandle;
+    // Stale handles are ignored and return false
+    auto remove(InstanceHandle handle) -> bool;
+    auto setTransform(InstanceHandle handle, const glm::mat4& transform) -> bool;
+    auto setFlags(InstanceHandle handle, uint8_t flags) -> bool;
+    void clear();
+    void reserve(uint32_t instanceCount);
+
+    [[nodiscard]] auto isValid(InstanceHandle handle) const noexcept -> bool {
+        return handle.slot < m_slotGenerations.size() &&
+               m_slotGenerations[handle.slot] == handle.generation;
+    }
+    // Current dense index of a valid handle
+    [[nodiscard]] auto getIndex(InstanceHandle handle) const noexcept -> uint32_t {
+        return m_slotIndices[handle.slot];
+    }
+    [[nodiscard]] auto getHandle(uint32_t index) const noexcept -> InstanceHandle {
+        const uint32_t slot = m_indexSlots[index];
+        return {slot, m_slotGenerations[slot]};
+    }
+    [[nodiscard]] auto getTransform(uint32_t index) const -> glm::mat4;
+
+    // Recomputes the world bounds of every dirty block, split across the job system (which may
+    // be null), and clears the dirty state. Unsupported kernels fall back to the scalar
+    // reference.
+    void updateBounds(JobSystem* jobSystem, BoundsKernel kernel);
+    void updateBounds(JobSystem* jobSystem) { updateBounds(jobSystem, getBestKernel()); }
+
+    [[nodiscard]] auto getCount() const noexcept -> uint32_t { return m_count; }
+    [[nodiscard]] auto paddedCount() const noexcept -> uint32_t {
+        return static_cast<uint32_t>(m_meshes.size());
+    }
+    [[nodiscard]] auto getWorldBounds() const noexcept -> const InstanceBounds& {
+        return m_worldBounds;
+    }
+    [[nodiscard]] auto getMeshes() const noexcept -> std::span<const uint32_t> {
+        return {m_meshes.data(), m_count};
+    }
+    [[nodiscard]] auto getFlags() const noexcept -> std::span<const uint8_t> {
+        return {m_flags.data(), m_count};
+    }
+    [[nodiscard]] auto getMeshBounds() const noexcept -> std::span<const glm::vec4> {
+        return m_meshBounds;
+    }
+    // Blocks awaiting the next updateBounds, and the blocks the last one recomputed, e.g. for
+    // uploading only the instance data that changed
+    [[nodiscard]] auto getDirtyBlocks() const noexcept -> std::span<const uint32_t> {
+        return m_dirtyBlocks;
+    }
+    [[nodiscard]] auto getUpdatedBlocks() const noexcept -> std::span<const uint32_t> {
+        return m_updatedBlocks;
+    }
+
+private:
+    void markDirty(uint32_t index);
+    void setTransformAt(uint32_t index, const glm::mat4& transform);
+    void moveInstance(uint32_t from, uint32_t to);
+    void resizeArrays(uint32_t paddedCount);
+
+    // Affine transform in column-major order, component column * 3 + row
+    std::array<std::vector<float>, 12> m_transforms;
+    InstanceBounds m_worldBounds;
+    std::vector<uint32_t> m_meshes;
+    std::vector<uint8_t> m_flags;
+    uint32_t m_count{0};
+
+    std::vector<glm::vec4> m_meshBounds;
+
+    // Handle slot to dense index and back; free slots are reused last in, first out
+    std::vector<uint32_t> m_slotIndices;
+    std::vector<uint32_t> m_slotGenerations;
+    std::vector<uint32_t> m_indexSlots;
+    std::vector<uint32_t> m_freeSlots;
+
+    // One bit per instance, kept for blocks beyond the current count so a block that empties
+    // and refills while dirty is never listed twice
+    std::vector<uint8_t> m_dirtyMasks;
+    std::vector<uint32_t> m_dirtyBlocks;
+    std::vector<uint32_t> m_updatedBlocks;
+};
@@ -0,0 +1,518 @@
+#include "CookCache.hpp"
+#include "Core/JobSystem.hpp"
+#include "Logger.hpp"
+#include "MappedFile.hpp"
+#include "PageFormat.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <random>
+
+namespace {
+
+constexpr uint32_t kIndexMagic = 0x49434756; // "VGCI"
+constexpr uint32_t kIndexVersion = 1;
+constexpr std::string_view kIndexName = "index.bin";
+constexpr std::string_view kEntryExtension = ".vgeo";
+
+// Bytes per hashing job; part of the hash definition, so changing it invalidates every entry
+constexpr size_t kHashChunkSize = 8u << 20;
+
+// Files modified this recently may still change within the same timestamp, so their hash is
+// not trusted on the next run (the same race git and ccache guard against)
+constexpr auto kSettleTime = std::chrono::seconds(2);
+// Records of files that are still settling never match a real modification time
+constexpr int64_t kUnsettled = std::numeric_limits<int64_t>::min();
+// Temporary files of cooks that crashed are removed once they are this old
+constexpr auto kStaleTemporaryAge = std::chrono::hours(1);
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+[[nodiscard]] auto load64(const uint8_t* bytes) noexcept -> uint64_t {
+    uint64_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] auto load32(const uint8_t* bytes) noexcept -> uint32_t {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] auto hashRound(uint64_t accumulator, uint64_t input) noexcept -> uint64_t {
+    accumulator += input * kPrime2;
+    return std::rotl(accumulator, 31) * kPrime1;
+}
+
+[[nodiscard]] auto mergeRound(uint64_t hash, uint64_t lane) noexcept -> uint64_t {
+    return (hash ^ hashRound(0, lane)) * kPrime1 + kPrime4;
+}
+
+// Four independent lanes over 32-byte stripes, then the tail and a final avalanche
+[[nodiscard]] auto hashChunk(std::span<const uint8_t> bytes, uint64_t seed) noexcept
+    -> uint64_t {
+    const uint8_t* it = bytes.data();
+    const uint8_t* end = it + bytes.size();
+
+    uint64_t hash;
+    if (bytes.size() >= 32) {
+        uint64_t lanes[4] = {seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1};
+        for (; end - it >= 32; it += 32) {
+            for (uint32_t lane = 0; lane < 4; ++lane) {
+                lanes[lane] = hashRound(lanes[lane], load64(it + lane * 8));
+            }
+        }
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) +
+               std::rotl(lanes[3], 18);
+        for (uint64_t lane : lanes) {
+            hash = mergeRound(hash, lane);
+        }
+    } else {
+        hash = seed + kPrime5;
+    }
+    hash += bytes.size();
+
+    for (; end - it >= 8; it += 8) {
+        hash = std::rotl(hash ^ hashRound(0, load64(it)), 27) * kPrime1 + kPrime4;
+    }
+    if (end - it >= 4) {
+        hash = std::rotl(hash ^ (load32(it) * kPrime1), 23) * kPrime2 + kPrime3;
+        it += 4;
+    }
+    for (; it != end; ++it) {
+        hash = std::rotl(hash ^ (*it * kPrime5), 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+template<typename T>
+void appendValue(std::vector<uint8_t>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void appendString(std::vector<uint8_t>& out, std::string_view text) {
+    appendValue(out, static_cast<uint32_t>(text.size()));
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+// Bounds-checked reads of the index; any failure leaves the reader failed for good
+class IndexReader {
+public:
+    explicit IndexReader(std::span<const uint8_t> data) : m_data(data) {}
+
+    template<typename T>
+    auto read(T& value) -> bool {
+        if (m_failed || m_data.size() - m_offset < sizeof(T)) {
+            m_failed = true;
+            return false;
+        }
+        std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    auto readString(std::string& text) -> bool {
+        uint32_t length = 0;
+        if (!read(length) || m_data.size() - m_offset < length) {
+            m_failed = true;
+            return false;
+        }
+        text.assign(reinterpret_cast<const char*>(m_data.data() + m_offset), length);
+        m_offset += length;
+        return true;
+    }
+
+    [[nodiscard]] auto isAtEnd() const noexcept -> bool {
+        return !m_failed && m_offset == m_data.size();
+    }
+
+private:
+    std::span<const uint8_t> m_data;
+    size_t m_offset{0};
+    bool m_failed{false};
+};
+
+// Temporary files carry a random suffix so concurrent cooks never write the same one
+[[nodiscard]] auto makeTemporaryPath(const std::filesystem::path& path)
+    -> std::filesystem::path {
+    thread_local std::mt19937_64 generator{std::random_device{}()};
+    std::filesystem::path temporary = path;
+    temporary += std::format(".{:016x}.tmp", generator());
+    return temporary;
+}
+
+[[nodiscard]] auto replaceFile(const std::filesystem::path& temporary,
+                               const std::filesystem::path& path) -> VoidResult {
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        const std::string reason = error.message();
+        std::filesystem::remove(temporary, error);
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to replace {}: {}", path.string(), reason)
+        ));
+    }
+    return {};
+}
+
+// Writes next to the destination and renames over it, so readers only ever see whole files
+[[nodiscard]] auto writeAtomically(const std::filesystem::path& path,
+                                   std::span<const uint8_t> data) -> VoidResult {
+    const std::filesystem::path temporary = makeTemporaryPath(path);
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return std::unexpected(makeError(
+                ErrorCode::FileOpenFailed,
+                std::format("Failed to open {} for writing", temporary.string())
+            ));
+        }
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        if (!file.flush()) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporary, error);
+            return std::unexpected(makeError(
+                ErrorCode::FileWriteFailed,
+                std::format("Failed to write {}", temporary.string())
+            ));
+        }
+    }
+    return replaceFile(temporary, path);
+}
+
+[[nodiscard]] auto getTimeTicks(std::filesystem::file_time_type time) noexcept -> int64_t {
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+} // namespace
+
+auto CookCache::open(std::filesystem::path directory, const CookCacheConfig& config)
+    -> Result<CookCache> {
+    ZoneScoped;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error || !std::filesystem::is_directory(directory, error)) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to create cook cache directory {}", directory.string())
+        ));
+    }
+
+    CookCache cache;
+    cache.m_directory = std::move(directory);
+    cache.m_config = config;
+    cache.loadIndex();
+    return cache;
+}
+
+void CookCache::loadIndex() {
+    const std::filesystem::path path = m_directory / kIndexName;
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return;
+    }
+    auto file = MappedFile::open(path);
+    if (!file) {
+        Logger::warn("Ignoring cook cache index: {}", file.error().toString());
+        return;
+    }
+
+    // A damaged index only costs rehashing, so it is dropped as a whole rather than trusted
+    IndexReader reader(file->getData());
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t fileCount = 0;
+    std::unordered_map<std::string, FileRecord> files;
+    bool valid = reader.read(magic) && reader.read(version) && magic == kIndexMagic &&
+                 version == kIndexVersion && reader.read(fileCount) &&
+                 reader.read(m_stats.totalHits) && reader.read(m_stats.totalMisses);
+    for (uint32_t i = 0; valid && i < fileCount; ++i) {
+        std::string name;
+        FileRecord record;
+        uint32_t dependencyCount = 0;
+        valid = reader.readString(name) && reader.read(record.size) &&
+                reader.read(record.modifiedTime) && reader.read(record.hash) &&
+                reader.read(dependencyCount);
+        for (uint32_t j = 0; valid && j < dependencyCount; ++j) {
+            valid = reader.readString(record.dependencies.emplace_back());
+        }
+        files.emplace(std::move(name), std::move(record));
+    }
+    if (!valid || !reader.isAtEnd()) {
+        Logger::warn("Ignoring damaged cook cache index {}", path.string());
+        m_stats.totalHits = 0;
+        m_stats.totalMisses = 0;
+        return;
+    }
+    m_files = std::move(files);
+}
+
+auto CookCache::save() -> VoidResult {
+    ZoneScoped;
+    // Records of deleted sources would otherwise pile up forever
+    std::erase_if(m_files, [](const auto& file) {
+        std::error_code error;
+        return !std::filesystem::exists(file.first, error);
+    });
+
+    std::vector<uint8_t> data;
+    appendValue(data, kIndexMagic);
+    appendValue(data, kIndexVersion);
+    appendValue(data, static_cast<uint32_t>(m_files.size()));
+    appendValue(data, m_stats.totalHits);
+    appendValue(data, m_stats.totalMisses);
+    for (const auto& [name, record] : m_files) {
+        appendString(data, name);
+        appendValue(data, record.size);
+        appendValue(data, record.modifiedTime);
+        appendValue(data, record.hash);
+        appendValue(data, static_cast<uint32_t>(record.dependencies.size()));
+        for (const std::string& dependency : record.dependencies) {
+            appendString(data, dependency);
+        }
+    }
+    return writeAtomically(m_directory / kIndexName, data);
+}
+
+auto CookCache::hashBytes(std::span<const uint8_t> bytes, JobSystem* jobSystem) -> uint64_t {
+    ZoneScoped;
+    if (bytes.size() <= kHashChunkSize) {
+        return hashChunk(bytes, 0);
+    }
+
+    const auto chunkCount = static_cast<uint32_t>((bytes.size() - 1) / kHashChunkSize + 1);
+    std::vector<uint64_t> chunkHashes(chunkCount);
+    parallelFor(jobSystem, chunkCount, 1, [&](uint32_t chunk) {
+        const size_t offset = static_cast<size_t>(chunk) * kHashChunkSize;
+        chunkHashes[chunk] =
+            hashChunk(bytes.subspan(offset, std::min(kHashChunkSize, bytes.size() - offset)),
+                      chunk);
+    });
+    return hashChunk({reinterpret_cast<const uint8_t*>(chunkHashes.data()),
+                      chunkHashes.size() * sizeof(uint64_t)},
+                     bytes.size());
+}
+
+auto CookCache::hashFile(const std::filesystem::path& path, const DependencyScanner* scanner,
+                         JobSystem* jobSystem) -> Result<FileRecord> {
+    std::error_code error;
+    const std::filesystem::path absolute =
+        std::filesystem::absolute(path, error).lexically_normal();
+    const uint64_t size = std::filesystem::file_size(absolute, error);
+    const auto modified = error ? std::filesystem::file_time_type{}
+                                : std::filesystem::last_write_time(absolute, error);
+    if (error) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to read {}: {}", path.string(), error.message())
+        ));
+    }
+
+    const std::string name = absolute.string();
+    if (auto it = m_files.find(name); it != m_files.end() && it->second.size == size &&
+                                      it->second.modifiedTime == getTimeTicks(modified)) {
+        ++m_stats.unchangedFiles;
+        return it->second;
+    }
+
+    ZoneScopedN("CookCache::hashFile");
+    auto file = MappedFile::open(absolute);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    file->prefetch(0, file->getSize());
+
+    FileRecord record;
+    record.size = file->getSize();
+    record.hash = hashBytes(file->getData(), jobSystem);
+    const bool settled =
+        record.size == size &&
+        std::filesystem::file_time_type::clock::now() - modified > kSettleTime;
+    record.modifiedTime = settled ? getTimeTicks(modified) : kUnsettled;
+    if (scanner != nullptr) {
+        auto dependencies = (*scanner)(absolute, file->getData());
+        if (!dependencies) {
+            return std::unexpected(dependencies.error());
+        }
+        for (const std::filesystem::path& dependency : *dependencies) {
+            record.dependencies.push_back(dependency.string());
+        }
+    }
+    ++m_stats.hashedFiles;
+
+    m_files.insert_or_assign(name, record);
+    return record;
+}
+
+auto CookCache::hashSource(const std::filesystem::path& path, const DependencyScanner& scanner,
+                           JobSystem* jobSystem) -> Result<uint64_t> {
+    ZoneScoped;
+    auto source = hashFile(path, &scanner, jobSystem);
+    if (!source) {
+        return std::unexpected(source.error());
+    }
+
+    std::vector<uint64_t> hashes{source->hash};
+    for (const std::string& dependency : source->dependencies) {
+        auto record = hashFile(dependency, nullptr, jobSystem);
+        if (!record) {
+            return std::unexpected(record.error());
+        }
+        hashes.push_back(record->hash);
+    }
+    return hashChunk({reinterpret_cast<const uint8_t*>(hashes.data()),
+                      hashes.size() * sizeof(uint64_t)},
+                     0);
+}
+
+auto CookCache::makeKey(uint64_t sourceHash, std::string_view settings, uint32_t cookerVersion)
+    -> uint64_t {
+    std::vector<uint8_t> bytes;
+    appendValue(bytes, sourceHash);
+    appendValue(bytes, cookerVersion);
+    appendValue(bytes, kPageFileVersion);
+    appendString(bytes, settings);
+    return hashChunk(bytes, 0);
+}
+
+auto CookCache::getEntryPath(uint64_t key) const -> std::filesystem::path {
+    return m_directory / std::format("{:016x}{}", key, kEntryExtension);
+}
+
+auto CookCache::fetch(uint64_t key, const std::filesystem::path& output) -> Result<bool> {
+    ZoneScoped;
+    const std::filesystem::path entry = getEntryPath(key);
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(entry, error);
+    if (error) {
+        ++m_stats.misses;
+        ++m_stats.totalMisses;
+        return false;
+    }
+
+    // Entries are renamed into place whole, so checking the header against the size catches
+    // anything truncated or written by another format version
+    PageFileHeader header;
+    {
+        std::ifstream file(entry, std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || header.magic != kPageFileMagic || header.version != kPageFileVersion ||
+            header.pagesOffset + static_cast<uint64_t>(header.pageCount) * header.pageSize !=
+                size) {
+            file.close();
+            Logger::warn("Removing invalid cook cache entry {}", entry.string());
+            std::filesystem::remove(entry, error);
+            ++m_stats.misses;
+            ++m_stats.totalMisses;
+            return false;
+        }
+    }
+
+    const std::filesystem::path temporary = makeTemporaryPath(output);
+    std::filesystem::copy_file(entry, temporary,
+                               std::filesystem::copy_options::overwrite_existing, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to copy {} to {}", entry.string(), output.string())
+        ));
+    }
+    if (auto result = replaceFile(temporary, output); !result) {
+        return std::unexpected(result.error());
+    }
+
+    // Eviction goes by modification time, so a hit marks the entry as recently used
+    std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), error);
+    ++m_stats.hits;
+    ++m_stats.totalHits;
+    return true;
+}
+
+auto CookCache::store(uint64_t key, std::span<const uint8_t> data) -> VoidResult {
+    ZoneScoped;
+    if (auto result = writeAtomically(getEntryPath(key), data); !result) {
+        return result;
+    }
+    evict(key);
+    return {};
+}
+
+void CookCache::evict(uint64_t keepKey) {
+    ZoneScoped;
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type lastUsed;
+        uint64_t size{0};
+    };
+
+    const auto now = std::filesystem::file_time_type::clock::now();
+    const std::filesystem::path keep = getEntryPath(keepKey);
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(m_directory, error)) {
+        std::error_code fileError;
+        const std::filesystem::path& path = file.path();
+        const auto lastUsed = file.last_write_time(fileError);
+        const uint64_t size = file.file_size(fileError);
+        if (fileError || !file.is_regular_file(fileError)) {
+            continue;
+        }
+        if (path.extension() == ".tmp") {
+            if (now - lastUsed > kStaleTemporaryAge) {
+                std::filesystem::remove(path, fileError);
+            }
+            continue;
+        }
+        if (path.extension() != kEntryExtension) {
+            continue;
+        }
+        totalSize += size;
+        // The entry just stored stays even if it alone exceeds the limit
+        if (path != keep) {
+            entries.push_back(Entry{path, lastUsed, size});
+        }
+    }
+    if (totalSize <= m_config.maxBytes) {
+        return;
+    }
+
+    std::ranges::sort(entries, [](const Entry& lhs, const Entry& rhs) {
+        return lhs.lastUsed < rhs.lastUsed;
+    });
+    for (const Entry& entry : entries) {
+        if (totalSize <= m_config.maxBytes) {
+            break;
+        }
+        // Another cook may have removed it already
+        if (std::filesystem::remove(entry.path, error)) {
+            ++m_stats.evictedEntries;
+            m_stats.evictedBytes += entry.size;
+        }
+        totalSize -= entry.size;
+    }
+    Logger::info("Cook cache evicted {} entries ({:.1f} MiB), {:.1f} MiB stored",
+                 m_stats.evictedEntries, static_cast<double>(m_stats.evictedBytes) / (1 << 20),
+                 static_cast<double>(totalSize) / (1 << 20));
+}
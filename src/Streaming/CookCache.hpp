@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Error.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+struct CookCacheConfig {
+    // Least recently used entries are evicted once the stored files take more than this
+    uint64_t maxBytes{4ull << 30};
+};
+
+struct CookCacheStats {
+    // This run
+    uint32_t hits{0};
+    uint32_t misses{0};
+    uint32_t hashedFiles{0};
+    // Files whose size and modification time matched the index, so they were not read
+    uint32_t unchangedFiles{0};
+    uint32_t evictedEntries{0};
+    uint64_t evictedBytes{0};
+    // Since the cache directory was created
+    uint64_t totalHits{0};
+    uint64_t totalMisses{0};
+};
+
+// Local store of cooked .vgeo files keyed by a content hash of the source files, the cooker
+// settings and the cooker and page format versions, so unchanged meshes are copied instead of
+// cooked again.
+//
+// Sources are only read when their size or modification time differs from what the index
+// recorded for them. Entries and the index are written to a temporary file that is renamed
+// into place, so a crash or a concurrent cook never leaves a torn file behind; concurrent
+// cooks only lose each other's index updates, which costs a rehash, never a wrong hit.
+class CookCache {
+public:
+    // Lists the other files a source reads, such as the buffers of a .gltf, given its contents
+    using DependencyScanner = std::function<Result<std::vector<std::filesystem::path>>(
+        const std::filesystem::path& path, std::span<const uint8_t> data)>;
+
+    [[nodiscard]] static auto open(std::filesystem::path directory,
+                                   const CookCacheConfig& config = {}) -> Result<CookCache>;
+
+    // Content hash of a source and its dependencies. Dependencies are only scanned again when
+    // the source itself changed.
+    [[nodiscard]] auto hashSource(const std::filesystem::path& path,
+                                  const DependencyScanner& scanner, JobSystem* jobSystem)
+        -> Result<uint64_t>;
+    [[nodiscard]] static auto makeKey(uint64_t sourceHash, std::string_view settings,
+                                      uint32_t cookerVersion) -> uint64_t;
+
+    // Copies the entry to output and returns true on a hit
+    [[nodiscard]] auto fetch(uint64_t key, const std::filesystem::path& output) -> Result<bool>;
+    // Adds an entry, then evicts the least recently used ones past the size limit
+    [[nodiscard]] auto store(uint64_t key, std::span<const uint8_t> data) -> VoidResult;
+    // Writes the index with the file records and hit counts
+    [[nodiscard]] auto save() -> VoidResult;
+
+    // 64-bit hash in the style of XXH64. Large inputs are hashed in fixed-size chunks in
+    // parallel and the chunk hashes hashed again, so the result does not depend on the
+    // thread count. jobSystem may be null.
+    [[nodiscard]] static auto hashBytes(std::span<const uint8_t> bytes, JobSystem* jobSystem)
+        -> uint64_t;
+
+    [[nodiscard]] auto getStats() const noexcept -> const CookCacheStats& { return m_stats; }
+    [[nodiscard]] auto getDirectory() const noexcept -> const std::filesystem::path& {
+        return m_directory;
+    }
+
+private:
+    struct FileRecord {
+        uint64_t size{0};
+        int64_t modifiedTime{0};
+        uint64_t hash{0};
+        std::vector<std::string> dependencies;
+    };
+
+    CookCache() = default;
+
+    // Record of one file, taken from the index when it is unchanged. scanner may be null for
+    // files without dependencies.
+    [[nodiscard]] auto hashFile(const std::filesystem::path& path,
+                                const DependencyScanner* scanner, JobSystem* jobSystem)
+        -> Result<FileRecord>;
+    [[nodiscard]] auto getEntryPath(uint64_t key) const -> std::filesystem::path;
+    void loadIndex();
+    void evict(uint64_t keepKey);
+
+    std::filesystem::path m_directory;
+    CookCacheConfig m_config;
+    CookCacheStats m_stats;
+    std::unordered_map<std::string, FileRecord> m_files;
+};
@@ -0,0 +1,225 @@
+#include "IoRing.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <utility>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define VG_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef VG_HAS_IO_URING
+
+namespace {
+
+auto loadAcquire(const uint32_t* value) -> uint32_t {
+    return std::atomic_ref(*const_cast<uint32_t*>(value)).load(std::memory_order_acquire);
+}
+
+void storeRelease(uint32_t* value, uint32_t newValue) {
+    std::atomic_ref(*value).store(newValue, std::memory_order_release);
+}
+
+template<typename T>
+auto offsetPointer(void* base, uint32_t offset) -> T* {
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + offset);
+}
+
+} // namespace
+
+auto IoRing::create(uint32_t entries) -> Result<IoRing> {
+    ZoneScoped;
+    IoRing ring;
+
+    io_uring_params params{};
+    const auto ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd < 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InitializationFailed,
+            std::format("io_uring_setup failed: {}", std::strerror(errno))
+        ));
+    }
+    ring.m_ringFd = ringFd;
+    ring.m_entryCount = params.sq_entries;
+
+    ring.m_submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring.m_completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMapping) {
+        ring.m_submissionRingSize = std::max(ring.m_submissionRingSize, ring.m_completionRingSize);
+        ring.m_completionRingSize = 0;
+    }
+
+    auto mapRing = [ringFd](size_t size, off_t offset) -> void* {
+        void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             ringFd, offset);
+        return mapping == MAP_FAILED ? nullptr : mapping;
+    };
+
+    ring.m_submissionRing = mapRing(ring.m_submissionRingSize, IORING_OFF_SQ_RING);
+    ring.m_completionRing = singleMapping
+                                ? ring.m_submissionRing
+                                : mapRing(ring.m_completionRingSize, IORING_OFF_CQ_RING);
+    ring.m_submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+    ring.m_submissionEntries = mapRing(ring.m_submissionEntriesSize, IORING_OFF_SQES);
+    if (ring.m_submissionRing == nullptr || ring.m_completionRing == nullptr ||
+        ring.m_submissionEntries == nullptr) {
+        return std::unexpected(makeError(
+            ErrorCode::InitializationFailed,
+            "Failed to map the io_uring queues"
+        ));
+    }
+
+    ring.m_submissionHead = offsetPointer<uint32_t>(ring.m_submissionRing, params.sq_off.head);
+    ring.m_submissionTail = offsetPointer<uint32_t>(ring.m_submissionRing, params.sq_off.tail);
+    ring.m_submissionMask =
+        *offsetPointer<uint32_t>(ring.m_submissionRing, params.sq_off.ring_mask);
+    ring.m_submissionArray = offsetPointer<uint32_t>(ring.m_submissionRing, params.sq_off.array);
+    ring.m_completionHead = offsetPointer<uint32_t>(ring.m_completionRing, params.cq_off.head);
+    ring.m_completionTail = offsetPointer<uint32_t>(ring.m_completionRing, params.cq_off.tail);
+    ring.m_completionMask =
+        *offsetPointer<uint32_t>(ring.m_completionRing, params.cq_off.ring_mask);
+    ring.m_completionEntries = offsetPointer<io_uring_cqe>(ring.m_completionRing,
+                                                           params.cq_off.cqes);
+
+    return ring;
+}
+
+void IoRing::close() noexcept {
+    if (m_submissionEntries != nullptr) {
+        munmap(m_submissionEntries, m_submissionEntriesSize);
+    }
+    if (m_completionRing != nullptr && m_completionRing != m_submissionRing) {
+        munmap(m_completionRing, m_completionRingSize);
+    }
+    if (m_submissionRing != nullptr) {
+        munmap(m_submissionRing, m_submissionRingSize);
+    }
+    if (m_ringFd >= 0) {
+        ::close(m_ringFd);
+    }
+    m_ringFd = -1;
+    m_submissionRing = nullptr;
+    m_completionRing = nullptr;
+    m_submissionEntries = nullptr;
+}
+
+auto IoRing::queueRead(int fileDescriptor, void* buffer, uint32_t size, uint64_t offset,
+                       uint64_t userData) -> bool {
+    // This thread is the only producer, so the tail needs no synchronization with itself
+    const uint32_t tail = *m_submissionTail;
+    if (tail - loadAcquire(m_submissionHead) >= m_entryCount) {
+        return false;
+    }
+
+    const uint32_t index = tail & m_submissionMask;
+    auto* entry = static_cast<io_uring_sqe*>(m_submissionEntries) + index;
+    std::memset(entry, 0, sizeof(*entry));
+    entry->opcode = IORING_OP_READ;
+    entry->fd = fileDescriptor;
+    entry->addr = reinterpret_cast<uint64_t>(buffer);
+    entry->len = size;
+    entry->off = offset;
+    entry->user_data = userData;
+    m_submissionArray[index] = index;
+
+    storeRelease(m_submissionTail, tail + 1);
+    ++m_unsubmitted;
+    return true;
+}
+
+auto IoRing::submit(uint32_t waitCount) -> VoidResult {
+    ZoneScoped;
+    const uint32_t flags = waitCount > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (true) {
+        const auto submitted = syscall(__NR_io_uring_enter, m_ringFd, m_unsubmitted, waitCount,
+                                       flags, nullptr, 0);
+        if (submitted >= 0) {
+            m_unsubmitted -= static_cast<uint32_t>(submitted);
+            return {};
+        }
+        if (errno != EINTR) {
+            return std::unexpected(makeError(
+                ErrorCode::Unknown,
+                std::format("io_uring_enter failed: {}", std::strerror(errno))
+            ));
+        }
+    }
+}
+
+auto IoRing::reap(std::span<Completion> output) -> uint32_t {
+    uint32_t head = *m_completionHead;
+    const uint32_t tail = loadAcquire(m_completionTail);
+    uint32_t count = 0;
+    for (; head != tail && count < output.size(); ++head, ++count) {
+        const auto& entry =
+            static_cast<const io_uring_cqe*>(m_completionEntries)[head & m_completionMask];
+        output[count] = Completion{entry.user_data, entry.res};
+    }
+    storeRelease(m_completionHead, head);
+    return count;
+}
+
+#else
+
+auto IoRing::create([[maybe_unused]] uint32_t entries) -> Result<IoRing> {
+    return std::unexpected(makeError(
+        ErrorCode::InitializationFailed,
+        "io_uring is not available on this platform"
+    ));
+}
+
+void IoRing::close() noexcept {}
+
+auto IoRing::queueRead(int, void*, uint32_t, uint64_t, uint64_t) -> bool {
+    return false;
+}
+
+auto IoRing::submit(uint32_t) -> VoidResult {
+    return std::unexpected(makeError(ErrorCode::Unknown, "io_uring is not available"));
+}
+
+auto IoRing::reap(std::span<Completion>) -> uint32_t {
+    return 0;
+}
+
+#endif
+
+IoRing::~IoRing() {
+    close();
+}
+
+IoRing::IoRing(IoRing&& other) noexcept {
+    *this = std::move(other);
+}
+
+IoRing& IoRing::operator=(IoRing&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_ringFd = std::exchange(other.m_ringFd, -1);
+        m_entryCount = std::exchange(other.m_entryCount, 0);
+        m_unsubmitted = std::exchange(other.m_unsubmitted, 0);
+        m_submissionRing = std::exchange(other.m_submissionRing, nullptr);
+        m_submissionRingSize = std::exchange(other.m_submissionRingSize, 0);
+        m_completionRing = std::exchange(other.m_completionRing, nullptr);
+        m_completionRingSize = std::exchange(other.m_completionRingSize, 0);
+        m_submissionEntries = std::exchange(other.m_submissionEntries, nullptr);
+        m_submissionEntriesSize = std::exchange(other.m_submissionEntriesSize, 0);
+        m_submissionHead = std::exchange(other.m_submissionHead, nullptr);
+        m_submissionTail = std::exchange(other.m_submissionTail, nullptr);
+        m_submissionMask = std::exchange(other.m_submissionMask, 0);
+        m_submissionArray = std::exchange(other.m_submissionArray, nullptr);
+        m_completionHead = std::exchange(other.m_completionHead, nullptr);
+        m_completionTail = std::exchange(other.m_completionTail, nullptr);
+        m_completionMask = std::exchange(other.m_completionMask, 0);
+        m_completionEntries = std::exchange(other.m_completionEntries, nullptr);
+    }
+    return *this;
+}
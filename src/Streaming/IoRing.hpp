@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Error.hpp"
+#include <cstdint>
+#include <span>
+
+// Minimal io_uring submission/completion ring for positional file reads, driven through the raw
+// system calls so no liburing dependency is needed. create() fails on kernels without io_uring,
+// where it is blocked by a seccomp policy, and on other platforms; callers fall back to pread.
+// A ring is owned by a single thread.
+class IoRing {
+public:
+    struct Completion {
+        uint64_t userData{0};
+        int32_t result{0}; // Bytes read or a negated errno
+    };
+
+    [[nodiscard]] static auto create(uint32_t entries) -> Result<IoRing>;
+    ~IoRing();
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+    IoRing(IoRing&& other) noexcept;
+    IoRing& operator=(IoRing&& other) noexcept;
+
+    // Returns false when the submission queue is full
+    [[nodiscard]] auto queueRead(int fileDescriptor, void* buffer, uint32_t size, uint64_t offset,
+                                 uint64_t userData) -> bool;
+    // Submits everything queued and blocks until at least waitCount completions are available
+    [[nodiscard]] auto submit(uint32_t waitCount) -> VoidResult;
+    // Moves available completions into output, returning how many were written
+    [[nodiscard]] auto reap(std::span<Completion> output) -> uint32_t;
+
+    [[nodiscard]] auto getEntryCount() const noexcept -> uint32_t { return m_entryCount; }
+
+private:
+    IoRing() = default;
+    void close() noexcept;
+
+    int m_ringFd{-1};
+    uint32_t m_entryCount{0};
+    uint32_t m_unsubmitted{0};
+
+    void* m_submissionRing{nullptr};
+    size_t m_submissionRingSize{0};
+    void* m_completionRing{nullptr};
+    size_t m_completionRingSize{0};
+    void* m_submissionEntries{nullptr};
+    size_t m_submissionEntriesSize{0};
+
+    uint32_t* m_submissionHead{nullptr};
+    uint32_t* m_submissionTail{nullptr};
+    uint32_t m_submissionMask{0};
+    uint32_t* m_submissionArray{nullptr};
+    uint32_t* m_completionHead{nullptr};
+    uint32_t* m_completionTail{nullptr};
+    uint32_t m_completionMask{0};
+    void* m_completionEntries{nullptr};
+};
@@ -0,0 +1,211 @@
+#include "MappedFile.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <format>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+auto systemPageSize() -> uint64_t {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Expands [offset, offset + size) to whole virtual memory pages within the mapping
+auto alignRange(uint64_t offset, uint64_t size, uint64_t mappingSize)
+    -> std::pair<uint64_t, uint64_t> {
+    static const uint64_t pageSize = systemPageSize();
+    const uint64_t begin = offset / pageSize * pageSize;
+    const uint64_t end = std::min(offset + size, mappingSize);
+    return {begin, end > begin ? end - begin : 0};
+}
+
+} // namespace
+
+auto MappedFile::open(const std::filesystem::path& path) -> Result<MappedFile> {
+    ZoneScoped;
+    MappedFile file;
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {}", path.string())
+        ));
+    }
+    file.m_fileHandle = fileHandle;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("{} is empty or its size is unavailable", path.string())
+        ));
+    }
+    file.m_size = static_cast<uint64_t>(size.QuadPart);
+
+    file.m_mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (file.m_mappingHandle == nullptr) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to create a file mapping for {}", path.string())
+        ));
+    }
+
+    file.m_data = static_cast<const uint8_t*>(
+        MapViewOfFile(file.m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+    const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {}", path.string())
+        ));
+    }
+
+    struct stat status{};
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        ::close(descriptor);
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("{} is empty or its size is unavailable", path.string())
+        ));
+    }
+    file.m_size = static_cast<uint64_t>(status.st_size);
+
+    void* mapping = mmap(nullptr, file.m_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    // The mapping keeps its own reference to the file
+    ::close(descriptor);
+    file.m_data = mapping == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapping);
+#endif
+
+    if (file.m_data == nullptr) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to map {}", path.string())
+        ));
+    }
+
+    return file;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+    , m_fileHandle(std::exchange(other.m_fileHandle, nullptr))
+    , m_mappingHandle(std::exchange(other.m_mappingHandle, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+        m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::close() noexcept {
+#ifdef _WIN32
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mappingHandle != nullptr) {
+        CloseHandle(m_mappingHandle);
+    }
+    if (m_fileHandle != nullptr) {
+        CloseHandle(m_fileHandle);
+    }
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+#else
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void MappedFile::adviseRandom() const noexcept {
+#ifndef _WIN32
+    if (m_data != nullptr) {
+        madvise(const_cast<uint8_t*>(m_data), m_size, MADV_RANDOM);
+    }
+#endif
+}
+
+void MappedFile::prefetch(uint64_t offset, uint64_t size) const noexcept {
+    const auto [begin, length] = alignRange(offset, size, m_size);
+    if (length == 0) {
+        return;
+    }
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(m_data + begin), length};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    madvise(const_cast<uint8_t*>(m_data + begin), length, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::populate(uint64_t offset, uint64_t size) const noexcept {
+    ZoneScoped;
+    const auto [begin, length] = alignRange(offset, size, m_size);
+    if (length == 0) {
+        return;
+    }
+#if defined(MADV_POPULATE_READ)
+    if (madvise(const_cast<uint8_t*>(m_data + begin), length, MADV_POPULATE_READ) == 0) {
+        return;
+    }
+#endif
+    // Older kernels and Windows: read ahead, then touch every page to map it
+    prefetch(begin, length);
+    const uint64_t pageSize = systemPageSize();
+    volatile uint8_t sink = 0;
+    for (uint64_t page = begin; page < begin + length; page += pageSize) {
+        sink = sink + m_data[page];
+    }
+}
+
+void MappedFile::release(uint64_t offset, uint64_t size) const noexcept {
+    const auto [begin, length] = alignRange(offset, size, m_size);
+    if (length == 0) {
+        return;
+    }
+#ifdef _WIN32
+    // Unmapping parts of a view is not possible; let the working set trimmer reclaim them
+    VirtualUnlock(const_cast<uint8_t*>(m_data + begin), length);
+#else
+    madvise(const_cast<uint8_t*>(m_data + begin), length, MADV_DONTNEED);
+#endif
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Error.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// Read-only memory mapping of a whole file. Ranges can be prefetched ahead of use, so first
+// access does not stall on a page fault, and released again to return their memory to the OS
+// (they fault back in from the file if touched again).
+class MappedFile {
+public:
+    [[nodiscard]] static auto open(const std::filesystem::path& path) -> Result<MappedFile>;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] auto getData() const noexcept -> std::span<const uint8_t> {
+        return {m_data, m_size};
+    }
+    [[nodiscard]] auto getSize() const noexcept -> uint64_t { return m_size; }
+
+    // Hints that the range is only accessed at random, disabling kernel read-ahead
+    void adviseRandom() const noexcept;
+    // Starts reading the range in the background
+    void prefetch(uint64_t offset, uint64_t size) const noexcept;
+    // Reads the range in and maps it before returning, so later accesses never fault
+    void populate(uint64_t offset, uint64_t size) const noexcept;
+    void release(uint64_t offset, uint64_t size) const noexcept;
+
+private:
+    MappedFile() = default;
+    void close() noexcept;
+
+    const uint8_t* m_data{nullptr};
+    uint64_t m_size{0};
+#ifdef _WIN32
+    void* m_fileHandle{nullptr};
+    void* m_mappingHandle{nullptr};
+#endif
+};
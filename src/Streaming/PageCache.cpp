@@ -0,0 +1,242 @@
+#include "PageCache.hpp"
+#include "Logger.hpp"
+#include "PageStreamer.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+
+auto PageCache::create(const PagedGeometry& geometry, PageStreamer& streamer,
+                       const Config& config) -> Result<std::unique_ptr<PageCache>> {
+    ZoneScoped;
+    const PageFileHeader& header = geometry.getHeader();
+    const uint64_t slotCount = std::min<uint64_t>(config.budgetBytes / header.pageSize,
+                                                  header.pageCount);
+    if (slotCount == 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            std::format("Page budget of {} bytes is smaller than one {} byte page",
+                        config.budgetBytes, header.pageSize)
+        ));
+    }
+    // Streaming a page needs its whole dependency chain resident at once
+    if (slotCount < header.levelCount) {
+        Logger::warn("Page budget holds {} pages but the hierarchy is {} levels deep; the "
+                     "finest levels may never become resident", slotCount, header.levelCount);
+    }
+
+    auto cache = std::unique_ptr<PageCache>(
+        new PageCache(geometry, streamer, static_cast<uint32_t>(slotCount)));
+    Logger::info("Page cache: {} slots of {} KiB ({} MiB budget, {} pages in file)", slotCount,
+                 header.pageSize / 1024, slotCount * header.pageSize >> 20, header.pageCount);
+    return cache;
+}
+
+PageCache::PageCache(const PagedGeometry& geometry, PageStreamer& streamer, uint32_t slotCount)
+    : m_geometry(geometry)
+    , m_streamer(streamer)
+    , m_pages(geometry.getPageCount())
+    , m_slotPages(slotCount, kNoPage)
+    , m_slotData(std::make_unique<uint8_t[]>(static_cast<uint64_t>(slotCount) *
+                                             geometry.getHeader().pageSize))
+{
+    m_freeSlots.reserve(slotCount);
+    for (uint32_t slot = slotCount; slot-- > 0;) {
+        m_freeSlots.push_back(slot);
+    }
+    m_stats.slotCount = slotCount;
+    m_stats.budgetBytes = static_cast<uint64_t>(slotCount) * geometry.getHeader().pageSize;
+}
+
+auto PageCache::getSlotData(uint32_t slot) const noexcept -> uint8_t* {
+    return m_slotData.get() + static_cast<uint64_t>(slot) * m_geometry.getHeader().pageSize;
+}
+
+void PageCache::beginFrame() {
+    ++m_frame;
+}
+
+void PageCache::touch(uint32_t page) {
+    PageRecord& record = m_pages[page];
+    record.lastUsedFrame = m_frame;
+    record.referenced = true;
+}
+
+auto PageCache::request(uint32_t page, float priority) -> bool {
+    ++m_stats.requests;
+    if (isResident(page)) {
+        ++m_stats.hits;
+        touch(page);
+        return true;
+    }
+
+    ++m_stats.misses;
+    m_pages[page].priority = priority;
+    requestMissing(page, priority);
+    return false;
+}
+
+void PageCache::requestMissing(uint32_t page, float priority) {
+    // Pages shared by many dependents are walked once per frame; without the mark every path
+    // through the DAG would walk them again
+    PageRecord& record = m_pages[page];
+    if (record.walkedFrame == m_frame) {
+        return;
+    }
+    record.walkedFrame = m_frame;
+
+    // Dependencies always live in earlier pages (checked on open), so this terminates
+    bool dependenciesResident = true;
+    for (uint32_t dependency : m_geometry.getPageDependencies(page)) {
+        if (isResident(dependency)) {
+            touch(dependency);
+        } else {
+            dependenciesResident = false;
+            // Parents ahead of their children
+            requestMissing(dependency, priority + 1.0f);
+        }
+    }
+
+    // While the previous frame had no room, reading more pages would only waste bandwidth
+    if (dependenciesResident && m_fullFrame + 1 < m_frame) {
+        m_streamer.request(page, priority);
+    }
+}
+
+void PageCache::update() {
+    ZoneScoped;
+    m_streamer.update();
+
+    std::vector<PageStreamer::CompletedPage> completed;
+    m_streamer.takeCompleted(completed);
+    for (const PageStreamer::CompletedPage& arrival : completed) {
+        if (!arrival.valid) {
+            ++m_stats.failed;
+        } else if (!isResident(arrival.page)) {
+            const auto dependencies = m_geometry.getPageDependencies(arrival.page);
+            // A dependency can be evicted while its dependent is in flight; the dependent is
+            // then requested again, which brings the dependency back first
+            const bool dependenciesResident = std::ranges::all_of(
+                dependencies, [this](uint32_t dependency) { return isResident(dependency); });
+            if (!dependenciesResident) {
+                ++m_stats.dependencyMisses;
+                // The walk this frame found the dependencies resident, so it must run again
+                m_pages[arrival.page].walkedFrame = 0;
+                requestMissing(arrival.page, m_pages[arrival.page].priority);
+            } else {
+                // Pinning the dependencies first keeps the clock from evicting them to make
+                // room
+                for (uint32_t dependency : dependencies) {
+                    ++m_pages[dependency].residentDependents;
+                }
+                const uint32_t slot = allocateSlot();
+                if (slot != kNoSlot) {
+                    install(arrival.page, slot, arrival.data);
+                } else {
+                    for (uint32_t dependency : dependencies) {
+                        --m_pages[dependency].residentDependents;
+                    }
+                    ++m_stats.rejected;
+                    m_fullFrame = m_frame;
+                }
+            }
+        }
+        m_streamer.releaseStaging(arrival.slot);
+    }
+
+    TracyPlot("Page Cache Resident MiB",
+              static_cast<float>(m_residentBytes) / static_cast<float>(1 << 20));
+    TracyPlot("Page Cache Hit Rate", m_stats.hitRate());
+}
+
+auto PageCache::allocateSlot() -> uint32_t {
+    if (!m_freeSlots.empty()) {
+        const uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+
+    // Two sweeps: the first may only clear reference bits
+    const auto slotCount = static_cast<uint32_t>(m_slotPages.size());
+    for (uint32_t step = 0; step < 2 * slotCount; ++step) {
+        const uint32_t slot = m_clockHand;
+        m_clockHand = (m_clockHand + 1) % slotCount;
+
+        PageRecord& record = m_pages[m_slotPages[slot]];
+        if (record.residentDependents > 0 || record.lastUsedFrame == m_frame) {
+            continue;
+        }
+        if (record.referenced) {
+            record.referenced = false;
+            continue;
+        }
+
+        evict(slot);
+        return slot;
+    }
+    return kNoSlot;
+}
+
+void PageCache::install(uint32_t page, uint32_t slot, std::span<const uint8_t> data) {
+    std::memcpy(getSlotData(slot), data.data(), data.size());
+    m_slotPages[slot] = page;
+
+    PageRecord& record = m_pages[page];
+    record.slot = slot;
+    record.lastUsedFrame = m_frame;
+    record.referenced = true;
+
+    m_residentBytes += data.size();
+    ++m_stats.installed;
+}
+
+void PageCache::evict(uint32_t slot) {
+    const uint32_t page = m_slotPages[slot];
+    for (uint32_t dependency : m_geometry.getPageDependencies(page)) {
+        --m_pages[dependency].residentDependents;
+    }
+
+    m_pages[page].slot = kNoSlot;
+    m_pages[page].referenced = false;
+    m_slotPages[slot] = kNoPage;
+    m_residentBytes -= m_geometry.getPageTable()[page].usedBytes;
+    ++m_stats.evictions;
+}
+
+auto PageCache::getPage(uint32_t page) const -> std::optional<PageView> {
+    if (!isResident(page)) {
+        return std::nullopt;
+    }
+    return m_geometry.getPage(page, {getSlotData(m_pages[page].slot),
+                                     m_geometry.getHeader().pageSize});
+}
+
+auto PageCache::getStats() const noexcept -> Stats {
+    Stats stats = m_stats;
+    stats.residentPages = stats.slotCount - static_cast<uint32_t>(m_freeSlots.size());
+    stats.residentBytes = m_residentBytes;
+    return stats;
+}
+
+auto PageCache::getLevelHistogram() const -> std::vector<uint32_t> {
+    std::vector<uint32_t> histogram(std::max(m_geometry.getHeader().levelCount, 1u), 0);
+    const auto pageTable = m_geometry.getPageTable();
+    for (uint32_t page : m_slotPages) {
+        if (page != kNoPage) {
+            ++histogram[std::min<size_t>(pageTable[page].level, histogram.size() - 1)];
+        }
+    }
+    return histogram;
+}
+
+auto PageCache::getAgeHistogram() const -> AgeHistogram {
+    AgeHistogram histogram{};
+    for (uint32_t page : m_slotPages) {
+        if (page != kNoPage) {
+            const uint64_t age = m_frame - m_pages[page].lastUsedFrame;
+            ++histogram[std::min<uint64_t>(std::bit_width(age), kAgeBucketCount - 1)];
+        }
+    }
+    return histogram;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Error.hpp"
+#include "PagedGeometry.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class PageStreamer;
+
+// Resident set of streamed pages within a hard memory budget. Resident pages live in
+// page-sized slots, budget / pageSize of them, so the budget holds by construction.
+//
+// Callers request the pages they need every frame. Resident pages count as hits; missing ones
+// are forwarded to the streamer, but only once every page they depend on is resident, so a
+// resident page always has its parents resident as well. A page with resident dependents is
+// pinned and never evicted.
+//
+// When a page arrives and no slot is free, a clock hand sweeps the slots: pages touched this
+// frame and pinned pages are skipped, pages touched since the hand last passed get a second
+// chance, and the first remaining page is evicted. If every slot is protected the arrival is
+// dropped rather than exceeding the budget. An arrival whose dependency was evicted while it
+// was in flight is dropped as well and requested again at its last priority.
+class PageCache {
+public:
+    struct Config {
+        uint64_t budgetBytes{256ull << 20};
+    };
+
+    struct Stats {
+        uint64_t requests{0};
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t installed{0};
+        uint64_t evictions{0};
+        uint64_t rejected{0}; // Arrivals dropped because every slot was protected
+        // Arrivals whose dependency was evicted while they were in flight; requested again
+        uint64_t dependencyMisses{0};
+        uint64_t failed{0};   // Arrivals that failed to read or validate
+        uint32_t residentPages{0};
+        uint32_t slotCount{0};
+        uint64_t residentBytes{0}; // Used bytes of the resident pages
+        uint64_t budgetBytes{0};
+
+        [[nodiscard]] auto hitRate() const noexcept -> float {
+            return requests > 0 ? static_cast<float>(hits) / static_cast<float>(requests) : 0.0f;
+        }
+    };
+
+    // Resident pages by frames since last use: bucket 0 holds this frame, bucket i > 0 holds
+    // [2^(i-1), 2^i) frames, and the last bucket everything older
+    static constexpr uint32_t kAgeBucketCount = 8;
+    using AgeHistogram = std::array<uint32_t, kAgeBucketCount>;
+
+    // The geometry and streamer must outlive the cache
+    [[nodiscard]] static auto create(const PagedGeometry& geometry, PageStreamer& streamer,
+                                     const Config& config) -> Result<std::unique_ptr<PageCache>>;
+
+    PageCache(const PageCache&) = delete;
+    PageCache& operator=(const PageCache&) = delete;
+    PageCache(PageCache&&) = delete;
+    PageCache& operator=(PageCache&&) = delete;
+
+    void beginFrame();
+    // Returns true when the page is resident; otherwise it is streamed in. A missing page and
+    // its missing dependencies are forwarded once per frame, at the priority of the first
+    // request that reached them, so callers should request the most important pages first.
+    auto request(uint32_t page, float priority) -> bool;
+    // Pumps the streamer and installs arrived pages
+    void update();
+
+    [[nodiscard]] auto isResident(uint32_t page) const noexcept -> bool {
+        return m_pages[page].slot != kNoSlot;
+    }
+    // View of a resident page's copy in the cache
+    [[nodiscard]] auto getPage(uint32_t page) const -> std::optional<PageView>;
+    // Slot a resident page occupies, for copies of the cache laid out by slot
+    [[nodiscard]] auto getSlot(uint32_t page) const noexcept -> uint32_t {
+        return m_pages[page].slot;
+    }
+
+    [[nodiscard]] auto getStats() const noexcept -> Stats;
+    // Resident pages per LOD level (the finest level in each page)
+    [[nodiscard]] auto getLevelHistogram() const -> std::vector<uint32_t>;
+    [[nodiscard]] auto getAgeHistogram() const -> AgeHistogram;
+
+private:
+    static constexpr uint32_t kNoSlot = ~0u;
+    static constexpr uint32_t kNoPage = ~0u;
+
+    struct PageRecord {
+        uint32_t slot{kNoSlot};
+        uint32_t residentDependents{0}; // Resident pages that depend on this one
+        uint64_t lastUsedFrame{0};
+        float priority{0.0f}; // Of the most recent request
+        uint64_t walkedFrame{0}; // Last frame requestMissing handled the page
+        bool referenced{false}; // Touched since the clock hand last passed
+    };
+
+    PageCache(const PagedGeometry& geometry, PageStreamer& streamer, uint32_t slotCount);
+
+    void requestMissing(uint32_t page, float priority);
+    void touch(uint32_t page);
+    [[nodiscard]] auto allocateSlot() -> uint32_t;
+    void install(uint32_t page, uint32_t slot, std::span<const uint8_t> data);
+    void evict(uint32_t slot);
+    [[nodiscard]] auto getSlotData(uint32_t slot) const noexcept -> uint8_t*;
+
+    const PagedGeometry& m_geometry;
+    PageStreamer& m_streamer;
+    std::vector<PageRecord> m_pages;
+    std::vector<uint32_t> m_slotPages; // Page held by each slot
+    std::vector<uint32_t> m_freeSlots;
+    std::unique_ptr<uint8_t[]> m_slotData;
+    uint32_t m_clockHand{0};
+    uint64_t m_frame{1};
+    uint64_t m_fullFrame{0}; // Last frame an arrival found every slot protected
+    uint64_t m_residentBytes{0};
+    Stats m_stats;
+};
@@ -0,0 +1,594 @@
+#include "PageDecoder.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VG_DECODE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VG_DECODE_TARGET(isa)
+#else
+#define VG_DECODE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace {
+
+constexpr uint32_t kBlockSize = 8;
+// Room for the largest sections rounded up to whole blocks
+constexpr uint32_t kMaxValues = kMaxPageClusterTriangles + kBlockSize;
+constexpr uint32_t kMaxStripIndices = kMaxPageClusterTriangles * 3 + kBlockSize;
+
+// Corners of each strip code's triangle, picked from the previous triangle (a, b, c) followed
+// by the next three strip indices, and how many strip indices the code consumes
+constexpr uint8_t kStripCorners[4][3] = {{3, 4, 5}, {2, 1, 3}, {0, 2, 3}, {1, 0, 3}};
+constexpr uint32_t kStripAdvance[4] = {3, 1, 1, 1};
+static_assert(kStripCorners[kStripRestart][0] == 3 && kStripAdvance[kStripEdgeAb] == 1);
+
+// Component kernels. Inputs and outputs hold whole blocks: count is rounded up to kBlockSize
+// and the lanes past it are garbage.
+struct DecodeFunctions {
+    // Bit-packed values of the given width, zero-extended
+    void (*unpack)(const uint8_t* section, uint32_t count, uint32_t bits, uint32_t* values);
+    // minimum + value * scale
+    void (*dequantize)(const uint32_t* values, uint32_t count, float minimum, float scale,
+                       float* output);
+    // Octahedral snorm pairs to unit vectors
+    void (*decodeOctahedral)(const uint32_t* x, const uint32_t* y, uint32_t count,
+                             uint32_t bits, float* outputX, float* outputY, float* outputZ);
+    // Walks the strip codes into three indices per triangle. Reads up to three indices past
+    // the last one consumed.
+    void (*assembleStrip)(const uint32_t* codes, const uint32_t* indices, uint32_t triangleCount,
+                          uint8_t* output);
+};
+
+struct ClusterScratch {
+    alignas(32) uint32_t values[3][kMaxValues];
+    alignas(32) float components[3][kMaxValues];
+    alignas(32) uint32_t stripIndices[kMaxStripIndices];
+};
+
+[[nodiscard]] auto loadUint32(const uint8_t* bytes) noexcept -> uint32_t {
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] auto roundUpToBlock(uint32_t count) noexcept -> uint32_t {
+    return (count + kBlockSize - 1) / kBlockSize * kBlockSize;
+}
+
+// maxps semantics, which std::max does not share for signed zeros
+[[nodiscard]] auto maxOf(float a, float b) noexcept -> float {
+    return a > b ? a : b;
+}
+
+[[nodiscard]] auto getSnormScale(uint32_t bits) noexcept -> float {
+    return 1.0f / static_cast<float>((1u << (bits - 1)) - 1);
+}
+
+void unpackScalar(const uint8_t* section, uint32_t count, uint32_t bits, uint32_t* values) {
+    const uint32_t mask = (1u << bits) - 1;
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint32_t bit = i * bits;
+        values[i] = (loadUint32(section + bit / 8) >> (bit % 8)) & mask;
+    }
+}
+
+void dequantizeScalar(const uint32_t* values, uint32_t count, float minimum, float scale,
+                      float* output) {
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] = minimum + static_cast<float>(values[i]) * scale;
+    }
+}
+
+void decodeOctahedralScalar(const uint32_t* x, const uint32_t* y, uint32_t count,
+                            uint32_t bits, float* outputX, float* outputY, float* outputZ) {
+    const uint32_t signShift = 32 - bits;
+    const float scale = getSnormScale(bits);
+    auto snorm = [&](uint32_t value) {
+        const int32_t extended = static_cast<int32_t>(value << signShift) >> signShift;
+        return maxOf(static_cast<float>(extended) * scale, -1.0f);
+    };
+
+    for (uint32_t i = 0; i < count; ++i) {
+        float normalX = snorm(x[i]);
+        float normalY = snorm(y[i]);
+        const float normalZ = 1.0f - std::abs(normalX) - std::abs(normalY);
+        const float fold = maxOf(-normalZ, 0.0f);
+        normalX += normalX >= 0.0f ? -fold : fold;
+        normalY += normalY >= 0.0f ? -fold : fold;
+        const float inverseLength =
+            1.0f / std::sqrt(normalX * normalX + normalY * normalY + normalZ * normalZ);
+        outputX[i] = normalX * inverseLength;
+        outputY[i] = normalY * inverseLength;
+        outputZ[i] = normalZ * inverseLength;
+    }
+}
+
+void assembleStripScalar(const uint32_t* codes, const uint32_t* indices, uint32_t triangleCount,
+                         uint8_t* output) {
+    uint32_t corners[6]{};
+    uint32_t cursor = 0;
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        const uint32_t code = codes[t];
+        corners[3] = indices[cursor];
+        corners[4] = indices[cursor + 1];
+        corners[5] = indices[cursor + 2];
+        const uint8_t* picks = kStripCorners[code];
+        const uint32_t a = corners[picks[0]];
+        const uint32_t b = corners[picks[1]];
+        const uint32_t c = corners[picks[2]];
+        corners[0] = a;
+        corners[1] = b;
+        corners[2] = c;
+        output[t * 3 + 0] = static_cast<uint8_t>(a);
+        output[t * 3 + 1] = static_cast<uint8_t>(b);
+        output[t * 3 + 2] = static_cast<uint8_t>(c);
+        cursor += kStripAdvance[code];
+    }
+}
+
+constexpr DecodeFunctions kScalarFunctions{unpackScalar, dequantizeScalar,
+                                           decodeOctahedralScalar, assembleStripScalar};
+
+#if VG_DECODE_X86
+
+// Eight values of a given width span exactly that many bytes, so every block starts on a byte
+// and the byte and bit position of each lane within it only depend on the width
+struct UnpackTable {
+    // The (up to) three bytes holding each lane's value, gathered into its 32-bit lane
+    alignas(32) uint8_t shuffle[32];
+    alignas(32) uint32_t shift[8];
+    // 1 << (8 - shift): multiplying and shifting right by 8 stands in for the per-lane shift
+    // SSE4.1 lacks; values span at most 23 bits, so the product never overflows
+    alignas(32) uint32_t multiplier[8];
+};
+
+constexpr auto kUnpackTables = [] {
+    std::array<UnpackTable, kMaxPackedBits + 1> tables{};
+    for (uint32_t bits = 0; bits <= kMaxPackedBits; ++bits) {
+        UnpackTable& table = tables[bits];
+        for (uint32_t lane = 0; lane < kBlockSize; ++lane) {
+            const uint32_t bit = lane * bits;
+            for (uint32_t byte = 0; byte < 4; ++byte) {
+                const uint32_t source = bit / 8 + byte;
+                table.shuffle[lane * 4 + byte] =
+                    byte < 3 && source < 16 ? static_cast<uint8_t>(source) : 0x80;
+            }
+            table.shift[lane] = bit % 8;
+            table.multiplier[lane] = 1u << (8 - bit % 8);
+        }
+    }
+    return tables;
+}();
+
+VG_DECODE_TARGET("sse4.1")
+void unpackSse41(const uint8_t* section, uint32_t count, uint32_t bits, uint32_t* values) {
+    const UnpackTable& table = kUnpackTables[bits];
+    const auto* shuffle = reinterpret_cast<const __m128i*>(table.shuffle);
+    const auto* multiplier = reinterpret_cast<const __m128i*>(table.multiplier);
+    const __m128i shuffleLow = _mm_load_si128(shuffle);
+    const __m128i shuffleHigh = _mm_load_si128(shuffle + 1);
+    const __m128i multiplierLow = _mm_load_si128(multiplier);
+    const __m128i multiplierHigh = _mm_load_si128(multiplier + 1);
+    const __m128i mask = _mm_set1_epi32(static_cast<int>((1u << bits) - 1));
+
+    for (uint32_t i = 0; i < count; i += kBlockSize) {
+        const __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(section + i / 8 * bits));
+        const __m128i low = _mm_srli_epi32(
+            _mm_mullo_epi32(_mm_shuffle_epi8(bytes, shuffleLow), multiplierLow), 8);
+        const __m128i high = _mm_srli_epi32(
+            _mm_mullo_epi32(_mm_shuffle_epi8(bytes, shuffleHigh), multiplierHigh), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_and_si128(low, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + 4), _mm_and_si128(high, mask));
+    }
+}
+
+VG_DECODE_TARGET("sse4.1")
+void dequantizeSse41(const uint32_t* values, uint32_t count, float minimum, float scale,
+                     float* output) {
+    const __m128 minimumLanes = _mm_set1_ps(minimum);
+    const __m128 scaleLanes = _mm_set1_ps(scale);
+    for (uint32_t i = 0; i < count; i += 4) {
+        const __m128 value =
+            _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+        _mm_storeu_ps(output + i, _mm_add_ps(minimumLanes, _mm_mul_ps(value, scaleLanes)));
+    }
+}
+
+// Sign-extends packed snorm values and scales them to [-1, 1]
+VG_DECODE_TARGET("sse4.1")
+auto loadSnormSse41(const uint32_t* values, __m128i signShift, __m128 scale) -> __m128 {
+    const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+    const __m128i extended = _mm_sra_epi32(_mm_sll_epi32(packed, signShift), signShift);
+    return _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(extended), scale), _mm_set1_ps(-1.0f));
+}
+
+VG_DECODE_TARGET("sse4.1")
+void decodeOctahedralSse41(const uint32_t* x, const uint32_t* y, uint32_t count,
+                           uint32_t bits, float* outputX, float* outputY, float* outputZ) {
+    const __m128i signShift = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+    const __m128 scale = _mm_set1_ps(getSnormScale(bits));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    for (uint32_t i = 0; i < count; i += 4) {
+        __m128 normalX = loadSnormSse41(x + i, signShift, scale);
+        __m128 normalY = loadSnormSse41(y + i, signShift, scale);
+        const __m128 normalZ = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(signBit, normalX)),
+                                          _mm_andnot_ps(signBit, normalY));
+        const __m128 fold = _mm_max_ps(_mm_xor_ps(normalZ, signBit), zero);
+        const __m128 negativeFold = _mm_xor_ps(fold, signBit);
+        normalX = _mm_add_ps(normalX,
+                             _mm_blendv_ps(fold, negativeFold, _mm_cmpge_ps(normalX, zero)));
+        normalY = _mm_add_ps(normalY,
+                             _mm_blendv_ps(fold, negativeFold, _mm_cmpge_ps(normalY, zero)));
+        __m128 lengthSquared =
+            _mm_add_ps(_mm_mul_ps(normalX, normalX), _mm_mul_ps(normalY, normalY));
+        lengthSquared = _mm_add_ps(lengthSquared, _mm_mul_ps(normalZ, normalZ));
+        const __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+        _mm_storeu_ps(outputX + i, _mm_mul_ps(normalX, inverseLength));
+        _mm_storeu_ps(outputY + i, _mm_mul_ps(normalY, inverseLength));
+        _mm_storeu_ps(outputZ + i, _mm_mul_ps(normalZ, inverseLength));
+    }
+}
+
+VG_DECODE_TARGET("avx2")
+void unpackAvx2(const uint8_t* section, uint32_t count, uint32_t bits, uint32_t* values) {
+    const UnpackTable& table = kUnpackTables[bits];
+    // The block's 16 bytes go to both halves, each half shuffling out four lanes
+    const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.shuffle));
+    const __m256i shift = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.shift));
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>((1u << bits) - 1));
+
+    for (uint32_t i = 0; i < count; i += kBlockSize) {
+        const __m256i bytes = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(section + i / 8 * bits)));
+        const __m256i value = _mm256_srlv_epi32(_mm256_shuffle_epi8(bytes, shuffle), shift);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i),
+                            _mm256_and_si256(value, mask));
+    }
+}
+
+VG_DECODE_TARGET("avx2")
+void dequantizeAvx2(const uint32_t* values, uint32_t count, float minimum, float scale,
+                    float* output) {
+    const __m256 minimumLanes = _mm256_set1_ps(minimum);
+    const __m256 scaleLanes = _mm256_set1_ps(scale);
+    for (uint32_t i = 0; i < count; i += kBlockSize) {
+        const __m256 value = _mm256_cvtepi32_ps(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+        _mm256_storeu_ps(output + i,
+                         _mm256_add_ps(minimumLanes, _mm256_mul_ps(value, scaleLanes)));
+    }
+}
+
+VG_DECODE_TARGET("avx2")
+auto loadSnormAvx2(const uint32_t* values, __m128i signShift, __m256 scale) -> __m256 {
+    const __m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+    const __m256i extended = _mm256_sra_epi32(_mm256_sll_epi32(packed, signShift), signShift);
+    return _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(extended), scale),
+                         _mm256_set1_ps(-1.0f));
+}
+
+VG_DECODE_TARGET("avx2")
+void decodeOctahedralAvx2(const uint32_t* x, const uint32_t* y, uint32_t count,
+                          uint32_t bits, float* outputX, float* outputY, float* outputZ) {
+    const __m128i signShift = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+    const __m256 scale = _mm256_set1_ps(getSnormScale(bits));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    for (uint32_t i = 0; i < count; i += kBlockSize) {
+        __m256 normalX = loadSnormAvx2(x + i, signShift, scale);
+        __m256 normalY = loadSnormAvx2(y + i, signShift, scale);
+        const __m256 normalZ =
+            _mm256_sub_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signBit, normalX)),
+                          _mm256_andnot_ps(signBit, normalY));
+        const __m256 fold = _mm256_max_ps(_mm256_xor_ps(normalZ, signBit), zero);
+        const __m256 negativeFold = _mm256_xor_ps(fold, signBit);
+        normalX = _mm256_add_ps(
+            normalX,
+            _mm256_blendv_ps(fold, negativeFold, _mm256_cmp_ps(normalX, zero, _CMP_GE_OQ)));
+        normalY = _mm256_add_ps(
+            normalY,
+            _mm256_blendv_ps(fold, negativeFold, _mm256_cmp_ps(normalY, zero, _CMP_GE_OQ)));
+        __m256 lengthSquared =
+            _mm256_add_ps(_mm256_mul_ps(normalX, normalX), _mm256_mul_ps(normalY, normalY));
+        lengthSquared = _mm256_add_ps(lengthSquared, _mm256_mul_ps(normalZ, normalZ));
+        const __m256 inverseLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSquared));
+        _mm256_storeu_ps(outputX + i, _mm256_mul_ps(normalX, inverseLength));
+        _mm256_storeu_ps(outputY + i, _mm256_mul_ps(normalY, inverseLength));
+        _mm256_storeu_ps(outputZ + i, _mm256_mul_ps(normalZ, inverseLength));
+    }
+}
+
+// Byte shuffles applying kStripCorners to a register holding the previous triangle in bytes
+// 0 to 2 and the next three strip indices in the low bytes of 32-bit lanes 1 to 3
+struct StripShuffle {
+    alignas(16) uint8_t bytes[16];
+};
+
+constexpr auto kStripShuffles = [] {
+    std::array<StripShuffle, 4> shuffles{};
+    for (uint32_t code = 0; code < 4; ++code) {
+        std::ranges::fill(shuffles[code].bytes, uint8_t{0x80});
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            const uint32_t pick = kStripCorners[code][corner];
+            shuffles[code].bytes[corner] = static_cast<uint8_t>(pick < 3 ? pick : (pick - 2) * 4);
+        }
+    }
+    return shuffles;
+}();
+
+// The walk is a serial chain of one shuffle per triangle, which wider registers would not
+// shorten, so the AVX2 kernel uses it as well
+VG_DECODE_TARGET("sse4.1")
+void assembleStripSse41(const uint32_t* codes, const uint32_t* indices, uint32_t triangleCount,
+                        uint8_t* output) {
+    if (triangleCount == 0) {
+        return;
+    }
+    __m128i state = _mm_setzero_si128();
+    uint32_t cursor = 0;
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        const uint32_t code = codes[t];
+        const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + cursor));
+        const __m128i shuffle =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(kStripShuffles[code].bytes));
+        state = _mm_shuffle_epi8(_mm_or_si128(state, _mm_slli_si128(next, 4)), shuffle);
+        // Four bytes at a time; the fourth is overwritten by the next triangle
+        const auto corners = static_cast<uint32_t>(_mm_cvtsi128_si32(state));
+        std::memcpy(output + t * 3, &corners, t + 1 < triangleCount ? 4 : 3);
+        cursor += kStripAdvance[code];
+    }
+}
+
+constexpr DecodeFunctions kSse41Functions{unpackSse41, dequantizeSse41, decodeOctahedralSse41,
+                                          assembleStripSse41};
+constexpr DecodeFunctions kAvx2Functions{unpackAvx2, dequantizeAvx2, decodeOctahedralAvx2,
+                                         assembleStripSse41};
+
+auto detectKernel() -> DecodeKernel {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    // AVX needs the OS to save the YMM registers as well as CPU support
+    const bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                       (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = osAvx && (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return avx2 ? DecodeKernel::Avx2 : sse41 ? DecodeKernel::Sse41 : DecodeKernel::Scalar;
+}
+
+#else
+
+auto detectKernel() -> DecodeKernel {
+    return DecodeKernel::Scalar;
+}
+
+#endif
+
+auto getFunctions(DecodeKernel kernel) -> const DecodeFunctions& {
+    if (!PageDecoder::isSupported(kernel)) {
+        return kScalarFunctions;
+    }
+    switch (kernel) {
+#if VG_DECODE_X86
+    case DecodeKernel::Avx2:
+        return kAvx2Functions;
+    case DecodeKernel::Sse41:
+        return kSse41Functions;
+#endif
+    default:
+        return kScalarFunctions;
+    }
+}
+
+// Interleaves up to four component arrays into consecutive vectors
+template<typename Vector>
+void interleave(const float (&components)[3][kMaxValues], uint32_t count, Vector* output) {
+    for (uint32_t i = 0; i < count; ++i) {
+        for (int c = 0; c < std::min(Vector::length(), 3); ++c) {
+            output[i][c] = components[c][i];
+        }
+    }
+}
+
+void decodeClusterPositions(const DecodeFunctions& functions, const uint8_t* data,
+                            const PageCluster& cluster, float positionStep,
+                            const PageClusterLayout& layout, ClusterScratch& scratch,
+                            glm::vec3* output) {
+    const uint32_t count = roundUpToBlock(cluster.vertexCount);
+    for (int axis = 0; axis < 3; ++axis) {
+        functions.unpack(data + layout.positions[axis], count, cluster.positionBits[axis],
+                         scratch.values[axis]);
+        functions.dequantize(scratch.values[axis], count, cluster.positionMin[axis],
+                             positionStep, scratch.components[axis]);
+    }
+    interleave(scratch.components, cluster.vertexCount, output);
+}
+
+void decodeClusterTriangles(const DecodeFunctions& functions, const uint8_t* data,
+                            const PageCluster& cluster, const PageClusterLayout& layout,
+                            ClusterScratch& scratch, uint8_t* output) {
+    functions.unpack(data + layout.stripCodes, roundUpToBlock(cluster.triangleCount),
+                     kStripCodeBits, scratch.values[0]);
+    functions.unpack(data + layout.stripIndices, roundUpToBlock(cluster.stripIndexCount),
+                     cluster.indexBits, scratch.stripIndices);
+    std::fill_n(scratch.stripIndices + cluster.stripIndexCount, 3, 0u);
+    functions.assembleStrip(scratch.values[0], scratch.stripIndices, cluster.triangleCount,
+                            output);
+}
+
+void decodeCluster(const DecodeFunctions& functions, const PageView& page,
+                   const PageCluster& cluster, const DecodedCluster& target,
+                   ClusterScratch& scratch, DecodedPage& output) {
+    const uint8_t* data = page.data.data() + cluster.dataOffset;
+    const PageClusterLayout layout = getClusterLayout(cluster);
+    const uint32_t count = roundUpToBlock(cluster.vertexCount);
+
+    decodeClusterPositions(functions, data, cluster, page.positionStep, layout, scratch,
+                           output.positions.data() + target.vertexOffset);
+
+    functions.unpack(data + layout.normals[0], count, cluster.normalBits, scratch.values[0]);
+    functions.unpack(data + layout.normals[1], count, cluster.normalBits, scratch.values[1]);
+    functions.decodeOctahedral(scratch.values[0], scratch.values[1], count, cluster.normalBits,
+                               scratch.components[0], scratch.components[1],
+                               scratch.components[2]);
+    interleave(scratch.components, cluster.vertexCount,
+               output.normals.data() + target.vertexOffset);
+
+    if (!output.tangents.empty()) {
+        glm::vec4* tangents = output.tangents.data() + target.vertexOffset;
+        if ((cluster.attributes & kPageAttributeTangents) != 0) {
+            for (int axis = 0; axis < 3; ++axis) {
+                functions.unpack(data + layout.tangents[axis], count,
+                                 axis < 2 ? cluster.normalBits : 1u, scratch.values[axis]);
+            }
+            functions.decodeOctahedral(scratch.values[0], scratch.values[1], count,
+                                       cluster.normalBits, scratch.components[0],
+                                       scratch.components[1], scratch.components[2]);
+            interleave(scratch.components, cluster.vertexCount, tangents);
+            for (uint32_t i = 0; i < cluster.vertexCount; ++i) {
+                tangents[i].w = scratch.values[2][i] != 0 ? -1.0f : 1.0f;
+            }
+        } else {
+            std::fill_n(tangents, cluster.vertexCount, glm::vec4{0.0f});
+        }
+    }
+
+    if (!output.uvs.empty()) {
+        glm::vec2* uvs = output.uvs.data() + target.vertexOffset;
+        if ((cluster.attributes & kPageAttributeUvs) != 0) {
+            for (int axis = 0; axis < 2; ++axis) {
+                functions.unpack(data + layout.uvs[axis], count, kUvBits, scratch.values[axis]);
+                functions.dequantize(scratch.values[axis], count, cluster.uvMin[axis],
+                                     cluster.uvScale[axis], scratch.components[axis]);
+            }
+            interleave(scratch.components, cluster.vertexCount, uvs);
+        } else {
+            std::fill_n(uvs, cluster.vertexCount, glm::vec2{0.0f});
+        }
+    }
+
+    uint8_t* triangles = output.triangles.data() + static_cast<size_t>(target.triangleOffset) * 3;
+    decodeClusterTriangles(functions, data, cluster, layout, scratch, triangles);
+}
+
+} // namespace
+
+auto PageDecoder::getBestKernel() -> DecodeKernel {
+    static const DecodeKernel kernel = detectKernel();
+    return kernel;
+}
+
+auto PageDecoder::isSupported(DecodeKernel kernel) -> bool {
+    const DecodeKernel best = getBestKernel();
+    switch (kernel) {
+    case DecodeKernel::Scalar:
+        return true;
+    case DecodeKernel::Sse41:
+        return best == DecodeKernel::Sse41 || best == DecodeKernel::Avx2;
+    case DecodeKernel::Avx2:
+        return best == kernel;
+    }
+    return false;
+}
+
+auto PageDecoder::getKernelName(DecodeKernel kernel) -> const char* {
+    switch (kernel) {
+    case DecodeKernel::Scalar:
+        return "scalar";
+    case DecodeKernel::Sse41:
+        return "sse4.1";
+    case DecodeKernel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+void PageDecoder::decodePage(const PageView& page, DecodedPage& output, DecodeKernel kernel) {
+    ZoneScoped;
+    const DecodeFunctions& functions = getFunctions(kernel);
+
+    output.clusters.resize(page.clusters.size());
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+    uint8_t attributes = 0;
+    for (size_t i = 0; i < page.clusters.size(); ++i) {
+        const PageCluster& cluster = page.clusters[i];
+        output.clusters[i] = DecodedCluster{vertexCount, cluster.vertexCount, triangleCount,
+                                            cluster.triangleCount};
+        vertexCount += cluster.vertexCount;
+        triangleCount += cluster.triangleCount;
+        attributes |= cluster.attributes;
+    }
+    output.positions.resize(vertexCount);
+    output.normals.resize(vertexCount);
+    output.tangents.resize((attributes & kPageAttributeTangents) != 0 ? vertexCount : 0);
+    output.uvs.resize((attributes & kPageAttributeUvs) != 0 ? vertexCount : 0);
+    output.triangles.resize(static_cast<size_t>(triangleCount) * 3);
+
+    ClusterScratch scratch;
+    for (size_t i = 0; i < page.clusters.size(); ++i) {
+        decodeCluster(functions, page, page.clusters[i], output.clusters[i], scratch, output);
+    }
+}
+
+void PageDecoder::decodePositions(const PageView& page, const PageCluster& cluster,
+                                  std::span<glm::vec3> positions, DecodeKernel kernel) {
+    ClusterScratch scratch;
+    decodeClusterPositions(getFunctions(kernel), page.data.data() + cluster.dataOffset, cluster,
+                           page.positionStep, getClusterLayout(cluster), scratch,
+                           positions.data());
+}
+
+void PageDecoder::decodeTriangles(const PageView& page, const PageCluster& cluster,
+                                  std::span<uint8_t> triangles, DecodeKernel kernel) {
+    ClusterScratch scratch;
+    decodeClusterTriangles(getFunctions(kernel), page.data.data() + cluster.dataOffset, cluster,
+                           getClusterLayout(cluster), scratch, triangles.data());
+}
+
+auto PageDecoder::hasValidTriangles(const PageView& page, const PageCluster& cluster) -> bool {
+    if (cluster.triangleCount > kMaxPageClusterTriangles ||
+        cluster.stripIndexCount > cluster.triangleCount * 3 || cluster.indexBits > 8) {
+        return false;
+    }
+    const uint8_t* data = page.data.data() + cluster.dataOffset;
+    const PageClusterLayout layout = getClusterLayout(cluster);
+    ClusterScratch scratch;
+    unpackScalar(data + layout.stripCodes, cluster.triangleCount, kStripCodeBits,
+                 scratch.values[0]);
+    unpackScalar(data + layout.stripIndices, cluster.stripIndexCount, cluster.indexBits,
+                 scratch.stripIndices);
+
+    // Strips start with a restart and consume exactly their indices
+    if (cluster.triangleCount > 0 && scratch.values[0][0] != kStripRestart) {
+        return false;
+    }
+    uint32_t cursor = 0;
+    for (uint32_t t = 0; t < cluster.triangleCount; ++t) {
+        cursor += kStripAdvance[scratch.values[0][t]];
+    }
+    if (cursor != cluster.stripIndexCount) {
+        return false;
+    }
+    return std::all_of(scratch.stripIndices, scratch.stripIndices + cluster.stripIndexCount,
+                       [&](uint32_t index) { return index < cluster.vertexCount; });
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "PagedGeometry.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class DecodeKernel : uint8_t {
+    Scalar,
+    Sse41,
+    Avx2,
+};
+
+struct DecodedCluster {
+    uint32_t vertexOffset{0};
+    uint32_t vertexCount{0};
+    uint32_t triangleOffset{0}; // First triangle, three bytes each
+    uint32_t triangleCount{0};
+};
+
+// A page expanded into flat arrays ready to copy into vertex and index buffers. Each cluster's
+// vertices are a range of every vertex array, and its triangles index them locally. Arrays of
+// attributes no cluster in the page has stay empty.
+struct DecodedPage {
+    std::vector<DecodedCluster> clusters;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec4> tangents; // Handedness in w
+    std::vector<glm::vec2> uvs;
+    std::vector<uint8_t> triangles;
+};
+
+// Expands the bit-packed clusters of a page (see PageFormat.hpp). The SIMD kernels unpack
+// eight values per step with a byte shuffle and per-lane shifts picked by the bit width,
+// dequantize in registers and walk triangle strips with one byte shuffle per triangle. They
+// evaluate the same operations in the same order as the scalar reference, and this file is
+// built without floating-point contraction, so every kernel produces bit-identical output.
+//
+// Decoding reads up to kPageTailPadding bytes past a cluster's sections, so page views must
+// cover whole pages, as PagedGeometry::getPage and PageCache::getPage do, and untrusted pages
+// must be validated first.
+class PageDecoder {
+public:
+    // Widest kernel the CPU supports, detected once
+    [[nodiscard]] static auto getBestKernel() -> DecodeKernel;
+    [[nodiscard]] static auto isSupported(DecodeKernel kernel) -> bool;
+    [[nodiscard]] static auto getKernelName(DecodeKernel kernel) -> const char*;
+
+    // Replaces the contents of output, reusing its memory. Unsupported kernels fall back to
+    // the scalar reference.
+    static void decodePage(const PageView& page, DecodedPage& output, DecodeKernel kernel);
+    static void decodePage(const PageView& page, DecodedPage& output) {
+        decodePage(page, output, getBestKernel());
+    }
+
+    // Single streams of one cluster for consumers that need only those; the outputs hold
+    // vertexCount positions and triangleCount * 3 indices
+    static void decodePositions(const PageView& page, const PageCluster& cluster,
+                                std::span<glm::vec3> positions,
+                                DecodeKernel kernel = getBestKernel());
+    static void decodeTriangles(const PageView& page, const PageCluster& cluster,
+                                std::span<uint8_t> triangles,
+                                DecodeKernel kernel = getBestKernel());
+
+    // Whether the strip consumes exactly its indices and every index is below the cluster's
+    // vertex count; the section bounds must have been checked already
+    [[nodiscard]] static auto hasValidTriangles(const PageView& page, const PageCluster& cluster)
+        -> bool;
+};
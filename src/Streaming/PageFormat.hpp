@@ -0,0 +1,256 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+// Cooked virtual geometry file (.vgeo). All structures are little-endian PODs used in place
+// from a memory mapping, so their layout must never change without bumping kPageFileVersion.
+//
+//   PageFileHeader
+//   hierarchy section: PageTableEntry[pageCount], PageGroup[groupCount], uint32_t dependencies[],
+//                      uint32_t clusterChildGroups[clusterCount], PageLeafLod[leafClusterCount]
+//   padding to kPageAlignment
+//   page 0 .. page N-1, pageSize bytes each
+//
+// The hierarchy section holds everything LOD selection and streaming decisions need and stays
+// resident; pages hold the cluster payload and are streamed on demand. Every group lives in a
+// single page, and pages are ordered from the coarsest level to the finest.
+//
+// Page layout: PageHeader, PageCluster[clusterCount], then per cluster a run of bit-packed
+// sections at its dataOffset (see PageClusterLayout). Each section holds one component of
+// every vertex or triangle at a fixed bit width chosen per cluster, least significant bit
+// first, and is padded to 32 bits:
+//   positions x, y, z   steps of the file's positionStep above positionMin, positionBits[axis]
+//                       bits
+//   normals x, y        octahedral, normalBits-bit snorm per component
+//   tangents x, y, w    octahedral like normals, then one handedness bit (kPageAttributeTangents)
+//   uvs u, v            kUvBits unorm, quantized to the cluster's uv box (kPageAttributeUvs)
+//   strip codes         2 bits per triangle (kStripRestart and the edge codes)
+//   strip indices       indexBits-bit local vertex indices, three for every triangle that
+//                       restarts the strip and one for every other
+// Decoders load 16 bytes at a time, so pages keep kPageTailPadding bytes after their used
+// bytes.
+
+constexpr uint32_t kPageFileMagic = 0x4f454756; // "VGEO"
+constexpr uint32_t kPageFileVersion = 6;
+constexpr uint32_t kPageMagic = 0x47504756; // "VGPG"
+constexpr uint32_t kDefaultPageSize = 128 * 1024;
+constexpr uint32_t kMinPageSize = 16 * 1024;
+// Pages start on virtual memory page boundaries so each can be mapped and advised on its own
+constexpr uint32_t kPageAlignment = 4096;
+// Triangles use 8-bit local vertex indices
+constexpr uint32_t kMaxPageClusterVertices = 256;
+constexpr uint32_t kMaxPageClusterTriangles = 512;
+constexpr uint32_t kPageTailPadding = 16;
+// Widest bit-packed component; every value then spans at most three bytes
+constexpr uint32_t kMaxPackedBits = 16;
+constexpr uint32_t kUvBits = 16;
+constexpr uint32_t kDefaultPositionBits = 12;
+constexpr uint32_t kDefaultNormalBits = 10;
+
+// PageCluster::attributes
+constexpr uint8_t kPageAttributeUvs = 1;
+constexpr uint8_t kPageAttributeTangents = 2;
+
+// Strip codes. The triangles of a cluster form generalized strips: each one either restarts
+// with three new indices or shares an edge of the previous triangle (a, b, c), keeping the
+// winding, and adds one new index d.
+constexpr uint32_t kStripRestart = 0; // (d0, d1, d2)
+constexpr uint32_t kStripEdgeBc = 1;  // (c, b, d)
+constexpr uint32_t kStripEdgeCa = 2;  // (a, c, d)
+constexpr uint32_t kStripEdgeAb = 3;  // (b, a, d)
+constexpr uint32_t kStripCodeBits = 2;
+
+// The roots were never simplified together, so they are split into groups of at most this
+// many clusters to fit pages
+constexpr uint32_t kMaxRootGroupClusters = 32;
+
+// clusterChildGroups holds, for every cluster in file order (pages in order, clusters in page
+// order), the group whose members were simplified into it. The cluster stands in for that
+// group while the group's page is missing, and its lodBounds and error are that group's.
+// Clusters of the finest level have none; their LOD data follows as PageLeafLod records in the
+// same order, so the hierarchy never needs a page.
+constexpr uint32_t kNoChildGroup = ~0u;
+
+struct PageFileHeader {
+    uint32_t magic{kPageFileMagic};
+    uint32_t version{kPageFileVersion};
+    uint32_t pageSize{kDefaultPageSize};
+    uint32_t pageCount{0};
+    uint32_t groupCount{0};
+    uint32_t dependencyCount{0};
+    uint32_t clusterCount{0};
+    uint32_t levelCount{0};
+    uint32_t leafClusterCount{0}; // Clusters without a child group
+    // Spacing of the position grid, a power of two. Every cluster quantizes to this one grid,
+    // so a vertex shared by neighbouring clusters decodes to the same bits in each.
+    float positionStep{0.0f};
+    uint64_t hierarchyOffset{0};
+    uint64_t hierarchySize{0};
+    uint64_t pagesOffset{0};
+    uint64_t triangleCount{0};
+    glm::vec4 bounds{0.0f}; // Sphere around the whole mesh
+};
+
+struct PageTableEntry {
+    uint32_t groupOffset{0}; // First entry in the group table
+    uint32_t groupCount{0};
+    uint32_t clusterCount{0};
+    uint32_t usedBytes{0};
+    // Pages holding the parents of this page's groups. They must be resident whenever this
+    // page is, otherwise a cut could reach clusters whose coarser fallback is missing.
+    uint32_t dependencyOffset{0};
+    uint32_t dependencyCount{0};
+    uint32_t level{0}; // Finest level of any group in the page
+    uint32_t checksum{0}; // FNV-1a of the used bytes
+};
+
+// A set of clusters simplified together. lodBounds and error describe the group's
+// simplification; the member clusters are part of the cut for threshold t when
+//     projected(error, lodBounds) > t && projected(clusterError, clusterLodBounds) <= t
+// The root clusters form a final group with infinite error.
+struct PageGroup {
+    glm::vec4 lodBounds{0.0f};
+    float error{0.0f};
+    // Largest own error of any member cluster; the group needs no refinement below it
+    float maxClusterError{0.0f};
+    uint32_t level{0};
+    uint32_t page{0};
+    uint32_t firstCluster{0}; // Index into the page's cluster table
+    uint32_t clusterCount{0};
+    uint32_t reserved[2]{};
+};
+
+struct PageLeafLod {
+    glm::vec4 lodBounds{0.0f};
+    float error{0.0f};
+};
+
+struct PageHeader {
+    uint32_t magic{kPageMagic};
+    uint32_t clusterCount{0};
+    uint32_t groupOffset{0};
+    uint32_t usedBytes{0};
+};
+
+struct PageCluster {
+    glm::vec4 boundingSphere{0.0f};
+    glm::vec4 lodBounds{0.0f};
+    glm::vec3 coneApex{0.0f};
+    float coneCutoff{1.0f};
+    glm::vec3 coneAxis{0.0f};
+    float error{0.0f};
+    // position = positionMin + quantized * positionStep; positionMin lies on the grid
+    glm::vec3 positionMin{0.0f};
+    uint32_t vertexCount{0};
+    uint32_t reserved[3]{};
+    uint32_t triangleCount{0};
+    // uv = uvMin + quantized * uvScale
+    glm::vec2 uvMin{0.0f};
+    glm::vec2 uvScale{0.0f};
+    // Byte offset of the bit-packed sections from the start of the page
+    uint32_t dataOffset{0};
+    uint32_t group{0};
+    uint8_t positionBits[3]{}; // 0 for axes the cluster is flat along
+    uint8_t normalBits{0};     // Also used for tangents
+    uint8_t attributes{0};
+    uint8_t indexBits{0};
+    uint16_t stripIndexCount{0}; // triangleCount plus two per restart
+};
+
+static_assert(sizeof(PageFileHeader) == 88 && std::is_trivially_copyable_v<PageFileHeader>);
+static_assert(sizeof(PageTableEntry) == 32 && std::is_trivially_copyable_v<PageTableEntry>);
+static_assert(sizeof(PageGroup) == 48 && std::is_trivially_copyable_v<PageGroup>);
+static_assert(sizeof(PageLeafLod) == 20 && std::is_trivially_copyable_v<PageLeafLod>);
+static_assert(sizeof(PageHeader) == 16 && std::is_trivially_copyable_v<PageHeader>);
+static_assert(sizeof(PageCluster) == 128 && std::is_trivially_copyable_v<PageCluster>);
+
+[[nodiscard]] constexpr auto alignUp(uint64_t value, uint64_t alignment) noexcept -> uint64_t {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+[[nodiscard]] constexpr auto packedSectionSize(uint32_t count, uint32_t bits) noexcept
+    -> uint32_t {
+    return static_cast<uint32_t>(alignUp(static_cast<uint64_t>(count) * bits, 32) / 8);
+}
+
+// Byte offsets of a cluster's sections from its dataOffset; absent attributes are empty
+struct PageClusterLayout {
+    uint32_t positions[3]{};
+    uint32_t normals[2]{};
+    uint32_t tangents[3]{};
+    uint32_t uvs[2]{};
+    uint32_t stripCodes{0};
+    uint32_t stripIndices{0};
+    uint32_t size{0};
+};
+
+[[nodiscard]] constexpr auto getClusterLayout(const PageCluster& cluster) noexcept
+    -> PageClusterLayout {
+    PageClusterLayout layout;
+    uint32_t offset = 0;
+    auto section = [&offset](uint32_t count, uint32_t bits) {
+        const uint32_t start = offset;
+        offset += packedSectionSize(count, bits);
+        return start;
+    };
+    const uint32_t vertexCount = cluster.vertexCount;
+    for (int axis = 0; axis < 3; ++axis) {
+        layout.positions[axis] = section(vertexCount, cluster.positionBits[axis]);
+    }
+    for (int axis = 0; axis < 2; ++axis) {
+        layout.normals[axis] = section(vertexCount, cluster.normalBits);
+    }
+    const bool tangents = (cluster.attributes & kPageAttributeTangents) != 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        layout.tangents[axis] = section(tangents ? vertexCount : 0,
+                                        axis < 2 ? cluster.normalBits : 1u);
+    }
+    const bool uvs = (cluster.attributes & kPageAttributeUvs) != 0;
+    for (int axis = 0; axis < 2; ++axis) {
+        layout.uvs[axis] = section(uvs ? vertexCount : 0, kUvBits);
+    }
+    layout.stripCodes = section(cluster.triangleCount, kStripCodeBits);
+    layout.stripIndices = section(cluster.stripIndexCount, cluster.indexBits);
+    layout.size = offset;
+    return layout;
+}
+
+// FNV-1a over the used bytes of a page
+[[nodiscard]] inline auto pageChecksum(std::span<const uint8_t> bytes) noexcept -> uint32_t {
+    uint32_t hash = 2166136261u;
+    for (uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 16777619u;
+    }
+    return hash;
+}
+
+// Nearest of the 2^bits evenly spaced levels in [0, 1]
+[[nodiscard]] inline auto quantizeUnorm(float value, uint32_t bits) noexcept -> uint32_t {
+    const auto levels = static_cast<float>((1u << bits) - 1);
+    return static_cast<uint32_t>(std::clamp(value, 0.0f, 1.0f) * levels + 0.5f);
+}
+
+// Octahedral unit vector encoding: two snorm components of the given width in two's
+// complement, masked to that width
+[[nodiscard]] inline auto encodeOctahedral(const glm::vec3& normal, uint32_t bits) noexcept
+    -> glm::uvec2 {
+    const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    glm::vec2 encoded = length > 0.0f ? glm::vec2{normal.x, normal.y} / length : glm::vec2{0.0f};
+    if (normal.z < 0.0f && length > 0.0f) {
+        encoded = glm::vec2{(1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+                            (1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f)};
+    }
+    const auto maximum = static_cast<float>((1u << (bits - 1)) - 1);
+    const uint32_t mask = (1u << bits) - 1;
+    auto snorm = [&](float value) {
+        const auto quantized =
+            static_cast<int32_t>(std::round(std::clamp(value, -1.0f, 1.0f) * maximum));
+        return static_cast<uint32_t>(quantized) & mask;
+    };
+    return {snorm(encoded.x), snorm(encoded.y)};
+}
@@ -0,0 +1,387 @@
+#include "PageStreamer.hpp"
+#include "IoRing.hpp"
+#include "Logger.hpp"
+#include "PagedGeometry.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <string>
+
+namespace {
+
+constexpr uint32_t kLatencyWindow = 1024;
+
+using Milliseconds = std::chrono::duration<float, std::milli>;
+
+auto percentile(std::vector<float> samples, float fraction) -> float {
+    if (samples.empty()) {
+        return 0.0f;
+    }
+    const auto rank = static_cast<size_t>(fraction * static_cast<float>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+// io_uring user data carries the whole read so completions need no lookup table
+auto packRead(uint32_t page, uint32_t slot) -> uint64_t {
+    return (static_cast<uint64_t>(page) << 32) | slot;
+}
+
+} // namespace
+
+auto PageStreamer::create(const PagedGeometry& geometry, const std::filesystem::path& path,
+                          const Config& config) -> Result<std::unique_ptr<PageStreamer>> {
+    ZoneScoped;
+    if (config.ioThreadCount == 0 || config.stagingSlotCount == 0 ||
+        config.maxInFlightPages == 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            "Page streaming needs at least one I/O thread, staging slot and in-flight page"
+        ));
+    }
+
+    auto file = StreamFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    if (file->getSize() < geometry.getPageOffset(geometry.getPageCount())) {
+        return std::unexpected(makeError(
+            ErrorCode::FileParseFailed,
+            std::format("{} is shorter than its page table", path.string())
+        ));
+    }
+
+    auto streamer = std::unique_ptr<PageStreamer>(
+        new PageStreamer(geometry, std::move(*file), config));
+    Logger::info("Page streaming: {} I/O threads using {}, {} staging slots ({} KiB)",
+                 config.ioThreadCount, streamer->getBackendName(), config.stagingSlotCount,
+                 config.stagingSlotCount * geometry.getHeader().pageSize / 1024);
+    return streamer;
+}
+
+PageStreamer::PageStreamer(const PagedGeometry& geometry, StreamFile file, const Config& config)
+    : m_geometry(geometry)
+    , m_file(std::move(file))
+    , m_config(config)
+    , m_pages(geometry.getPageCount())
+{
+    // Probe once so every thread agrees on the backend; a kernel or seccomp policy that
+    // rejects io_uring fails here rather than on every read
+    if (m_config.preferIoUring && m_file.getDescriptor() >= 0) {
+        auto ring = IoRing::create(8);
+        m_useIoRing = ring.has_value();
+        if (!ring) {
+            Logger::debug("io_uring unavailable, falling back to pread: {}",
+                          ring.error().message);
+        }
+    }
+
+    const uint64_t pageSize = geometry.getHeader().pageSize;
+    m_staging = std::make_unique<uint8_t[]>(pageSize * m_config.stagingSlotCount);
+    m_freeSlots.reserve(m_config.stagingSlotCount);
+    for (uint32_t slot = m_config.stagingSlotCount; slot-- > 0;) {
+        m_freeSlots.push_back(slot);
+    }
+    m_latencySamples.reserve(kLatencyWindow);
+    m_ioLatencySamples.reserve(kLatencyWindow);
+
+    m_ioThreads.reserve(m_config.ioThreadCount);
+    for (uint32_t i = 0; i < m_config.ioThreadCount; ++i) {
+        m_ioThreads.emplace_back([this, i]() { ioThreadLoop(i); });
+    }
+}
+
+PageStreamer::~PageStreamer() {
+    ZoneScoped;
+    {
+        std::lock_guard lock(m_readMutex);
+        m_running = false;
+        m_readQueue.clear();
+    }
+    m_readCondition.notify_all();
+
+    for (auto& thread : m_ioThreads) {
+        thread.join();
+    }
+}
+
+auto PageStreamer::getBackendName() const noexcept -> std::string_view {
+    return m_useIoRing ? "io_uring" : "pread";
+}
+
+auto PageStreamer::getSlotData(uint32_t slot) noexcept -> uint8_t* {
+    return m_staging.get() + static_cast<uint64_t>(slot) * m_geometry.getHeader().pageSize;
+}
+
+void PageStreamer::request(uint32_t page, float priority) {
+    PageRecord& record = m_pages[page];
+    ++m_stats.requested;
+    record.lastRequest = m_updateIndex;
+
+    if (record.state != PageState::Idle) {
+        ++m_stats.deduplicated;
+        record.priority = std::max(record.priority, priority);
+        return;
+    }
+
+    record.state = PageState::Pending;
+    record.priority = priority;
+    record.requestTime = Clock::now();
+    m_pendingPages.push_back(page);
+}
+
+void PageStreamer::update() {
+    ZoneScoped;
+
+    // Requests the caller stopped renewing are no longer wanted (the view moved on)
+    const uint64_t updateIndex = m_updateIndex++;
+    std::erase_if(m_pendingPages, [&](uint32_t page) {
+        PageRecord& record = m_pages[page];
+        if (updateIndex - record.lastRequest < m_config.maxRequestAge) {
+            return false;
+        }
+        record.state = PageState::Idle;
+        ++m_stats.dropped;
+        return true;
+    });
+
+    std::sort(m_pendingPages.begin(), m_pendingPages.end(), [this](uint32_t a, uint32_t b) {
+        return m_pages[a].priority != m_pages[b].priority
+                   ? m_pages[a].priority > m_pages[b].priority
+                   : a < b;
+    });
+
+    const auto pageTable = m_geometry.getPageTable();
+    size_t dispatchCount = 0;
+    {
+        std::lock_guard lock(m_readMutex);
+        for (uint32_t page : m_pendingPages) {
+            const uint64_t size = pageTable[page].usedBytes;
+            // A page larger than the whole byte budget still goes out once nothing else is
+            if (m_freeSlots.empty() || m_inFlightPages >= m_config.maxInFlightPages ||
+                (m_inFlightPages > 0 && m_inFlightBytes + size > m_config.maxInFlightBytes)) {
+                break;
+            }
+
+            PageRecord& record = m_pages[page];
+            record.state = PageState::InFlight;
+            record.dispatchTime = Clock::now();
+
+            m_readQueue.push_back(ReadRequest{page, m_freeSlots.back()});
+            m_freeSlots.pop_back();
+            m_inFlightBytes += size;
+            ++m_inFlightPages;
+            ++dispatchCount;
+        }
+    }
+    if (dispatchCount > 0) {
+        m_pendingPages.erase(m_pendingPages.begin(),
+                             m_pendingPages.begin() + static_cast<ptrdiff_t>(dispatchCount));
+        m_stats.dispatched += dispatchCount;
+        m_readCondition.notify_all();
+    }
+
+    TracyPlot("Streaming Pending", static_cast<int64_t>(m_pendingPages.size()));
+    TracyPlot("Streaming In Flight", static_cast<int64_t>(m_inFlightPages));
+}
+
+void PageStreamer::takeCompleted(std::vector<CompletedPage>& output) {
+    ZoneScoped;
+    std::vector<ReadResult> results;
+    {
+        std::lock_guard lock(m_resultMutex);
+        results.swap(m_results);
+    }
+
+    const auto pageTable = m_geometry.getPageTable();
+    for (const ReadResult& result : results) {
+        PageRecord& record = m_pages[result.page];
+        const uint32_t usedBytes = pageTable[result.page].usedBytes;
+        const float latency = Milliseconds(result.finishTime - record.requestTime).count();
+        const float ioLatency = Milliseconds(result.finishTime - record.dispatchTime).count();
+
+        if (m_latencySamples.size() < kLatencyWindow) {
+            m_latencySamples.push_back(latency);
+            m_ioLatencySamples.push_back(ioLatency);
+        } else {
+            m_latencySamples[m_sampleCount % kLatencyWindow] = latency;
+            m_ioLatencySamples[m_sampleCount % kLatencyWindow] = ioLatency;
+        }
+        ++m_sampleCount;
+
+        m_inFlightBytes -= usedBytes;
+        --m_inFlightPages;
+        record.state = PageState::Idle;
+        if (result.valid) {
+            ++m_stats.completed;
+            m_stats.bytesRead += usedBytes;
+        } else {
+            ++m_stats.failed;
+        }
+
+        output.push_back(CompletedPage{
+            result.page,
+            result.slot,
+            {getSlotData(result.slot), usedBytes},
+            result.valid,
+            latency,
+        });
+    }
+}
+
+void PageStreamer::releaseStaging(uint32_t slot) {
+    m_freeSlots.push_back(slot);
+}
+
+auto PageStreamer::isIdle() const noexcept -> bool {
+    return m_pendingPages.empty() && m_inFlightPages == 0;
+}
+
+auto PageStreamer::getStats() const -> Stats {
+    Stats stats = m_stats;
+    stats.pending = static_cast<uint32_t>(m_pendingPages.size());
+    stats.inFlight = m_inFlightPages;
+    stats.latencyP50Ms = percentile(m_latencySamples, 0.50f);
+    stats.latencyP95Ms = percentile(m_latencySamples, 0.95f);
+    stats.latencyP99Ms = percentile(m_latencySamples, 0.99f);
+    stats.ioLatencyP50Ms = percentile(m_ioLatencySamples, 0.50f);
+    stats.ioLatencyP95Ms = percentile(m_ioLatencySamples, 0.95f);
+    stats.ioLatencyP99Ms = percentile(m_ioLatencySamples, 0.99f);
+    return stats;
+}
+
+auto PageStreamer::popReads(std::vector<ReadRequest>& output, uint32_t maxCount, bool block)
+    -> bool {
+    std::unique_lock lock(m_readMutex);
+    if (block) {
+        m_readCondition.wait(lock, [this]() { return !m_running || !m_readQueue.empty(); });
+    }
+    while (maxCount > 0 && !m_readQueue.empty()) {
+        output.push_back(m_readQueue.front());
+        m_readQueue.pop_front();
+        --maxCount;
+    }
+    return m_running;
+}
+
+void PageStreamer::finishRead(const ReadRequest& read, bool success) {
+    ZoneScoped;
+    bool valid = success;
+    if (valid && m_config.validatePages) {
+        const std::span<const uint8_t> pageData{getSlotData(read.slot),
+                                                m_geometry.getHeader().pageSize};
+        auto result = m_geometry.validatePage(read.page, pageData);
+        if (!result) {
+            Logger::warn("Streamed page rejected: {}", result.error().message);
+            valid = false;
+        }
+    }
+
+    std::lock_guard lock(m_resultMutex);
+    m_results.push_back(ReadResult{read.page, read.slot, valid, Clock::now()});
+}
+
+void PageStreamer::ioThreadLoop(uint32_t threadIndex) {
+    const std::string threadName = std::format("Page I/O {}", threadIndex);
+    tracy::SetThreadName(threadName.c_str());
+
+    if (m_useIoRing) {
+        auto ring = IoRing::create(m_config.maxInFlightPages);
+        if (ring) {
+            ioRingLoop(*ring);
+            return;
+        }
+        Logger::warn("I/O thread {} could not create an io_uring, using pread: {}",
+                     threadIndex, ring.error().message);
+    }
+    preadLoop();
+}
+
+void PageStreamer::preadLoop() {
+    std::vector<ReadRequest> reads;
+    while (true) {
+        reads.clear();
+        if (!popReads(reads, 1, true)) {
+            return;
+        }
+        for (const ReadRequest& read : reads) {
+            ZoneScopedN("Page Read");
+            auto result = m_file.readAt(getSlotData(read.slot),
+                                        m_geometry.getPageTable()[read.page].usedBytes,
+                                        m_geometry.getPageOffset(read.page));
+            if (!result) {
+                Logger::warn("Page {} read failed: {}", read.page, result.error().message);
+            }
+            finishRead(read, result.has_value());
+        }
+    }
+}
+
+void PageStreamer::ioRingLoop(IoRing& ring) {
+    const auto pageTable = m_geometry.getPageTable();
+    // Reads the kernel owns; their staging slots must not be freed before they complete
+    std::vector<ReadRequest> outstanding;
+    std::vector<ReadRequest> reads;
+    std::array<IoRing::Completion, 32> completions;
+    bool running = true;
+
+    while (running || !outstanding.empty()) {
+        reads.clear();
+        if (running) {
+            const auto capacity = ring.getEntryCount() - static_cast<uint32_t>(outstanding.size());
+            running = popReads(reads, capacity, outstanding.empty());
+        }
+        for (const ReadRequest& read : reads) {
+            const bool queued = ring.queueRead(m_file.getDescriptor(), getSlotData(read.slot),
+                                               pageTable[read.page].usedBytes,
+                                               m_geometry.getPageOffset(read.page),
+                                               packRead(read.page, read.slot));
+            if (!queued) {
+                // Cannot happen while outstanding reads stay within the ring size
+                finishRead(read, false);
+                continue;
+            }
+            outstanding.push_back(read);
+        }
+        if (outstanding.empty()) {
+            continue;
+        }
+
+        if (auto result = ring.submit(1); !result) {
+            // Only a broken ring fails here; report its reads as failed so the pages can be
+            // requested again and serve everything from now on with pread
+            Logger::warn("io_uring submission failed, switching to pread: {}",
+                         result.error().message);
+            for (const ReadRequest& read : outstanding) {
+                finishRead(read, false);
+            }
+            if (running) {
+                preadLoop();
+            }
+            return;
+        }
+
+        ZoneScopedN("Page Completions");
+        const uint32_t count = ring.reap(completions);
+        for (uint32_t i = 0; i < count; ++i) {
+            const IoRing::Completion& completion = completions[i];
+            const ReadRequest read{static_cast<uint32_t>(completion.userData >> 32),
+                                   static_cast<uint32_t>(completion.userData)};
+            std::erase_if(outstanding, [&read](const ReadRequest& other) {
+                return other.slot == read.slot;
+            });
+
+            const bool success = completion.result >= 0 &&
+                                 static_cast<uint32_t>(completion.result) ==
+                                     pageTable[read.page].usedBytes;
+            if (!success) {
+                Logger::warn("Page {} read failed: {}", read.page,
+                             completion.result < 0 ? std::strerror(-completion.result)
+                                                   : "short read");
+            }
+            finishRead(read, success);
+        }
+    }
+}
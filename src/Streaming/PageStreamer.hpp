@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Error.hpp"
+#include "StreamFile.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class IoRing;
+class PagedGeometry;
+
+// Streams pages of a cooked .vgeo file into a fixed set of page-sized staging slots on
+// dedicated I/O threads. All public functions belong to the thread that pumps update(),
+// normally the main thread once per frame:
+//   request() queues pages by priority, repeated requests for the same page are merged;
+//   update() drops requests that were not renewed recently and dispatches the most important
+//   ones within the in-flight budgets;
+//   takeCompleted() hands out finished pages, whose slot stays reserved until released.
+// I/O threads read with io_uring where the kernel allows it and with pread otherwise, then
+// verify each page before it is handed out.
+class PageStreamer {
+public:
+    struct Config {
+        uint32_t ioThreadCount{2};
+        uint32_t maxInFlightPages{32};
+        uint64_t maxInFlightBytes{8ull << 20};
+        uint32_t stagingSlotCount{64};
+        // Pending requests not renewed for this many updates are dropped
+        uint32_t maxRequestAge{4};
+        bool preferIoUring{true};
+        bool validatePages{true};
+    };
+
+    struct CompletedPage {
+        uint32_t page{0};
+        uint32_t slot{0};
+        std::span<const uint8_t> data; // Used bytes of the page in its staging slot
+        bool valid{false};             // False when the read or the validation failed
+        float latencyMs{0.0f};         // From the first request to completion
+    };
+
+    struct Stats {
+        uint64_t requested{0};
+        uint64_t deduplicated{0}; // Requests merged into a pending or in-flight one
+        uint64_t dropped{0};      // Pending requests that went stale before dispatch
+        uint64_t dispatched{0};
+        uint64_t completed{0};
+        uint64_t failed{0};
+        uint64_t bytesRead{0};
+        uint32_t pending{0};
+        uint32_t inFlight{0};
+        // Over the most recent completions
+        float latencyP50Ms{0.0f};
+        float latencyP95Ms{0.0f};
+        float latencyP99Ms{0.0f};
+        float ioLatencyP50Ms{0.0f};
+        float ioLatencyP95Ms{0.0f};
+        float ioLatencyP99Ms{0.0f};
+    };
+
+    // The geometry must outlive the streamer
+    [[nodiscard]] static auto create(const PagedGeometry& geometry,
+                                     const std::filesystem::path& path, const Config& config)
+        -> Result<std::unique_ptr<PageStreamer>>;
+    ~PageStreamer();
+
+    PageStreamer(const PageStreamer&) = delete;
+    PageStreamer& operator=(const PageStreamer&) = delete;
+    PageStreamer(PageStreamer&&) = delete;
+    PageStreamer& operator=(PageStreamer&&) = delete;
+
+    // Higher priority is dispatched first; re-requesting raises a pending page's priority
+    void request(uint32_t page, float priority);
+    void update();
+    // Appends finished pages to output; every slot must be given back with releaseStaging
+    void takeCompleted(std::vector<CompletedPage>& output);
+    void releaseStaging(uint32_t slot);
+
+    // True when nothing is pending, in flight or waiting to be taken
+    [[nodiscard]] auto isIdle() const noexcept -> bool;
+    [[nodiscard]] auto getStats() const -> Stats;
+    [[nodiscard]] auto getBackendName() const noexcept -> std::string_view;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class PageState : uint8_t {
+        Idle,
+        Pending,
+        InFlight,
+    };
+
+    struct PageRecord {
+        PageState state{PageState::Idle};
+        float priority{0.0f};
+        uint64_t lastRequest{0}; // Update index of the most recent request
+        Clock::time_point requestTime;
+        Clock::time_point dispatchTime;
+    };
+
+    struct ReadRequest {
+        uint32_t page{0};
+        uint32_t slot{0};
+    };
+
+    struct ReadResult {
+        uint32_t page{0};
+        uint32_t slot{0};
+        bool valid{false};
+        Clock::time_point finishTime;
+    };
+
+    PageStreamer(const PagedGeometry& geometry, StreamFile file, const Config& config);
+
+    void ioThreadLoop(uint32_t threadIndex);
+    void ioRingLoop(IoRing& ring);
+    void preadLoop();
+    [[nodiscard]] auto popReads(std::vector<ReadRequest>& output, uint32_t maxCount,
+                                bool block) -> bool;
+    void finishRead(const ReadRequest& read, bool success);
+    [[nodiscard]] auto getSlotData(uint32_t slot) noexcept -> uint8_t*;
+
+    const PagedGeometry& m_geometry;
+    StreamFile m_file;
+    Config m_config;
+    bool m_useIoRing{false};
+
+    // Main thread state
+    std::vector<PageRecord> m_pages;
+    std::vector<uint32_t> m_pendingPages;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<float> m_latencySamples; // Rolling windows, oldest overwritten first
+    std::vector<float> m_ioLatencySamples;
+    uint64_t m_sampleCount{0};
+    uint64_t m_updateIndex{0};
+    uint64_t m_inFlightBytes{0};
+    uint32_t m_inFlightPages{0};
+    Stats m_stats;
+
+    std::unique_ptr<uint8_t[]> m_staging;
+
+    // Shared with the I/O threads
+    std::mutex m_readMutex;
+    std::condition_variable m_readCondition;
+    std::deque<ReadRequest> m_readQueue; // In dispatch order, most important first
+    std::mutex m_resultMutex;
+    std::vector<ReadResult> m_results;
+    bool m_running{true};
+    std::vector<std::thread> m_ioThreads;
+};
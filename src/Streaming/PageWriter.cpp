@@ -0,0 +1,515 @@
+#include "PageWriter.hpp"
+#include "Geometry/BoundingSphere.hpp"
+#include "Logger.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+struct FileGroup {
+    std::span<const uint32_t> clusters;
+    glm::vec4 lodBounds{0.0f};
+    float error{0.0f};
+    uint32_t level{0};
+    // DAG group whose simplification this group describes; kNoGroup for the roots
+    uint32_t dagGroup{ClusterLod::kNoGroup};
+};
+
+struct EncodedCluster {
+    PageCluster record; // Everything but dataOffset and group
+    std::vector<uint8_t> data;
+};
+
+// Appends values packed at the given width, least significant bit first, padded to 32 bits
+void appendSection(std::vector<uint8_t>& output, std::span<const uint32_t> values,
+                   uint32_t bits) {
+    const size_t start = output.size();
+    output.resize(start + packedSectionSize(static_cast<uint32_t>(values.size()), bits), 0);
+    uint8_t* section = output.data() + start;
+    for (size_t i = 0; i < values.size(); ++i) {
+        const uint64_t bit = i * bits;
+        for (uint32_t written = 0; written < bits;) {
+            const uint32_t shift = static_cast<uint32_t>((bit + written) % 8);
+            const uint32_t count = std::min(bits - written, 8 - shift);
+            const uint32_t chunk = (values[i] >> written) & ((1u << count) - 1);
+            section[(bit + written) / 8] |= static_cast<uint8_t>(chunk << shift);
+            written += count;
+        }
+    }
+}
+
+// Quantizes each component to the box spanned by the values, with no bits for flat axes
+template<int N>
+void quantizeToBox(std::span<const glm::vec<N, float>> values, uint32_t bits,
+                   glm::vec<N, float>& boxMin, glm::vec<N, float>& boxScale,
+                   uint8_t (&axisBits)[N], std::vector<uint32_t> (&quantized)[N]) {
+    glm::vec<N, float> boxMax{std::numeric_limits<float>::lowest()};
+    boxMin = glm::vec<N, float>{std::numeric_limits<float>::max()};
+    for (const auto& value : values) {
+        boxMin = glm::min(boxMin, value);
+        boxMax = glm::max(boxMax, value);
+    }
+    const glm::vec<N, float> extent = boxMax - boxMin;
+    for (int axis = 0; axis < N; ++axis) {
+        const uint32_t width = extent[axis] > 0.0f ? bits : 0;
+        axisBits[axis] = static_cast<uint8_t>(width);
+        boxScale[axis] =
+            width > 0 ? extent[axis] / static_cast<float>((1u << width) - 1) : 0.0f;
+        quantized[axis].clear();
+        for (const auto& value : values) {
+            quantized[axis].push_back(
+                width > 0 ? quantizeUnorm((value[axis] - boxMin[axis]) / extent[axis], width)
+                          : 0);
+        }
+    }
+}
+
+// Spacing of the position grid shared by every cluster. It is the power of two that gives the
+// largest cluster of the finest level about `bits` per axis, grown until the largest cluster of
+// any level fits kMaxPackedBits. Grid coordinates are then exact in float, and a cluster spans
+// at most extent / step + 1 steps once its vertices are rounded to the grid.
+auto choosePositionStep(const ClusterDag& dag, const MeshData& mesh, uint32_t bits) -> float {
+    float leafExtent = 0.0f;
+    float extent = 0.0f;
+    for (uint32_t id = 0; id < dag.mesh.clusters.size(); ++id) {
+        const Cluster& cluster = dag.mesh.clusters[id];
+        glm::vec3 lower{std::numeric_limits<float>::max()};
+        glm::vec3 upper{std::numeric_limits<float>::lowest()};
+        for (uint32_t i = 0; i < cluster.vertexCount; ++i) {
+            const glm::vec3& position = mesh.positions[dag.mesh.vertices[cluster.vertexOffset + i]];
+            lower = glm::min(lower, position);
+            upper = glm::max(upper, position);
+        }
+        const glm::vec3 size = upper - lower;
+        const float clusterExtent = std::max({size.x, size.y, size.z, 0.0f});
+        extent = std::max(extent, clusterExtent);
+        if (dag.lods[id].level == 0) {
+            leafExtent = std::max(leafExtent, clusterExtent);
+        }
+    }
+    const float step = std::max({leafExtent / static_cast<float>((1u << bits) - 1),
+                                 extent / static_cast<float>((1u << kMaxPackedBits) - 2),
+                                 std::numeric_limits<float>::min()});
+    return std::exp2(std::ceil(std::log2(step)));
+}
+
+auto encodeCluster(const ClusterDag& dag, const MeshData& mesh, uint32_t clusterId,
+                   float positionStep, const PageWriter::Config& config) -> EncodedCluster {
+    const Cluster& cluster = dag.mesh.clusters[clusterId];
+    const std::span<const uint32_t> vertices(dag.mesh.vertices.data() + cluster.vertexOffset,
+                                             cluster.vertexCount);
+    EncodedCluster encoded;
+    PageCluster& record = encoded.record;
+    record.boundingSphere = glm::vec4{cluster.bounds.center, cluster.bounds.radius};
+    record.lodBounds = dag.lods[clusterId].lodBounds;
+    record.coneApex = cluster.bounds.coneApex;
+    record.coneCutoff = cluster.bounds.coneCutoff;
+    record.coneAxis = cluster.bounds.coneAxis;
+    record.error = dag.lods[clusterId].error;
+    record.vertexCount = cluster.vertexCount;
+    record.triangleCount = cluster.triangleCount;
+    record.normalBits = static_cast<uint8_t>(config.normalBits);
+
+    // Vertices round to the shared grid independently of the cluster, and the cluster stores
+    // its offsets from the lowest grid point it touches
+    std::vector<uint32_t> quantized[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        std::vector<int64_t> grid;
+        for (uint32_t vertex : vertices) {
+            grid.push_back(std::llround(mesh.positions[vertex][axis] / positionStep));
+        }
+        const int64_t lowest = grid.empty() ? 0 : std::ranges::min(grid);
+        record.positionMin[axis] = static_cast<float>(lowest) * positionStep;
+        quantized[axis].clear();
+        for (int64_t value : grid) {
+            quantized[axis].push_back(static_cast<uint32_t>(value - lowest));
+        }
+        record.positionBits[axis] = static_cast<uint8_t>(
+            std::bit_width(quantized[axis].empty() ? 0u : std::ranges::max(quantized[axis])));
+        appendSection(encoded.data, quantized[axis], record.positionBits[axis]);
+    }
+
+    auto appendOctahedral = [&](auto direction) {
+        for (auto& values : quantized) {
+            values.clear();
+        }
+        for (uint32_t vertex : vertices) {
+            const glm::uvec2 octahedral = encodeOctahedral(direction(vertex), config.normalBits);
+            quantized[0].push_back(octahedral.x);
+            quantized[1].push_back(octahedral.y);
+        }
+        appendSection(encoded.data, quantized[0], config.normalBits);
+        appendSection(encoded.data, quantized[1], config.normalBits);
+    };
+    appendOctahedral([&](uint32_t vertex) { return mesh.normals[vertex]; });
+
+    if (!mesh.tangents.empty()) {
+        record.attributes |= kPageAttributeTangents;
+        appendOctahedral([&](uint32_t vertex) { return glm::vec3{mesh.tangents[vertex]}; });
+        quantized[2].clear();
+        for (uint32_t vertex : vertices) {
+            quantized[2].push_back(mesh.tangents[vertex].w < 0.0f ? 1 : 0);
+        }
+        appendSection(encoded.data, quantized[2], 1);
+    }
+
+    if (!mesh.uvs.empty()) {
+        record.attributes |= kPageAttributeUvs;
+        std::vector<glm::vec2> uvs;
+        for (uint32_t vertex : vertices) {
+            uvs.push_back(mesh.uvs[vertex]);
+        }
+        // Flat axes get no bits in the box, but the layout fixes uvs at kUvBits
+        uint8_t uvBits[2];
+        std::vector<uint32_t> quantizedUvs[2];
+        quantizeToBox<2>(uvs, kUvBits, record.uvMin, record.uvScale, uvBits, quantizedUvs);
+        appendSection(encoded.data, quantizedUvs[0], kUvBits);
+        appendSection(encoded.data, quantizedUvs[1], kUvBits);
+    }
+
+    // Triangles keep the builder's order. Each one continues the strip when it holds an edge
+    // of the previous triangle as decoded, reversed, and restarts it otherwise.
+    constexpr uint32_t kSharedCorners[4][2] = {{0, 0}, {2, 1}, {0, 2}, {1, 0}};
+    std::vector<uint32_t> codes;
+    std::vector<uint32_t> indices;
+    std::array<uint32_t, 3> previous{};
+    for (uint32_t t = 0; t < cluster.triangleCount; ++t) {
+        const uint8_t* local =
+            dag.mesh.triangles.data() + (static_cast<size_t>(cluster.triangleOffset) + t) * 3;
+        uint32_t code = kStripRestart;
+        uint32_t added = 0;
+        for (uint32_t edge = kStripEdgeBc; t > 0 && edge <= kStripEdgeAb; ++edge) {
+            const uint32_t first = previous[kSharedCorners[edge][0]];
+            const uint32_t second = previous[kSharedCorners[edge][1]];
+            for (uint32_t corner = 0; corner < 3; ++corner) {
+                if (local[corner] == first && local[(corner + 1) % 3] == second) {
+                    code = edge;
+                    added = local[(corner + 2) % 3];
+                    break;
+                }
+            }
+            if (code != kStripRestart) {
+                break;
+            }
+        }
+
+        codes.push_back(code);
+        if (code == kStripRestart) {
+            previous = {local[0], local[1], local[2]};
+            indices.insert(indices.end(), previous.begin(), previous.end());
+        } else {
+            previous = {previous[kSharedCorners[code][0]], previous[kSharedCorners[code][1]],
+                        added};
+            indices.push_back(added);
+        }
+    }
+    record.indexBits = static_cast<uint8_t>(
+        std::bit_width(indices.empty() ? 0u : std::ranges::max(indices)));
+    record.stripIndexCount = static_cast<uint16_t>(indices.size());
+    appendSection(encoded.data, codes, kStripCodeBits);
+    appendSection(encoded.data, indices, record.indexBits);
+
+    return encoded;
+}
+
+template<typename T>
+void appendBytes(std::vector<uint8_t>& output, std::span<const T> values) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(values.data());
+    output.insert(output.end(), bytes, bytes + values.size_bytes());
+}
+
+} // namespace
+
+auto PageWriter::serialize(const ClusterDag& dag, const MeshData& mesh, const Config& config,
+                           std::vector<uint32_t>* clusterOrder) -> Result<std::vector<uint8_t>> {
+    ZoneScoped;
+    if (config.pageSize < kMinPageSize || config.pageSize % kPageAlignment != 0) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            std::format("Page size must be a multiple of {} and at least {}", kPageAlignment,
+                        kMinPageSize)
+        ));
+    }
+    if (config.positionBits < 1 || config.positionBits > kMaxPackedBits ||
+        config.normalBits < 2 || config.normalBits > kMaxPackedBits) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            std::format("Position bits must be 1 to {} and normal bits 2 to {}", kMaxPackedBits,
+                        kMaxPackedBits)
+        ));
+    }
+    if (mesh.normals.size() != mesh.positions.size()) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            "Paged geometry needs a normal per vertex"
+        ));
+    }
+    if ((!mesh.uvs.empty() && mesh.uvs.size() != mesh.positions.size()) ||
+        (!mesh.tangents.empty() && mesh.tangents.size() != mesh.positions.size())) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidMeshData,
+            "Vertex attribute arrays do not match the position count"
+        ));
+    }
+
+    // Cluster sizes depend on their contents, so they are encoded before packing
+    const float positionStep = choosePositionStep(dag, mesh, config.positionBits);
+    std::vector<EncodedCluster> encoded;
+    encoded.reserve(dag.mesh.clusters.size());
+    {
+        ZoneScopedN("Encode Clusters");
+        for (uint32_t cluster = 0; cluster < dag.mesh.clusters.size(); ++cluster) {
+            encoded.push_back(encodeCluster(dag, mesh, cluster, positionStep, config));
+        }
+    }
+
+    // DAG groups plus a final group holding the roots, coarsest level first
+    std::vector<FileGroup> groups;
+    groups.reserve(dag.groups.size() + 1);
+    for (uint32_t i = 0; i < dag.groups.size(); ++i) {
+        const ClusterGroup& group = dag.groups[i];
+        groups.push_back(FileGroup{
+            std::span(dag.groupClusters).subspan(group.clusterOffset, group.clusterCount),
+            group.lodBounds, group.error, group.level, i});
+    }
+    // Roots were never simplified together, so they can be split freely to fit pages
+    for (size_t offset = 0; offset < dag.roots.size(); offset += kMaxRootGroupClusters) {
+        const std::span<const uint32_t> roots = std::span(dag.roots).subspan(
+            offset, std::min<size_t>(kMaxRootGroupClusters, dag.roots.size() - offset));
+        std::vector<glm::vec4> rootSpheres;
+        for (uint32_t root : roots) {
+            rootSpheres.push_back(dag.lods[root].lodBounds);
+        }
+        groups.push_back(FileGroup{roots, mergeSpheres(rootSpheres),
+                                   std::numeric_limits<float>::infinity(), dag.levelCount - 1,
+                                   ClusterLod::kNoGroup});
+    }
+    std::ranges::stable_sort(groups, [](const FileGroup& lhs, const FileGroup& rhs) {
+        return lhs.level > rhs.level;
+    });
+
+    // Pack whole groups into pages, leaving the decoders' read-ahead free at the end
+    const uint32_t pageCapacity = config.pageSize - kPageTailPadding;
+    std::vector<uint32_t> groupPages(groups.size());
+    std::vector<uint32_t> pageGroupOffsets{0};
+    uint32_t pageBytes = sizeof(PageHeader);
+    for (uint32_t i = 0; i < groups.size(); ++i) {
+        uint32_t groupBytes = 0;
+        for (uint32_t cluster : groups[i].clusters) {
+            groupBytes += static_cast<uint32_t>(sizeof(PageCluster) + encoded[cluster].data.size());
+        }
+        if (sizeof(PageHeader) + groupBytes > pageCapacity) {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidArgument,
+                std::format("A cluster group needs {} bytes, more than a page holds", groupBytes)
+            ));
+        }
+        if (pageBytes + groupBytes > pageCapacity) {
+            pageGroupOffsets.push_back(i);
+            pageBytes = sizeof(PageHeader);
+        }
+        pageBytes += groupBytes;
+        groupPages[i] = static_cast<uint32_t>(pageGroupOffsets.size() - 1);
+    }
+    pageGroupOffsets.push_back(static_cast<uint32_t>(groups.size()));
+    const auto pageCount = static_cast<uint32_t>(pageGroupOffsets.size() - 1);
+
+    std::vector<uint32_t> clusterPages(dag.mesh.clusters.size(), 0);
+    std::vector<uint32_t> clusterFileGroups(dag.mesh.clusters.size(), 0);
+    for (uint32_t i = 0; i < groups.size(); ++i) {
+        for (uint32_t cluster : groups[i].clusters) {
+            clusterPages[cluster] = groupPages[i];
+            clusterFileGroups[cluster] = i;
+        }
+    }
+
+    std::vector<PageTableEntry> pageTable(pageCount);
+    std::vector<PageGroup> pageGroups(groups.size());
+    std::vector<uint32_t> dependencies;
+    for (uint32_t page = 0; page < pageCount; ++page) {
+        PageTableEntry& entry = pageTable[page];
+        entry.groupOffset = pageGroupOffsets[page];
+        entry.groupCount = pageGroupOffsets[page + 1] - pageGroupOffsets[page];
+        entry.level = std::numeric_limits<uint32_t>::max();
+        entry.dependencyOffset = static_cast<uint32_t>(dependencies.size());
+
+        for (uint32_t i = entry.groupOffset; i < entry.groupOffset + entry.groupCount; ++i) {
+            const FileGroup& group = groups[i];
+            PageGroup& pageGroup = pageGroups[i];
+            pageGroup.lodBounds = group.lodBounds;
+            pageGroup.error = group.error;
+            pageGroup.level = group.level;
+            pageGroup.page = page;
+            pageGroup.firstCluster = entry.clusterCount;
+            pageGroup.clusterCount = static_cast<uint32_t>(group.clusters.size());
+            for (uint32_t cluster : group.clusters) {
+                pageGroup.maxClusterError =
+                    std::max(pageGroup.maxClusterError, dag.lods[cluster].error);
+            }
+            entry.clusterCount += pageGroup.clusterCount;
+            entry.level = std::min(entry.level, group.level);
+
+            if (group.dagGroup != ClusterLod::kNoGroup) {
+                const ClusterGroup& dagGroup = dag.groups[group.dagGroup];
+                for (uint32_t parent = dagGroup.parentClusterOffset;
+                     parent < dagGroup.parentClusterOffset + dagGroup.parentClusterCount;
+                     ++parent) {
+                    if (clusterPages[parent] != page) {
+                        dependencies.push_back(clusterPages[parent]);
+                    }
+                }
+            }
+        }
+
+        const auto begin = dependencies.begin() + entry.dependencyOffset;
+        std::sort(begin, dependencies.end());
+        dependencies.erase(std::unique(begin, dependencies.end()), dependencies.end());
+        entry.dependencyCount =
+            static_cast<uint32_t>(dependencies.size()) - entry.dependencyOffset;
+    }
+
+    // Clusters are numbered in file order, which is group order since pages hold consecutive
+    // groups. The parents a DAG group was simplified into stand in for its file group.
+    std::vector<uint32_t> clusterFileIndices(dag.mesh.clusters.size(), 0);
+    std::vector<uint32_t> dagGroupFileGroups(dag.groups.size(), 0);
+    uint32_t fileIndex = 0;
+    for (uint32_t i = 0; i < groups.size(); ++i) {
+        for (uint32_t cluster : groups[i].clusters) {
+            clusterFileIndices[cluster] = fileIndex++;
+        }
+        if (groups[i].dagGroup != ClusterLod::kNoGroup) {
+            dagGroupFileGroups[groups[i].dagGroup] = i;
+        }
+    }
+    std::vector<uint32_t> clusterChildGroups(fileIndex, kNoChildGroup);
+    for (uint32_t i = 0; i < dag.groups.size(); ++i) {
+        const ClusterGroup& dagGroup = dag.groups[i];
+        for (uint32_t parent = dagGroup.parentClusterOffset;
+             parent < dagGroup.parentClusterOffset + dagGroup.parentClusterCount; ++parent) {
+            clusterChildGroups[clusterFileIndices[parent]] = dagGroupFileGroups[i];
+        }
+    }
+    // Parents took their LOD data from the group they were simplified from; only the finest
+    // clusters have their own
+    std::vector<PageLeafLod> leafLods;
+    for (const FileGroup& group : groups) {
+        for (uint32_t cluster : group.clusters) {
+            if (clusterChildGroups[clusterFileIndices[cluster]] == kNoChildGroup) {
+                const ClusterLod& lod = dag.lods[cluster];
+                leafLods.push_back(PageLeafLod{lod.lodBounds, lod.error});
+            }
+        }
+    }
+
+    PageFileHeader header;
+    header.pageSize = config.pageSize;
+    header.pageCount = pageCount;
+    header.groupCount = static_cast<uint32_t>(pageGroups.size());
+    header.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    header.clusterCount = static_cast<uint32_t>(dag.mesh.clusters.size());
+    header.levelCount = dag.levelCount;
+    header.leafClusterCount = static_cast<uint32_t>(leafLods.size());
+    header.positionStep = positionStep;
+    header.triangleCount = dag.mesh.triangleCount();
+    std::vector<glm::vec4> rootSpheres;
+    for (uint32_t root : dag.roots) {
+        rootSpheres.push_back(dag.lods[root].lodBounds);
+    }
+    header.bounds = mergeSpheres(rootSpheres);
+    header.hierarchyOffset = sizeof(PageFileHeader);
+    header.hierarchySize = pageTable.size() * sizeof(PageTableEntry) +
+                           pageGroups.size() * sizeof(PageGroup) +
+                           dependencies.size() * sizeof(uint32_t) +
+                           clusterChildGroups.size() * sizeof(uint32_t) +
+                           leafLods.size() * sizeof(PageLeafLod);
+    header.pagesOffset = alignUp(header.hierarchyOffset + header.hierarchySize, kPageAlignment);
+
+    std::vector<uint8_t> output(header.pagesOffset + static_cast<uint64_t>(pageCount) *
+                                                         config.pageSize, 0);
+
+    // Pages are written first so the table can record their used size and checksum
+    if (clusterOrder) {
+        clusterOrder->clear();
+    }
+    uint64_t usedBytes = 0;
+    for (uint32_t page = 0; page < pageCount; ++page) {
+        ZoneScopedN("Write Page");
+        PageTableEntry& entry = pageTable[page];
+        uint8_t* pageData = output.data() + header.pagesOffset +
+                            static_cast<uint64_t>(page) * config.pageSize;
+
+        PageHeader pageHeader;
+        pageHeader.clusterCount = entry.clusterCount;
+        pageHeader.groupOffset = entry.groupOffset;
+
+        auto* pageClusters = reinterpret_cast<PageCluster*>(pageData + sizeof(PageHeader));
+        uint32_t offset = sizeof(PageHeader) + entry.clusterCount * sizeof(PageCluster);
+        uint32_t clusterIndex = 0;
+        for (uint32_t i = entry.groupOffset; i < entry.groupOffset + entry.groupCount; ++i) {
+            for (uint32_t clusterId : groups[i].clusters) {
+                const EncodedCluster& cluster = encoded[clusterId];
+                PageCluster record = cluster.record;
+                record.dataOffset = offset;
+                record.group = clusterFileGroups[clusterId];
+                std::memcpy(pageData + offset, cluster.data.data(), cluster.data.size());
+                offset += static_cast<uint32_t>(cluster.data.size());
+                if (clusterOrder) {
+                    clusterOrder->push_back(clusterId);
+                }
+                std::memcpy(&pageClusters[clusterIndex++], &record, sizeof(record));
+            }
+        }
+
+        pageHeader.usedBytes = offset;
+        std::memcpy(pageData, &pageHeader, sizeof(pageHeader));
+        entry.usedBytes = offset;
+        usedBytes += offset;
+        entry.checksum = pageChecksum(std::span<const uint8_t>(pageData, offset));
+    }
+
+    std::vector<uint8_t> hierarchy;
+    hierarchy.reserve(header.hierarchyOffset + header.hierarchySize);
+    appendBytes(hierarchy, std::span<const PageFileHeader>(&header, 1));
+    appendBytes(hierarchy, std::span<const PageTableEntry>(pageTable));
+    appendBytes(hierarchy, std::span<const PageGroup>(pageGroups));
+    appendBytes(hierarchy, std::span<const uint32_t>(dependencies));
+    appendBytes(hierarchy, std::span<const uint32_t>(clusterChildGroups));
+    appendBytes(hierarchy, std::span<const PageLeafLod>(leafLods));
+    std::ranges::copy(hierarchy, output.begin());
+
+    Logger::debug("Serialized {} clusters into {} pages ({} KiB hierarchy, {:.1f}% page fill)",
+                  header.clusterCount, pageCount, header.hierarchySize / 1024,
+                  pageCount ? 100.0 * static_cast<double>(usedBytes) / pageCount / config.pageSize
+                            : 0.0);
+    return output;
+}
+
+auto PageWriter::write(const std::filesystem::path& path, std::span<const uint8_t> data)
+    -> VoidResult {
+    ZoneScoped;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {} for writing", path.string())
+        ));
+    }
+
+    file.write(reinterpret_cast<const char*>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to write {}", path.string())
+        ));
+    }
+
+    return {};
+}
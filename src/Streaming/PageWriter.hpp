@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Error.hpp"
+#include "Geometry/ClusterDag.hpp"
+#include "Geometry/MeshData.hpp"
+#include "PageFormat.hpp"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Serializes a cluster DAG into the paged file format described in PageFormat.hpp
+class PageWriter {
+public:
+    struct Config {
+        uint32_t pageSize{kDefaultPageSize};
+        // Per axis of the largest cluster of the finest level, 1 to kMaxPackedBits. This sets
+        // the spacing of the position grid all clusters share; coarser clusters take as many
+        // bits as the grid needs to span them.
+        uint32_t positionBits{kDefaultPositionBits};
+        // Per octahedral component of normals and tangents, 2 to kMaxPackedBits
+        uint32_t normalBits{kDefaultNormalBits};
+    };
+
+    // mesh is the one the DAG was built from and must have normals. Its uvs and tangents are
+    // stored when present. clusterOrder, when given, receives the DAG cluster ids in the order
+    // they were written, page after page.
+    [[nodiscard]] static auto serialize(const ClusterDag& dag, const MeshData& mesh,
+                                        const Config& config,
+                                        std::vector<uint32_t>* clusterOrder = nullptr)
+        -> Result<std::vector<uint8_t>>;
+
+    [[nodiscard]] static auto write(const std::filesystem::path& path,
+                                    std::span<const uint8_t> data) -> VoidResult;
+};
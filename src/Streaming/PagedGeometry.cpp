@@ -0,0 +1,209 @@
+#include "PagedGeometry.hpp"
+#include "Logger.hpp"
+#include "PageDecoder.hpp"
+#include <tracy/Tracy.hpp>
+#include <cmath>
+#include <format>
+
+auto PagedGeometry::open(const std::filesystem::path& path) -> Result<PagedGeometry> {
+    ZoneScoped;
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    PagedGeometry geometry(std::move(*file));
+    if (auto result = geometry.initialize(path); !result) {
+        return std::unexpected(result.error());
+    }
+
+    Logger::debug("Mapped {}: {} pages, {} groups, {} KiB hierarchy", path.string(),
+                  geometry.getPageCount(), geometry.m_groups.size(),
+                  geometry.m_header->hierarchySize / 1024);
+    return geometry;
+}
+
+auto PagedGeometry::initialize(const std::filesystem::path& path) -> VoidResult {
+    ZoneScoped;
+    const std::span<const uint8_t> data = m_file.getData();
+    auto invalid = [&path](std::string_view reason) {
+        return std::unexpected(makeError(
+            ErrorCode::FileParseFailed,
+            std::format("{}: {}", path.string(), reason)
+        ));
+    };
+
+    if (data.size() < sizeof(PageFileHeader)) {
+        return invalid("file too small for a header");
+    }
+
+    m_header = reinterpret_cast<const PageFileHeader*>(data.data());
+    const PageFileHeader& header = *m_header;
+    if (header.magic != kPageFileMagic) {
+        return invalid("not a cooked geometry file");
+    }
+    if (header.version != kPageFileVersion) {
+        return invalid(std::format("version {} is not supported (expected {})", header.version,
+                                   kPageFileVersion));
+    }
+    if (header.pageSize < kMinPageSize || header.pageSize % kPageAlignment != 0 ||
+        header.pagesOffset % kPageAlignment != 0) {
+        return invalid("bad page size or alignment");
+    }
+    if (!(header.positionStep > 0.0f) || !std::isfinite(header.positionStep)) {
+        return invalid("bad position step");
+    }
+
+    const uint64_t hierarchySize = header.pageCount * sizeof(PageTableEntry) +
+                                   header.groupCount * sizeof(PageGroup) +
+                                   header.dependencyCount * sizeof(uint32_t) +
+                                   header.clusterCount * sizeof(uint32_t) +
+                                   header.leafClusterCount * sizeof(PageLeafLod);
+    if (header.hierarchyOffset < sizeof(PageFileHeader) ||
+        header.hierarchySize != hierarchySize ||
+        header.hierarchyOffset + hierarchySize > header.pagesOffset ||
+        header.pagesOffset + static_cast<uint64_t>(header.pageCount) * header.pageSize >
+            data.size()) {
+        return invalid("section sizes do not match the file");
+    }
+
+    // Everything in the hierarchy is needed right away; map it before touching it so the
+    // validation below does not fault page by page
+    m_file.adviseRandom();
+    m_file.populate(header.hierarchyOffset, header.hierarchySize);
+
+    const uint8_t* hierarchy = data.data() + header.hierarchyOffset;
+    m_pageTable = {reinterpret_cast<const PageTableEntry*>(hierarchy), header.pageCount};
+    m_groups = {reinterpret_cast<const PageGroup*>(m_pageTable.data() + header.pageCount),
+                header.groupCount};
+    m_dependencies = {reinterpret_cast<const uint32_t*>(m_groups.data() + header.groupCount),
+                      header.dependencyCount};
+    m_clusterChildGroups = {m_dependencies.data() + header.dependencyCount, header.clusterCount};
+    m_leafClusterLods = {
+        reinterpret_cast<const PageLeafLod*>(m_clusterChildGroups.data() + header.clusterCount),
+        header.leafClusterCount};
+
+    uint64_t groupCount = 0;
+    uint64_t clusterCount = 0;
+    for (uint32_t page = 0; page < header.pageCount; ++page) {
+        const PageTableEntry& entry = m_pageTable[page];
+        if (entry.groupOffset != groupCount ||
+            static_cast<uint64_t>(entry.groupOffset) + entry.groupCount > header.groupCount ||
+            static_cast<uint64_t>(entry.dependencyOffset) + entry.dependencyCount >
+                header.dependencyCount ||
+            entry.usedBytes > header.pageSize - kPageTailPadding ||
+            sizeof(PageHeader) + static_cast<uint64_t>(entry.clusterCount) * sizeof(PageCluster) >
+                entry.usedBytes) {
+            return invalid(std::format("page {} has an invalid table entry", page));
+        }
+        groupCount += entry.groupCount;
+        clusterCount += entry.clusterCount;
+
+        // Streaming walks dependencies recursively and relies on them forming a DAG
+        for (uint32_t dependency : getPageDependencies(page)) {
+            if (dependency >= page) {
+                return invalid(std::format("page {} depends on a later page", page));
+            }
+        }
+    }
+    if (groupCount != header.groupCount) {
+        return invalid("page table does not cover every group");
+    }
+    if (clusterCount != header.clusterCount) {
+        return invalid("page table does not cover every cluster");
+    }
+    uint64_t leafClusterCount = 0;
+    for (uint32_t childGroup : m_clusterChildGroups) {
+        if (childGroup == kNoChildGroup) {
+            ++leafClusterCount;
+        } else if (childGroup >= header.groupCount) {
+            return invalid("a cluster refers to a group that does not exist");
+        }
+    }
+    if (leafClusterCount != header.leafClusterCount) {
+        return invalid("leaf LOD records do not match the clusters without a child group");
+    }
+
+    return {};
+}
+
+auto PagedGeometry::getPageDependencies(uint32_t page) const -> std::span<const uint32_t> {
+    const PageTableEntry& entry = m_pageTable[page];
+    return m_dependencies.subspan(entry.dependencyOffset, entry.dependencyCount);
+}
+
+auto PagedGeometry::getPage(uint32_t page) const -> PageView {
+    return getPage(page, m_file.getData().subspan(getPageOffset(page), m_header->pageSize));
+}
+
+auto PagedGeometry::getPage(uint32_t page, std::span<const uint8_t> pageData) const
+    -> PageView {
+    const PageTableEntry& entry = m_pageTable[page];
+
+    PageView view;
+    view.header = reinterpret_cast<const PageHeader*>(pageData.data());
+    view.clusters = {reinterpret_cast<const PageCluster*>(pageData.data() + sizeof(PageHeader)),
+                     entry.clusterCount};
+    view.data = pageData.first(entry.usedBytes);
+    view.positionStep = m_header->positionStep;
+    return view;
+}
+
+auto PagedGeometry::validatePage(uint32_t page) const -> VoidResult {
+    return validatePage(page,
+                        m_file.getData().subspan(getPageOffset(page), m_header->pageSize));
+}
+
+auto PagedGeometry::validatePage(uint32_t page, std::span<const uint8_t> pageData) const
+    -> VoidResult {
+    ZoneScoped;
+    const PageTableEntry& entry = m_pageTable[page];
+    auto invalid = [page](std::string_view reason) {
+        return std::unexpected(makeError(
+            ErrorCode::FileParseFailed,
+            std::format("Page {}: {}", page, reason)
+        ));
+    };
+
+    // Decoders read ahead into the padding after the used bytes
+    if (pageData.size() < static_cast<uint64_t>(entry.usedBytes) + kPageTailPadding) {
+        return invalid("data is shorter than the page");
+    }
+    const PageView view = getPage(page, pageData);
+    if (view.header->magic != kPageMagic || view.header->clusterCount != entry.clusterCount ||
+        view.header->groupOffset != entry.groupOffset ||
+        view.header->usedBytes != entry.usedBytes) {
+        return invalid("header does not match the page table");
+    }
+    if (pageChecksum(view.data) != entry.checksum) {
+        return invalid("checksum mismatch");
+    }
+
+    for (const PageCluster& cluster : view.clusters) {
+        const PageClusterLayout layout = getClusterLayout(cluster);
+        if (cluster.vertexCount > kMaxPageClusterVertices ||
+            cluster.triangleCount > kMaxPageClusterTriangles ||
+            static_cast<uint64_t>(cluster.dataOffset) + layout.size > entry.usedBytes ||
+            cluster.group >= m_header->groupCount) {
+            return invalid("cluster sections out of bounds");
+        }
+        if (cluster.positionBits[0] > kMaxPackedBits || cluster.positionBits[1] > kMaxPackedBits ||
+            cluster.positionBits[2] > kMaxPackedBits || cluster.normalBits < 2 ||
+            cluster.normalBits > kMaxPackedBits || cluster.indexBits > 8) {
+            return invalid("cluster bit widths out of range");
+        }
+        if (!PageDecoder::hasValidTriangles(view, cluster)) {
+            return invalid("triangle index out of range");
+        }
+    }
+
+    return {};
+}
+
+void PagedGeometry::prefetchPage(uint32_t page) const noexcept {
+    m_file.prefetch(getPageOffset(page), m_pageTable[page].usedBytes);
+}
+
+void PagedGeometry::releasePage(uint32_t page) const noexcept {
+    m_file.release(getPageOffset(page), m_header->pageSize);
+}
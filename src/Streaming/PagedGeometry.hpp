@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Error.hpp"
+#include "MappedFile.hpp"
+#include "PageFormat.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// Cluster payload of one page, viewed in place in the mapping
+struct PageView {
+    const PageHeader* header{nullptr};
+    std::span<const PageCluster> clusters;
+    // Used bytes of the page, cluster data offsets are into this. The page's remaining bytes
+    // follow it in memory.
+    std::span<const uint8_t> data;
+    float positionStep{0.0f}; // PageFileHeader::positionStep
+};
+
+// A cooked .vgeo file opened through a memory mapping. Opening validates the header and page
+// table in O(pages) and populates the hierarchy section only; pages are faulted in on first
+// access unless prefetched. All spans point into the mapping and stay valid for the lifetime
+// of the object, including across moves.
+class PagedGeometry {
+public:
+    [[nodiscard]] static auto open(const std::filesystem::path& path) -> Result<PagedGeometry>;
+
+    [[nodiscard]] auto getHeader() const noexcept -> const PageFileHeader& { return *m_header; }
+    [[nodiscard]] auto getPageCount() const noexcept -> uint32_t { return m_header->pageCount; }
+    [[nodiscard]] auto getPageTable() const noexcept -> std::span<const PageTableEntry> {
+        return m_pageTable;
+    }
+    [[nodiscard]] auto getGroups() const noexcept -> std::span<const PageGroup> {
+        return m_groups;
+    }
+    [[nodiscard]] auto getPageDependencies(uint32_t page) const -> std::span<const uint32_t>;
+    // Per cluster in file order, the group it was simplified from, or kNoChildGroup
+    [[nodiscard]] auto getClusterChildGroups() const noexcept -> std::span<const uint32_t> {
+        return m_clusterChildGroups;
+    }
+    // LOD data of the clusters without a child group, in file order
+    [[nodiscard]] auto getLeafClusterLods() const noexcept -> std::span<const PageLeafLod> {
+        return m_leafClusterLods;
+    }
+
+    // Byte range of a page within the file
+    [[nodiscard]] auto getPageOffset(uint32_t page) const noexcept -> uint64_t {
+        return m_header->pagesOffset + static_cast<uint64_t>(page) * m_header->pageSize;
+    }
+
+    // Touches only the page header; validate the page first when its contents are untrusted
+    [[nodiscard]] auto getPage(uint32_t page) const -> PageView;
+    // Views a copy of the page held elsewhere, e.g. in a streaming staging buffer
+    [[nodiscard]] auto getPage(uint32_t page, std::span<const uint8_t> pageData) const
+        -> PageView;
+    // Checks the checksum and every cluster's sections and indices against the page bounds,
+    // O(page size)
+    [[nodiscard]] auto validatePage(uint32_t page) const -> VoidResult;
+    [[nodiscard]] auto validatePage(uint32_t page, std::span<const uint8_t> pageData) const
+        -> VoidResult;
+
+    void prefetchPage(uint32_t page) const noexcept;
+    void releasePage(uint32_t page) const noexcept;
+
+private:
+    explicit PagedGeometry(MappedFile file) : m_file(std::move(file)) {}
+    [[nodiscard]] auto initialize(const std::filesystem::path& path) -> VoidResult;
+
+    MappedFile m_file;
+    const PageFileHeader* m_header{nullptr};
+    std::span<const PageTableEntry> m_pageTable;
+    std::span<const PageGroup> m_groups;
+    std::span<const uint32_t> m_dependencies;
+    std::span<const uint32_t> m_clusterChildGroups;
+    std::span<const PageLeafLod> m_leafClusterLods;
+};
@@ -0,0 +1,154 @@
+#include "StreamFile.hpp"
+#include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+auto StreamFile::open(const std::filesystem::path& path) -> Result<StreamFile> {
+    ZoneScoped;
+    StreamFile file;
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {}", path.string())
+        ));
+    }
+    file.m_fileHandle = fileHandle;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size)) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Size of {} is unavailable", path.string())
+        ));
+    }
+    file.m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+    file.m_descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file.m_descriptor < 0) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Failed to open {}", path.string())
+        ));
+    }
+
+    struct stat status{};
+    if (fstat(file.m_descriptor, &status) != 0) {
+        return std::unexpected(makeError(
+            ErrorCode::FileOpenFailed,
+            std::format("Size of {} is unavailable", path.string())
+        ));
+    }
+    file.m_size = static_cast<uint64_t>(status.st_size);
+    // Pages are requested in LOD order, not file order; read-ahead would only waste bandwidth
+    posix_fadvise(file.m_descriptor, 0, 0, POSIX_FADV_RANDOM);
+#endif
+
+    return file;
+}
+
+StreamFile::~StreamFile() {
+    close();
+}
+
+StreamFile::StreamFile(StreamFile&& other) noexcept
+#ifdef _WIN32
+    : m_fileHandle(std::exchange(other.m_fileHandle, nullptr))
+#else
+    : m_descriptor(std::exchange(other.m_descriptor, -1))
+#endif
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+StreamFile& StreamFile::operator=(StreamFile&& other) noexcept {
+    if (this != &other) {
+        close();
+#ifdef _WIN32
+        m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+#else
+        m_descriptor = std::exchange(other.m_descriptor, -1);
+#endif
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+void StreamFile::close() noexcept {
+#ifdef _WIN32
+    if (m_fileHandle != nullptr) {
+        CloseHandle(m_fileHandle);
+    }
+    m_fileHandle = nullptr;
+#else
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+    }
+    m_descriptor = -1;
+#endif
+    m_size = 0;
+}
+
+auto StreamFile::getDescriptor() const noexcept -> int {
+#ifdef _WIN32
+    return -1;
+#else
+    return m_descriptor;
+#endif
+}
+
+auto StreamFile::readAt(void* buffer, uint64_t size, uint64_t offset) const -> VoidResult {
+    auto* destination = static_cast<uint8_t*>(buffer);
+    while (size > 0) {
+#ifdef _WIN32
+        // Overlapped offsets on a synchronous handle make ReadFile positional and thread safe
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD bytesRead = 0;
+        const auto chunk = static_cast<DWORD>(std::min<uint64_t>(size, 1u << 30));
+        if (!ReadFile(m_fileHandle, destination, chunk, &bytesRead, &overlapped) ||
+            bytesRead == 0) {
+            return std::unexpected(makeError(
+                ErrorCode::FileParseFailed,
+                std::format("Read of {} bytes at {} failed", size, offset)
+            ));
+        }
+        const uint64_t count = bytesRead;
+#else
+        const ssize_t bytesRead =
+            pread(m_descriptor, destination, size, static_cast<off_t>(offset));
+        if (bytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead <= 0) {
+            return std::unexpected(makeError(
+                ErrorCode::FileParseFailed,
+                std::format("Read of {} bytes at {} failed: {}", size, offset,
+                            bytesRead == 0 ? "end of file" : std::strerror(errno))
+            ));
+        }
+        const auto count = static_cast<uint64_t>(bytesRead);
+#endif
+        destination += count;
+        offset += count;
+        size -= count;
+    }
+    return {};
+}
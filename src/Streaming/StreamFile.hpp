@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Error.hpp"
+#include <cstdint>
+#include <filesystem>
+
+// Read-only file handle for positional reads from any number of threads at once. Streaming
+// reads go through this rather than the mapping so that a slow disk blocks an I/O thread, not
+// whichever thread first touches the page.
+class StreamFile {
+public:
+    [[nodiscard]] static auto open(const std::filesystem::path& path) -> Result<StreamFile>;
+    ~StreamFile();
+
+    StreamFile(const StreamFile&) = delete;
+    StreamFile& operator=(const StreamFile&) = delete;
+    StreamFile(StreamFile&& other) noexcept;
+    StreamFile& operator=(StreamFile&& other) noexcept;
+
+    // Reads exactly size bytes at offset, retrying short reads
+    [[nodiscard]] auto readAt(void* buffer, uint64_t size, uint64_t offset) const -> VoidResult;
+
+    // POSIX file descriptor for io_uring submissions, -1 on Windows
+    [[nodiscard]] auto getDescriptor() const noexcept -> int;
+    [[nodiscard]] auto getSize() const noexcept -> uint64_t { return m_size; }
+
+private:
+    StreamFile() = default;
+    void close() noexcept;
+
+#ifdef _WIN32
+    void* m_fileHandle{nullptr};
+#else
+    int m_descriptor{-1};
+#endif
+    uint64_t m_size{0};
+};
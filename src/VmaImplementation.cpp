@@ -0,0 +1,3 @@
+// The allocator's implementation, compiled once for the whole program
+#define VMA_IMPLEMENTATION
+#include <vk_mem_alloc.h>
@@ -1,27 +1,80 @@
 #include "VulkanContext.hpp"
 #include "Window.hpp"
 #include "Logger.hpp"
+#include "Core/JobSystem.hpp"
 #include <tracy/Tracy.hpp>
-#include <set>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
 #include <format>
+#include <utility>
 
-auto VulkanContext::create(const Window& window, const std::string& appName, bool enableValidation)
+namespace {
+
+const std::array<const char*, 1> kSwapchainExtensions{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+
+auto getDeviceExtensions(VkPhysicalDevice device) -> std::vector<VkExtensionProperties> {
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+    return extensions;
+}
+
+auto hasExtension(const std::vector<VkExtensionProperties>& extensions, const char* name)
+    -> bool {
+    return std::ranges::any_of(extensions, [&](const VkExtensionProperties& extension) {
+        return strcmp(extension.extensionName, name) == 0;
+    });
+}
+
+} // namespace
+
+auto VulkanContext::create(const Window& window, const std::string& appName, bool enableValidation,
+                           uint32_t framesInFlight,
+                           const std::filesystem::path& pipelineCacheDirectory)
+    -> Result<VulkanContext> {
+    ZoneScoped;
+    VulkanContext context;
+    context.m_enableValidationLayers = enableValidation;
+    context.m_window = &window;
+    context.m_framesInFlight = std::clamp(framesInFlight, 1u, kMaxFramesInFlight);
+    context.m_pipelineCacheDirectory = pipelineCacheDirectory;
+
+    if (auto result = context.initialize(&window, appName, enableValidation); !result) {
+        return std::unexpected(result.error());
+    }
+
+    return context;
+}
+
+auto VulkanContext::createHeadless(const std::string& appName, bool enableValidation,
+                                   uint32_t width, uint32_t height, uint32_t framesInFlight,
+                                   const std::filesystem::path& pipelineCacheDirectory)
     -> Result<VulkanContext> {
     ZoneScoped;
     VulkanContext context;
     context.m_enableValidationLayers = enableValidation;
+    context.m_headless = true;
+    context.m_framesInFlight = std::clamp(framesInFlight, 1u, kMaxFramesInFlight);
+    context.m_pipelineCacheDirectory = pipelineCacheDirectory;
 
-    if (auto result = context.initialize(window, appName, enableValidation); !result) {
+    if (auto result = context.initialize(nullptr, appName, enableValidation); !result) {
+        return std::unexpected(result.error());
+    }
+
+    if (auto result = context.createOffscreenTargets(width, height); !result) {
         return std::unexpected(result.error());
     }
 
     return context;
 }
 
-auto VulkanContext::initialize(const Window& window, const std::string& appName, bool enableValidation) noexcept
+auto VulkanContext::initialize(const Window* window, const std::string& appName, bool enableValidation) noexcept
     -> VoidResult {
     ZoneScoped;
-    Logger::info("Initializing Vulkan context");
+    Logger::info("Initializing {}Vulkan context", m_headless ? "headless " : "");
 
     if (auto result = createInstance(appName); !result) {
         return std::unexpected(result.error());
@@ -31,8 +84,10 @@ auto VulkanContext::initialize(const Window& window, const std::string& appName,
         return std::unexpected(result.error());
     }
 
-    if (auto result = createSurface(window); !result) {
-        return std::unexpected(result.error());
+    if (window) {
+        if (auto result = createSurface(*window); !result) {
+            return std::unexpected(result.error());
+        }
     }
 
     if (auto result = pickPhysicalDevice(); !result) {
@@ -43,82 +98,123 @@ auto VulkanContext::initialize(const Window& window, const std::string& appName,
         return std::unexpected(result.error());
     }
 
+    auto memory = GpuMemory::create(m_instance, m_physicalDevice, m_device,
+                                    m_memoryBudgetEnabled);
+    if (!memory) {
+        return std::unexpected(memory.error());
+    }
+    m_memory = std::move(*memory);
+
+    // A missing or stale cache file is not an error, the cache just starts empty
+    auto pipelineCache = PipelineCache::create(m_physicalDevice, m_device,
+                                               m_pipelineCacheDirectory);
+    if (!pipelineCache) {
+        return std::unexpected(pipelineCache.error());
+    }
+    m_pipelineCache = std::move(*pipelineCache);
+
+    if (window) {
+        if (auto result = createSwapchain(); !result) {
+            return std::unexpected(result.error());
+        }
+    }
+
+    if (auto result = createFrameResources(); !result) {
+        return std::unexpected(result.error());
+    }
+
     Logger::info("Vulkan context initialized successfully");
     return {};
 }
 
-VulkanContext::VulkanContext(VulkanContext&& other) noexcept
-    : m_instance(other.m_instance)
-    , m_debugMessenger(other.m_debugMessenger)
-    , m_surface(other.m_surface)
-    , m_physicalDevice(other.m_physicalDevice)
-    , m_device(other.m_device)
-    , m_graphicsQueue(other.m_graphicsQueue)
-    , m_presentQueue(other.m_presentQueue)
-    , m_enableValidationLayers(other.m_enableValidationLayers)
-    , m_validationLayers(std::move(other.m_validationLayers)) {
-
-    // Nullify moved-from object to prevent double-free
-    other.m_instance = VK_NULL_HANDLE;
-    other.m_debugMessenger = VK_NULL_HANDLE;
-    other.m_surface = VK_NULL_HANDLE;
-    other.m_physicalDevice = VK_NULL_HANDLE;
-    other.m_device = VK_NULL_HANDLE;
-    other.m_graphicsQueue = VK_NULL_HANDLE;
-    other.m_presentQueue = VK_NULL_HANDLE;
+VulkanContext::VulkanContext(VulkanContext&& other) noexcept {
+    *this = std::move(other);
 }
 
 VulkanContext& VulkanContext::operator=(VulkanContext&& other) noexcept {
     if (this != &other) {
         // Clean up current resources
-        if (m_device != VK_NULL_HANDLE) {
-            vkDestroyDevice(m_device, nullptr);
-        }
-
-        if (m_enableValidationLayers && m_debugMessenger != VK_NULL_HANDLE) {
-            auto func = reinterpret_cast<PFN_vkDestroyDebugUtilsMessengerEXT>(
-                vkGetInstanceProcAddr(m_instance, "vkDestroyDebugUtilsMessengerEXT")
-            );
-            if (func != nullptr) {
-                func(m_instance, m_debugMessenger, nullptr);
-            }
-        }
-
-        if (m_surface != VK_NULL_HANDLE) {
-            vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
-        }
-
-        if (m_instance != VK_NULL_HANDLE) {
-            vkDestroyInstance(m_instance, nullptr);
-        }
-
-        // Transfer ownership
-        m_instance = other.m_instance;
-        m_debugMessenger = other.m_debugMessenger;
-        m_surface = other.m_surface;
-        m_physicalDevice = other.m_physicalDevice;
-        m_device = other.m_device;
-        m_graphicsQueue = other.m_graphicsQueue;
-        m_presentQueue = other.m_presentQueue;
+        destroy();
+
+        // Transfer ownership, leaving the moved-from object with nothing to destroy
+        m_instance = std::exchange(other.m_instance, VK_NULL_HANDLE);
+        m_debugMessenger = std::exchange(other.m_debugMessenger, VK_NULL_HANDLE);
+        m_surface = std::exchange(other.m_surface, VK_NULL_HANDLE);
+        m_physicalDevice = std::exchange(other.m_physicalDevice, VK_NULL_HANDLE);
+        m_device = std::exchange(other.m_device, VK_NULL_HANDLE);
+        m_graphicsQueue = std::exchange(other.m_graphicsQueue, VK_NULL_HANDLE);
+        m_presentQueue = std::exchange(other.m_presentQueue, VK_NULL_HANDLE);
+        m_graphicsFamily = other.m_graphicsFamily;
+        m_presentFamily = other.m_presentFamily;
+        m_deviceQueues = std::move(other.m_deviceQueues);
+        m_queueSlots = other.m_queueSlots;
+        m_presentSlot = other.m_presentSlot;
+        m_frameWaits = std::move(other.m_frameWaits);
+        other.m_deviceQueues.clear();
+        m_memoryBudgetEnabled = other.m_memoryBudgetEnabled;
+        m_memory = std::move(other.m_memory);
+        m_pipelineCacheDirectory = std::move(other.m_pipelineCacheDirectory);
+        m_pipelineCache = std::move(other.m_pipelineCache);
+
+        m_window = std::exchange(other.m_window, nullptr);
+        m_swapchain = std::exchange(other.m_swapchain, VK_NULL_HANDLE);
+        m_swapchainFormat = other.m_swapchainFormat;
+        m_swapchainExtent = other.m_swapchainExtent;
+        m_swapchainImages = std::move(other.m_swapchainImages);
+        m_swapchainImageViews = std::move(other.m_swapchainImageViews);
+        m_renderFinished = std::move(other.m_renderFinished);
+        m_swapchainDirty = other.m_swapchainDirty;
+        other.m_swapchainImageViews.clear();
+        other.m_renderFinished.clear();
+
+        m_framesInFlight = other.m_framesInFlight;
+        m_currentFrame = other.m_currentFrame;
+        m_imageIndex = other.m_imageIndex;
+        m_frameStarted = std::exchange(other.m_frameStarted, false);
+        m_frames = std::exchange(other.m_frames, {});
+
+        m_headless = other.m_headless;
+        m_offscreenExtent = other.m_offscreenExtent;
+        m_offscreenColor = std::exchange(other.m_offscreenColor, {});
+        m_offscreenDepth = std::exchange(other.m_offscreenDepth, {});
         m_enableValidationLayers = other.m_enableValidationLayers;
         m_validationLayers = std::move(other.m_validationLayers);
-
-        // Nullify moved-from object
-        other.m_instance = VK_NULL_HANDLE;
-        other.m_debugMessenger = VK_NULL_HANDLE;
-        other.m_surface = VK_NULL_HANDLE;
-        other.m_physicalDevice = VK_NULL_HANDLE;
-        other.m_device = VK_NULL_HANDLE;
-        other.m_graphicsQueue = VK_NULL_HANDLE;
-        other.m_presentQueue = VK_NULL_HANDLE;
     }
     return *this;
 }
 
 VulkanContext::~VulkanContext() {
     ZoneScoped;
+    if (m_instance != VK_NULL_HANDLE) {
+        destroy();
+        Logger::info("Vulkan context destroyed");
+    }
+}
+
+void VulkanContext::destroy() noexcept {
+    // Frames in flight may still be executing
+    waitIdle();
+    destroyFrameResources();
+    destroySwapchainResources(m_swapchain);
+    m_swapchain = VK_NULL_HANDLE;
+    destroyOffscreenTargets();
+    m_memory.reset();
+    if (m_pipelineCache) {
+        if (auto result = m_pipelineCache->save(); !result) {
+            Logger::warn("Pipeline cache not saved: {}", result.error().toString());
+        }
+        m_pipelineCache.reset();
+    }
+
     if (m_device != VK_NULL_HANDLE) {
+        for (const auto& deviceQueue : m_deviceQueues) {
+            if (deviceQueue->timeline != VK_NULL_HANDLE) {
+                vkDestroySemaphore(m_device, deviceQueue->timeline, nullptr);
+            }
+        }
+        m_deviceQueues.clear();
         vkDestroyDevice(m_device, nullptr);
+        m_device = VK_NULL_HANDLE;
     }
 
     if (m_enableValidationLayers && m_debugMessenger != VK_NULL_HANDLE) {
@@ -128,17 +224,18 @@ VulkanContext::~VulkanContext() {
         if (func != nullptr) {
             func(m_instance, m_debugMessenger, nullptr);
         }
+        m_debugMessenger = VK_NULL_HANDLE;
     }
 
     if (m_surface != VK_NULL_HANDLE) {
         vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+        m_surface = VK_NULL_HANDLE;
     }
 
     if (m_instance != VK_NULL_HANDLE) {
         vkDestroyInstance(m_instance, nullptr);
+        m_instance = VK_NULL_HANDLE;
     }
-
-    Logger::info("Vulkan context destroyed");
 }
 
 auto VulkanContext::createInstance(const std::string& appName) noexcept -> VoidResult {
@@ -150,7 +247,8 @@ auto VulkanContext::createInstance(const std::string& appName) noexcept -> VoidR
         ));
     }
 
-    if (!glfwVulkanSupported()) {
+    // Headless contexts never initialize GLFW, so they cannot ask it about Vulkan support
+    if (!m_headless && !glfwVulkanSupported()) {
         return std::unexpected(makeError(
             ErrorCode::VulkanInstanceCreationFailed,
             "Vulkan is not supported on this system"
@@ -169,17 +267,20 @@ auto VulkanContext::createInstance(const std::string& appName) noexcept -> VoidR
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char*> extensions;
+    if (!m_headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-    if (!glfwExtensions) {
-        return std::unexpected(makeError(
-            ErrorCode::VulkanInstanceCreationFailed,
-            "Failed to get required Vulkan extensions from GLFW. Vulkan may not be available."
-        ));
-    }
+        if (!glfwExtensions) {
+            return std::unexpected(makeError(
+                ErrorCode::VulkanInstanceCreationFailed,
+                "Failed to get required Vulkan extensions from GLFW. Vulkan may not be available."
+            ));
+        }
 
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (m_enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -290,30 +391,77 @@ auto VulkanContext::createLogicalDevice() noexcept -> VoidResult {
     ZoneScoped;
     auto indices = findQueueFamilies(m_physicalDevice);
 
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = {
-        indices.graphicsFamily.value(),
-        indices.presentFamily.value()
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, families.data());
+
+    // Each queue type takes the next unused queue of its family, and shares the last one once
+    // the family runs out. Compute falls back to the graphics family, transfer to the compute
+    // family, then graphics; on the graphics family a second queue still lets work overlap.
+    const uint32_t graphicsFamily = indices.graphicsFamily.value();
+    std::vector<uint32_t> queuesUsed(familyCount, 0);
+    auto assignQueue = [&](uint32_t family) {
+        if (queuesUsed[family] < families[family].queueCount) {
+            ++queuesUsed[family];
+        }
+        const std::pair<uint32_t, uint32_t> slot{family, queuesUsed[family] - 1};
+        return slot;
     };
+    std::array<std::pair<uint32_t, uint32_t>, kQueueTypeCount> queueSlots{};
+    queueSlots[static_cast<size_t>(QueueType::Graphics)] = assignQueue(graphicsFamily);
+    const uint32_t computeFamily = indices.computeFamily.value_or(graphicsFamily);
+    queueSlots[static_cast<size_t>(QueueType::Compute)] = assignQueue(computeFamily);
+    queueSlots[static_cast<size_t>(QueueType::Transfer)] =
+        assignQueue(indices.transferFamily.value_or(computeFamily));
+    // Presentation only ever needs the first queue of its family
+    const uint32_t presentFamily = indices.presentFamily.value_or(graphicsFamily);
+    queuesUsed[presentFamily] = std::max(queuesUsed[presentFamily], 1u);
 
-    float queuePriority = 1.0f;
-    for (uint32_t queueFamily : uniqueQueueFamilies) {
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    std::vector<std::vector<float>> queuePriorities(familyCount);
+    for (uint32_t family = 0; family < familyCount; ++family) {
+        if (queuesUsed[family] == 0) {
+            continue;
+        }
+        queuePriorities[family].assign(queuesUsed[family], 1.0f);
         VkDeviceQueueCreateInfo queueCreateInfo{};
         queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queueCreateInfo.queueFamilyIndex = queueFamily;
-        queueCreateInfo.queueCount = 1;
-        queueCreateInfo.pQueuePriorities = &queuePriority;
+        queueCreateInfo.queueFamilyIndex = family;
+        queueCreateInfo.queueCount = queuesUsed[family];
+        queueCreateInfo.pQueuePriorities = queuePriorities[family].data();
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
     VkPhysicalDeviceFeatures deviceFeatures{};
+    VkPhysicalDeviceVulkan13Features features13{};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features13.synchronization2 = VK_TRUE;
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.pNext = &features13;
+    features12.timelineSemaphore = VK_TRUE;
+
+    // Headless contexts never present
+    std::vector<const char*> extensions;
+    if (m_surface != VK_NULL_HANDLE) {
+        extensions.assign(kSwapchainExtensions.begin(), kSwapchainExtensions.end());
+    }
+    // Optional: without it the allocator estimates the budget from its own allocations
+    m_memoryBudgetEnabled = hasExtension(getDeviceExtensions(m_physicalDevice),
+                                         VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (m_memoryBudgetEnabled) {
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &features12;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = 0;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     if (m_enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(m_validationLayers.size());
@@ -329,13 +477,74 @@ auto VulkanContext::createLogicalDevice() noexcept -> VoidResult {
         ));
     }
 
-    vkGetDeviceQueue(m_device, indices.graphicsFamily.value(), 0, &m_graphicsQueue);
-    vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
+    // Queue types on the same queue share its DeviceQueue
+    auto findOrAddQueue = [&](std::pair<uint32_t, uint32_t> slot) {
+        for (uint32_t i = 0; i < m_deviceQueues.size(); ++i) {
+            if (m_deviceQueues[i]->family == slot.first &&
+                m_deviceQueues[i]->index == slot.second) {
+                return i;
+            }
+        }
+        auto deviceQueue = std::make_unique<DeviceQueue>();
+        deviceQueue->family = slot.first;
+        deviceQueue->index = slot.second;
+        vkGetDeviceQueue(m_device, slot.first, slot.second, &deviceQueue->queue);
+        m_deviceQueues.push_back(std::move(deviceQueue));
+        return static_cast<uint32_t>(m_deviceQueues.size() - 1);
+    };
+    for (size_t type = 0; type < kQueueTypeCount; ++type) {
+        m_queueSlots[type] = findOrAddQueue(queueSlots[type]);
+    }
+    m_presentSlot = findOrAddQueue({presentFamily, 0});
+
+    m_graphicsFamily = graphicsFamily;
+    m_graphicsQueue = getDeviceQueue(QueueType::Graphics).queue;
+    if (indices.presentFamily) {
+        m_presentFamily = presentFamily;
+        m_presentQueue = m_deviceQueues[m_presentSlot]->queue;
+    }
+
+    static constexpr std::array<const char*, kQueueTypeCount> kQueueNames{
+        "graphics", "async compute", "transfer"};
+    for (size_t type = 0; type < kQueueTypeCount; ++type) {
+        const DeviceQueue& deviceQueue = *m_deviceQueues[m_queueSlots[type]];
+        const auto sharedWith = std::ranges::find(m_queueSlots, m_queueSlots[type]);
+        const auto owner = static_cast<size_t>(sharedWith - m_queueSlots.begin());
+        Logger::info("  {} queue: family {} queue {}{}", kQueueNames[type], deviceQueue.family,
+                     deviceQueue.index,
+                     owner == type ? "" : std::format(", shared with {}", kQueueNames[owner]));
+    }
+
+    if (auto result = createQueueTimelines(); !result) {
+        return std::unexpected(result.error());
+    }
 
     Logger::info("Logical device created");
     return {};
 }
 
+auto VulkanContext::createQueueTimelines() noexcept -> VoidResult {
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    for (const auto& deviceQueue : m_deviceQueues) {
+        if (vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &deviceQueue->timeline) !=
+            VK_SUCCESS) {
+            return std::unexpected(makeError(
+                ErrorCode::VulkanResourceCreationFailed,
+                "Failed to create queue timeline semaphore"
+            ));
+        }
+    }
+    return {};
+}
+
 auto VulkanContext::checkValidationLayerSupport() const -> bool {
     ZoneScoped;
     uint32_t layerCount;
@@ -373,19 +582,25 @@ auto VulkanContext::findQueueFamilies(VkPhysicalDevice device) const -> QueueFam
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
     for (uint32_t i = 0; i < queueFamilies.size(); ++i) {
-        if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        const VkQueueFlags flags = queueFamilies[i].queueFlags;
+        if ((flags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphicsFamily) {
             indices.graphicsFamily = i;
+        } else if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) &&
+                   !indices.computeFamily) {
+            indices.computeFamily = i;
+        } else if ((flags & VK_QUEUE_TRANSFER_BIT) &&
+                   !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+                   !indices.transferFamily) {
+            indices.transferFamily = i;
         }
 
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
+        if (m_surface != VK_NULL_HANDLE && !indices.presentFamily) {
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
 
-        if (presentSupport) {
-            indices.presentFamily = i;
-        }
-
-        if (indices.isComplete()) {
-            break;
+            if (presentSupport) {
+                indices.presentFamily = i;
+            }
         }
     }
 
@@ -394,19 +609,795 @@ auto VulkanContext::findQueueFamilies(VkPhysicalDevice device) const -> QueueFam
 
 auto VulkanContext::isDeviceSuitable(VkPhysicalDevice device) const -> bool {
     ZoneScoped;
+    // Render graph barriers are recorded with synchronization2, core in Vulkan 1.3, and queues
+    // synchronize with timeline semaphores
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_3) {
+        return false;
+    }
+    VkPhysicalDeviceVulkan13Features features13{};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.pNext = &features13;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &features12;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+    if (!features13.synchronization2 || !features12.timelineSemaphore) {
+        return false;
+    }
+
     auto indices = findQueueFamilies(device);
-    return indices.isComplete();
+    if (m_surface == VK_NULL_HANDLE) {
+        return indices.isComplete(false);
+    }
+    if (!indices.isComplete()) {
+        return false;
+    }
+
+    const auto extensions = getDeviceExtensions(device);
+    for (const char* required : kSwapchainExtensions) {
+        if (!hasExtension(extensions, required)) {
+            return false;
+        }
+    }
+
+    uint32_t formatCount = 0;
+    uint32_t presentModeCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &formatCount, nullptr);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &presentModeCount, nullptr);
+    return formatCount > 0 && presentModeCount > 0;
+}
+
+auto VulkanContext::createOffscreenTargets(uint32_t width, uint32_t height) noexcept
+    -> VoidResult {
+    ZoneScoped;
+    m_offscreenExtent = VkExtent2D{width, height};
+
+    // Color is cleared by transfer and can be copied out for image comparisons; depth is only
+    // ever attached
+    if (auto result = createOffscreenTarget(
+            VK_FORMAT_R8G8B8A8_UNORM,
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            VK_IMAGE_ASPECT_COLOR_BIT, m_offscreenColor);
+        !result) {
+        return std::unexpected(result.error());
+    }
+
+    if (auto result = createOffscreenTarget(VK_FORMAT_D32_SFLOAT,
+                                            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                            VK_IMAGE_ASPECT_DEPTH_BIT, m_offscreenDepth);
+        !result) {
+        return std::unexpected(result.error());
+    }
+
+    Logger::info("Offscreen targets created: {}x{}", width, height);
+    return {};
+}
+
+auto VulkanContext::createOffscreenTarget(VkFormat format, VkImageUsageFlags usage,
+                                          VkImageAspectFlags aspect,
+                                          OffscreenTarget& target) noexcept -> VoidResult {
+    ZoneScoped;
+    target.format = format;
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = VkExtent3D{m_offscreenExtent.width, m_offscreenExtent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    auto image = m_memory->createImage(imageInfo);
+    if (!image) {
+        return std::unexpected(image.error());
+    }
+    target.image = image->image;
+    target.allocation = image->allocation;
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = target.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange = VkImageSubresourceRange{aspect, 0, 1, 0, 1};
+
+    if (vkCreateImageView(m_device, &viewInfo, nullptr, &target.view) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to create offscreen image view"
+        ));
+    }
+
+    return {};
+}
+
+void VulkanContext::destroyOffscreenTargets() noexcept {
+    if (m_device == VK_NULL_HANDLE || !m_memory) {
+        return;
+    }
+
+    for (OffscreenTarget* target : {&m_offscreenColor, &m_offscreenDepth}) {
+        if (target->view != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, target->view, nullptr);
+        }
+        GpuImage image{target->image, target->allocation};
+        m_memory->destroyImage(image);
+        *target = OffscreenTarget{};
+    }
+}
+
+auto VulkanContext::createSwapchain() noexcept -> VoidResult {
+    ZoneScoped;
+    VkSurfaceCapabilitiesKHR capabilities;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &capabilities);
+
+    VkExtent2D extent = capabilities.currentExtent;
+    if (extent.width == std::numeric_limits<uint32_t>::max()) {
+        int width = 0;
+        int height = 0;
+        glfwGetFramebufferSize(m_window->getHandle(), &width, &height);
+        extent.width = std::clamp(static_cast<uint32_t>(width),
+                                  capabilities.minImageExtent.width,
+                                  capabilities.maxImageExtent.width);
+        extent.height = std::clamp(static_cast<uint32_t>(height),
+                                   capabilities.minImageExtent.height,
+                                   capabilities.maxImageExtent.height);
+    }
+    // Minimized: keep the old swapchain (if any) dirty and retry next frame
+    if (extent.width == 0 || extent.height == 0) {
+        m_swapchainDirty = true;
+        return {};
+    }
+
+    uint32_t formatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &formatCount, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &formatCount,
+                                         formats.data());
+    VkSurfaceFormatKHR surfaceFormat = formats.front();
+    for (const VkSurfaceFormatKHR& format : formats) {
+        if (format.format == VK_FORMAT_B8G8R8A8_SRGB &&
+            format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+            surfaceFormat = format;
+            break;
+        }
+    }
+
+    uint32_t presentModeCount = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount,
+                                              nullptr);
+    std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &presentModeCount,
+                                              presentModes.data());
+    // FIFO is always available; mailbox keeps latency low without tearing
+    const VkPresentModeKHR presentMode =
+        std::ranges::find(presentModes, VK_PRESENT_MODE_MAILBOX_KHR) != presentModes.end()
+            ? VK_PRESENT_MODE_MAILBOX_KHR
+            : VK_PRESENT_MODE_FIFO_KHR;
+
+    uint32_t imageCount = capabilities.minImageCount + 1;
+    if (capabilities.maxImageCount > 0) {
+        imageCount = std::min(imageCount, capabilities.maxImageCount);
+    }
+
+    const std::array<uint32_t, 2> familyIndices{m_graphicsFamily, m_presentFamily};
+    const VkSwapchainKHR oldSwapchain = m_swapchain;
+
+    VkSwapchainCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = m_surface;
+    createInfo.minImageCount = imageCount;
+    createInfo.imageFormat = surfaceFormat.format;
+    createInfo.imageColorSpace = surfaceFormat.colorSpace;
+    createInfo.imageExtent = extent;
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage =
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (m_graphicsFamily != m_presentFamily) {
+        createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        createInfo.queueFamilyIndexCount = static_cast<uint32_t>(familyIndices.size());
+        createInfo.pQueueFamilyIndices = familyIndices.data();
+    } else {
+        createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
+    createInfo.preTransform = capabilities.currentTransform;
+    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode = presentMode;
+    createInfo.clipped = VK_TRUE;
+    createInfo.oldSwapchain = oldSwapchain;
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    if (vkCreateSwapchainKHR(m_device, &createInfo, nullptr, &swapchain) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to create swapchain"
+        ));
+    }
+    // Callers have waited for the device, so the old images are no longer in use
+    destroySwapchainResources(oldSwapchain);
+    m_swapchain = swapchain;
+    m_swapchainFormat = surfaceFormat.format;
+    m_swapchainExtent = extent;
+
+    vkGetSwapchainImagesKHR(m_device, m_swapchain, &imageCount, nullptr);
+    m_swapchainImages.resize(imageCount);
+    vkGetSwapchainImagesKHR(m_device, m_swapchain, &imageCount, m_swapchainImages.data());
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    m_swapchainImageViews.reserve(imageCount);
+    m_renderFinished.reserve(imageCount);
+    for (VkImage image : m_swapchainImages) {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = m_swapchainFormat;
+        viewInfo.subresourceRange = VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+        VkImageView view = VK_NULL_HANDLE;
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        if (vkCreateImageView(m_device, &viewInfo, nullptr, &view) != VK_SUCCESS ||
+            vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+            if (view != VK_NULL_HANDLE) {
+                vkDestroyImageView(m_device, view, nullptr);
+            }
+            return std::unexpected(makeError(
+                ErrorCode::VulkanResourceCreationFailed,
+                "Failed to create swapchain image resources"
+            ));
+        }
+        m_swapchainImageViews.push_back(view);
+        m_renderFinished.push_back(semaphore);
+    }
+
+    m_swapchainDirty = false;
+    Logger::info("Swapchain created: {}x{}, {} images, {}", extent.width, extent.height,
+                 imageCount, presentMode == VK_PRESENT_MODE_MAILBOX_KHR ? "mailbox" : "fifo");
+    return {};
+}
+
+void VulkanContext::destroySwapchainResources(VkSwapchainKHR swapchain) noexcept {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    for (VkSemaphore semaphore : m_renderFinished) {
+        vkDestroySemaphore(m_device, semaphore, nullptr);
+    }
+    for (VkImageView view : m_swapchainImageViews) {
+        vkDestroyImageView(m_device, view, nullptr);
+    }
+    m_renderFinished.clear();
+    m_swapchainImageViews.clear();
+    m_swapchainImages.clear();
+
+    if (swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(m_device, swapchain, nullptr);
+    }
+}
+
+auto VulkanContext::createFrameResources() noexcept -> VoidResult {
+    ZoneScoped;
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    // Reset as a whole once per frame rather than buffer by buffer
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = m_graphicsFamily;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    // The first wait on each frame must not block
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (uint32_t i = 0; i < m_framesInFlight; ++i) {
+        FrameResources& frame = m_frames[i];
+
+        if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS) {
+            return std::unexpected(makeError(
+                ErrorCode::VulkanResourceCreationFailed,
+                "Failed to create frame command pool"
+            ));
+        }
+
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = frame.commandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(m_device, &allocateInfo, &frame.commandBuffer) !=
+                VK_SUCCESS ||
+            vkCreateFence(m_device, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS ||
+            vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &frame.imageAvailable) !=
+                VK_SUCCESS) {
+            return std::unexpected(makeError(
+                ErrorCode::VulkanResourceCreationFailed,
+                "Failed to create frame synchronization objects"
+            ));
+        }
+
+        // Persistently mapped for the lifetime of the context. Any queue may copy from it.
+        auto upload = LinearAllocator::create(*m_memory, kUploadRingSize,
+                                              VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                              getQueueFamilies());
+        if (!upload) {
+            return std::unexpected(upload.error());
+        }
+        frame.upload = *upload;
+    }
+
+    Logger::info("{} frames in flight, {} MB upload ring each", m_framesInFlight,
+                 kUploadRingSize >> 20);
+    return {};
+}
+
+void VulkanContext::destroyFrameResources() noexcept {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    for (FrameResources& frame : m_frames) {
+        for (const ThreadCommands& thread : frame.threadCommands) {
+            vkDestroyCommandPool(m_device, thread.commandPool, nullptr);
+        }
+        if (m_memory) {
+            frame.upload.destroy(*m_memory);
+        }
+        if (frame.imageAvailable != VK_NULL_HANDLE) {
+            vkDestroySemaphore(m_device, frame.imageAvailable, nullptr);
+        }
+        if (frame.inFlight != VK_NULL_HANDLE) {
+            vkDestroyFence(m_device, frame.inFlight, nullptr);
+        }
+        // Frees the command buffer with it
+        if (frame.commandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(m_device, frame.commandPool, nullptr);
+        }
+        frame = FrameResources{};
+    }
+}
+
+auto VulkanContext::getTargetImage() const -> VkImage {
+    return m_headless ? m_offscreenColor.image : m_swapchainImages[m_imageIndex];
+}
+
+void VulkanContext::recordClear(VkCommandBuffer commandBuffer, VkImage image) const {
+    const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    // Previous contents are discarded. The source scope orders this frame after the previous
+    // clear of a shared offscreen target, and chains with the acquire semaphore wait.
+    VkImageMemoryBarrier toTransfer{};
+    toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = image;
+    toTransfer.subresourceRange = range;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &toTransfer);
+
+    const VkClearColorValue clearColor{{0.02f, 0.02f, 0.03f, 1.0f}};
+    vkCmdClearColorImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor,
+                         1, &range);
+}
+
+void VulkanContext::recordFinalTransition(VkCommandBuffer commandBuffer, VkImage image,
+                                          VkImageLayout finalLayout) const {
+    VkImageMemoryBarrier toFinal{};
+    toFinal.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toFinal.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toFinal.dstAccessMask = 0;
+    toFinal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toFinal.newLayout = finalLayout;
+    toFinal.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toFinal.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toFinal.image = image;
+    toFinal.subresourceRange = VkImageSubresourceRange{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &toFinal);
+}
+
+void VulkanContext::replaceFence(FrameResources& frame) noexcept {
+    vkDestroyFence(m_device, frame.inFlight, nullptr);
+    frame.inFlight = VK_NULL_HANDLE;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    if (vkCreateFence(m_device, &fenceInfo, nullptr, &frame.inFlight) != VK_SUCCESS) {
+        Logger::critical("Failed to recreate a frame fence");
+    }
 }
 
 auto VulkanContext::beginFrame() -> std::optional<uint32_t> {
     ZoneScoped;
-    // Frame rendering will be implemented here
-    return std::nullopt;
+    FrameResources& frame = m_frames[m_currentFrame];
+
+    // Blocks only when the CPU is m_framesInFlight frames ahead of the GPU
+    {
+        ZoneScopedN("Wait For Frame");
+        vkWaitForFences(m_device, 1, &frame.inFlight, VK_TRUE,
+                        std::numeric_limits<uint64_t>::max());
+    }
+
+    m_imageIndex = 0;
+    if (!m_headless) {
+        if (m_swapchainDirty || m_swapchain == VK_NULL_HANDLE) {
+            waitIdle();
+            if (auto result = createSwapchain(); !result) {
+                Logger::error("Swapchain recreation failed: {}", result.error().message);
+                return std::nullopt;
+            }
+            if (m_swapchainDirty) {
+                return std::nullopt;
+            }
+        }
+
+        const VkResult acquired = vkAcquireNextImageKHR(
+            m_device, m_swapchain, std::numeric_limits<uint64_t>::max(), frame.imageAvailable,
+            VK_NULL_HANDLE, &m_imageIndex);
+        if (acquired == VK_ERROR_OUT_OF_DATE_KHR) {
+            m_swapchainDirty = true;
+            return std::nullopt;
+        }
+        if (acquired != VK_SUCCESS && acquired != VK_SUBOPTIMAL_KHR) {
+            Logger::error("Failed to acquire swapchain image: {}", static_cast<int>(acquired));
+            return std::nullopt;
+        }
+    }
+
+    // The fence is reset in endFrame, right before the submission that signals it again
+    vkResetCommandPool(m_device, frame.commandPool, 0);
+    for (ThreadCommands& thread : frame.threadCommands) {
+        vkResetCommandPool(m_device, thread.commandPool, 0);
+        thread.usedCount = 0;
+    }
+    frame.upload.reset();
+    m_memory->beginFrame();
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(frame.commandBuffer, &beginInfo);
+    recordClear(frame.commandBuffer, getTargetImage());
+
+    m_frameStarted = true;
+    return m_imageIndex;
 }
 
 void VulkanContext::endFrame() {
     ZoneScoped;
-    // Frame end logic will be implemented here
+    if (!m_frameStarted) {
+        return;
+    }
+    m_frameStarted = false;
+    FrameResources& frame = m_frames[m_currentFrame];
+
+    recordFinalTransition(frame.commandBuffer, getTargetImage(),
+                          m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                     : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    vkEndCommandBuffer(frame.commandBuffer);
+
+    // Besides the swapchain image, the frame waits for whatever other queues produced for it
+    std::vector<VkSemaphoreSubmitInfo> waitInfos;
+    waitInfos.reserve(m_frameWaits.size() + 1);
+    if (!m_headless) {
+        VkSemaphoreSubmitInfo& imageWait = waitInfos.emplace_back();
+        imageWait.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        imageWait.semaphore = frame.imageAvailable;
+        imageWait.stageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    }
+    for (const QueueWait& wait : m_frameWaits) {
+        VkSemaphoreSubmitInfo& waitInfo = waitInfos.emplace_back();
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        waitInfo.semaphore = getDeviceQueue(wait.queue).timeline;
+        waitInfo.value = wait.value;
+        waitInfo.stageMask = wait.stages;
+    }
+    m_frameWaits.clear();
+
+    VkCommandBufferSubmitInfo commandBufferInfo{};
+    commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    commandBufferInfo.commandBuffer = frame.commandBuffer;
+
+    DeviceQueue& graphics = getDeviceQueue(QueueType::Graphics);
+    bool submitted = false;
+    {
+        ZoneScopedN("Submit");
+        std::lock_guard lock(graphics.mutex);
+        // Signals the graphics timeline too, so other queues can wait for the frame
+        std::array<VkSemaphoreSubmitInfo, 2> signalInfos{};
+        signalInfos[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        signalInfos[0].semaphore = graphics.timeline;
+        signalInfos[0].value = graphics.lastSubmitted + 1;
+        signalInfos[0].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        signalInfos[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        signalInfos[1].semaphore = m_headless ? VK_NULL_HANDLE : m_renderFinished[m_imageIndex];
+        signalInfos[1].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+        VkSubmitInfo2 submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submitInfo.waitSemaphoreInfoCount = static_cast<uint32_t>(waitInfos.size());
+        submitInfo.pWaitSemaphoreInfos = waitInfos.data();
+        submitInfo.commandBufferInfoCount = 1;
+        submitInfo.pCommandBufferInfos = &commandBufferInfo;
+        submitInfo.signalSemaphoreInfoCount = m_headless ? 1 : 2;
+        submitInfo.pSignalSemaphoreInfos = signalInfos.data();
+
+        vkResetFences(m_device, 1, &frame.inFlight);
+        submitted = vkQueueSubmit2(graphics.queue, 1, &submitInfo, frame.inFlight) == VK_SUCCESS;
+        bool signalled = submitted;
+        if (!submitted) {
+            Logger::error("Failed to submit frame command buffer");
+            // An empty submission still consumes the acquire semaphore and signals the fence
+            // and the timeline value the frame promised, so nothing waits on them forever
+            VkSubmitInfo2 emptyInfo{};
+            emptyInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+            emptyInfo.waitSemaphoreInfoCount = m_headless ? 0 : 1;
+            emptyInfo.pWaitSemaphoreInfos = waitInfos.data();
+            emptyInfo.signalSemaphoreInfoCount = 1;
+            emptyInfo.pSignalSemaphoreInfos = signalInfos.data();
+            signalled =
+                vkQueueSubmit2(graphics.queue, 1, &emptyInfo, frame.inFlight) == VK_SUCCESS;
+            if (!signalled) {
+                Logger::critical("Failed to submit the fallback for a failed frame");
+                replaceFence(frame);
+            }
+        }
+        if (signalled) {
+            ++graphics.lastSubmitted;
+        }
+    }
+
+    if (!m_headless && !submitted) {
+        // Nothing was rendered and renderFinished will not be signalled, so the image is not
+        // presented. It stays acquired until the swapchain is recreated before the next frame.
+        m_swapchainDirty = true;
+    } else if (!m_headless) {
+        ZoneScopedN("Present");
+        VkPresentInfoKHR presentInfo{};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &m_renderFinished[m_imageIndex];
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = &m_swapchain;
+        presentInfo.pImageIndices = &m_imageIndex;
+
+        DeviceQueue& present = *m_deviceQueues[m_presentSlot];
+        std::lock_guard lock(present.mutex);
+        const VkResult presented = vkQueuePresentKHR(present.queue, &presentInfo);
+        if (presented == VK_ERROR_OUT_OF_DATE_KHR || presented == VK_SUBOPTIMAL_KHR) {
+            m_swapchainDirty = true;
+        }
+    }
+
+    m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+}
+
+auto VulkanContext::enableParallelRecording(uint32_t threadCount) -> VoidResult {
+    ZoneScoped;
+    // Pools may still own buffers of frames in flight
+    waitIdle();
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = m_graphicsFamily;
+
+    for (uint32_t i = 0; i < m_framesInFlight; ++i) {
+        FrameResources& frame = m_frames[i];
+        for (const ThreadCommands& thread : frame.threadCommands) {
+            vkDestroyCommandPool(m_device, thread.commandPool, nullptr);
+        }
+        frame.threadCommands.clear();
+        frame.threadCommands.resize(threadCount);
+
+        for (ThreadCommands& thread : frame.threadCommands) {
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &thread.commandPool) !=
+                VK_SUCCESS) {
+                return std::unexpected(makeError(
+                    ErrorCode::VulkanResourceCreationFailed,
+                    "Failed to create recording thread command pool"
+                ));
+            }
+        }
+    }
+
+    Logger::info("Parallel command recording on {} threads", threadCount);
+    return {};
+}
+
+auto VulkanContext::acquireSecondaryBuffer(ThreadCommands& thread) -> VkCommandBuffer {
+    if (thread.usedCount == thread.commandBuffers.size()) {
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = thread.commandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocateInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(m_device, &allocateInfo, &commandBuffer) != VK_SUCCESS) {
+            return VK_NULL_HANDLE;
+        }
+        thread.commandBuffers.push_back(commandBuffer);
+    }
+    return thread.commandBuffers[thread.usedCount++];
+}
+
+void VulkanContext::recordParallel(JobSystem* jobSystem, uint32_t chunkCount,
+                                   const RecordFunction& record) {
+    ZoneScoped;
+    FrameResources& frame = m_frames[m_currentFrame];
+    if (jobSystem == nullptr || frame.threadCommands.size() < jobSystem->getThreadCount()) {
+        for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+            record(frame.commandBuffer, chunk);
+        }
+        return;
+    }
+
+    // Secondary buffers recorded outside a render pass inherit nothing
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    std::vector<VkCommandBuffer> chunkBuffers(chunkCount, VK_NULL_HANDLE);
+    jobSystem->parallelFor(chunkCount, 1, [&](uint32_t chunk) {
+        ZoneScopedN("Record Chunk");
+        ZoneValue(chunk);
+        // Each thread only ever touches its own pool, so none of this needs a lock
+        ThreadCommands& thread = frame.threadCommands[jobSystem->getCurrentThreadIndex()];
+        const VkCommandBuffer commandBuffer = acquireSecondaryBuffer(thread);
+        if (commandBuffer == VK_NULL_HANDLE) {
+            return;
+        }
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        record(commandBuffer, chunk);
+        vkEndCommandBuffer(commandBuffer);
+        chunkBuffers[chunk] = commandBuffer;
+    });
+
+    const auto [first, last] = std::ranges::remove(chunkBuffers, VK_NULL_HANDLE);
+    if (first != last) {
+        Logger::error("Failed to allocate {} secondary command buffers, their chunks are dropped",
+                      std::distance(first, last));
+        chunkBuffers.erase(first, last);
+    }
+    if (!chunkBuffers.empty()) {
+        vkCmdExecuteCommands(frame.commandBuffer, static_cast<uint32_t>(chunkBuffers.size()),
+                             chunkBuffers.data());
+    }
+}
+
+auto VulkanContext::allocateUpload(VkDeviceSize size, VkDeviceSize alignment)
+    -> std::optional<UploadAllocation> {
+    return m_frames[m_currentFrame].upload.allocate(size, alignment);
+}
+
+auto VulkanContext::submit(QueueType queue, std::span<const VkCommandBuffer> commandBuffers,
+                           std::span<const QueueWait> waits) -> Result<uint64_t> {
+    ZoneScoped;
+    std::vector<VkSemaphoreSubmitInfo> waitInfos(waits.size());
+    for (size_t i = 0; i < waits.size(); ++i) {
+        waitInfos[i].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        waitInfos[i].semaphore = getDeviceQueue(waits[i].queue).timeline;
+        waitInfos[i].value = waits[i].value;
+        waitInfos[i].stageMask = waits[i].stages;
+    }
+    std::vector<VkCommandBufferSubmitInfo> commandBufferInfos(commandBuffers.size());
+    for (size_t i = 0; i < commandBuffers.size(); ++i) {
+        commandBufferInfos[i].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+        commandBufferInfos[i].commandBuffer = commandBuffers[i];
+    }
+
+    DeviceQueue& deviceQueue = getDeviceQueue(queue);
+    std::lock_guard lock(deviceQueue.mutex);
+    VkSemaphoreSubmitInfo signalInfo{};
+    signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signalInfo.semaphore = deviceQueue.timeline;
+    signalInfo.value = deviceQueue.lastSubmitted + 1;
+    signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo2 submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo.waitSemaphoreInfoCount = static_cast<uint32_t>(waitInfos.size());
+    submitInfo.pWaitSemaphoreInfos = waitInfos.data();
+    submitInfo.commandBufferInfoCount = static_cast<uint32_t>(commandBufferInfos.size());
+    submitInfo.pCommandBufferInfos = commandBufferInfos.data();
+    submitInfo.signalSemaphoreInfoCount = 1;
+    submitInfo.pSignalSemaphoreInfos = &signalInfo;
+
+    if (vkQueueSubmit2(deviceQueue.queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to submit to queue"
+        ));
+    }
+    return ++deviceQueue.lastSubmitted;
+}
+
+auto VulkanContext::getCompletedValue(QueueType queue) const -> uint64_t {
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(m_device, getDeviceQueue(queue).timeline, &value);
+    return value;
+}
+
+auto VulkanContext::getSubmittedValue(QueueType queue) const -> uint64_t {
+    DeviceQueue& deviceQueue = getDeviceQueue(queue);
+    std::lock_guard lock(deviceQueue.mutex);
+    return deviceQueue.lastSubmitted;
+}
+
+auto VulkanContext::waitForQueue(QueueType queue, uint64_t value, uint64_t timeoutNs) const
+    -> bool {
+    ZoneScoped;
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &getDeviceQueue(queue).timeline;
+    waitInfo.pValues = &value;
+    return vkWaitSemaphores(m_device, &waitInfo, timeoutNs) == VK_SUCCESS;
+}
+
+void VulkanContext::addFrameWait(const QueueWait& wait) {
+    m_frameWaits.push_back(wait);
+}
+
+auto VulkanContext::createCommandPool(QueueType queue, VkCommandPoolCreateFlags flags) const
+    -> Result<VkCommandPool> {
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = flags;
+    poolInfo.queueFamilyIndex = getQueueFamily(queue);
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        return std::unexpected(makeError(
+            ErrorCode::VulkanResourceCreationFailed,
+            "Failed to create command pool"
+        ));
+    }
+    return commandPool;
+}
+
+auto VulkanContext::getQueueFamily(QueueType queue) const -> uint32_t {
+    return getDeviceQueue(queue).family;
+}
+
+auto VulkanContext::getQueueFamilies() const -> std::array<uint32_t, kQueueTypeCount> {
+    std::array<uint32_t, kQueueTypeCount> families{};
+    for (size_t i = 0; i < kQueueTypeCount; ++i) {
+        families[i] = getDeviceQueue(static_cast<QueueType>(i)).family;
+    }
+    return families;
+}
+
+auto VulkanContext::hasDedicatedQueue(QueueType queue) const -> bool {
+    const uint32_t slot = m_queueSlots[static_cast<size_t>(queue)];
+    return std::ranges::count(m_queueSlots, slot) == 1;
 }
 
 void VulkanContext::waitIdle() const {
@@ -2,24 +2,83 @@
 
 #include <vulkan/vulkan.h>
 #include "Error.hpp"
+#include "GpuMemory.hpp"
+#include "PipelineCache.hpp"
+#include <array>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string_view>
 #include <vector>
 #include <optional>
 
+class JobSystem;
 class Window;
 
+// Work that can overlap with rendering goes to its own queue when the device has one.
+// Streamed pages are copied to the GPU on the transfer queue (see GpuPagePool). Culling still
+// runs on the CPU, so nothing is submitted to the compute queue yet.
+enum class QueueType : uint8_t {
+    Graphics,
+    Compute,  // Meant for async compute: culling, Hi-Z build
+    Transfer, // Copy engine: streaming uploads
+    Count,
+};
+
+// A point on a queue's timeline that a submission waits for before the given stages run
+struct QueueWait {
+    QueueType queue{QueueType::Graphics};
+    uint64_t value{0};
+    VkPipelineStageFlags2 stages{VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT};
+};
+
 class VulkanContext {
 public:
+    static constexpr uint32_t kMaxFramesInFlight = 3;
+    static constexpr size_t kQueueTypeCount = static_cast<size_t>(QueueType::Count);
+    // Host-visible staging memory per frame in flight, recycled when the frame's fence signals
+    static constexpr VkDeviceSize kUploadRingSize = 8ull << 20;
+
     struct QueueFamilyIndices {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
+        // Dedicated families: compute without graphics, transfer without either. Missing when
+        // the device has none, and the work shares a queue of another family.
+        std::optional<uint32_t> computeFamily;
+        std::optional<uint32_t> transferFamily;
 
-        [[nodiscard]] constexpr auto isComplete() const noexcept -> bool {
-            return graphicsFamily.has_value() && presentFamily.has_value();
+        // Headless contexts have no surface and need no present queue
+        [[nodiscard]] constexpr auto isComplete(bool requirePresent = true) const noexcept
+            -> bool {
+            return graphicsFamily.has_value() && (presentFamily.has_value() || !requirePresent);
         }
     };
 
-    [[nodiscard]] static auto create(const Window& window, const std::string& appName, bool enableValidation)
+    // Image with its own memory and a view over all of it
+    struct OffscreenTarget {
+        VkImage image{VK_NULL_HANDLE};
+        VmaAllocation allocation{VK_NULL_HANDLE};
+        VkImageView view{VK_NULL_HANDLE};
+        VkFormat format{VK_FORMAT_UNDEFINED};
+    };
+
+    // Slice of the current frame's upload ring; data is mapped and coherent
+    using UploadAllocation = LinearAllocator::Allocation;
+
+    // The pipeline cache is loaded from and saved to pipelineCacheDirectory; empty keeps it
+    // in memory only
+    [[nodiscard]] static auto create(const Window& window, const std::string& appName, bool enableValidation,
+                                     uint32_t framesInFlight = 2,
+                                     const std::filesystem::path& pipelineCacheDirectory = {})
+        -> Result<VulkanContext>;
+    // No GLFW, surface or swapchain: any device with a graphics queue will do, and frames go
+    // to offscreen color and depth targets of the given size
+    [[nodiscard]] static auto createHeadless(
+        const std::string& appName, bool enableValidation, uint32_t width, uint32_t height,
+        uint32_t framesInFlight = 2, const std::filesystem::path& pipelineCacheDirectory = {})
         -> Result<VulkanContext>;
     ~VulkanContext();
 
@@ -28,25 +87,152 @@ public:
     VulkanContext(VulkanContext&& other) noexcept;
     VulkanContext& operator=(VulkanContext&& other) noexcept;
 
+    // Waits until the frame that last used this frame's resources has finished on the GPU,
+    // acquires a swapchain image and begins the frame's command buffer. Returns the image
+    // index, or nothing when no frame can be rendered, e.g. while the window is minimized.
     [[nodiscard]] auto beginFrame() -> std::optional<uint32_t>;
+    // Submits the frame's command buffer and presents; does not wait for the GPU
     void endFrame();
     void waitIdle() const;
+    // The swapchain is recreated before the next frame
+    void notifyResized() noexcept { m_swapchainDirty = true; }
+
+    // Records one chunk of a frame's commands; chunk is in [0, chunkCount) of recordParallel()
+    using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t chunk)>;
+
+    // Creates a command pool per recording thread and frame in flight for recordParallel();
+    // threadCount is the job system's thread count
+    [[nodiscard]] auto enableParallelRecording(uint32_t threadCount) -> VoidResult;
+    // Records every chunk on the job system into a secondary command buffer from the recording
+    // thread's own pool, then executes them from the frame's command buffer in chunk order, so
+    // the frame does not depend on which thread recorded what. Without parallel recording or a
+    // job system, chunks are recorded in order straight into the frame's command buffer. Valid
+    // between beginFrame() and endFrame(), outside of any render pass; the frame's color target
+    // is in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.
+    void recordParallel(JobSystem* jobSystem, uint32_t chunkCount, const RecordFunction& record);
+
+    // Valid between beginFrame() and endFrame(); nothing when the ring is exhausted
+    [[nodiscard]] auto allocateUpload(VkDeviceSize size, VkDeviceSize alignment = 16)
+        -> std::optional<UploadAllocation>;
+
+    // Every queue has a timeline semaphore that counts its completed submissions. Queue types
+    // without a queue of their own share one, and its timeline, with another type.
+    //
+    // Submits command buffers allocated from a pool of the queue's family once every wait is
+    // reached, and returns the timeline value signalled on completion. Thread safe.
+    [[nodiscard]] auto submit(QueueType queue, std::span<const VkCommandBuffer> commandBuffers,
+                              std::span<const QueueWait> waits = {}) -> Result<uint64_t>;
+    [[nodiscard]] auto getCompletedValue(QueueType queue) const -> uint64_t;
+    // Value the queue's latest submission signals on completion
+    [[nodiscard]] auto getSubmittedValue(QueueType queue) const -> uint64_t;
+    // Blocks until the queue's timeline reaches value; false on timeout
+    [[nodiscard]] auto waitForQueue(
+        QueueType queue, uint64_t value,
+        uint64_t timeoutNs = std::numeric_limits<uint64_t>::max()) const -> bool;
+    // The current frame's submission waits for this too, e.g. for async compute culling.
+    // Valid between beginFrame() and endFrame().
+    void addFrameWait(const QueueWait& wait);
+    [[nodiscard]] auto createCommandPool(QueueType queue, VkCommandPoolCreateFlags flags) const
+        -> Result<VkCommandPool>;
+    [[nodiscard]] auto getQueueFamily(QueueType queue) const -> uint32_t;
+    // Family of every queue type, for buffers the queues share
+    [[nodiscard]] auto getQueueFamilies() const -> std::array<uint32_t, kQueueTypeCount>;
+    // Whether the queue type has a VkQueue to itself, so its work can overlap with the others
+    [[nodiscard]] auto hasDedicatedQueue(QueueType queue) const -> bool;
 
     [[nodiscard]] auto getInstance() const noexcept -> VkInstance { return m_instance; }
     [[nodiscard]] auto getDevice() const noexcept -> VkDevice { return m_device; }
     [[nodiscard]] auto getPhysicalDevice() const noexcept -> VkPhysicalDevice { return m_physicalDevice; }
+    [[nodiscard]] auto getMemory() const noexcept -> GpuMemory& { return *m_memory; }
+    [[nodiscard]] auto getPipelineCache() const noexcept -> PipelineCache& {
+        return *m_pipelineCache;
+    }
     [[nodiscard]] auto getGraphicsQueue() const noexcept -> VkQueue { return m_graphicsQueue; }
     [[nodiscard]] auto getPresentQueue() const noexcept -> VkQueue { return m_presentQueue; }
+    [[nodiscard]] auto getGraphicsQueueFamily() const noexcept -> uint32_t {
+        return m_graphicsFamily;
+    }
+    [[nodiscard]] auto isHeadless() const noexcept -> bool { return m_headless; }
+    [[nodiscard]] auto getOffscreenColor() const noexcept -> const OffscreenTarget& {
+        return m_offscreenColor;
+    }
+    [[nodiscard]] auto getOffscreenDepth() const noexcept -> const OffscreenTarget& {
+        return m_offscreenDepth;
+    }
+    [[nodiscard]] auto getOffscreenExtent() const noexcept -> VkExtent2D {
+        return m_offscreenExtent;
+    }
+    [[nodiscard]] auto getSwapchainExtent() const noexcept -> VkExtent2D { return m_swapchainExtent; }
+    [[nodiscard]] auto getFramesInFlight() const noexcept -> uint32_t { return m_framesInFlight; }
+    // Index of the frame in flight being recorded, for indexing per-frame resources
+    [[nodiscard]] auto getCurrentFrame() const noexcept -> uint32_t { return m_currentFrame; }
+    [[nodiscard]] auto getCommandBuffer() const noexcept -> VkCommandBuffer {
+        return m_frames[m_currentFrame].commandBuffer;
+    }
 
 private:
+    // One VkQueue of the device and its timeline. Submissions to a queue must not overlap.
+    struct DeviceQueue {
+        VkQueue queue{VK_NULL_HANDLE};
+        uint32_t family{0};
+        uint32_t index{0};
+        VkSemaphore timeline{VK_NULL_HANDLE};
+        uint64_t lastSubmitted{0};
+        std::mutex mutex;
+    };
+
+    // Secondary command buffers of one recording thread, kept and reused across frames
+    struct ThreadCommands {
+        VkCommandPool commandPool{VK_NULL_HANDLE};
+        std::vector<VkCommandBuffer> commandBuffers;
+        uint32_t usedCount{0};
+    };
+
+    // Everything one frame in flight owns; reused once its fence has signalled
+    struct FrameResources {
+        VkCommandPool commandPool{VK_NULL_HANDLE};
+        VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+        VkFence inFlight{VK_NULL_HANDLE};
+        VkSemaphore imageAvailable{VK_NULL_HANDLE};
+        LinearAllocator upload;
+        // One per job system thread once parallel recording is enabled
+        std::vector<ThreadCommands> threadCommands;
+    };
+
     VulkanContext() = default;
-    [[nodiscard]] auto initialize(const Window& window, const std::string& appName, bool enableValidation) noexcept -> VoidResult;
+    // window is null for headless contexts
+    [[nodiscard]] auto initialize(const Window* window, const std::string& appName, bool enableValidation) noexcept -> VoidResult;
+    void destroy() noexcept;
 
     [[nodiscard]] auto createInstance(const std::string& appName) noexcept -> VoidResult;
     [[nodiscard]] auto setupDebugMessenger() noexcept -> VoidResult;
     [[nodiscard]] auto createSurface(const Window& window) noexcept -> VoidResult;
     [[nodiscard]] auto pickPhysicalDevice() noexcept -> VoidResult;
     [[nodiscard]] auto createLogicalDevice() noexcept -> VoidResult;
+    [[nodiscard]] auto createQueueTimelines() noexcept -> VoidResult;
+    [[nodiscard]] auto getDeviceQueue(QueueType queue) const -> DeviceQueue& {
+        return *m_deviceQueues[m_queueSlots[static_cast<size_t>(queue)]];
+    }
+    [[nodiscard]] auto createSwapchain() noexcept -> VoidResult;
+    void destroySwapchainResources(VkSwapchainKHR swapchain) noexcept;
+    [[nodiscard]] auto createFrameResources() noexcept -> VoidResult;
+    void destroyFrameResources() noexcept;
+    [[nodiscard]] auto createOffscreenTargets(uint32_t width, uint32_t height) noexcept
+        -> VoidResult;
+    [[nodiscard]] auto createOffscreenTarget(VkFormat format, VkImageUsageFlags usage,
+                                             VkImageAspectFlags aspect,
+                                             OffscreenTarget& target) noexcept -> VoidResult;
+    void destroyOffscreenTargets() noexcept;
+    [[nodiscard]] auto acquireSecondaryBuffer(ThreadCommands& thread) -> VkCommandBuffer;
+    // Color image the current frame renders to
+    [[nodiscard]] auto getTargetImage() const -> VkImage;
+    // Leaves the image in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL for the frame's commands
+    void recordClear(VkCommandBuffer commandBuffer, VkImage image) const;
+    void recordFinalTransition(VkCommandBuffer commandBuffer, VkImage image,
+                               VkImageLayout finalLayout) const;
+    // Swaps in a new, signalled fence after every submission meant to signal the old one
+    // failed, so the frame's next wait returns
+    void replaceFence(FrameResources& frame) noexcept;
 
     [[nodiscard]] auto checkValidationLayerSupport() const -> bool;
     [[nodiscard]] auto findQueueFamilies(VkPhysicalDevice device) const -> QueueFamilyIndices;
@@ -66,7 +252,41 @@ private:
     VkDevice m_device{VK_NULL_HANDLE};
     VkQueue m_graphicsQueue{VK_NULL_HANDLE};
     VkQueue m_presentQueue{VK_NULL_HANDLE};
+    uint32_t m_graphicsFamily{0};
+    uint32_t m_presentFamily{0};
+    // Distinct queues, and which of them each QueueType and presentation use
+    std::vector<std::unique_ptr<DeviceQueue>> m_deviceQueues;
+    std::array<uint32_t, kQueueTypeCount> m_queueSlots{};
+    uint32_t m_presentSlot{0};
+    std::vector<QueueWait> m_frameWaits;
+    bool m_memoryBudgetEnabled{false};
+    // Destroyed after everything allocated from it, before the device
+    std::unique_ptr<GpuMemory> m_memory;
+    std::filesystem::path m_pipelineCacheDirectory;
+    // Saved when the context is destroyed
+    std::unique_ptr<PipelineCache> m_pipelineCache;
+
+    const Window* m_window{nullptr};
+    VkSwapchainKHR m_swapchain{VK_NULL_HANDLE};
+    VkFormat m_swapchainFormat{VK_FORMAT_UNDEFINED};
+    VkExtent2D m_swapchainExtent{0, 0};
+    std::vector<VkImage> m_swapchainImages;
+    std::vector<VkImageView> m_swapchainImageViews;
+    // Per swapchain image: presentation may still wait on it after the frame's fence signals
+    std::vector<VkSemaphore> m_renderFinished;
+    bool m_swapchainDirty{false};
+
+    uint32_t m_framesInFlight{2};
+    uint32_t m_currentFrame{0};
+    uint32_t m_imageIndex{0};
+    bool m_frameStarted{false};
+    std::array<FrameResources, kMaxFramesInFlight> m_frames{};
+
+    bool m_headless{false};
+    VkExtent2D m_offscreenExtent{0, 0};
+    OffscreenTarget m_offscreenColor;
+    OffscreenTarget m_offscreenDepth;
 
     bool m_enableValidationLayers{false};
     std::vector<const char*> m_validationLayers{"VK_LAYER_KHRONOS_validation"};
-};
\ No newline at end of file
+};
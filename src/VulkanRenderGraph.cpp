@@ -0,0 +1,147 @@
+#include "VulkanRenderGraph.hpp"
+#include <tracy/Tracy.hpp>
+#include <array>
+#include <vector>
+
+namespace {
+
+struct UsageInfo {
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 access;
+    VkAccessFlags2 writeAccess;
+};
+
+constexpr VkPipelineStageFlags2 kShaderStages = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+                                                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+                                                VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+constexpr VkPipelineStageFlags2 kDepthStages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT |
+                                               VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+// Indexed by ResourceUsage
+constexpr std::array<UsageInfo, static_cast<size_t>(ResourceUsage::Count)> kUsageInfos{{
+    {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+     VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+     VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT},
+    {kDepthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_NONE},
+    {kDepthStages,
+     VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+     VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT},
+    {kShaderStages, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE},
+    {kShaderStages, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_NONE},
+    // Storage writes include atomics, which read as well
+    {kShaderStages,
+     VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+     VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT},
+    {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+     VK_ACCESS_2_NONE},
+    {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE},
+    {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+     VK_ACCESS_2_TRANSFER_WRITE_BIT},
+    // Presentation engine reads are made visible by the semaphore, not the barrier
+    {VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_ACCESS_2_NONE},
+}};
+
+} // namespace
+
+auto getUsageStages(UsageMask usages) noexcept -> VkPipelineStageFlags2 {
+    VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+    for (size_t i = 0; i < kUsageInfos.size(); ++i) {
+        if (usages & (1u << i)) {
+            stages |= kUsageInfos[i].stages;
+        }
+    }
+    return stages;
+}
+
+auto getUsageAccess(UsageMask usages, bool writesOnly) noexcept -> VkAccessFlags2 {
+    VkAccessFlags2 access = VK_ACCESS_2_NONE;
+    for (size_t i = 0; i < kUsageInfos.size(); ++i) {
+        if (usages & (1u << i)) {
+            access |= writesOnly ? kUsageInfos[i].writeAccess : kUsageInfos[i].access;
+        }
+    }
+    return access;
+}
+
+auto getVkImageLayout(ImageLayout layout) noexcept -> VkImageLayout {
+    switch (layout) {
+    case ImageLayout::Undefined:
+        return VK_IMAGE_LAYOUT_UNDEFINED;
+    case ImageLayout::General:
+        return VK_IMAGE_LAYOUT_GENERAL;
+    case ImageLayout::ColorAttachment:
+        return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    case ImageLayout::DepthAttachment:
+        return VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+    case ImageLayout::ShaderReadOnly:
+        return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    case ImageLayout::TransferSrc:
+        return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    case ImageLayout::TransferDst:
+        return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    case ImageLayout::Present:
+        return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+    return VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+void recordRenderGraphBarriers(VkCommandBuffer commandBuffer,
+                               std::span<const RenderGraphBarrier> barriers,
+                               std::span<const RenderGraphBinding> bindings) {
+    ZoneScoped;
+    if (barriers.empty()) {
+        return;
+    }
+
+    std::vector<VkImageMemoryBarrier2> imageBarriers;
+    std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+    for (const RenderGraphBarrier& barrier : barriers) {
+        const RenderGraphBinding& binding = bindings[barrier.resource];
+        // before is empty only on first use of memory no earlier resource occupied
+        const VkPipelineStageFlags2 srcStages =
+            barrier.before != 0 ? getUsageStages(barrier.before) : VK_PIPELINE_STAGE_2_NONE;
+        const VkAccessFlags2 srcAccess = getUsageAccess(barrier.before, true);
+        const VkPipelineStageFlags2 dstStages = getUsageStages(barrier.after);
+        const VkAccessFlags2 dstAccess = getUsageAccess(barrier.after, false);
+
+        if (binding.image != VK_NULL_HANDLE) {
+            VkImageMemoryBarrier2 imageBarrier{};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            imageBarrier.srcStageMask = srcStages;
+            imageBarrier.srcAccessMask = srcAccess;
+            imageBarrier.dstStageMask = dstStages;
+            imageBarrier.dstAccessMask = dstAccess;
+            imageBarrier.oldLayout = barrier.discard || barrier.before == 0
+                                         ? VK_IMAGE_LAYOUT_UNDEFINED
+                                         : getVkImageLayout(getUsageMaskLayout(barrier.before));
+            imageBarrier.newLayout = getVkImageLayout(getUsageMaskLayout(barrier.after));
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = binding.image;
+            imageBarrier.subresourceRange.aspectMask = binding.aspect;
+            imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+            imageBarriers.push_back(imageBarrier);
+        } else if (binding.buffer != VK_NULL_HANDLE) {
+            VkBufferMemoryBarrier2 bufferBarrier{};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+            bufferBarrier.srcStageMask = srcStages;
+            bufferBarrier.srcAccessMask = srcAccess;
+            bufferBarrier.dstStageMask = dstStages;
+            bufferBarrier.dstAccessMask = dstAccess;
+            bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.buffer = binding.buffer;
+            bufferBarrier.size = VK_WHOLE_SIZE;
+            bufferBarriers.push_back(bufferBarrier);
+        }
+    }
+
+    VkDependencyInfo dependency{};
+    dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+    dependency.pBufferMemoryBarriers = bufferBarriers.data();
+    dependency.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+    dependency.pImageMemoryBarriers = imageBarriers.data();
+    vkCmdPipelineBarrier2(commandBuffer, &dependency);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "Render/RenderGraph.hpp"
+#include <span>
+
+// Vulkan objects a render graph resource is bound to for one frame: aliased transients are
+// created over the offsets of CompiledRenderGraph::allocations, imported ones are passed in
+struct RenderGraphBinding {
+    VkImage image{VK_NULL_HANDLE};
+    VkImageAspectFlags aspect{VK_IMAGE_ASPECT_COLOR_BIT};
+    VkBuffer buffer{VK_NULL_HANDLE};
+};
+
+[[nodiscard]] auto getUsageStages(UsageMask usages) noexcept -> VkPipelineStageFlags2;
+// Only write accesses need to be made available, so src masks pass writesOnly
+[[nodiscard]] auto getUsageAccess(UsageMask usages, bool writesOnly) noexcept -> VkAccessFlags2;
+[[nodiscard]] auto getVkImageLayout(ImageLayout layout) noexcept -> VkImageLayout;
+
+// Records one batch of barriers, e.g. CompiledRenderGraph::getPassBarriers, as a single
+// vkCmdPipelineBarrier2. bindings is indexed by resource.
+void recordRenderGraphBarriers(VkCommandBuffer commandBuffer,
+                               std::span<const RenderGraphBarrier> barriers,
+                               std::span<const RenderGraphBinding> bindings);
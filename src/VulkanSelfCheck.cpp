@@ -0,0 +1,117 @@
+#include "VulkanSelfCheck.hpp"
+#include "Core/JobSystem.hpp"
+#include "Logger.hpp"
+#include "VulkanContext.hpp"
+#include <tracy/Tracy.hpp>
+#include <cstdint>
+
+namespace {
+
+constexpr uint32_t kCheckExtent = 64;
+constexpr uint32_t kChunkCount = 64;
+constexpr VkDeviceSize kRegionBytes = 256;
+// More frames than can be in flight, so every frame's recording pools are reset and reused
+constexpr uint32_t kCheckFrames = 2 * VulkanContext::kMaxFramesInFlight;
+
+void recordMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 dstStages,
+                         VkAccessFlags2 dstAccess) {
+    VkMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask = dstStages;
+    barrier.dstAccessMask = dstAccess;
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.memoryBarrierCount = 1;
+    dependencyInfo.pMemoryBarriers = &barrier;
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+auto makeFillValue(uint32_t frame, uint32_t chunk) -> uint32_t {
+    return frame << 16 | chunk;
+}
+
+// Chunk c waits for the fills before it and then fills regions [0, kChunkCount - c) with its
+// own value. Region r ends up holding chunk kChunkCount - 1 - r only if every chunk ran, in
+// chunk order, whichever thread recorded it.
+auto checkParallelRecording(VulkanContext& context, JobSystem& jobSystem) -> bool {
+    ZoneScoped;
+    if (auto result = context.enableParallelRecording(jobSystem.getThreadCount()); !result) {
+        Logger::error("{}", result.error().toString());
+        return false;
+    }
+
+    GpuMemory& memory = context.getMemory();
+    auto buffer = memory.createBuffer(MemoryPool::Staging, kChunkCount * kRegionBytes,
+                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    if (!buffer) {
+        Logger::error("{}", buffer.error().toString());
+        return false;
+    }
+
+    bool passed = true;
+    for (uint32_t frame = 0; frame < kCheckFrames && passed; ++frame) {
+        if (!context.beginFrame()) {
+            Logger::error("Frame {} could not begin", frame);
+            passed = false;
+            break;
+        }
+        context.recordParallel(&jobSystem, kChunkCount,
+                               [&](VkCommandBuffer commandBuffer, uint32_t chunk) {
+            recordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+                                VK_ACCESS_2_TRANSFER_WRITE_BIT);
+            vkCmdFillBuffer(commandBuffer, buffer->buffer, 0,
+                            (kChunkCount - chunk) * kRegionBytes, makeFillValue(frame, chunk));
+        });
+        recordMemoryBarrier(context.getCommandBuffer(), VK_PIPELINE_STAGE_2_HOST_BIT,
+                            VK_ACCESS_2_HOST_READ_BIT);
+        context.endFrame();
+        context.waitIdle();
+
+        const auto* values = static_cast<const uint32_t*>(buffer->data);
+        uint32_t wrongRegions = 0;
+        for (uint32_t region = 0; region < kChunkCount; ++region) {
+            const uint32_t expected = makeFillValue(frame, kChunkCount - 1 - region);
+            const uint32_t* regionValues = values + region * kRegionBytes / sizeof(uint32_t);
+            for (uint32_t i = 0; i < kRegionBytes / sizeof(uint32_t); ++i) {
+                if (regionValues[i] != expected) {
+                    ++wrongRegions;
+                    break;
+                }
+            }
+        }
+        if (wrongRegions != 0) {
+            Logger::error("Frame {}: {} of {} regions hold another chunk's value", frame,
+                          wrongRegions, kChunkCount);
+            passed = false;
+        }
+    }
+
+    memory.destroyBuffer(*buffer);
+    if (passed) {
+        Logger::info("Parallel recording: {} chunks on {} threads ran in chunk order in {} "
+                     "frames", kChunkCount, jobSystem.getThreadCount(), kCheckFrames);
+    }
+    return passed;
+}
+
+} // namespace
+
+auto runVulkanSelfCheck(JobSystem& jobSystem) -> bool {
+    ZoneScoped;
+    auto context = VulkanContext::createHeadless("Virtual Geometry - Self Check", true,
+                                                 kCheckExtent, kCheckExtent);
+    if (!context) {
+        Logger::error("No headless Vulkan context: {}", context.error().toString());
+        return false;
+    }
+
+    const bool passed = checkParallelRecording(*context, jobSystem);
+    context->waitIdle();
+    if (passed) {
+        Logger::info("Every Vulkan check passed");
+    }
+    return passed;
+}
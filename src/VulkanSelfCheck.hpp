@@ -0,0 +1,7 @@
+#pragma once
+
+class JobSystem;
+
+// Drives the parts of VulkanContext the demo frame does not reach yet on a headless device and
+// checks their results on the host. Returns false when a check fails or no device is available.
+[[nodiscard]] auto runVulkanSelfCheck(JobSystem& jobSystem) -> bool;
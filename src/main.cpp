@@ -1,12 +1,86 @@
 #include "Application.hpp"
+#include "Core/JobSystem.hpp"
 #include "Logger.hpp"
+#include "VulkanSelfCheck.hpp"
+#include <charconv>
+#include <string>
+#include <string_view>
+
+auto main(int argc, char** argv) -> int {
+    // [geometry.vgeo] [--software] [--headless] [--frames <n>] [--frames-in-flight <n>]
+    // [--camera <path.txt>] [--benchmark <output stem>] [--pipeline-cache <directory>]
+    // [--occlusion] | --check-vulkan
+    std::string geometryPath;
+    RenderBackend renderBackend = RenderBackend::Vulkan;
+    bool headless = false;
+    uint32_t frameCount = 0;
+    uint32_t framesInFlight = 2;
+    CameraPath cameraPath;
+    std::string benchmarkOutput;
+    std::string pipelineCacheDirectory = "cache";
+    bool occlusionCulling = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        if (argument == "--software") {
+            renderBackend = RenderBackend::Software;
+        } else if (argument == "--headless") {
+            headless = true;
+        } else if (argument == "--frames" && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            const auto [ptr, ec] =
+                std::from_chars(value.data(), value.data() + value.size(), frameCount);
+            if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                Logger::critical("Invalid frame count: {}", value);
+                return 1;
+            }
+        } else if (argument == "--frames-in-flight" && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            const auto [ptr, ec] =
+                std::from_chars(value.data(), value.data() + value.size(), framesInFlight);
+            if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                Logger::critical("Invalid frames in flight: {}", value);
+                return 1;
+            }
+        } else if (argument == "--camera" && i + 1 < argc) {
+            auto pathResult = CameraPath::load(argv[++i]);
+            if (!pathResult) {
+                Logger::critical("{}", pathResult.error().toString());
+                return 1;
+            }
+            cameraPath = std::move(*pathResult);
+        } else if (argument == "--benchmark" && i + 1 < argc) {
+            benchmarkOutput = argv[++i];
+        } else if (argument == "--pipeline-cache" && i + 1 < argc) {
+            pipelineCacheDirectory = argv[++i];
+        } else if (argument == "--occlusion") {
+            occlusionCulling = true;
+        } else if (argument == "--check-vulkan") {
+            Logger::init();
+            const auto jobSystem = JobSystem::create();
+            return runVulkanSelfCheck(*jobSystem) ? 0 : 1;
+        } else {
+            geometryPath = argument;
+        }
+    }
+    // Headless runs and benchmarks always end, after one pass along the camera path
+    if ((headless || !benchmarkOutput.empty()) && frameCount == 0) {
+        frameCount = 600;
+    }
 
-auto main() -> int {
     Application::Config config{
         .applicationName = "Virtual Geometry - Demo",
         .windowWidth = 1280,
         .windowHeight = 720,
-        .enableValidationLayers = true
+        .enableValidationLayers = true,
+        .geometryPath = geometryPath,
+        .renderBackend = renderBackend,
+        .framesInFlight = framesInFlight,
+        .headless = headless,
+        .frameCount = frameCount,
+        .cameraPath = cameraPath,
+        .benchmarkOutput = benchmarkOutput,
+        .pipelineCacheDirectory = pipelineCacheDirectory,
+        .occlusionCulling = occlusionCulling
     };
 
     auto appResult = Application::create(config);
@@ -0,0 +1,962 @@
+#include "Core/JobSystem.hpp"
+#include "Geometry/ClusterDag.hpp"
+#include "Geometry/MeshData.hpp"
+#include "Geometry/MeshImporter.hpp"
+#include "Logger.hpp"
+#include "Streaming/CookCache.hpp"
+#include "Streaming/PageDecoder.hpp"
+#include "Streaming/PagedGeometry.hpp"
+#include "Streaming/PageWriter.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Bump whenever cooking produces different output for the same source and settings, so cook
+// cache entries made by older cookers stop matching
+constexpr uint32_t kCookerVersion = 1;
+
+struct CookOptions {
+    std::string inputPath;
+    std::string outputPath;
+    std::optional<uint32_t> sphereSegments;
+    std::optional<uint32_t> terrainResolution;
+    ClusterDagBuilder::Config dagConfig;
+    PageWriter::Config pageConfig;
+    MeshImportConfig importConfig;
+    std::string cacheDirectory;
+    CookCacheConfig cacheConfig;
+    uint32_t threadCount{0};
+    bool compareGroupers{false};
+    bool importBenchmark{false};
+    bool decodeBenchmark{false};
+};
+
+void printUsage() {
+    Logger::info("Usage: vg-cook <mesh.obj|.ply|.gltf|.glb> [options]");
+    Logger::info("       vg-cook --sphere <segments> | --terrain <resolution> [options]");
+    Logger::info("Options:");
+    Logger::info("  --output <file>      Write the cooked geometry as a paged .vgeo file");
+    Logger::info("  --page-size <bytes>  Streaming page size (default 131072)");
+    Logger::info("  --position-bits <n>  Position bits per axis, finest clusters (default 12)");
+    Logger::info("  --normal-bits <n>    Bits per octahedral normal component (default 10)");
+    Logger::info("  --max-vertices <n>   Vertices per cluster (default 64)");
+    Logger::info("  --max-triangles <n>  Triangles per cluster (default 124)");
+    Logger::info("  --group-size <n>     Clusters simplified together per DAG group (default 8)");
+    Logger::info("  --grouper <name>     Cluster grouping: graph (default) or spatial");
+    Logger::info("  --compare-groupers   Cook with every grouper and compare the results");
+    Logger::info("  --threads <n>        Worker threads including the main thread (default all)");
+    Logger::info("  --cache <dir>        Reuse cooked files of unchanged sources and settings");
+    Logger::info("  --cache-size <MiB>   Evict least recently used cache entries past this "
+                 "(default 4096)");
+    Logger::info("  --no-weld            Keep duplicate vertices of the source file");
+    Logger::info("  --import-benchmark   Write the input in every source format, import each back");
+    Logger::info("                       and check it matches");
+    Logger::info("  --decode-benchmark   Decode the written pages with every kernel, check them");
+    Logger::info("                       against the source and report throughput");
+}
+
+auto parseUint(std::string_view text) -> std::optional<uint32_t> {
+    uint32_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+auto parseArguments(int argc, char** argv) -> Result<CookOptions> {
+    CookOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+
+        auto nextUint = [&]() -> Result<uint32_t> {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Missing value for {}", argument)
+                ));
+            }
+            const auto value = parseUint(argv[++i]);
+            if (!value) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Invalid value for {}: {}", argument, argv[i])
+                ));
+            }
+            return *value;
+        };
+
+        Result<uint32_t> value;
+        if (argument == "--sphere") {
+            value = nextUint();
+            options.sphereSegments = value.value_or(0);
+        } else if (argument == "--terrain") {
+            value = nextUint();
+            options.terrainResolution = value.value_or(0);
+        } else if (argument == "--output") {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(ErrorCode::InvalidArgument, "Missing output path"));
+            }
+            options.outputPath = argv[++i];
+        } else if (argument == "--page-size") {
+            value = nextUint();
+            options.pageConfig.pageSize = value.value_or(0);
+        } else if (argument == "--position-bits") {
+            value = nextUint();
+            options.pageConfig.positionBits = value.value_or(0);
+        } else if (argument == "--normal-bits") {
+            value = nextUint();
+            options.pageConfig.normalBits = value.value_or(0);
+        } else if (argument == "--max-vertices") {
+            value = nextUint();
+            options.dagConfig.cluster.maxVertices = value.value_or(0);
+        } else if (argument == "--max-triangles") {
+            value = nextUint();
+            options.dagConfig.cluster.maxTriangles = value.value_or(0);
+        } else if (argument == "--group-size") {
+            value = nextUint();
+            options.dagConfig.grouping.targetSize = value.value_or(0);
+            options.dagConfig.grouping.minSize =
+                std::min(options.dagConfig.grouping.minSize, value.value_or(0));
+            options.dagConfig.grouping.maxSize =
+                std::max(options.dagConfig.grouping.maxSize, value.value_or(0));
+        } else if (argument == "--grouper") {
+            const std::string_view name = i + 1 < argc ? argv[++i] : "";
+            if (name == "graph") {
+                options.dagConfig.grouping.method = ClusterGrouper::Method::GraphPartition;
+            } else if (name == "spatial") {
+                options.dagConfig.grouping.method = ClusterGrouper::Method::SpatialSort;
+            } else {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Unknown grouper: {}", name)
+                ));
+            }
+        } else if (argument == "--compare-groupers") {
+            options.compareGroupers = true;
+        } else if (argument == "--cache") {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(ErrorCode::InvalidArgument, "Missing cache path"));
+            }
+            options.cacheDirectory = argv[++i];
+        } else if (argument == "--cache-size") {
+            value = nextUint();
+            options.cacheConfig.maxBytes = static_cast<uint64_t>(value.value_or(0)) << 20;
+        } else if (argument == "--threads") {
+            value = nextUint();
+            options.threadCount = value.value_or(0);
+        } else if (argument == "--no-weld") {
+            options.importConfig.weld = false;
+        } else if (argument == "--import-benchmark") {
+            options.importBenchmark = true;
+        } else if (argument == "--decode-benchmark") {
+            options.decodeBenchmark = true;
+        } else if (argument.starts_with("--")) {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidArgument,
+                std::format("Unknown option: {}", argument)
+            ));
+        } else {
+            options.inputPath = argument;
+        }
+
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+    }
+
+    if (options.inputPath.empty() && !options.sphereSegments && !options.terrainResolution) {
+        return std::unexpected(makeError(ErrorCode::InvalidArgument, "No input mesh given"));
+    }
+    if (options.decodeBenchmark && options.outputPath.empty()) {
+        return std::unexpected(makeError(
+            ErrorCode::InvalidArgument,
+            "--decode-benchmark decodes the written file and needs --output"
+        ));
+    }
+
+    return options;
+}
+
+auto loadInput(const CookOptions& options, JobSystem* jobSystem) -> Result<MeshData> {
+    if (options.sphereSegments) {
+        return MeshData::createSphere(*options.sphereSegments);
+    }
+    if (options.terrainResolution) {
+        return MeshData::createTerrain(*options.terrainResolution);
+    }
+    return MeshImporter::load(options.inputPath, jobSystem, options.importConfig);
+}
+
+auto writeFile(const std::filesystem::path& path, std::string_view contents) -> VoidResult {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+        return std::unexpected(makeError(
+            ErrorCode::FileWriteFailed,
+            std::format("Failed to write {}", path.string())
+        ));
+    }
+    return {};
+}
+
+template<typename T>
+void appendBytes(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Shortest round-trip formatting, so text formats reproduce every float exactly
+auto toObj(const MeshData& mesh) -> std::string {
+    std::string out;
+    for (const glm::vec3& p : mesh.positions) {
+        std::format_to(std::back_inserter(out), "v {} {} {}\n", p.x, p.y, p.z);
+    }
+    for (const glm::vec2& uv : mesh.uvs) {
+        std::format_to(std::back_inserter(out), "vt {} {}\n", uv.x, uv.y);
+    }
+    for (const glm::vec3& n : mesh.normals) {
+        std::format_to(std::back_inserter(out), "vn {} {} {}\n", n.x, n.y, n.z);
+    }
+    // Corners index every attribute array with the same number: "f 1/1/1 2/2/2 3/3/3"
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        out += 'f';
+        for (size_t corner = 0; corner < 3; ++corner) {
+            const uint32_t index = mesh.indices[i + corner] + 1;
+            std::format_to(std::back_inserter(out), " {}", index);
+            if (!mesh.uvs.empty()) {
+                std::format_to(std::back_inserter(out), "/{}", index);
+            } else if (!mesh.normals.empty()) {
+                out += '/';
+            }
+            if (!mesh.normals.empty()) {
+                std::format_to(std::back_inserter(out), "/{}", index);
+            }
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+auto toPly(const MeshData& mesh, bool binary) -> std::string {
+    std::string out = std::format("ply\nformat {} 1.0\nelement vertex {}\n",
+                                  binary ? "binary_little_endian" : "ascii",
+                                  mesh.positions.size());
+    out += "property float x\nproperty float y\nproperty float z\n";
+    if (!mesh.normals.empty()) {
+        out += "property float nx\nproperty float ny\nproperty float nz\n";
+    }
+    if (!mesh.uvs.empty()) {
+        out += "property float u\nproperty float v\n";
+    }
+    out += std::format("element face {}\nproperty list uchar uint vertex_indices\nend_header\n",
+                       mesh.triangleCount());
+
+    for (size_t v = 0; v < mesh.positions.size(); ++v) {
+        std::vector<float> values{mesh.positions[v].x, mesh.positions[v].y, mesh.positions[v].z};
+        if (!mesh.normals.empty()) {
+            values.insert(values.end(), {mesh.normals[v].x, mesh.normals[v].y, mesh.normals[v].z});
+        }
+        if (!mesh.uvs.empty()) {
+            values.insert(values.end(), {mesh.uvs[v].x, mesh.uvs[v].y});
+        }
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (binary) {
+                appendBytes(out, values[i]);
+            } else {
+                std::format_to(std::back_inserter(out), "{}{}", i == 0 ? "" : " ", values[i]);
+            }
+        }
+        if (!binary) {
+            out += '\n';
+        }
+    }
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        if (binary) {
+            appendBytes(out, uint8_t{3});
+            for (size_t corner = 0; corner < 3; ++corner) {
+                appendBytes(out, mesh.indices[i + corner]);
+            }
+        } else {
+            std::format_to(std::back_inserter(out), "3 {} {} {}\n", mesh.indices[i],
+                           mesh.indices[i + 1], mesh.indices[i + 2]);
+        }
+    }
+    return out;
+}
+
+// glTF JSON and its one buffer; uri is empty for GLB, whose binary chunk holds the buffer
+auto toGltf(const MeshData& mesh, std::string_view uri) -> std::pair<std::string, std::string> {
+    std::string buffer;
+    std::string views;
+    std::string accessors;
+    std::string attributes;
+    auto addView = [&](const void* data, size_t size, uint32_t target) {
+        const size_t view = views.empty() ? 0 : std::ranges::count(views, '{');
+        std::format_to(std::back_inserter(views),
+                       "{}{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{},\"target\":{}}}",
+                       views.empty() ? "" : ",", buffer.size(), size, target);
+        buffer.append(static_cast<const char*>(data), size);
+        return view;
+    };
+    auto addAccessor = [&](size_t view, uint32_t componentType, size_t count,
+                           std::string_view type, std::string_view extra) {
+        const size_t accessor = accessors.empty() ? 0 : std::ranges::count(accessors, '{');
+        std::format_to(std::back_inserter(accessors),
+                       "{}{{\"bufferView\":{},\"componentType\":{},\"count\":{},"
+                       "\"type\":\"{}\"{}}}",
+                       accessors.empty() ? "" : ",", view, componentType, count, type, extra);
+        return accessor;
+    };
+
+    glm::vec3 lower = mesh.positions.empty() ? glm::vec3{0.0f} : mesh.positions.front();
+    glm::vec3 upper = lower;
+    for (const glm::vec3& p : mesh.positions) {
+        lower = glm::min(lower, p);
+        upper = glm::max(upper, p);
+    }
+    const size_t count = mesh.positions.size();
+    const size_t positions = addAccessor(
+        addView(mesh.positions.data(), count * sizeof(glm::vec3), 34962), 5126, count, "VEC3",
+        std::format(",\"min\":[{},{},{}],\"max\":[{},{},{}]", lower.x, lower.y, lower.z,
+                    upper.x, upper.y, upper.z));
+    std::format_to(std::back_inserter(attributes), "\"POSITION\":{}", positions);
+    if (!mesh.normals.empty()) {
+        const size_t normals = addAccessor(
+            addView(mesh.normals.data(), count * sizeof(glm::vec3), 34962), 5126, count, "VEC3",
+            "");
+        std::format_to(std::back_inserter(attributes), ",\"NORMAL\":{}", normals);
+    }
+    if (!mesh.uvs.empty()) {
+        const size_t uvs = addAccessor(
+            addView(mesh.uvs.data(), count * sizeof(glm::vec2), 34962), 5126, count, "VEC2", "");
+        std::format_to(std::back_inserter(attributes), ",\"TEXCOORD_0\":{}", uvs);
+    }
+    const size_t indices = addAccessor(
+        addView(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t), 34963), 5125,
+        mesh.indices.size(), "SCALAR", "");
+
+    const std::string bufferUri = uri.empty() ? "" : std::format(",\"uri\":\"{}\"", uri);
+    std::string json = std::format(
+        "{{\"asset\":{{\"version\":\"2.0\"}},\"scene\":0,\"scenes\":[{{\"nodes\":[0]}}],"
+        "\"nodes\":[{{\"mesh\":0}}],\"meshes\":[{{\"primitives\":[{{\"attributes\":{{{}}},"
+        "\"indices\":{}}}]}}],\"buffers\":[{{\"byteLength\":{}{}}}],\"bufferViews\":[{}],"
+        "\"accessors\":[{}]}}",
+        attributes, indices, buffer.size(), bufferUri, views, accessors);
+    return {std::move(json), std::move(buffer)};
+}
+
+auto toGlb(const MeshData& mesh) -> std::string {
+    auto [json, buffer] = toGltf(mesh, "");
+    json.resize((json.size() + 3) & ~size_t{3}, ' ');
+    buffer.resize((buffer.size() + 3) & ~size_t{3}, '\0');
+
+    std::string out;
+    appendBytes(out, uint32_t{0x46546C67});
+    appendBytes(out, uint32_t{2});
+    appendBytes(out, static_cast<uint32_t>(12 + 8 + json.size() + 8 + buffer.size()));
+    appendBytes(out, static_cast<uint32_t>(json.size()));
+    appendBytes(out, uint32_t{0x4E4F534A});
+    out += json;
+    appendBytes(out, static_cast<uint32_t>(buffer.size()));
+    appendBytes(out, uint32_t{0x004E4942});
+    out += buffer;
+    return out;
+}
+
+// Imports must reproduce every triangle corner of the source bit for bit, whatever order
+// welding leaves the vertices in
+auto matchesSource(const MeshData& source, const MeshData& imported) -> bool {
+    if (imported.indices.size() != source.indices.size() ||
+        imported.normals.empty() != source.normals.empty() ||
+        imported.uvs.empty() != source.uvs.empty()) {
+        return false;
+    }
+    auto same = [](const auto& a, const auto& b) { return std::memcmp(&a, &b, sizeof(a)) == 0; };
+    for (size_t i = 0; i < source.indices.size(); ++i) {
+        const uint32_t s = source.indices[i];
+        const uint32_t d = imported.indices[i];
+        if (!same(source.positions[s], imported.positions[d]) ||
+            (!source.normals.empty() && !same(source.normals[s], imported.normals[d])) ||
+            (!source.uvs.empty() && !same(source.uvs[s], imported.uvs[d]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes the mesh in every source format and imports each back, reporting parse throughput
+auto runImportBenchmark(const CookOptions& options, const MeshData& mesh, JobSystem* jobSystem)
+    -> bool {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "vg-cook-import";
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    auto [gltfJson, gltfBuffer] = toGltf(mesh, "mesh.bin");
+    const std::pair<std::string_view, std::string> kFiles[] = {
+        {"mesh.obj", toObj(mesh)},
+        {"mesh-ascii.ply", toPly(mesh, false)},
+        {"mesh.ply", toPly(mesh, true)},
+        {"mesh.gltf", std::move(gltfJson)},
+        {"mesh.bin", std::move(gltfBuffer)},
+        {"mesh.glb", toGlb(mesh)},
+    };
+    for (const auto& [name, contents] : kFiles) {
+        if (auto result = writeFile(directory / name, contents); !result) {
+            Logger::error("{}", result.error().toString());
+            return false;
+        }
+    }
+
+    bool passed = true;
+    for (const std::string_view name : {"mesh.obj", "mesh-ascii.ply", "mesh.ply", "mesh.gltf",
+                                        "mesh.glb"}) {
+        MeshImportStats stats;
+        auto imported = MeshImporter::load(directory / name, jobSystem, options.importConfig,
+                                           &stats);
+        if (!imported) {
+            Logger::error("Import of {} failed: {}", name, imported.error().toString());
+            passed = false;
+            continue;
+        }
+        const bool matches = imported->validate().has_value() && matchesSource(mesh, *imported);
+        Logger::info("{:16} {:5} {:8.1f} MiB {:8.0f} MB/s  {}", name,
+                     MeshImporter::getFormatName(stats.format),
+                     static_cast<double>(stats.sourceBytes) / (1024 * 1024),
+                     stats.getParseMegabytesPerSecond(), matches ? "matches" : "MISMATCH");
+        passed &= matches;
+    }
+
+    std::filesystem::remove_all(directory, error);
+    if (passed) {
+        Logger::info("Every import check passed");
+    }
+    return passed;
+}
+
+// FNV-1a over the cooked DAG, used to check that cooks are reproducible
+auto hashDag(const ClusterDag& dag) -> uint64_t {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    mix(dag.mesh.vertices.data(), dag.mesh.vertices.size() * sizeof(uint32_t));
+    mix(dag.mesh.triangles.data(), dag.mesh.triangles.size());
+    for (const ClusterLod& lod : dag.lods) {
+        mix(&lod.lodBounds, sizeof(lod.lodBounds));
+        mix(&lod.error, sizeof(lod.error));
+        mix(&lod.group, sizeof(lod.group));
+    }
+    return hash;
+}
+
+struct CookResult {
+    ClusterDag dag;
+    double seconds{0.0};
+};
+
+auto cookDag(const MeshData& mesh, const ClusterDagBuilder::Config& config, JobSystem* jobSystem)
+    -> Result<CookResult> {
+    using Clock = std::chrono::steady_clock;
+    using Seconds = std::chrono::duration<double>;
+
+    const auto start = Clock::now();
+    auto dag = ClusterDagBuilder::build(mesh.positions, mesh.indices, config, jobSystem);
+    if (!dag) {
+        return std::unexpected(dag.error());
+    }
+    return CookResult{std::move(*dag), Seconds(Clock::now() - start).count()};
+}
+
+// Locked edges are the share of a level's edges on group boundaries; the kept ratio is how many
+// of its triangles survive into the next level (the simplifier aims for half)
+void logDag(const ClusterDag& dag, bool perLevel) {
+    uint64_t edgeCount = 0;
+    uint64_t lockedEdgeCount = 0;
+    uint64_t triangleCount = 0;
+    uint64_t parentTriangleCount = 0;
+    for (uint32_t level = 0; level < dag.levels.size(); ++level) {
+        const ClusterDagLevel& info = dag.levels[level];
+        edgeCount += info.edgeCount;
+        lockedEdgeCount += info.lockedEdgeCount;
+        triangleCount += info.triangleCount;
+        parentTriangleCount += info.parentTriangleCount;
+        if (perLevel) {
+            Logger::info("  Level {:2}: {:8} clusters, {:10} triangles ({:.1f} per cluster), "
+                         "{:6} groups, {:5.1f}% edges locked, {:5.1f}% triangles kept",
+                         level, info.clusterCount, info.triangleCount,
+                         static_cast<double>(info.triangleCount) / info.clusterCount,
+                         info.groupCount,
+                         100.0 * info.lockedEdgeCount / std::max(info.edgeCount, 1u),
+                         100.0 * info.parentTriangleCount /
+                             std::max(info.triangleCount, uint64_t{1}));
+        }
+    }
+
+    size_t coneCount = 0;
+    for (const Cluster& cluster : dag.mesh.clusters) {
+        coneCount += cluster.bounds.coneCutoff < 1.0f;
+    }
+
+    const size_t clusterCount = dag.mesh.clusters.size();
+    Logger::info("DAG: {} clusters, {} groups, {} levels, {} roots, {:.1f}% with cones",
+                 clusterCount, dag.groups.size(), dag.levelCount, dag.roots.size(),
+                 clusterCount ? 100.0 * coneCount / clusterCount : 0.0);
+    Logger::info("All levels: {:.1f}% edges locked, {:.1f}% triangles kept",
+                 100.0 * lockedEdgeCount / std::max(edgeCount, uint64_t{1}),
+                 100.0 * parentTriangleCount / std::max(triangleCount, uint64_t{1}));
+    if (!dag.roots.empty()) {
+        Logger::info("Root error: {:.6f}", dag.lods[dag.roots.front()].error);
+    }
+}
+
+// Returns the written file's contents; clusterOrder receives the DAG cluster ids in file order
+auto writePages(const CookOptions& options, MeshData& mesh, const ClusterDag& dag,
+                std::vector<uint32_t>& clusterOrder) -> Result<std::vector<uint8_t>> {
+    if (mesh.normals.empty()) {
+        mesh.computeNormals();
+    }
+    if (!mesh.uvs.empty() && mesh.tangents.empty()) {
+        mesh.computeTangents();
+    }
+
+    auto data = PageWriter::serialize(dag, mesh, options.pageConfig, &clusterOrder);
+    if (!data) {
+        return std::unexpected(data.error());
+    }
+    if (auto result = PageWriter::write(options.outputPath, *data); !result) {
+        return std::unexpected(result.error());
+    }
+
+    // Read the file back through the runtime loader to catch format mismatches at cook time
+    auto geometry = PagedGeometry::open(options.outputPath);
+    if (!geometry) {
+        return std::unexpected(geometry.error());
+    }
+    // The hierarchy repeats every cluster's LOD data so selection never reads a page; the
+    // copies must agree with the pages or streamed and selected clusters drift apart
+    const auto childGroups = geometry->getClusterChildGroups();
+    const auto leafLods = geometry->getLeafClusterLods();
+    uint32_t fileIndex = 0;
+    uint32_t leaf = 0;
+    for (uint32_t page = 0; page < geometry->getPageCount(); ++page) {
+        if (auto result = geometry->validatePage(page); !result) {
+            return std::unexpected(result.error());
+        }
+        const PageView view = geometry->getPage(page);
+        for (const PageCluster& cluster : view.clusters) {
+            const uint32_t childGroup = childGroups[fileIndex++];
+            PageLeafLod lod;
+            if (childGroup == kNoChildGroup) {
+                lod = leafLods[leaf++];
+            } else {
+                const PageGroup& group = geometry->getGroups()[childGroup];
+                lod = PageLeafLod{group.lodBounds, group.error};
+            }
+            if (lod.lodBounds != cluster.lodBounds || lod.error != cluster.error) {
+                return std::unexpected(makeError(
+                    ErrorCode::FileParseFailed,
+                    std::format("Page {}: hierarchy LOD data differs from the page", page)
+                ));
+            }
+        }
+    }
+
+    const PageFileHeader& header = geometry->getHeader();
+    Logger::info("Wrote {}: {} pages of {} KiB, {} KiB resident hierarchy, {:.1f} MiB total "
+                 "({:.2f} bytes per triangle)",
+                 options.outputPath, header.pageCount, header.pageSize / 1024,
+                 header.hierarchySize / 1024, static_cast<double>(data->size()) / (1024 * 1024),
+                 static_cast<double>(data->size()) / std::max(header.triangleCount, uint64_t{1}));
+    return data;
+}
+
+// Everything that changes the cooked file for the same source; the thread count does not
+auto describeSettings(const CookOptions& options) -> std::string {
+    const ClusterDagBuilder::Config& dag = options.dagConfig;
+    return std::format("sphere={} terrain={} weld={} pageSize={} positionBits={} normalBits={} "
+                       "maxVertices={} maxTriangles={} coneWeight={} grouper={} "
+                       "groupSize={}/{}/{} simplifyRatio={} maxLevels={}",
+                       options.sphereSegments.value_or(0), options.terrainResolution.value_or(0),
+                       options.importConfig.weld, options.pageConfig.pageSize,
+                       options.pageConfig.positionBits, options.pageConfig.normalBits,
+                       dag.cluster.maxVertices, dag.cluster.maxTriangles, dag.cluster.coneWeight,
+                       static_cast<uint32_t>(dag.grouping.method), dag.grouping.minSize,
+                       dag.grouping.targetSize, dag.grouping.maxSize, dag.simplifyRatio,
+                       dag.maxLevels);
+}
+
+// Triangles rotated to put their smallest index first and sorted, so encodings that reorder
+// triangles or rotate their corners without changing the winding compare equal
+auto canonicalTriangles(std::span<const uint8_t> triangles)
+    -> std::vector<std::array<uint8_t, 3>> {
+    std::vector<std::array<uint8_t, 3>> canonical;
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        std::array<uint8_t, 3> triangle{triangles[i], triangles[i + 1], triangles[i + 2]};
+        std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+        canonical.push_back(triangle);
+    }
+    std::ranges::sort(canonical);
+    return canonical;
+}
+
+auto sameDecodedPage(const DecodedPage& lhs, const DecodedPage& rhs) -> bool {
+    auto same = [](const auto& a, const auto& b) {
+        return a.size() == b.size() &&
+               (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(a[0])) == 0);
+    };
+    return lhs.clusters.size() == rhs.clusters.size() && same(lhs.positions, rhs.positions) &&
+           same(lhs.normals, rhs.normals) && same(lhs.tangents, rhs.tangents) &&
+           same(lhs.uvs, rhs.uvs) && same(lhs.triangles, rhs.triangles);
+}
+
+// Decodes the written file with the scalar reference and checks it against the source, then
+// times every kernel over all pages and checks each reproduces the reference bit for bit
+auto runDecodeBenchmark(const CookOptions& options, const MeshData& mesh, const ClusterDag& dag,
+                        std::span<const uint32_t> clusterOrder, JobSystem* jobSystem) -> bool {
+    using Clock = std::chrono::steady_clock;
+    using Seconds = std::chrono::duration<double>;
+
+    auto geometry = PagedGeometry::open(options.outputPath);
+    if (!geometry) {
+        Logger::error("{}", geometry.error().toString());
+        return false;
+    }
+    const uint32_t pageCount = geometry->getPageCount();
+
+    // Positions, normals, tangents, uvs and strips
+    uint64_t sectionBytes[5]{};
+    uint64_t usedBytes = 0;
+    uint64_t recordBytes = 0;
+    uint64_t vertexCount = 0;
+    uint64_t triangleCount = 0;
+    uint64_t restartCount = 0;
+    std::vector<DecodedPage> reference(pageCount);
+    for (uint32_t page = 0; page < pageCount; ++page) {
+        const PageView view = geometry->getPage(page);
+        usedBytes += view.data.size();
+        recordBytes += sizeof(PageHeader) + view.clusters.size() * sizeof(PageCluster);
+        for (const PageCluster& cluster : view.clusters) {
+            const PageClusterLayout layout = getClusterLayout(cluster);
+            sectionBytes[0] += layout.normals[0] - layout.positions[0];
+            sectionBytes[1] += layout.tangents[0] - layout.normals[0];
+            sectionBytes[2] += layout.uvs[0] - layout.tangents[0];
+            sectionBytes[3] += layout.stripCodes - layout.uvs[0];
+            sectionBytes[4] += layout.size - layout.stripCodes;
+            vertexCount += cluster.vertexCount;
+            triangleCount += cluster.triangleCount;
+            restartCount += (cluster.stripIndexCount - cluster.triangleCount) / 2;
+        }
+        PageDecoder::decodePage(view, reference[page], DecodeKernel::Scalar);
+    }
+
+    const auto perTriangle = [&](uint64_t bytes) {
+        return static_cast<double>(bytes) / std::max(triangleCount, uint64_t{1});
+    };
+    Logger::info("{} pages, {} vertices, {} triangles in all levels: {:.2f} bytes per triangle",
+                 pageCount, vertexCount, triangleCount, perTriangle(usedBytes));
+    Logger::info("  positions {:.2f}, normals {:.2f}, tangents {:.2f}, uvs {:.2f}, "
+                 "strips {:.2f}, cluster records {:.2f}",
+                 perTriangle(sectionBytes[0]), perTriangle(sectionBytes[1]),
+                 perTriangle(sectionBytes[2]), perTriangle(sectionBytes[3]),
+                 perTriangle(sectionBytes[4]), perTriangle(recordBytes));
+    Logger::info("Strips: {:.1f}% of triangles restart, {:.2f} bytes of indices per triangle, "
+                 "{:.1f}x smaller than 32-bit index lists",
+                 100.0 * perTriangle(restartCount), perTriangle(sectionBytes[4]),
+                 12.0 / std::max(perTriangle(sectionBytes[4]), 1e-9));
+
+    // Largest errors against the source, matching clusters up through the file order
+    auto angle = [](const glm::vec3& a, const glm::vec3& b) {
+        const float cosine = glm::dot(glm::normalize(a), glm::normalize(b));
+        return glm::degrees(std::acos(std::clamp(cosine, -1.0f, 1.0f)));
+    };
+    float positionError = 0.0f;
+    float normalError = 0.0f;
+    float tangentError = 0.0f;
+    float uvError = 0.0f;
+    uint32_t handednessMismatches = 0;
+    uint32_t triangleMismatches = 0;
+    // A vertex shared by clusters, across a border or a level, must decode to the same bits in
+    // each of them or the surface cracks between them
+    std::vector<glm::vec3> firstPositions(mesh.positions.size());
+    std::vector<uint32_t> positionUses(mesh.positions.size(), 0);
+    uint32_t crackedVertices = 0;
+    size_t orderIndex = 0;
+    for (uint32_t page = 0; page < pageCount; ++page) {
+        const DecodedPage& decoded = reference[page];
+        for (const DecodedCluster& target : decoded.clusters) {
+            const Cluster& cluster = dag.mesh.clusters[clusterOrder[orderIndex++]];
+            for (uint32_t i = 0; i < target.vertexCount; ++i) {
+                const uint32_t vertex = dag.mesh.vertices[cluster.vertexOffset + i];
+                const size_t v = target.vertexOffset + i;
+                positionError = std::max(
+                    positionError, glm::length(decoded.positions[v] - mesh.positions[vertex]));
+                if (positionUses[vertex]++ == 0) {
+                    firstPositions[vertex] = decoded.positions[v];
+                } else if (std::memcmp(&firstPositions[vertex], &decoded.positions[v],
+                                       sizeof(glm::vec3)) != 0) {
+                    ++crackedVertices;
+                }
+                normalError =
+                    std::max(normalError, angle(decoded.normals[v], mesh.normals[vertex]));
+                if (!decoded.tangents.empty()) {
+                    tangentError = std::max(tangentError,
+                                            angle(glm::vec3{decoded.tangents[v]},
+                                                  glm::vec3{mesh.tangents[vertex]}));
+                    handednessMismatches += decoded.tangents[v].w != mesh.tangents[vertex].w;
+                }
+                if (!decoded.uvs.empty()) {
+                    const glm::vec2 difference = glm::abs(decoded.uvs[v] - mesh.uvs[vertex]);
+                    uvError = std::max({uvError, difference.x, difference.y});
+                }
+            }
+            const auto decodedTriangles = std::span(decoded.triangles)
+                                              .subspan(target.triangleOffset * size_t{3},
+                                                       target.triangleCount * size_t{3});
+            const auto sourceTriangles = std::span(dag.mesh.triangles)
+                                             .subspan(cluster.triangleOffset * size_t{3},
+                                                      cluster.triangleCount * size_t{3});
+            triangleMismatches += canonicalTriangles(decodedTriangles) !=
+                                  canonicalTriangles(sourceTriangles);
+        }
+    }
+    glm::vec3 lower{std::numeric_limits<float>::max()};
+    glm::vec3 upper{std::numeric_limits<float>::lowest()};
+    for (const glm::vec3& position : mesh.positions) {
+        lower = glm::min(lower, position);
+        upper = glm::max(upper, position);
+    }
+    Logger::info("Largest errors: position {:.3g} ({:.3g} of the bounds diagonal), normal "
+                 "{:.3f} deg, tangent {:.3f} deg, uv {:.3g}",
+                 positionError, positionError / std::max(glm::length(upper - lower), 1e-30f),
+                 normalError, tangentError, uvError);
+    const auto sharedVertices = std::ranges::count_if(positionUses, [](uint32_t uses) {
+        return uses > 1;
+    });
+    Logger::info("{} vertices are shared by several clusters, {} uses decode differently",
+                 sharedVertices, crackedVertices);
+    bool passed = crackedVertices == 0;
+    if (triangleMismatches != 0 || handednessMismatches != 0) {
+        Logger::error("{} clusters decode to different triangles, {} tangents flip handedness",
+                      triangleMismatches, handednessMismatches);
+        passed = false;
+    }
+
+    uint64_t outputBytes = 0;
+    for (const DecodedPage& page : reference) {
+        outputBytes += page.positions.size() * sizeof(glm::vec3) +
+                       page.normals.size() * sizeof(glm::vec3) +
+                       page.tangents.size() * sizeof(glm::vec4) +
+                       page.uvs.size() * sizeof(glm::vec2) + page.triangles.size();
+    }
+    Logger::info("Decoding on {} threads, best kernel: {}", jobSystem->getThreadCount(),
+                 PageDecoder::getKernelName(PageDecoder::getBestKernel()));
+
+    std::vector<DecodedPage> decoded(pageCount);
+    for (const DecodeKernel kernel : {DecodeKernel::Scalar, DecodeKernel::Sse41,
+                                      DecodeKernel::Avx2}) {
+        const char* name = PageDecoder::getKernelName(kernel);
+        if (!PageDecoder::isSupported(kernel)) {
+            Logger::info("  {:>7}: not supported", name);
+            continue;
+        }
+
+        auto decodeAll = [&] {
+            jobSystem->parallelFor(pageCount, 1, [&](uint32_t page) {
+                PageDecoder::decodePage(geometry->getPage(page), decoded[page], kernel);
+            });
+        };
+        decodeAll();
+        uint32_t mismatchedPages = 0;
+        for (uint32_t page = 0; page < pageCount; ++page) {
+            mismatchedPages += !sameDecodedPage(decoded[page], reference[page]);
+        }
+
+        uint32_t passes = 0;
+        const auto start = Clock::now();
+        do {
+            decodeAll();
+            ++passes;
+        } while (passes < 3 || Seconds(Clock::now() - start).count() < 0.25);
+        const double seconds = Seconds(Clock::now() - start).count() / passes;
+        Logger::info("  {:>7}: {:7.0f} MB/s in, {:7.1f} M vertices/s, {:5.2f} GB/s out{}", name,
+                     static_cast<double>(usedBytes) / seconds * 1e-6,
+                     static_cast<double>(vertexCount) / seconds * 1e-6,
+                     static_cast<double>(outputBytes) / seconds * 1e-9,
+                     mismatchedPages ? std::format(", {} pages MISMATCH", mismatchedPages) : "");
+        passed &= mismatchedPages == 0;
+    }
+
+    if (passed) {
+        Logger::info("Every decode check passed");
+    }
+    return passed;
+}
+
+struct CacheLookup {
+    CookCache cache;
+    uint64_t key{0};
+};
+
+auto openCache(const CookOptions& options, JobSystem* jobSystem) -> Result<CacheLookup> {
+    auto cache = CookCache::open(options.cacheDirectory, options.cacheConfig);
+    if (!cache) {
+        return std::unexpected(cache.error());
+    }
+
+    // Generated meshes are fully described by their settings
+    uint64_t sourceHash = 0;
+    if (!options.inputPath.empty()) {
+        auto hash = cache->hashSource(options.inputPath, MeshImporter::findDependencies,
+                                      jobSystem);
+        if (!hash) {
+            return std::unexpected(hash.error());
+        }
+        sourceHash = *hash;
+    }
+    const uint64_t key = CookCache::makeKey(sourceHash, describeSettings(options),
+                                            kCookerVersion);
+    return CacheLookup{std::move(*cache), key};
+}
+
+void closeCache(CookCache& cache) {
+    if (auto result = cache.save(); !result) {
+        Logger::warn("Failed to save the cook cache index: {}", result.error().toString());
+    }
+
+    const CookCacheStats& stats = cache.getStats();
+    const uint64_t lookups = stats.totalHits + stats.totalMisses;
+    Logger::info("Cook cache: {} hits, {} misses; {} source files unchanged, {} hashed; "
+                 "{} hits, {} misses since created ({:.0f}% hit rate)",
+                 stats.hits, stats.misses, stats.unchangedFiles, stats.hashedFiles,
+                 stats.totalHits, stats.totalMisses,
+                 lookups ? 100.0 * stats.totalHits / lookups : 0.0);
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    Logger::init();
+
+    auto options = parseArguments(argc, argv);
+    if (!options) {
+        Logger::error("{}", options.error().toString());
+        printUsage();
+        return 1;
+    }
+
+    const auto jobSystem = JobSystem::create(options->threadCount);
+
+    // Cached cooks skip loading the source altogether; a broken cache only costs a full cook
+    std::optional<CacheLookup> cache;
+    if (!options->cacheDirectory.empty() && !options->outputPath.empty() &&
+        !options->compareGroupers && !options->importBenchmark && !options->decodeBenchmark) {
+        using Clock = std::chrono::steady_clock;
+        using Seconds = std::chrono::duration<double>;
+
+        const auto start = Clock::now();
+        auto lookup = openCache(*options, jobSystem.get());
+        auto hit = lookup ? lookup->cache.fetch(lookup->key, options->outputPath)
+                          : Result<bool>(std::unexpected(lookup.error()));
+        if (!hit) {
+            Logger::warn("Cook cache unavailable: {}", hit.error().toString());
+        } else if (*hit) {
+            Logger::info("Cook cache hit {:016x}: wrote {} in {:.1f} ms", lookup->key,
+                         options->outputPath, Seconds(Clock::now() - start).count() * 1e3);
+            closeCache(lookup->cache);
+            return 0;
+        } else {
+            cache = std::move(*lookup);
+        }
+    }
+
+    auto mesh = loadInput(*options, jobSystem.get());
+    if (!mesh) {
+        Logger::critical("Failed to load mesh: {}", mesh.error().toString());
+        return 1;
+    }
+
+    if (auto result = mesh->validate(); !result) {
+        Logger::critical("Invalid mesh: {}", result.error().toString());
+        return 1;
+    }
+
+    if (options->importBenchmark) {
+        return runImportBenchmark(*options, *mesh, jobSystem.get()) ? 0 : 1;
+    }
+
+    Logger::info("Input: {} vertices, {} triangles, {} threads", mesh->vertexCount(),
+                 mesh->triangleCount(), jobSystem->getThreadCount());
+
+    if (!options->compareGroupers) {
+        auto cook = cookDag(*mesh, options->dagConfig, jobSystem.get());
+        if (!cook) {
+            Logger::critical("Cluster DAG build failed: {}", cook.error().toString());
+            return 1;
+        }
+        logDag(cook->dag, true);
+        Logger::info("Cook time: {:.3f} s ({:.2f} M triangles/s), hash {:016x}", cook->seconds,
+                     cook->seconds > 0.0 ? mesh->triangleCount() / cook->seconds * 1e-6 : 0.0,
+                     hashDag(cook->dag));
+
+        if (!options->outputPath.empty()) {
+            std::vector<uint32_t> clusterOrder;
+            auto data = writePages(*options, *mesh, cook->dag, clusterOrder);
+            if (!data) {
+                Logger::critical("Failed to write {}: {}", options->outputPath,
+                                 data.error().toString());
+                return 1;
+            }
+            if (options->decodeBenchmark) {
+                return runDecodeBenchmark(*options, *mesh, cook->dag, clusterOrder,
+                                          jobSystem.get())
+                           ? 0
+                           : 1;
+            }
+            if (cache) {
+                if (auto result = cache->cache.store(cache->key, *data); !result) {
+                    Logger::warn("Failed to store the cook in the cache: {}",
+                                 result.error().toString());
+                }
+                closeCache(cache->cache);
+            }
+        }
+        return 0;
+    }
+
+    constexpr std::pair<ClusterGrouper::Method, std::string_view> kGroupers[] = {
+        {ClusterGrouper::Method::SpatialSort, "spatial"},
+        {ClusterGrouper::Method::GraphPartition, "graph"},
+    };
+    for (const auto& [method, name] : kGroupers) {
+        ClusterDagBuilder::Config config = options->dagConfig;
+        config.grouping.method = method;
+        auto cook = cookDag(*mesh, config, jobSystem.get());
+        if (!cook) {
+            Logger::critical("Cluster DAG build failed: {}", cook.error().toString());
+            return 1;
+        }
+
+        Logger::info("Grouper '{}':", name);
+        logDag(cook->dag, false);
+        Logger::info("Cook time: {:.3f} s", cook->seconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,724 @@
+#include "Core/JobSystem.hpp"
+#include "Culling/ClusterCulling.hpp"
+#include "Culling/ClusterHierarchy.hpp"
+#include "Culling/LodSelector.hpp"
+#include "Culling/OcclusionCuller.hpp"
+#include "Geometry/ClusterBuilder.hpp"
+#include "Geometry/ClusterDag.hpp"
+#include "Geometry/MeshData.hpp"
+#include "Logger.hpp"
+#include "Scene/InstanceStore.hpp"
+#include "Streaming/PagedGeometry.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct CullOptions {
+    std::string inputPath;
+    uint32_t terrainResolution{256};
+    uint32_t targetClusters{1'000'000};
+    uint32_t frames{60};
+    uint32_t threadCount{0};
+    float errorThreshold{1.0f};
+    // Check and time the frustum and cone culling kernels instead of LOD selection
+    bool kernels{false};
+    // Fly through a terrain with frustum, cone and Hi-Z occlusion culling instead
+    bool occlusion{false};
+    // Check and time the instance store's world bounds updates instead
+    bool instances{false};
+    uint32_t instanceCount{500'000};
+    uint32_t movingPercent{5};
+};
+
+void printUsage() {
+    Logger::info("Usage: vg-cull [geometry.vgeo] [options]");
+    Logger::info("Benchmarks CPU LOD selection over a grid of instances of one mesh.");
+    Logger::info("       vg-cull --kernels [--clusters <n>]");
+    Logger::info("Checks every SIMD culling kernel against the scalar reference and times them.");
+    Logger::info("       vg-cull --occlusion [--terrain <resolution>] [--frames <n>]");
+    Logger::info("Flies through a terrain with frustum, cone and software occlusion culling.");
+    Logger::info("       vg-cull --instances [--count <n>] [--moving <percent>] [--frames <n>]");
+    Logger::info("Checks the SIMD instance bounds kernels and times full and partial updates.");
+    Logger::info("Options:");
+    Logger::info("  --terrain <resolution>  Cook a terrain when no file is given (default 256)");
+    Logger::info("  --clusters <n>          Instance the mesh until the scene has n clusters "
+                 "(default 1000000)");
+    Logger::info("  --frames <n>            Camera path length (default 60)");
+    Logger::info("  --threshold <pixels>    Projected error threshold (default 1)");
+    Logger::info("  --count <n>             Instances in the store (default 500000)");
+    Logger::info("  --moving <percent>      Instances moved per frame (default 5)");
+    Logger::info("  --threads <n>           Worker threads including the main thread "
+                 "(default all)");
+}
+
+auto parseUint(std::string_view text) -> std::optional<uint32_t> {
+    uint32_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+auto parseArguments(int argc, char** argv) -> Result<CullOptions> {
+    CullOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+
+        auto nextUint = [&]() -> Result<uint32_t> {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Missing value for {}", argument)
+                ));
+            }
+            const auto value = parseUint(argv[++i]);
+            if (!value) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Invalid value for {}: {}", argument, argv[i])
+                ));
+            }
+            return *value;
+        };
+
+        Result<uint32_t> value;
+        if (argument == "--terrain") {
+            value = nextUint();
+            options.terrainResolution = value.value_or(0);
+        } else if (argument == "--clusters") {
+            value = nextUint();
+            options.targetClusters = value.value_or(0);
+        } else if (argument == "--frames") {
+            value = nextUint();
+            options.frames = value.value_or(0);
+        } else if (argument == "--threshold") {
+            value = nextUint();
+            options.errorThreshold = static_cast<float>(value.value_or(1));
+        } else if (argument == "--threads") {
+            value = nextUint();
+            options.threadCount = value.value_or(0);
+        } else if (argument == "--kernels") {
+            options.kernels = true;
+        } else if (argument == "--occlusion") {
+            options.occlusion = true;
+        } else if (argument == "--instances") {
+            options.instances = true;
+        } else if (argument == "--count") {
+            value = nextUint();
+            options.instanceCount = value.value_or(0);
+        } else if (argument == "--moving") {
+            value = nextUint();
+            options.movingPercent = std::min(value.value_or(0), 100u);
+        } else if (argument.starts_with("--")) {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidArgument,
+                std::format("Unknown option: {}", argument)
+            ));
+        } else {
+            options.inputPath = argument;
+        }
+
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+    }
+
+    return options;
+}
+
+auto loadHierarchy(const CullOptions& options, JobSystem* jobSystem)
+    -> Result<ClusterHierarchy> {
+    if (!options.inputPath.empty()) {
+        auto geometry = PagedGeometry::open(options.inputPath);
+        if (!geometry) {
+            return std::unexpected(geometry.error());
+        }
+        return ClusterHierarchy::fromPagedGeometry(*geometry);
+    }
+
+    const MeshData mesh = MeshData::createTerrain(options.terrainResolution);
+    auto dag = ClusterDagBuilder::build(mesh.positions, mesh.indices, ClusterDagBuilder::Config{},
+                                        jobSystem);
+    if (!dag) {
+        return std::unexpected(dag.error());
+    }
+    return ClusterHierarchy::fromDag(*dag);
+}
+
+// Square grid of instances with varying rotation about Y and scale, spaced so that neighbours
+// never overlap
+auto createInstances(const ClusterHierarchy& hierarchy, uint32_t count, float& spacing)
+    -> std::vector<LodInstance> {
+    const glm::vec4 bounds = hierarchy.getNodes()[0].bounds;
+    const auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+    spacing = bounds.w * 3.0f;
+
+    std::vector<LodInstance> instances(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const float angle = static_cast<float>(i) * 2.399963f; // Golden angle
+        const float scale = 0.75f + 0.5f * static_cast<float>((i * 7919u) % 101u) / 100.0f;
+        const float cosAngle = std::cos(angle) * scale;
+        const float sinAngle = std::sin(angle) * scale;
+        const glm::vec3 position{static_cast<float>(i % side) * spacing, 0.0f,
+                                 static_cast<float>(i / side) * spacing};
+        const glm::vec3 center = glm::vec3{bounds.x, bounds.y, bounds.z} * scale;
+        instances[i].transform = glm::mat4{
+            glm::vec4{cosAngle, 0.0f, -sinAngle, 0.0f},
+            glm::vec4{0.0f, scale, 0.0f, 0.0f},
+            glm::vec4{sinAngle, 0.0f, cosAngle, 0.0f},
+            glm::vec4{position - center, 1.0f},
+        };
+    }
+    return instances;
+}
+
+struct RunResult {
+    LodSelector::Stats total;
+    float worstMilliseconds{0.0f};
+};
+
+auto runPath(LodSelector& selector, const ClusterHierarchy& hierarchy,
+             std::span<const LodInstance> instances, std::span<const LodCamera> path,
+             JobSystem* jobSystem) -> RunResult {
+    RunResult result;
+    std::vector<SelectedCluster> cut;
+    for (const LodCamera& camera : path) {
+        const LodSelector::Stats stats =
+            selector.select(hierarchy, instances, camera, jobSystem, cut);
+        result.total.nodesVisited += stats.nodesVisited;
+        result.total.groupsTested += stats.groupsTested;
+        result.total.clustersTested += stats.clustersTested;
+        result.total.clustersSelected += stats.clustersSelected;
+        result.total.milliseconds += stats.milliseconds;
+        result.worstMilliseconds = std::max(result.worstMilliseconds, stats.milliseconds);
+    }
+    return result;
+}
+
+// Scene clusters per millisecond counts every cluster of every instance as resolved, whether
+// it was tested or skipped with its subtree
+void logRun(std::string_view name, const RunResult& result, size_t frameCount,
+            uint64_t sceneClusters) {
+    const LodSelector::Stats& total = result.total;
+    const double frames = static_cast<double>(frameCount);
+    const double milliseconds = std::max(static_cast<double>(total.milliseconds), 1e-6);
+    Logger::info("{}: {:.2f} ms/frame (worst {:.2f}), {:.0f} clusters tested/ms, "
+                 "{:.0f} scene clusters/ms", name, total.milliseconds / frames,
+                 result.worstMilliseconds, total.clustersTested / milliseconds,
+                 sceneClusters * frames / milliseconds);
+    Logger::info("  {:.0f} nodes, {:.0f} groups and {:.0f} clusters tested/frame, "
+                 "{:.0f} clusters selected/frame", total.nodesVisited / frames,
+                 total.groupsTested / frames, total.clustersTested / frames,
+                 total.clustersSelected / frames);
+}
+
+// Random spheres and cones filling a box around the camera, so every plane and the cone test
+// decide some clusters
+auto createRandomBounds(uint32_t count) -> ClusterCullBounds {
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(0.05f, 4.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> cutoff(0.0f, 1.2f);
+
+    ClusterCullBounds bounds;
+    bounds.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        glm::vec3 axis{unit(random), unit(random), unit(random)};
+        axis = glm::length(axis) > 0.0f ? glm::normalize(axis) : glm::vec3{0.0f, 0.0f, 1.0f};
+        // Wide cones get a cutoff of 1 from the cluster builder
+        bounds.add(glm::vec4{position(random), position(random), position(random), radius(random)},
+                   axis, std::min(cutoff(random), 1.0f));
+    }
+    return bounds;
+}
+
+// Vulkan perspective (depth 0 to 1, y down) looking along yaw around the Y axis
+auto createViewProjection(const glm::vec3& position, float yaw, float farDistance)
+    -> glm::mat4 {
+    const float focal = 1.0f / std::tan(glm::radians(60.0f) * 0.5f);
+    const float aspect = 16.0f / 9.0f;
+    const float nearDistance = 0.1f;
+    const glm::mat4 projection{
+        glm::vec4{focal / aspect, 0.0f, 0.0f, 0.0f},
+        glm::vec4{0.0f, -focal, 0.0f, 0.0f},
+        glm::vec4{0.0f, 0.0f, farDistance / (nearDistance - farDistance), -1.0f},
+        glm::vec4{0.0f, 0.0f, nearDistance * farDistance / (nearDistance - farDistance), 0.0f},
+    };
+
+    // The view matrix rotates by -yaw and moves the camera to the origin
+    const float cosYaw = std::cos(yaw);
+    const float sinYaw = std::sin(yaw);
+    const glm::vec3 right{cosYaw, 0.0f, -sinYaw};
+    const glm::vec3 back{sinYaw, 0.0f, cosYaw};
+    const glm::mat4 view{
+        glm::vec4{right.x, 0.0f, back.x, 0.0f},
+        glm::vec4{0.0f, 1.0f, 0.0f, 0.0f},
+        glm::vec4{right.z, 0.0f, back.z, 0.0f},
+        glm::vec4{-glm::dot(right, position), -position.y, -glm::dot(back, position), 1.0f},
+    };
+    return projection * view;
+}
+
+auto runKernelBenchmark(const CullOptions& options) -> int {
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    const ClusterCullBounds bounds = createRandomBounds(std::max(options.targetClusters, 1u));
+    std::vector<CullView> views;
+    for (uint32_t i = 0; i < 8; ++i) {
+        const float yaw = static_cast<float>(i) * glm::radians(45.0f);
+        const glm::vec3 position{std::sin(yaw) * 20.0f, 5.0f, std::cos(yaw) * 20.0f};
+        views.push_back(CullView::fromViewProjection(createViewProjection(position, yaw, 150.0f),
+                                                     position));
+        views.back().coneCulling = i % 4 != 3;
+    }
+    Logger::info("{} random clusters, {} views, best kernel: {}", bounds.count, views.size(),
+                 ClusterCuller::getKernelName(ClusterCuller::getBestKernel()));
+
+    std::vector<std::vector<uint32_t>> reference(views.size());
+    for (size_t i = 0; i < views.size(); ++i) {
+        ClusterCuller::cull(bounds, views[i], reference[i], CullKernel::Scalar);
+    }
+
+    bool allMatch = true;
+    std::vector<uint32_t> visible;
+    for (const CullKernel kernel :
+         {CullKernel::Scalar, CullKernel::Sse41, CullKernel::Avx2, CullKernel::Neon}) {
+        const char* name = ClusterCuller::getKernelName(kernel);
+        if (!ClusterCuller::isSupported(kernel)) {
+            Logger::info("  {:>7}: not supported", name);
+            continue;
+        }
+
+        uint64_t visibleCount = 0;
+        for (size_t i = 0; i < views.size(); ++i) {
+            visible.clear();
+            ClusterCuller::cull(bounds, views[i], visible, kernel);
+            visibleCount += visible.size();
+            if (visible != reference[i]) {
+                Logger::error("  {:>7}: view {} gives {} visible clusters, the reference {}",
+                              name, i, visible.size(), reference[i].size());
+                allMatch = false;
+            }
+        }
+
+        const uint32_t repeats = 4;
+        const auto start = Clock::now();
+        for (uint32_t repeat = 0; repeat < repeats; ++repeat) {
+            for (const CullView& view : views) {
+                visible.clear();
+                ClusterCuller::cull(bounds, view, visible, kernel);
+            }
+        }
+        const double milliseconds = Milliseconds(Clock::now() - start).count();
+        const double tested = static_cast<double>(bounds.count) * views.size() * repeats;
+        Logger::info("  {:>7}: {:.0f} clusters tested/ms, {:.1f}% visible", name,
+                     tested / milliseconds,
+                     100.0 * visibleCount / (static_cast<double>(bounds.count) * views.size()));
+    }
+
+    if (!allMatch) {
+        Logger::critical("SIMD culling does not match the scalar reference");
+        return 1;
+    }
+    Logger::info("Every supported kernel matches the scalar reference exactly");
+    return 0;
+}
+
+// Random affine transform: rotation about a random axis, non-uniform scale and translation
+auto createRandomTransform(std::mt19937& random) -> glm::mat4 {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+
+    glm::vec3 axis{unit(random), unit(random), unit(random)};
+    axis = glm::length(axis) > 0.0f ? glm::normalize(axis) : glm::vec3{0.0f, 1.0f, 0.0f};
+    const float angle = unit(random) * 3.14159265f;
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+    const glm::vec3 a = axis * (1.0f - c);
+    // Rodrigues' rotation matrix, columns scaled
+    const glm::vec3 scales{scale(random), scale(random), scale(random)};
+    return glm::mat4{
+        glm::vec4{c + a.x * axis.x, a.x * axis.y + s * axis.z, a.x * axis.z - s * axis.y, 0.0f} *
+            scales.x,
+        glm::vec4{a.y * axis.x - s * axis.z, c + a.y * axis.y, a.y * axis.z + s * axis.x, 0.0f} *
+            scales.y,
+        glm::vec4{a.z * axis.x + s * axis.y, a.z * axis.y - s * axis.x, c + a.z * axis.z, 0.0f} *
+            scales.z,
+        glm::vec4{position(random), position(random), position(random), 1.0f},
+    };
+}
+
+auto boundsEqual(const InstanceBounds& a, const InstanceBounds& b) -> bool {
+    return a.centerX == b.centerX && a.centerY == b.centerY && a.centerZ == b.centerZ &&
+           a.radius == b.radius;
+}
+
+// Fills an instance store, checks every SIMD kernel against the scalar reference, times full
+// updates and frames in which only some instances move, then removes and adds instances and
+// checks the handles and bounds that survive the churn
+auto runInstanceBenchmark(const CullOptions& options, JobSystem* jobSystem) -> int {
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    const uint32_t count = std::max(options.instanceCount, 1u);
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 20.0f);
+
+    InstanceStore store;
+    std::vector<uint32_t> meshes;
+    for (uint32_t i = 0; i < 64; ++i) {
+        meshes.push_back(store.addMesh(
+            glm::vec4{unit(random) * 5.0f, unit(random) * 5.0f, unit(random) * 5.0f,
+                      radius(random)}));
+    }
+    store.reserve(count);
+    std::vector<InstanceHandle> handles(count);
+    std::vector<glm::mat4> transforms(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        transforms[i] = createRandomTransform(random);
+        handles[i] = store.add(meshes[random() % meshes.size()], transforms[i],
+                               static_cast<uint8_t>(i % 4));
+    }
+    Logger::info("{} instances of {} meshes, best kernel: {}", count, meshes.size(),
+                 InstanceStore::getKernelName(InstanceStore::getBestKernel()));
+
+    store.updateBounds(nullptr, BoundsKernel::Scalar);
+    const InstanceBounds reference = store.getWorldBounds();
+
+    bool allMatch = true;
+    for (const BoundsKernel kernel : {BoundsKernel::Scalar, BoundsKernel::Sse2,
+                                      BoundsKernel::Avx2}) {
+        const char* name = InstanceStore::getKernelName(kernel);
+        if (!InstanceStore::isSupported(kernel)) {
+            Logger::info("  {:>6}: not supported", name);
+            continue;
+        }
+
+        const uint32_t repeats = 8;
+        double milliseconds = 0.0;
+        for (uint32_t repeat = 0; repeat < repeats; ++repeat) {
+            for (uint32_t i = 0; i < count; ++i) {
+                store.setTransform(handles[i], transforms[i]);
+            }
+            const auto start = Clock::now();
+            store.updateBounds(jobSystem, kernel);
+            milliseconds += Milliseconds(Clock::now() - start).count();
+        }
+        if (!boundsEqual(store.getWorldBounds(), reference)) {
+            Logger::error("  {:>6}: world bounds differ from the scalar reference", name);
+            allMatch = false;
+        }
+        Logger::info("  {:>6}: full update {:.3f} ms, {:.0f} instances/ms", name,
+                     milliseconds / repeats, count * repeats / milliseconds);
+    }
+
+    // Moving a random subset per frame touches only the blocks holding it
+    const auto movingCount = static_cast<uint32_t>(
+        static_cast<uint64_t>(count) * options.movingPercent / 100);
+    const uint32_t frames = std::max(options.frames, 1u);
+    double setMilliseconds = 0.0;
+    double updateMilliseconds = 0.0;
+    uint64_t updatedBlocks = 0;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        auto start = Clock::now();
+        for (uint32_t moved = 0; moved < movingCount; ++moved) {
+            const uint32_t i = random() % count;
+            transforms[i][3] += glm::vec4{unit(random), unit(random), unit(random), 0.0f};
+            store.setTransform(handles[i], transforms[i]);
+        }
+        setMilliseconds += Milliseconds(Clock::now() - start).count();
+        start = Clock::now();
+        store.updateBounds(jobSystem);
+        updateMilliseconds += Milliseconds(Clock::now() - start).count();
+        updatedBlocks += store.getUpdatedBlocks().size();
+    }
+    Logger::info("{}% moving: {:.3f} ms setting transforms, {:.3f} ms updating bounds per frame, "
+                 "{:.1f}% of the blocks recomputed", options.movingPercent,
+                 setMilliseconds / frames, updateMilliseconds / frames,
+                 100.0 * static_cast<double>(updatedBlocks) /
+                     (static_cast<double>(frames) * store.paddedCount() /
+                      InstanceStore::kBlockSize));
+
+    // Churn: remove every third instance, add as many back, then compare the bounds of every
+    // survivor with a fresh recomputation
+    uint32_t staleAccepted = 0;
+    for (uint32_t i = 0; i < count; i += 3) {
+        store.remove(handles[i]);
+        staleAccepted += store.setTransform(handles[i], transforms[i]) ? 1 : 0;
+    }
+    for (uint32_t i = 0; i < count; i += 3) {
+        handles[i] = store.add(meshes[i % meshes.size()], transforms[i]);
+    }
+    store.updateBounds(jobSystem);
+    const InstanceBounds churned = store.getWorldBounds();
+    for (uint32_t i = 0; i < count; ++i) {
+        store.setTransform(handles[i], transforms[i]);
+    }
+    store.updateBounds(nullptr, BoundsKernel::Scalar);
+
+    bool handlesMatch = store.getCount() == count;
+    for (uint32_t i = 0; i < count && handlesMatch; ++i) {
+        handlesMatch = store.isValid(handles[i]) &&
+                       store.getHandle(store.getIndex(handles[i])) == handles[i] &&
+                       store.getTransform(store.getIndex(handles[i])) == transforms[i];
+    }
+    if (staleAccepted > 0 || !handlesMatch) {
+        Logger::error("Handles do not survive removal: {} stale handles accepted", staleAccepted);
+        allMatch = false;
+    }
+    if (!boundsEqual(churned, store.getWorldBounds())) {
+        Logger::error("Bounds after removing and adding instances are out of date");
+        allMatch = false;
+    }
+
+    if (!allMatch) {
+        Logger::critical("Instance bounds do not match the scalar reference");
+        return 1;
+    }
+    Logger::info("Every supported kernel matches the scalar reference exactly, and handles and "
+                 "bounds survive removal");
+    return 0;
+}
+
+// Clusters of a terrain scaled up until its hills hide each other. Every frame the clusters
+// that passed the previous frame serve as occluders; the rest go through frustum and cone
+// culling, then the Hi-Z test.
+auto runOcclusionBenchmark(const CullOptions& options, JobSystem* jobSystem) -> int {
+    const float scale = 200.0f;
+    const MeshData mesh = MeshData::createTerrain(options.terrainResolution);
+    auto clusterMesh = ClusterBuilder::build(mesh.positions, mesh.indices,
+                                             ClusterBuilder::Config{}, jobSystem);
+    if (!clusterMesh) {
+        Logger::critical("Clustering failed: {}", clusterMesh.error().toString());
+        return 1;
+    }
+
+    const glm::mat4 transform{glm::vec4{scale, 0.0f, 0.0f, 0.0f},
+                              glm::vec4{0.0f, scale, 0.0f, 0.0f},
+                              glm::vec4{0.0f, 0.0f, scale, 0.0f},
+                              glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+    const auto clusterCount = static_cast<uint32_t>(clusterMesh->clusters.size());
+    std::vector<std::vector<uint32_t>> clusterIndices(clusterCount);
+    std::vector<OcclusionBox> boxes(clusterCount);
+    ClusterCullBounds bounds;
+    bounds.reserve(clusterCount);
+    for (uint32_t i = 0; i < clusterCount; ++i) {
+        const Cluster& cluster = clusterMesh->clusters[i];
+        OcclusionBox& box = boxes[i];
+        box.min = glm::vec3{std::numeric_limits<float>::max()};
+        box.max = glm::vec3{std::numeric_limits<float>::lowest()};
+        for (uint32_t t = 0; t < cluster.triangleCount * 3; ++t) {
+            const uint32_t local = clusterMesh->triangles[cluster.triangleOffset * 3 + t];
+            const uint32_t vertex = clusterMesh->vertices[cluster.vertexOffset + local];
+            clusterIndices[i].push_back(vertex);
+            box.min = glm::min(box.min, mesh.positions[vertex] * scale);
+            box.max = glm::max(box.max, mesh.positions[vertex] * scale);
+        }
+        bounds.add(glm::vec4{cluster.bounds.center * scale, cluster.bounds.radius * scale},
+                   cluster.bounds.coneAxis, cluster.bounds.coneCutoff);
+    }
+    Logger::info("Terrain: {} clusters, {} triangles, {} threads", clusterCount,
+                 mesh.triangleCount(), jobSystem->getThreadCount());
+
+    // Circle low over the terrain, looking across its centre
+    OcclusionCuller occlusion(OcclusionCuller::Config{});
+    std::vector<uint32_t> previousVisible(clusterCount);
+    std::iota(previousVisible.begin(), previousVisible.end(), 0u);
+    std::vector<uint32_t> frustumVisible;
+    std::vector<OcclusionBox> candidateBoxes;
+    std::vector<uint32_t> occlusionVisible;
+
+    OcclusionCuller::Stats total;
+    uint64_t frustumCulled = 0;
+    const uint32_t frameCount = std::max(options.frames, 1u);
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        const float angle = static_cast<float>(frame) / static_cast<float>(frameCount) *
+                            glm::radians(360.0f);
+        glm::vec3 position{std::cos(angle) * scale * 0.3f, 0.0f, std::sin(angle) * scale * 0.3f};
+        const glm::vec3* ground = &mesh.positions[0];
+        for (const glm::vec3& vertex : mesh.positions) {
+            const glm::vec2 offset{vertex.x * scale - position.x, vertex.z * scale - position.z};
+            const glm::vec2 best{ground->x * scale - position.x, ground->z * scale - position.z};
+            if (glm::dot(offset, offset) < glm::dot(best, best)) {
+                ground = &vertex;
+            }
+        }
+        position.y = ground->y * scale + 2.0f;
+        const float yaw = std::atan2(position.x, position.z);
+        const glm::mat4 viewProjection = createViewProjection(position, yaw, 1000.0f);
+
+        occlusion.beginFrame(viewProjection, position);
+        for (uint32_t cluster : previousVisible) {
+            const ClusterBounds& clusterBounds = clusterMesh->clusters[cluster].bounds;
+            occlusion.addOccluder(Occluder{mesh.positions, clusterIndices[cluster], transform,
+                                           glm::vec4{clusterBounds.center * scale,
+                                                     clusterBounds.radius * scale}});
+        }
+        occlusion.rasterize(jobSystem);
+
+        frustumVisible.clear();
+        ClusterCuller::cull(bounds, CullView::fromViewProjection(viewProjection, position),
+                            frustumVisible);
+        frustumCulled += clusterCount - frustumVisible.size();
+        candidateBoxes.clear();
+        for (uint32_t cluster : frustumVisible) {
+            candidateBoxes.push_back(boxes[cluster]);
+        }
+        occlusionVisible.clear();
+        occlusion.cullBoxes(candidateBoxes, occlusionVisible);
+
+        previousVisible.clear();
+        for (uint32_t index : occlusionVisible) {
+            previousVisible.push_back(frustumVisible[index]);
+        }
+
+        const OcclusionCuller::Stats& stats = occlusion.getStats();
+        total.occludersRasterized += stats.occludersRasterized;
+        total.trianglesRasterized += stats.trianglesRasterized;
+        total.boxesTested += stats.boxesTested;
+        total.boxesOccluded += stats.boxesOccluded;
+        total.rasterMilliseconds += stats.rasterMilliseconds;
+        total.pyramidMilliseconds += stats.pyramidMilliseconds;
+        total.testMilliseconds += stats.testMilliseconds;
+    }
+
+    const double frames = frameCount;
+    Logger::info("{}x{} depth buffer, {} triangle budget", occlusion.getWidth(),
+                 occlusion.getHeight(), OcclusionCuller::Config{}.triangleBudget);
+    Logger::info("Per frame: {:.0f} occluders, {:.0f} triangles rasterized, {:.1f}% of clusters "
+                 "outside the frustum or back-facing", total.occludersRasterized / frames,
+                 total.trianglesRasterized / frames,
+                 100.0 * frustumCulled / (frames * clusterCount));
+    Logger::info("Occlusion: {:.1f}% of the remaining clusters occluded, raster {:.3f} ms, "
+                 "pyramid {:.3f} ms, tests {:.3f} ms per frame", 100.0 * total.occludedFraction(),
+                 total.rasterMilliseconds / frames, total.pyramidMilliseconds / frames,
+                 total.testMilliseconds / frames);
+    return 0;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    Logger::init();
+
+    auto options = parseArguments(argc, argv);
+    if (!options) {
+        Logger::error("{}", options.error().toString());
+        printUsage();
+        return 1;
+    }
+    if (options->kernels) {
+        return runKernelBenchmark(*options);
+    }
+    if (options->occlusion) {
+        const auto jobSystem = JobSystem::create(options->threadCount);
+        return runOcclusionBenchmark(*options, jobSystem.get());
+    }
+    if (options->instances) {
+        const auto jobSystem = JobSystem::create(options->threadCount);
+        return runInstanceBenchmark(*options, jobSystem.get());
+    }
+
+    const auto jobSystem = JobSystem::create(options->threadCount);
+    auto hierarchy = loadHierarchy(*options, jobSystem.get());
+    if (!hierarchy) {
+        Logger::critical("Failed to load the hierarchy: {}", hierarchy.error().toString());
+        return 1;
+    }
+
+    const auto meshClusters = static_cast<uint32_t>(hierarchy->getClusters().size());
+    const uint32_t instanceCount =
+        std::max((options->targetClusters + meshClusters - 1) / meshClusters, 1u);
+    float spacing = 0.0f;
+    const std::vector<LodInstance> instances = createInstances(*hierarchy, instanceCount, spacing);
+    Logger::info("Scene: {} instances x {} clusters = {} clusters, {} groups and {} BVH nodes "
+                 "per mesh, {} levels", instanceCount, meshClusters,
+                 static_cast<uint64_t>(instanceCount) * meshClusters,
+                 hierarchy->getGroups().size(), hierarchy->getNodes().size(),
+                 hierarchy->getLevelCount());
+
+    // Low diagonal flight across the grid, looking at 1080p with a 60 degree field of view
+    const float gridSize = std::ceil(std::sqrt(static_cast<float>(instanceCount))) * spacing;
+    std::vector<LodCamera> path;
+    for (uint32_t frame = 0; frame < std::max(options->frames, 1u); ++frame) {
+        const float t =
+            static_cast<float>(frame) / static_cast<float>(std::max(options->frames, 2u) - 1);
+        const glm::vec3 position{t * gridSize, spacing * 0.25f, t * gridSize};
+        path.push_back(LodCamera::fromPerspective(position, glm::radians(60.0f), 1080.0f, 0.1f,
+                                                  options->errorThreshold));
+    }
+
+    // The BVH traversal must pick exactly the clusters the exhaustive test picks
+    LodSelector selector;
+    std::vector<SelectedCluster> cut;
+    std::vector<SelectedCluster> reference;
+    for (const LodCamera& camera : {path.front(), path[path.size() / 2]}) {
+        selector.select(*hierarchy, instances, camera, jobSystem.get(), cut);
+        LodSelector::selectBruteForce(*hierarchy, instances, camera, reference);
+        const bool matches = std::ranges::equal(cut, reference, [](const auto& a, const auto& b) {
+            return a.instance == b.instance && a.cluster == b.cluster;
+        });
+        if (!matches) {
+            Logger::critical("BVH selection picked {} clusters, exhaustive selection {}",
+                             cut.size(), reference.size());
+            return 1;
+        }
+    }
+    Logger::info("BVH selection matches exhaustive selection");
+
+    // Pages run from coarse to fine and depend only on earlier ones, so the first half of a
+    // cooked file is a residency state the cache can reach
+    uint32_t pageCount = 0;
+    for (const HierarchyCluster& cluster : hierarchy->getClusters()) {
+        pageCount = std::max(pageCount, cluster.page + 1);
+    }
+    if (pageCount > 1) {
+        std::vector<uint8_t> residentPages(pageCount, 0);
+        std::fill_n(residentPages.begin(), (pageCount + 1) / 2, uint8_t{1});
+        const LodSelector::Stats partial = selector.select(*hierarchy, instances, path.front(),
+                                                           jobSystem.get(), cut, residentPages);
+        LodSelector::selectBruteForce(*hierarchy, instances, path.front(), reference,
+                                      residentPages);
+        const bool matches = std::ranges::equal(cut, reference, [](const auto& a, const auto& b) {
+            return a.instance == b.instance && a.cluster == b.cluster;
+        });
+        const bool resident = std::ranges::all_of(cut, [&](const SelectedCluster& selected) {
+            return residentPages[hierarchy->getClusters()[selected.cluster].page] != 0;
+        });
+        if (!matches || !resident) {
+            Logger::critical("Selection over {} of {} pages differs from exhaustive selection "
+                             "or reaches a missing page", (pageCount + 1) / 2, pageCount);
+            return 1;
+        }
+        Logger::info("With {} of {} pages resident: {} clusters, {} standing in for missing "
+                     "pages", (pageCount + 1) / 2, pageCount, partial.clustersSelected,
+                     partial.clustersFallback);
+    }
+
+    const LodSelector::Stats bruteForce =
+        LodSelector::selectBruteForce(*hierarchy, instances, path.front(), reference);
+    const uint64_t sceneClusters = static_cast<uint64_t>(instanceCount) * meshClusters;
+    logRun("Exhaustive", RunResult{bruteForce, bruteForce.milliseconds}, 1, sceneClusters);
+    logRun("BVH, 1 thread", runPath(selector, *hierarchy, instances, path, nullptr), path.size(),
+           sceneClusters);
+    const std::string parallelName = std::format("BVH, {} threads", jobSystem->getThreadCount());
+    logRun(parallelName, runPath(selector, *hierarchy, instances, path, jobSystem.get()),
+           path.size(), sceneClusters);
+    return 0;
+}
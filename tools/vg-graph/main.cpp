@@ -0,0 +1,542 @@
+#include "Logger.hpp"
+#include "Render/RenderGraph.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct GraphOptions {
+    uint32_t width{3840};
+    uint32_t height{2160};
+    uint32_t iterations{1000};
+    bool verbose{false};
+};
+
+void printUsage() {
+    Logger::info("Usage: vg-graph [options]");
+    Logger::info("Compiles the render graph of a virtual geometry frame, checks the schedule,");
+    Logger::info("barriers and memory aliasing, and reports the transient memory saved.");
+    Logger::info("Options:");
+    Logger::info("  --width <pixels>        Target width (default 3840)");
+    Logger::info("  --height <pixels>       Target height (default 2160)");
+    Logger::info("  --iterations <n>        Compilations to time (default 1000)");
+    Logger::info("  --verbose               Print every pass with its barriers");
+}
+
+auto parseUint(std::string_view text) -> std::optional<uint32_t> {
+    uint32_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+auto parseArguments(int argc, char** argv) -> Result<GraphOptions> {
+    GraphOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+
+        auto nextUint = [&]() -> Result<uint32_t> {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Missing value for {}", argument)
+                ));
+            }
+            const auto value = parseUint(argv[++i]);
+            if (!value || *value == 0) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Invalid value for {}: {}", argument, argv[i])
+                ));
+            }
+            return *value;
+        };
+
+        Result<uint32_t> value;
+        if (argument == "--width") {
+            value = nextUint();
+            options.width = value.value_or(0);
+        } else if (argument == "--height") {
+            value = nextUint();
+            options.height = value.value_or(0);
+        } else if (argument == "--iterations") {
+            value = nextUint();
+            options.iterations = value.value_or(0);
+        } else if (argument == "--verbose") {
+            options.verbose = true;
+        } else {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidArgument,
+                std::format("Unknown option: {}", argument)
+            ));
+        }
+
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+    }
+
+    return options;
+}
+
+// Declarations mirrored outside the graph, so the compiled schedule can be checked against
+// every dependency without trusting the compiler's own bookkeeping
+struct Declarations {
+    struct Version {
+        uint32_t writer{std::numeric_limits<uint32_t>::max()};
+        std::vector<uint32_t> readers;
+    };
+
+    // Per resource, per version
+    std::vector<std::vector<Version>> versions;
+    std::vector<uint64_t> sizes;
+};
+
+class GraphBuilder {
+public:
+    auto image(std::string name, uint64_t bytes) -> RenderGraphHandle {
+        // Optimal tiling images are placed on 64 KiB boundaries by every driver we target
+        return add(m_graph.createResource(RenderGraphResourceDesc{
+            std::move(name), ResourceKind::Image, bytes, 64 * 1024}), bytes);
+    }
+    auto buffer(std::string name, uint64_t bytes) -> RenderGraphHandle {
+        return add(m_graph.createResource(RenderGraphResourceDesc{
+            std::move(name), ResourceKind::Buffer, bytes, 256}), bytes);
+    }
+    auto importResource(std::string name, ResourceKind kind, UsageMask initial, UsageMask final = 0)
+        -> RenderGraphHandle {
+        return add(m_graph.importResource(std::move(name), kind, initial, final), 0);
+    }
+
+    auto pass(std::string name) -> uint32_t { return m_graph.addPass(std::move(name)); }
+    void read(uint32_t pass, RenderGraphHandle handle, ResourceUsage usage) {
+        m_graph.read(pass, handle, usage);
+        m_declarations.versions[handle.resource][handle.version].readers.push_back(pass);
+    }
+    auto write(uint32_t pass, RenderGraphHandle handle, ResourceUsage usage)
+        -> RenderGraphHandle {
+        const RenderGraphHandle written = m_graph.write(pass, handle, usage);
+        auto& versions = m_declarations.versions[handle.resource];
+        versions.resize(std::max<size_t>(versions.size(), written.version + 1));
+        versions[written.version].writer = pass;
+        return written;
+    }
+
+    [[nodiscard]] auto getGraph() const -> const RenderGraph& { return m_graph; }
+    [[nodiscard]] auto getDeclarations() const -> const Declarations& { return m_declarations; }
+
+private:
+    auto add(RenderGraphHandle handle, uint64_t bytes) -> RenderGraphHandle {
+        m_declarations.versions.emplace_back(1);
+        m_declarations.sizes.push_back(bytes);
+        return handle;
+    }
+
+    RenderGraph m_graph;
+    Declarations m_declarations;
+};
+
+// Cull -> rasterize -> material resolve -> post, as the GPU path will run it.
+// reverseIndependent moves a pass with no inputs to the front of the declarations, which is
+// the same program and must compile to a valid schedule with the same memory footprint.
+auto buildFrame(const GraphOptions& options, bool reverseIndependent) -> GraphBuilder {
+    using enum ResourceUsage;
+    GraphBuilder builder;
+    const uint64_t pixels = static_cast<uint64_t>(options.width) * options.height;
+    const uint64_t quarterPixels = pixels / 16;
+
+    const auto swapchain =
+        builder.importResource("swapchain", ResourceKind::Image, 0, usageBit(Present));
+    const auto pages = builder.importResource("cluster pages", ResourceKind::Buffer,
+                                      usageBit(TransferWrite));
+    const auto instances = builder.importResource("instances", ResourceKind::Buffer,
+                                          usageBit(TransferWrite));
+    // Read by the next frame's occlusion culling, so it outlives the graph
+    const auto hiZ = builder.importResource("hi-z", ResourceKind::Image, usageBit(SampledRead));
+
+    auto visibleInstances = builder.buffer("visible instances", 4ull << 20);
+    auto visibleClusters = builder.buffer("visible clusters", 16ull << 20);
+    auto rasterArgs = builder.buffer("raster arguments", 4096);
+    auto visibility = builder.image("visibility buffer", pixels * 8);
+    auto depth = builder.image("depth", pixels * 4);
+    auto albedo = builder.image("albedo", pixels * 4);
+    auto normals = builder.image("normals", pixels * 8);
+    auto hdr = builder.image("hdr color", pixels * 8);
+    auto bloom = builder.image("bloom", quarterPixels * 8);
+    auto overdraw = builder.image("overdraw", pixels * 4);
+
+    // Independent of culling: with reverseIndependent it is declared first, and the schedule
+    // must be valid either way
+    auto declareClear = [&]() {
+        const uint32_t clear = builder.pass("clear visibility");
+        visibility = builder.write(clear, visibility, TransferWrite);
+    };
+    if (reverseIndependent) {
+        declareClear();
+    }
+
+    const uint32_t instanceCull = builder.pass("instance cull");
+    builder.read(instanceCull, instances, StorageRead);
+    visibleInstances = builder.write(instanceCull, visibleInstances, StorageWrite);
+
+    const uint32_t clusterCull = builder.pass("cluster cull");
+    builder.read(clusterCull, visibleInstances, StorageRead);
+    builder.read(clusterCull, pages, StorageRead);
+    visibleClusters = builder.write(clusterCull, visibleClusters, StorageWrite);
+    rasterArgs = builder.write(clusterCull, rasterArgs, StorageWrite);
+
+    if (!reverseIndependent) {
+        declareClear();
+    }
+
+    const uint32_t softwareRaster = builder.pass("software raster");
+    builder.read(softwareRaster, visibleClusters, StorageRead);
+    builder.read(softwareRaster, rasterArgs, IndirectRead);
+    builder.read(softwareRaster, pages, StorageRead);
+    visibility = builder.write(softwareRaster, visibility, StorageWrite);
+
+    const uint32_t hardwareRaster = builder.pass("hardware raster");
+    builder.read(hardwareRaster, visibleClusters, StorageRead);
+    builder.read(hardwareRaster, rasterArgs, IndirectRead);
+    builder.read(hardwareRaster, pages, StorageRead);
+    visibility = builder.write(hardwareRaster, visibility, StorageWrite);
+    depth = builder.write(hardwareRaster, depth, DepthAttachmentWrite);
+
+    const uint32_t buildHiZ = builder.pass("build hi-z");
+    builder.read(buildHiZ, depth, SampledRead);
+    static_cast<void>(builder.write(buildHiZ, hiZ, StorageWrite));
+
+    // Debug view nobody consumes: culled
+    const uint32_t overdrawView = builder.pass("overdraw view");
+    builder.read(overdrawView, visibility, StorageRead);
+    overdraw = builder.write(overdrawView, overdraw, StorageWrite);
+
+    const uint32_t materialResolve = builder.pass("material resolve");
+    builder.read(materialResolve, visibility, StorageRead);
+    builder.read(materialResolve, pages, StorageRead);
+    albedo = builder.write(materialResolve, albedo, StorageWrite);
+    normals = builder.write(materialResolve, normals, StorageWrite);
+
+    const uint32_t lighting = builder.pass("lighting");
+    builder.read(lighting, albedo, SampledRead);
+    builder.read(lighting, normals, SampledRead);
+    builder.read(lighting, depth, SampledRead);
+    hdr = builder.write(lighting, hdr, StorageWrite);
+
+    const uint32_t bloomPass = builder.pass("bloom");
+    builder.read(bloomPass, hdr, SampledRead);
+    bloom = builder.write(bloomPass, bloom, StorageWrite);
+
+    const uint32_t tonemap = builder.pass("tonemap");
+    builder.read(tonemap, hdr, SampledRead);
+    builder.read(tonemap, bloom, SampledRead);
+    static_cast<void>(builder.write(tonemap, swapchain, ColorAttachmentWrite));
+
+    return builder;
+}
+
+struct CheckResult {
+    uint32_t failures{0};
+
+    void expect(bool condition, std::string_view message) {
+        if (!condition) {
+            Logger::error("  FAILED: {}", message);
+            ++failures;
+        }
+    }
+};
+
+// Every dependency is honoured, no two live transients share memory, and every transient
+// image starts with a discarding transition
+void checkCompiled(const GraphBuilder& builder, const CompiledRenderGraph& compiled,
+                   CheckResult& result) {
+    const RenderGraph& graph = builder.getGraph();
+    const Declarations& declarations = builder.getDeclarations();
+
+    std::vector<uint32_t> position(graph.getPassCount(), std::numeric_limits<uint32_t>::max());
+    for (uint32_t index = 0; index < compiled.passes.size(); ++index) {
+        position[compiled.passes[index].pass] = index;
+    }
+    auto scheduled = [&](uint32_t pass) {
+        return pass < position.size() && position[pass] != std::numeric_limits<uint32_t>::max();
+    };
+
+    for (uint32_t r = 0; r < declarations.versions.size(); ++r) {
+        const auto& versions = declarations.versions[r];
+        for (size_t v = 0; v < versions.size(); ++v) {
+            const uint32_t writer = versions[v].writer;
+            for (const uint32_t reader : versions[v].readers) {
+                if (scheduled(reader)) {
+                    result.expect(v == 0 || scheduled(writer),
+                                  std::format("{} runs without the writer of {}",
+                                              graph.getPassName(reader), graph.getResourceName(r)));
+                    result.expect(v == 0 || !scheduled(writer) ||
+                                      position[writer] < position[reader],
+                                  std::format("{} reads {} before it is written",
+                                              graph.getPassName(reader), graph.getResourceName(r)));
+                }
+            }
+            if (v + 1 < versions.size() && scheduled(versions[v + 1].writer)) {
+                const uint32_t next = versions[v + 1].writer;
+                for (const uint32_t reader : versions[v].readers) {
+                    result.expect(!scheduled(reader) || position[reader] < position[next],
+                                  std::format("{} overwrites {} before {} read it",
+                                              graph.getPassName(next), graph.getResourceName(r),
+                                              graph.getPassName(reader)));
+                }
+                result.expect(v == 0 || position[writer] < position[next],
+                              std::format("Writes of {} are reordered", graph.getResourceName(r)));
+            }
+        }
+    }
+
+    for (uint32_t a = 0; a < graph.getResourceCount(); ++a) {
+        const CompiledRenderGraph::Allocation& first = compiled.allocations[a];
+        if (graph.isImported(a) || !first.used) {
+            continue;
+        }
+        result.expect(first.offset + declarations.sizes[a] <= compiled.heapSize,
+                      std::format("{} lies outside the heap", graph.getResourceName(a)));
+        for (uint32_t b = a + 1; b < graph.getResourceCount(); ++b) {
+            const CompiledRenderGraph::Allocation& second = compiled.allocations[b];
+            if (graph.isImported(b) || !second.used) {
+                continue;
+            }
+            const bool alive = first.firstPass <= second.lastPass &&
+                               second.firstPass <= first.lastPass;
+            const bool shared = first.offset < second.offset + declarations.sizes[b] &&
+                                second.offset < first.offset + declarations.sizes[a];
+            result.expect(!(alive && shared),
+                          std::format("{} and {} are alive at once in the same memory",
+                                      graph.getResourceName(a), graph.getResourceName(b)));
+        }
+    }
+
+    std::vector<bool> seen(graph.getResourceCount(), false);
+    for (const CompiledRenderGraph::Pass& pass : compiled.passes) {
+        std::vector<bool> inBatch(graph.getResourceCount(), false);
+        for (const RenderGraphBarrier& barrier : compiled.getPassBarriers(pass)) {
+            result.expect(!inBatch[barrier.resource],
+                          std::format("Two barriers for {} before {}",
+                                      graph.getResourceName(barrier.resource),
+                                      graph.getPassName(pass.pass)));
+            inBatch[barrier.resource] = true;
+            if (!seen[barrier.resource] && !graph.isImported(barrier.resource) &&
+                graph.getResourceKind(barrier.resource) == ResourceKind::Image) {
+                result.expect(barrier.discard,
+                              std::format("First use of {} keeps undefined contents",
+                                          graph.getResourceName(barrier.resource)));
+            }
+            seen[barrier.resource] = true;
+        }
+    }
+}
+
+// Declarations the compiler must reject
+void checkErrors(CheckResult& result) {
+    {
+        RenderGraph graph;
+        const auto target = graph.importResource("target", ResourceKind::Image, 0);
+        const auto scratch = graph.createResource(RenderGraphResourceDesc{
+            "scratch", ResourceKind::Image, 1024, 1});
+        const uint32_t pass = graph.addPass("reads garbage");
+        graph.read(pass, scratch, ResourceUsage::SampledRead);
+        static_cast<void>(graph.write(pass, target, ResourceUsage::ColorAttachmentWrite));
+        result.expect(!graph.compile(), "Reading a transient nobody wrote compiles");
+    }
+    {
+        RenderGraph graph;
+        const auto target = graph.importResource("target", ResourceKind::Buffer, 0);
+        const uint32_t first = graph.addPass("first");
+        const uint32_t second = graph.addPass("second");
+        static_cast<void>(graph.write(first, target, ResourceUsage::StorageWrite));
+        static_cast<void>(graph.write(second, target, ResourceUsage::StorageWrite));
+        result.expect(!graph.compile(), "Writing an overwritten version compiles");
+    }
+    {
+        // a reads what b produces from what a produces
+        RenderGraph graph;
+        const auto x = graph.importResource("x", ResourceKind::Buffer, 0);
+        const auto y = graph.importResource("y", ResourceKind::Buffer, 0);
+        const uint32_t a = graph.addPass("a");
+        const uint32_t b = graph.addPass("b");
+        const auto xWritten = graph.write(a, x, ResourceUsage::StorageWrite);
+        graph.read(b, xWritten, ResourceUsage::StorageRead);
+        const auto yWritten = graph.write(b, y, ResourceUsage::StorageWrite);
+        graph.read(a, yWritten, ResourceUsage::StorageRead);
+        result.expect(!graph.compile(), "A dependency cycle compiles");
+    }
+    {
+        RenderGraph graph;
+        const auto target = graph.importResource("target", ResourceKind::Image, 0);
+        const uint32_t pass = graph.addPass("two layouts");
+        const auto written = graph.write(pass, target, ResourceUsage::ColorAttachmentWrite);
+        graph.read(pass, written, ResourceUsage::SampledRead);
+        result.expect(!graph.compile(), "An image in two layouts in one pass compiles");
+    }
+}
+
+// A transient taking over memory waits for the last write to its predecessor and every read
+// since, not just the predecessor's last pass
+void checkAliasing(CheckResult& result) {
+    RenderGraph graph;
+    const auto first = graph.createResource(RenderGraphResourceDesc{
+        "first", ResourceKind::Buffer, 1024, 1});
+    const auto second = graph.createResource(RenderGraphResourceDesc{
+        "second", ResourceKind::Buffer, 1024, 1});
+    const auto args = graph.importResource("args", ResourceKind::Buffer, 0);
+    const auto counts = graph.importResource("counts", ResourceKind::Buffer, 0);
+    const auto output = graph.importResource("output", ResourceKind::Buffer, 0);
+
+    const uint32_t produce = graph.addPass("produce");
+    const auto firstWritten = graph.write(produce, first, ResourceUsage::StorageWrite);
+    const uint32_t indirect = graph.addPass("indirect");
+    graph.read(indirect, firstWritten, ResourceUsage::IndirectRead);
+    static_cast<void>(graph.write(indirect, args, ResourceUsage::StorageWrite));
+    const uint32_t storage = graph.addPass("storage");
+    graph.read(storage, firstWritten, ResourceUsage::StorageRead);
+    const auto countsWritten = graph.write(storage, counts, ResourceUsage::StorageWrite);
+    const uint32_t reuse = graph.addPass("reuse");
+    graph.read(reuse, countsWritten, ResourceUsage::StorageRead);
+    const auto secondWritten = graph.write(reuse, second, ResourceUsage::StorageWrite);
+    const uint32_t consume = graph.addPass("consume");
+    graph.read(consume, secondWritten, ResourceUsage::StorageRead);
+    static_cast<void>(graph.write(consume, output, ResourceUsage::StorageWrite));
+
+    auto compiled = graph.compile();
+    if (!compiled) {
+        result.expect(false, "The aliasing graph does not compile");
+        return;
+    }
+    result.expect(compiled->allocations[first.resource].offset ==
+                      compiled->allocations[second.resource].offset,
+                  "Buffers with disjoint lifetimes are not aliased");
+    const UsageMask expected = usageBit(ResourceUsage::StorageWrite) |
+                               usageBit(ResourceUsage::IndirectRead) |
+                               usageBit(ResourceUsage::StorageRead);
+    const auto barrier = std::ranges::find(compiled->barriers, second.resource,
+                                           &RenderGraphBarrier::resource);
+    result.expect(barrier != compiled->barriers.end() && barrier->discard &&
+                      (barrier->before & expected) == expected,
+                  "An aliased buffer does not wait for every use of the memory it takes over");
+}
+
+auto formatUsages(UsageMask usages) -> std::string {
+    static constexpr std::array kNames{"color", "depth-read", "depth-write", "sampled",
+                                       "storage-read", "storage-write", "indirect",
+                                       "transfer-read", "transfer-write", "present"};
+    static_assert(kNames.size() == static_cast<size_t>(ResourceUsage::Count));
+    if (usages == 0) {
+        return "none";
+    }
+    std::string text;
+    for (size_t i = 0; i < kNames.size(); ++i) {
+        if (usages & (1u << i)) {
+            text += text.empty() ? "" : "|";
+            text += kNames[i];
+        }
+    }
+    return text;
+}
+
+void printSchedule(const RenderGraph& graph, const CompiledRenderGraph& compiled) {
+    for (const CompiledRenderGraph::Pass& pass : compiled.passes) {
+        Logger::info("  {} ({} barriers)", graph.getPassName(pass.pass), pass.barrierCount);
+        for (const RenderGraphBarrier& barrier : compiled.getPassBarriers(pass)) {
+            Logger::info("      {}: {} -> {}{}", graph.getResourceName(barrier.resource),
+                         formatUsages(barrier.before), formatUsages(barrier.after),
+                         barrier.discard ? " (discard)" : "");
+        }
+    }
+    for (const RenderGraphBarrier& barrier : compiled.getFinalBarriers()) {
+        Logger::info("  final: {}: {} -> {}", graph.getResourceName(barrier.resource),
+                     formatUsages(barrier.before), formatUsages(barrier.after));
+    }
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    Logger::init();
+
+    auto options = parseArguments(argc, argv);
+    if (!options) {
+        Logger::error("{}", options.error().toString());
+        printUsage();
+        return 1;
+    }
+
+    CheckResult checks;
+    const GraphBuilder builder = buildFrame(*options, false);
+    const RenderGraph& graph = builder.getGraph();
+    auto compiled = graph.compile();
+    if (!compiled) {
+        Logger::critical("Compilation failed: {}", compiled.error().toString());
+        return 1;
+    }
+
+    Logger::info("Frame at {}x{}: {} passes ({} culled), {} resources, {} barriers in {} batches",
+                 options->width, options->height, graph.getPassCount(),
+                 compiled->culledPassCount, graph.getResourceCount(), compiled->barriers.size(),
+                 compiled->passes.size() + (compiled->getFinalBarriers().empty() ? 0 : 1));
+    if (options->verbose) {
+        printSchedule(graph, *compiled);
+    } else {
+        std::string order;
+        for (const CompiledRenderGraph::Pass& pass : compiled->passes) {
+            order += order.empty() ? "" : " -> ";
+            order += graph.getPassName(pass.pass);
+        }
+        Logger::info("  {}", order);
+    }
+
+    const double mebibyte = 1024.0 * 1024.0;
+    Logger::info("Transient memory: {:.1f} MiB aliased into {:.1f} MiB ({:.0f}% saved)",
+                 compiled->transientSize / mebibyte, compiled->heapSize / mebibyte,
+                 100.0 * (1.0 - static_cast<double>(compiled->heapSize) /
+                                    std::max<double>(compiled->transientSize, 1.0)));
+
+    checkCompiled(builder, *compiled, checks);
+    checks.expect(compiled->culledPassCount == 1, "The unused overdraw view is not culled");
+
+    // Same program, different declaration order
+    const GraphBuilder reordered = buildFrame(*options, true);
+    if (auto reorderedCompiled = reordered.getGraph().compile(); reorderedCompiled) {
+        checkCompiled(reordered, *reorderedCompiled, checks);
+        checks.expect(reorderedCompiled->heapSize == compiled->heapSize,
+                      "Declaration order changes the heap size");
+    } else {
+        checks.expect(false, "The reordered frame does not compile");
+    }
+    checkErrors(checks);
+    checkAliasing(checks);
+
+    using Clock = std::chrono::steady_clock;
+    using Microseconds = std::chrono::duration<double, std::micro>;
+    const auto start = Clock::now();
+    size_t barrierCount = 0;
+    for (uint32_t i = 0; i < options->iterations; ++i) {
+        barrierCount += graph.compile()->barriers.size();
+    }
+    Logger::info("Compile: {:.2f} us per frame graph",
+                 Microseconds(Clock::now() - start).count() / options->iterations);
+    static_cast<void>(barrierCount);
+
+    if (checks.failures > 0) {
+        Logger::critical("{} render graph checks failed", checks.failures);
+        return 1;
+    }
+    Logger::info("Every render graph check passed");
+    return 0;
+}
@@ -0,0 +1,303 @@
+#include "Core/JobSystem.hpp"
+#include "Geometry/ClusterBuilder.hpp"
+#include "Geometry/MeshData.hpp"
+#include "Logger.hpp"
+#include "Raster/SoftwareRasterizer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct RasterOptions {
+    uint32_t sphereSegments{512};
+    uint32_t terrainResolution{0}; // Cook a terrain instead of a sphere when set
+    uint32_t instances{16};
+    uint32_t frames{30};
+    uint32_t threadCount{0};
+    uint32_t width{1280};
+    uint32_t height{720};
+    std::string outputPath; // PPM of the last frame, coloured by cluster
+};
+
+void printUsage() {
+    Logger::info("Usage: vg-raster [options]");
+    Logger::info("Orbits a grid of clustered meshes with the software rasterizer, checks that");
+    Logger::info("the visibility buffer does not depend on the thread count and reports");
+    Logger::info("triangle throughput.");
+    Logger::info("Options:");
+    Logger::info("  --sphere <segments>     Sphere tessellation (default 512)");
+    Logger::info("  --terrain <resolution>  Use a terrain instead of the sphere");
+    Logger::info("  --instances <n>         Instances in the grid (default 16)");
+    Logger::info("  --frames <n>            Camera path length (default 30)");
+    Logger::info("  --width <pixels>        Visibility buffer width (default 1280)");
+    Logger::info("  --height <pixels>       Visibility buffer height (default 720)");
+    Logger::info("  --threads <n>           Worker threads including the main thread "
+                 "(default all)");
+    Logger::info("  --output <file.ppm>     Write the last frame coloured by cluster");
+}
+
+auto parseUint(std::string_view text) -> std::optional<uint32_t> {
+    uint32_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+auto parseArguments(int argc, char** argv) -> Result<RasterOptions> {
+    RasterOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+
+        auto nextUint = [&]() -> Result<uint32_t> {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Missing value for {}", argument)
+                ));
+            }
+            const auto value = parseUint(argv[++i]);
+            if (!value || *value == 0) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Invalid value for {}: {}", argument, argv[i])
+                ));
+            }
+            return *value;
+        };
+
+        Result<uint32_t> value;
+        if (argument == "--sphere") {
+            value = nextUint();
+            options.sphereSegments = value.value_or(0);
+        } else if (argument == "--terrain") {
+            value = nextUint();
+            options.terrainResolution = value.value_or(0);
+        } else if (argument == "--instances") {
+            value = nextUint();
+            options.instances = value.value_or(0);
+        } else if (argument == "--frames") {
+            value = nextUint();
+            options.frames = value.value_or(0);
+        } else if (argument == "--width") {
+            value = nextUint();
+            options.width = value.value_or(0);
+        } else if (argument == "--height") {
+            value = nextUint();
+            options.height = value.value_or(0);
+        } else if (argument == "--threads") {
+            value = nextUint();
+            options.threadCount = value.value_or(0);
+        } else if (argument == "--output") {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    "Missing value for --output"
+                ));
+            }
+            options.outputPath = argv[++i];
+        } else {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidArgument,
+                std::format("Unknown option: {}", argument)
+            ));
+        }
+
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+    }
+
+    return options;
+}
+
+// Vulkan perspective (depth 0 to 1, y down) at position, looking horizontally at target
+auto createViewProjection(const glm::vec3& position, const glm::vec3& target, float aspect)
+    -> glm::mat4 {
+    const float focal = 1.0f / std::tan(glm::radians(60.0f) * 0.5f);
+    const float nearDistance = 0.05f;
+    const float farDistance = 1000.0f;
+    const glm::mat4 projection{
+        glm::vec4{focal / aspect, 0.0f, 0.0f, 0.0f},
+        glm::vec4{0.0f, -focal, 0.0f, 0.0f},
+        glm::vec4{0.0f, 0.0f, farDistance / (nearDistance - farDistance), -1.0f},
+        glm::vec4{0.0f, 0.0f, nearDistance * farDistance / (nearDistance - farDistance), 0.0f},
+    };
+
+    const float yaw = std::atan2(position.x - target.x, position.z - target.z);
+    const glm::vec3 right{std::cos(yaw), 0.0f, -std::sin(yaw)};
+    const glm::vec3 back{std::sin(yaw), 0.0f, std::cos(yaw)};
+    const glm::mat4 view{
+        glm::vec4{right.x, 0.0f, back.x, 0.0f},
+        glm::vec4{0.0f, 1.0f, 0.0f, 0.0f},
+        glm::vec4{right.z, 0.0f, back.z, 0.0f},
+        glm::vec4{-glm::dot(right, position), -position.y, -glm::dot(back, position), 1.0f},
+    };
+    return projection * view;
+}
+
+void submitScene(SoftwareRasterizer& rasterizer, const MeshData& mesh,
+                 const ClusterMesh& clusters, std::span<const glm::mat4> transforms) {
+    for (const glm::mat4& transform : transforms) {
+        for (const Cluster& cluster : clusters.clusters) {
+            rasterizer.addCluster(RasterCluster{
+                mesh.positions,
+                std::span(clusters.vertices).subspan(cluster.vertexOffset, cluster.vertexCount),
+                std::span(clusters.triangles)
+                    .subspan(static_cast<size_t>(cluster.triangleOffset) * 3,
+                             static_cast<size_t>(cluster.triangleCount) * 3),
+                transform,
+            });
+        }
+    }
+}
+
+auto writePpm(const std::string& path, const SoftwareRasterizer& rasterizer) -> bool {
+    std::ofstream file(path, std::ios::binary);
+    file << std::format("P6\n{} {}\n255\n", rasterizer.getWidth(), rasterizer.getHeight());
+    for (const uint64_t value : rasterizer.getVisibilityBuffer()) {
+        uint32_t hash = value == SoftwareRasterizer::kEmpty
+                            ? 0u
+                            : SoftwareRasterizer::getCluster(value) * 2654435761u | 0x404040u;
+        const char rgb[3] = {static_cast<char>(hash >> 16), static_cast<char>(hash >> 8),
+                             static_cast<char>(hash)};
+        file.write(rgb, 3);
+    }
+    return file.good();
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    Logger::init();
+
+    auto options = parseArguments(argc, argv);
+    if (!options) {
+        Logger::error("{}", options.error().toString());
+        printUsage();
+        return 1;
+    }
+
+    const auto jobSystem = JobSystem::create(options->threadCount);
+    const MeshData mesh = options->terrainResolution > 0
+                              ? MeshData::createTerrain(options->terrainResolution)
+                              : MeshData::createSphere(options->sphereSegments);
+    auto clusters = ClusterBuilder::build(mesh.positions, mesh.indices, ClusterBuilder::Config{},
+                                          jobSystem.get());
+    if (!clusters) {
+        Logger::critical("Clustering failed: {}", clusters.error().toString());
+        return 1;
+    }
+
+    // Square grid of unit-sized instances two units apart
+    const auto side =
+        static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(options->instances))));
+    std::vector<glm::mat4> transforms;
+    for (uint32_t i = 0; i < options->instances; ++i) {
+        transforms.push_back(glm::mat4{
+            glm::vec4{1.0f, 0.0f, 0.0f, 0.0f},
+            glm::vec4{0.0f, 1.0f, 0.0f, 0.0f},
+            glm::vec4{0.0f, 0.0f, 1.0f, 0.0f},
+            glm::vec4{static_cast<float>(i % side) * 2.0f, 0.0f,
+                      static_cast<float>(i / side) * 2.0f, 1.0f},
+        });
+    }
+    const float center = static_cast<float>(side - 1);
+    const glm::vec3 target{center, 0.0f, center};
+    Logger::info("Scene: {} instances x {} clusters, {} triangles, {}x{}, {} threads",
+                 options->instances, clusters->clusters.size(),
+                 clusters->triangleCount() * options->instances, options->width, options->height,
+                 jobSystem->getThreadCount());
+
+    SoftwareRasterizer::Config config;
+    config.width = options->width;
+    config.height = options->height;
+    SoftwareRasterizer rasterizer(config);
+    const float aspect = static_cast<float>(options->width) / static_cast<float>(options->height);
+    auto cameraAt = [&](uint32_t frame) {
+        const float angle = static_cast<float>(frame) / static_cast<float>(options->frames) *
+                            glm::radians(360.0f);
+        const float distance = static_cast<float>(side) * 1.5f + 1.0f;
+        const glm::vec3 position = target + glm::vec3{std::cos(angle) * distance, 0.6f,
+                                                      std::sin(angle) * distance};
+        return createViewProjection(position, target, aspect);
+    };
+
+    // The atomic min makes the result independent of scheduling, so one thread and many must
+    // agree on every pixel
+    rasterizer.beginFrame(cameraAt(0));
+    submitScene(rasterizer, mesh, *clusters, transforms);
+    rasterizer.render(nullptr);
+    const std::vector<uint64_t> reference(rasterizer.getVisibilityBuffer().begin(),
+                                          rasterizer.getVisibilityBuffer().end());
+    rasterizer.beginFrame(cameraAt(0));
+    submitScene(rasterizer, mesh, *clusters, transforms);
+    rasterizer.render(jobSystem.get());
+    const auto covered = std::ranges::count_if(
+        reference, [](uint64_t value) { return value != SoftwareRasterizer::kEmpty; });
+    if (!std::ranges::equal(reference, rasterizer.getVisibilityBuffer())) {
+        Logger::critical("The visibility buffer depends on the thread count");
+        return 1;
+    }
+    if (covered == 0) {
+        Logger::critical("Nothing was rasterized");
+        return 1;
+    }
+    Logger::info("Single and multithreaded visibility buffers match, {:.1f}% of pixels covered",
+                 100.0 * static_cast<double>(covered) / static_cast<double>(reference.size()));
+
+    SoftwareRasterizer::Stats total;
+    float worstMilliseconds = 0.0f;
+    for (uint32_t frame = 0; frame < options->frames; ++frame) {
+        rasterizer.beginFrame(cameraAt(frame));
+        submitScene(rasterizer, mesh, *clusters, transforms);
+        rasterizer.render(jobSystem.get());
+
+        const SoftwareRasterizer::Stats& stats = rasterizer.getStats();
+        total.trianglesSubmitted += stats.trianglesSubmitted;
+        total.trianglesCulled += stats.trianglesCulled;
+        total.trianglesClipped += stats.trianglesClipped;
+        total.microTriangles += stats.microTriangles;
+        total.binnedTriangles += stats.binnedTriangles;
+        total.binEntries += stats.binEntries;
+        total.setupMilliseconds += stats.setupMilliseconds;
+        total.binMilliseconds += stats.binMilliseconds;
+        total.tileMilliseconds += stats.tileMilliseconds;
+        total.milliseconds += stats.milliseconds;
+        worstMilliseconds = std::max(worstMilliseconds, stats.milliseconds);
+    }
+
+    const double frames = options->frames;
+    const double drawn = static_cast<double>(total.microTriangles + total.binnedTriangles);
+    Logger::info("{:.2f} ms/frame (worst {:.2f}): setup and micro-triangles {:.2f}, binning "
+                 "{:.2f}, tiles {:.2f}", total.milliseconds / frames, worstMilliseconds,
+                 total.setupMilliseconds / frames, total.binMilliseconds / frames,
+                 total.tileMilliseconds / frames);
+    Logger::info("{:.1f} Mtris/s submitted, {:.1f}% culled, {:.0f} clipped/frame, "
+                 "{:.1f}% of drawn triangles micro, {:.2f} tiles per binned triangle",
+                 static_cast<double>(total.trianglesSubmitted) /
+                     std::max(static_cast<double>(total.milliseconds), 1e-6) / 1000.0,
+                 100.0 * static_cast<double>(total.trianglesCulled) /
+                     std::max(static_cast<double>(total.trianglesSubmitted), 1.0),
+                 static_cast<double>(total.trianglesClipped) / frames,
+                 100.0 * static_cast<double>(total.microTriangles) / std::max(drawn, 1.0),
+                 static_cast<double>(total.binEntries) /
+                     std::max(static_cast<double>(total.binnedTriangles), 1.0));
+
+    if (!options->outputPath.empty()) {
+        if (!writePpm(options->outputPath, rasterizer)) {
+            Logger::critical("Failed to write {}", options->outputPath);
+            return 1;
+        }
+        Logger::info("Wrote {}", options->outputPath);
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include "Logger.hpp"
+#include "Streaming/PageCache.hpp"
+#include "Streaming/PageStreamer.hpp"
+#include "Streaming/PagedGeometry.hpp"
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct StreamOptions {
+    std::string inputPath;
+    PageStreamer::Config streamerConfig;
+    uint32_t passes{1};
+    // Cache simulation instead of a full-file pass when set
+    std::optional<uint32_t> cacheBudgetMib;
+    uint32_t frames{600};
+};
+
+void printUsage() {
+    Logger::info("Usage: vg-stream <geometry.vgeo> [options]");
+    Logger::info("Streams every page through the page streamer and reports throughput.");
+    Logger::info("Options:");
+    Logger::info("  --backend <name>        I/O backend: uring (default, falls back) or pread");
+    Logger::info("  --io-threads <n>        I/O threads (default 2)");
+    Logger::info("  --in-flight <n>         Maximum pages in flight (default 32)");
+    Logger::info("  --in-flight-kib <n>     Maximum bytes in flight in KiB (default 8192)");
+    Logger::info("  --staging-slots <n>     Page-sized staging slots (default 64)");
+    Logger::info("  --no-validate           Skip page verification on the I/O threads");
+    Logger::info("  --passes <n>            Stream the whole file this many times (default 1)");
+    Logger::info("  --cache-mib <n>         Simulate a camera sweep through a page cache of n MiB");
+    Logger::info("  --frames <n>            Frames to simulate with --cache-mib (default 600)");
+}
+
+auto parseUint(std::string_view text) -> std::optional<uint32_t> {
+    uint32_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+auto parseArguments(int argc, char** argv) -> Result<StreamOptions> {
+    StreamOptions options;
+    PageStreamer::Config& config = options.streamerConfig;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+
+        auto nextUint = [&]() -> Result<uint32_t> {
+            if (i + 1 >= argc) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Missing value for {}", argument)
+                ));
+            }
+            const auto value = parseUint(argv[++i]);
+            if (!value) {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Invalid value for {}: {}", argument, argv[i])
+                ));
+            }
+            return *value;
+        };
+
+        Result<uint32_t> value;
+        if (argument == "--backend") {
+            const std::string_view name = i + 1 < argc ? argv[++i] : "";
+            if (name == "uring") {
+                config.preferIoUring = true;
+            } else if (name == "pread") {
+                config.preferIoUring = false;
+            } else {
+                return std::unexpected(makeError(
+                    ErrorCode::InvalidArgument,
+                    std::format("Unknown backend: {}", name)
+                ));
+            }
+        } else if (argument == "--io-threads") {
+            value = nextUint();
+            config.ioThreadCount = value.value_or(0);
+        } else if (argument == "--in-flight") {
+            value = nextUint();
+            config.maxInFlightPages = value.value_or(0);
+        } else if (argument == "--in-flight-kib") {
+            value = nextUint();
+            config.maxInFlightBytes = static_cast<uint64_t>(value.value_or(0)) * 1024;
+        } else if (argument == "--staging-slots") {
+            value = nextUint();
+            config.stagingSlotCount = value.value_or(0);
+        } else if (argument == "--no-validate") {
+            config.validatePages = false;
+        } else if (argument == "--passes") {
+            value = nextUint();
+            options.passes = value.value_or(0);
+        } else if (argument == "--cache-mib") {
+            value = nextUint();
+            options.cacheBudgetMib = value.value_or(0);
+        } else if (argument == "--frames") {
+            value = nextUint();
+            options.frames = value.value_or(0);
+        } else if (argument.starts_with("--")) {
+            return std::unexpected(makeError(
+                ErrorCode::InvalidArgument,
+                std::format("Unknown option: {}", argument)
+            ));
+        } else {
+            options.inputPath = argument;
+        }
+
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+    }
+
+    if (options.inputPath.empty()) {
+        return std::unexpected(makeError(ErrorCode::InvalidArgument, "No input file given"));
+    }
+
+    return options;
+}
+
+// Requests every page each update, coarsest first as a renderer would, until all have arrived
+auto streamAllPages(const PagedGeometry& geometry, PageStreamer& streamer) -> uint32_t {
+    const uint32_t pageCount = geometry.getPageCount();
+    std::vector<bool> arrived(pageCount, false);
+    std::vector<PageStreamer::CompletedPage> completed;
+    uint32_t remaining = pageCount;
+    uint32_t failed = 0;
+
+    while (remaining > 0) {
+        for (uint32_t page = 0; page < pageCount; ++page) {
+            if (!arrived[page]) {
+                // Pages are stored coarsest level first
+                streamer.request(page, static_cast<float>(pageCount - page));
+            }
+        }
+        streamer.update();
+
+        completed.clear();
+        streamer.takeCompleted(completed);
+        for (const PageStreamer::CompletedPage& page : completed) {
+            if (!arrived[page.page]) {
+                arrived[page.page] = true;
+                --remaining;
+                failed += page.valid ? 0 : 1;
+            }
+            streamer.releaseStaging(page.slot);
+        }
+        if (completed.empty()) {
+            std::this_thread::yield();
+        }
+    }
+    return failed;
+}
+
+// A view sweeping across the file: every frame wants the roots plus a window of pages around a
+// moving center, nearer pages first. Pages are stored coarsest first, so the window moves from
+// coarse to fine detail and back.
+auto simulateCache(const PagedGeometry& geometry, PageStreamer& streamer, uint32_t budgetMib,
+                   uint32_t frames) -> VoidResult {
+    auto cache = PageCache::create(geometry, streamer,
+                                   PageCache::Config{static_cast<uint64_t>(budgetMib) << 20});
+    if (!cache) {
+        return std::unexpected(cache.error());
+    }
+
+    const uint32_t pageCount = geometry.getPageCount();
+    std::vector<uint32_t> rootPages;
+    for (uint32_t page = 0; page < pageCount; ++page) {
+        if (geometry.getPageDependencies(page).empty()) {
+            rootPages.push_back(page);
+        }
+    }
+
+    const uint32_t window = std::max(pageCount / 4, 1u);
+    const uint32_t period = 2 * pageCount;
+    uint64_t peakResidentBytes = 0;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        (*cache)->beginFrame();
+        for (uint32_t page : rootPages) {
+            (*cache)->request(page, std::numeric_limits<float>::infinity());
+        }
+
+        // Triangle wave so the sweep turns around at either end of the file
+        const uint32_t phase = frame % period;
+        const uint32_t center = phase < pageCount ? phase : period - phase - 1;
+        const uint32_t first = center > window / 2 ? center - window / 2 : 0;
+        for (uint32_t page = first; page < std::min(first + window, pageCount); ++page) {
+            const auto distance = static_cast<float>(page > center ? page - center : center - page);
+            (*cache)->request(page, -distance);
+        }
+
+        (*cache)->update();
+        peakResidentBytes = std::max(peakResidentBytes, (*cache)->getStats().residentBytes);
+        // Gives the I/O threads a frame's worth of time
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    const PageCache::Stats stats = (*cache)->getStats();
+    Logger::info("Cache: {} requests, {:.1f}% hits, {} installed, {} evictions, {} rejected, "
+                 "{} re-requested for an evicted dependency, {} failed", stats.requests,
+                 stats.hitRate() * 100.0f, stats.installed, stats.evictions, stats.rejected,
+                 stats.dependencyMisses, stats.failed);
+    Logger::info("Resident: {} of {} slots, {:.1f} MiB, peak {:.1f} MiB of {:.1f} MiB budget",
+                 stats.residentPages, stats.slotCount,
+                 static_cast<double>(stats.residentBytes) / (1 << 20),
+                 static_cast<double>(peakResidentBytes) / (1 << 20),
+                 static_cast<double>(stats.budgetBytes) / (1 << 20));
+
+    std::string levels;
+    for (uint32_t count : (*cache)->getLevelHistogram()) {
+        levels += std::format(" {}", count);
+    }
+    Logger::info("Resident pages per level (finest first):{}", levels);
+
+    std::string ages;
+    for (uint32_t count : (*cache)->getAgeHistogram()) {
+        ages += std::format(" {}", count);
+    }
+    Logger::info("Resident pages by frames unused (0, 1, 2-3, 4-7, ...):{}", ages);
+    return {};
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    Logger::init();
+
+    auto options = parseArguments(argc, argv);
+    if (!options) {
+        Logger::error("{}", options.error().toString());
+        printUsage();
+        return 1;
+    }
+
+    auto geometry = PagedGeometry::open(options->inputPath);
+    if (!geometry) {
+        Logger::critical("Failed to open {}: {}", options->inputPath,
+                         geometry.error().toString());
+        return 1;
+    }
+
+    auto streamer = PageStreamer::create(*geometry, options->inputPath, options->streamerConfig);
+    if (!streamer) {
+        Logger::critical("Failed to start streaming: {}", streamer.error().toString());
+        return 1;
+    }
+
+    if (options->cacheBudgetMib) {
+        auto result = simulateCache(*geometry, **streamer, *options->cacheBudgetMib,
+                                    options->frames);
+        if (!result) {
+            Logger::critical("Cache simulation failed: {}", result.error().toString());
+            return 1;
+        }
+        return 0;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    using Seconds = std::chrono::duration<double>;
+    uint32_t failed = 0;
+    const auto start = Clock::now();
+    for (uint32_t pass = 0; pass < options->passes; ++pass) {
+        failed += streamAllPages(*geometry, **streamer);
+    }
+    const double seconds = Seconds(Clock::now() - start).count();
+
+    const PageStreamer::Stats stats = (*streamer)->getStats();
+    Logger::info("Backend {}: {} pages, {:.1f} MiB in {:.3f} s ({:.1f} MiB/s, {:.0f} pages/s)",
+                 (*streamer)->getBackendName(), stats.completed,
+                 static_cast<double>(stats.bytesRead) / (1 << 20), seconds,
+                 seconds > 0.0 ? static_cast<double>(stats.bytesRead) / (1 << 20) / seconds : 0.0,
+                 seconds > 0.0 ? static_cast<double>(stats.completed) / seconds : 0.0);
+    Logger::info("Requests: {} made, {} merged, {} dispatched, {} failed", stats.requested,
+                 stats.deduplicated, stats.dispatched, stats.failed);
+    Logger::info("Request latency: p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms",
+                 stats.latencyP50Ms, stats.latencyP95Ms, stats.latencyP99Ms);
+    Logger::info("I/O latency:     p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms",
+                 stats.ioLatencyP50Ms, stats.ioLatencyP95Ms, stats.ioLatencyP99Ms);
+
+    return failed == 0 ? 0 : 1;
+}